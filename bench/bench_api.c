@@ -0,0 +1,162 @@
+// Times every student_logic call the app is built on, at several list sizes,
+// over the synthetic dataset from bench_util.h. Results go to stdout as one
+// JSON document so runs from different releases can be diffed by a script;
+// progress notes go to stderr.
+// Usage: bench_api [rows ...]   (default 1,000 100,000 10,000,000)
+//
+// Each size starts from an empty column-layout list:
+//   addStudent      every row, in generator order
+//   searchStudent   random rolls, all hits
+//   modifyStudent   random rolls, new marks
+//   sortStudents    the whole list, by marks, once
+//   getAverageMarks repeated calls
+//   saveToFile      the whole list
+//   loadFromFile    the file just saved, into an empty list
+//   rollRange       windows of RANGE_WIDTH consecutive rolls, random starts
+//   removeStudent   random rolls (each one shifts the tail, so fewer of them
+//                   at large sizes)
+//
+// Build: make benchmarks   (build/bench_api; the Makefile has the source list)
+
+#include "bench_util.h"
+#include <string.h>
+
+#define SEED 20240611u
+#define LOOKUPS 1000000
+#define AVERAGE_CALLS 10000000
+#define RANGE_QUERIES 100000
+#define RANGE_WIDTH 100
+#define MAX_REMOVES 1000
+#define REMOVE_ROW_BUDGET 20000000LL // removes * rows: keeps the 10M run to seconds
+
+static int firstRun = 1;
+
+static void report(int rows, const char *op, long long iterations, double seconds) {
+    printf("%s\n    {\"rows\": %d, \"op\": \"%s\", \"iterations\": %lld, \"seconds\": %.6f, \"ns_per_op\": %.1f}",
+           firstRun ? "" : ",", rows, op, iterations, seconds, iterations > 0 ? seconds * 1e9 / iterations : 0.0);
+    firstRun = 0;
+    fflush(stdout);
+}
+
+static void fail(const char *what, int rows) {
+    fprintf(stderr, "%s failed at %d rows\n", what, rows);
+    exit(EXIT_FAILURE);
+}
+
+static void benchSize(int n) {
+    fprintf(stderr, "%d rows...\n", n);
+    BenchGenerator gen;
+    if (!benchGeneratorInit(&gen, n, SEED)) fail("Generator", n);
+    StudentList list;
+    initListLayout(&list, LAYOUT_COLUMNS);
+
+    // addStudent
+    double start = benchNow();
+    for (int i = 0; i < n; i++) {
+        char name[64];
+        int roll;
+        float marks;
+        benchGenerate(&gen, i, name, sizeof(name), &roll, &marks);
+        if (!addStudent(&list, name, roll, marks)) fail("addStudent", n);
+    }
+    report(n, "addStudent", n, benchNow() - start);
+
+    // searchStudent
+    unsigned seed = SEED ^ (unsigned)n;
+    long long found = 0;
+    start = benchNow();
+    for (int q = 0; q < LOOKUPS; q++) {
+        found += searchStudent(&list, gen.rolls[benchRand(&seed) % (unsigned)n]) >= 0;
+    }
+    report(n, "searchStudent", LOOKUPS, benchNow() - start);
+    if (found != LOOKUPS) fail("searchStudent", n);
+
+    // modifyStudent
+    start = benchNow();
+    for (int q = 0; q < LOOKUPS; q++) {
+        unsigned r = benchRand(&seed);
+        if (!modifyStudent(&list, gen.rolls[r % (unsigned)n], NULL, (float)((r >> 8) % 201) / 2.0f)) {
+            fail("modifyStudent", n);
+        }
+    }
+    report(n, "modifyStudent", LOOKUPS, benchNow() - start);
+
+    // sortStudents
+    start = benchNow();
+    sortStudents(&list, 1);
+    report(n, "sortStudents", 1, benchNow() - start);
+
+    // getAverageMarks
+    volatile float sink = 0;
+    start = benchNow();
+    for (int q = 0; q < AVERAGE_CALLS; q++) {
+        sink += getAverageMarks(&list);
+    }
+    report(n, "getAverageMarks", AVERAGE_CALLS, benchNow() - start);
+    (void)sink;
+
+    // saveToFile / loadFromFile
+    start = benchNow();
+    if (!saveToFile(&list, FILENAME)) fail("saveToFile", n);
+    report(n, "saveToFile", 1, benchNow() - start);
+    freeList(&list);
+
+    initListLayout(&list, LAYOUT_COLUMNS);
+    start = benchNow();
+    if (!loadFromFile(&list, FILENAME) || list.count != n) fail("loadFromFile", n);
+    report(n, "loadFromFile", 1, benchNow() - start);
+
+    // rollRange (the load built the order)
+    int rows[RANGE_WIDTH];
+    found = 0;
+    start = benchNow();
+    for (int q = 0; q < RANGE_QUERIES; q++) {
+        int from = 1 + (int)(benchRand(&seed) % (unsigned)n);
+        found += rollRange(&list, from, from + RANGE_WIDTH - 1, rows, RANGE_WIDTH);
+    }
+    report(n, "rollRange", RANGE_QUERIES, benchNow() - start);
+    if (found < RANGE_QUERIES) fail("rollRange", n);
+
+    // removeStudent
+    long long removes = REMOVE_ROW_BUDGET / n;
+    if (removes > MAX_REMOVES) removes = MAX_REMOVES;
+    if (removes > n) removes = n;
+    if (removes < 1) removes = 1;
+    start = benchNow();
+    for (long long q = 0; q < removes; q++) {
+        // Distinct rolls: walk the shuffled roll order from the back
+        if (!removeStudent(&list, gen.rolls[n - 1 - q])) fail("removeStudent", n);
+    }
+    report(n, "removeStudent", removes, benchNow() - start);
+
+    freeList(&list);
+    benchGeneratorFree(&gen);
+    remove(FILENAME);
+}
+
+int main(int argc, char *argv[]) {
+    int defaults[] = { 1000, 100000, 10000000 };
+    int sizes[64];
+    int count = 0;
+    for (int a = 1; a < argc && count < 64; a++) {
+        sizes[count] = atoi(argv[a]);
+        if (sizes[count] < 1) {
+            fprintf(stderr, "Usage: %s [rows ...]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        count++;
+    }
+    if (count == 0) {
+        memcpy(sizes, defaults, sizeof(defaults));
+        count = BENCH_COUNT(defaults);
+    }
+
+    benchEnterScratchDir();
+
+    printf("{\n  \"benchmark\": \"student_api\",\n  \"compiler\": \"%s\",\n  \"seed\": %u,\n  \"runs\": [", __VERSION__, SEED);
+    for (int s = 0; s < count; s++) {
+        benchSize(sizes[s]);
+    }
+    printf("\n  ]\n}\n");
+    return 0;
+}
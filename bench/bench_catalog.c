@@ -0,0 +1,90 @@
+// Catalog costs with many shards: building and saving a sharded dataset,
+// reopening the catalog (manifest only), the first lookup (one shard
+// loaded), then the whole-dataset calls that load every shard in parallel.
+// Run once with CSV shards and once with snapshot shards.
+// Usage: bench_catalog [shards] [rows per shard]   (default 2,000 and 2,000)
+//
+// Build: make benchmarks   (build/bench_catalog; the Makefile has the source list)
+
+#include "bench_util.h"
+#include "../student_catalog.h"
+
+static void fail(const char *what) {
+    fprintf(stderr, "%s failed\n", what);
+    exit(EXIT_FAILURE);
+}
+
+static void row(const char *what, double seconds) {
+    printf("  %-34s %10.4f\n", what, seconds);
+}
+
+static void benchShards(const char *name, int snapshots, int shards, int perShard) {
+    int n = shards * perShard;
+    BenchGenerator gen;
+    if (!benchGeneratorInit(&gen, n, 4242u)) fail("Generator");
+    printf("%s shards: %d x %d rows\n", snapshots ? "snapshot" : "CSV", shards, perShard);
+
+    StudentCatalog catalog;
+    if (!catalogOpen(&catalog, "catalog")) fail("catalogOpen");
+    CatalogDataset *dataset = catalogCreateDataset(&catalog, name, perShard, snapshots);
+    if (dataset == NULL) fail("catalogCreateDataset");
+    double start = benchNow();
+    for (int i = 0; i < n; i++) {
+        char student[64];
+        int roll;
+        float marks;
+        benchGenerate(&gen, i, student, sizeof(student), &roll, &marks);
+        if (!catalogAddStudent(&catalog, dataset, student, roll, marks)) fail("catalogAddStudent");
+    }
+    row("add (routed)", benchNow() - start);
+    start = benchNow();
+    if (!catalogSave(&catalog)) fail("catalogSave");
+    row("save (parallel)", benchNow() - start);
+    catalogClose(&catalog);
+
+    start = benchNow();
+    if (!catalogOpen(&catalog, "catalog")) fail("catalogOpen");
+    row("open (manifest only)", benchNow() - start);
+    dataset = catalogDataset(&catalog, name);
+    if (dataset == NULL || catalogCount(dataset) != n) fail("catalogCount");
+
+    CatalogRow found;
+    start = benchNow();
+    if (!catalogSearchStudent(&catalog, dataset, gen.rolls[0], &found)) fail("catalogSearchStudent");
+    row("first lookup (loads 1 shard)", benchNow() - start);
+
+    start = benchNow();
+    if (!catalogLoadDataset(&catalog, dataset)) fail("catalogLoadDataset");
+    row("load the rest (parallel)", benchNow() - start);
+
+    ClassStats stats;
+    start = benchNow();
+    if (!catalogStats(&catalog, dataset, &stats) || stats.count != n) fail("catalogStats");
+    row("stats (gathered)", benchNow() - start);
+
+    CatalogRow rows[1000];
+    start = benchNow();
+    if (catalogSearchByName(&catalog, dataset, "Grace", NAME_MATCH_PREFIX, 0, rows, 1000) < 0) fail("catalogSearchByName");
+    row("name search (scatter-gather)", benchNow() - start);
+
+    start = benchNow();
+    if (catalogRollRange(&catalog, dataset, n / 2, n / 2 + 999, rows, 1000) != 1000) fail("catalogRollRange");
+    row("1000-roll range (routed)", benchNow() - start);
+
+    catalogClose(&catalog);
+    benchGeneratorFree(&gen);
+}
+
+int main(int argc, char *argv[]) {
+    int shards = argc > 1 ? atoi(argv[1]) : 2000;
+    int perShard = argc > 2 ? atoi(argv[2]) : 2000;
+    if (shards < 1 || perShard < 1 || (long long)shards * perShard > 100000000) {
+        fprintf(stderr, "Usage: %s [shards] [rows per shard]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    benchEnterScratchDir();
+    printf("  %-34s %10s\n", "", "seconds");
+    benchShards("csv", 0, shards, perShard);
+    benchShards("snap", 1, shards, perShard);
+    return 0;
+}
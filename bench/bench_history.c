@@ -0,0 +1,120 @@
+// Undo history: what it costs ordinary mutations, and what an undo point,
+// a named version and an undo/redo cost in time and memory.
+// Usage: bench_history [rows]   (default 1,000,000)
+//
+// Each mutation is timed with the history off, on, and on with an undo
+// point before every call (the worst case: every call is its own step, so
+// each pays for copying the spine and the chunk it writes to).
+//
+// Build: make benchmarks   (build/bench_history; the Makefile has the source list)
+
+#include "bench_util.h"
+
+typedef enum { HISTORY_OFF, HISTORY_ON, HISTORY_EVERY_CALL } HistoryMode;
+
+#define ADDS 100000
+#define MODIFIES 100000
+#define REMOVES 200 // Each one moves the rows above it
+
+static void setUp(StudentList *list, int n, HistoryMode mode) {
+    initListLayout(list, LAYOUT_COLUMNS);
+    benchFillList(list, n, 777u);
+    if (mode != HISTORY_OFF) {
+        enableHistory(list);
+        markUndoPoint(list, "start"); // Makes the history's copy now, outside the timings
+    }
+}
+
+// ns per call for adds, modifies and removes in the given mode
+static void timeMutations(int n, HistoryMode mode, double *ns) {
+    StudentList list;
+    setUp(&list, n, mode);
+    unsigned seed = 99u;
+
+    double start = benchNow();
+    for (int i = 0; i < ADDS; i++) {
+        if (mode == HISTORY_EVERY_CALL) markUndoPoint(&list, "add");
+        addStudent(&list, "Added Student", n + 1 + i, 55.0f);
+    }
+    ns[0] = (benchNow() - start) * 1e9 / ADDS;
+
+    start = benchNow();
+    for (int i = 0; i < MODIFIES; i++) {
+        if (mode == HISTORY_EVERY_CALL) markUndoPoint(&list, "modify");
+        int roll = (int)(benchRand(&seed) % (unsigned)n) + 1;
+        modifyStudent(&list, roll, (i & 1) ? "Renamed Student" : "", (float)(i % 101));
+    }
+    ns[1] = (benchNow() - start) * 1e9 / MODIFIES;
+
+    start = benchNow();
+    for (int i = 0; i < REMOVES; i++) {
+        if (mode == HISTORY_EVERY_CALL) markUndoPoint(&list, "remove");
+        removeStudent(&list, studentRoll(&list, (int)(benchRand(&seed) % (unsigned)list.count)));
+    }
+    ns[2] = (benchNow() - start) * 1e9 / REMOVES;
+    freeList(&list);
+}
+
+static void timeUndo(StudentList *list, const char *label) {
+    double start = benchNow();
+    int ok = undoChange(list);
+    double undo = benchNow() - start;
+    start = benchNow();
+    ok = ok && redoChange(list);
+    double redo = benchNow() - start;
+    if (!ok) {
+        fprintf(stderr, "%s: undo/redo failed\n", label);
+        exit(EXIT_FAILURE);
+    }
+    printf("%-26s %12.6f %12.6f\n", label, undo, redo);
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    benchEnterScratchDir();
+
+    static const char *modes[] = { "history off", "history on", "undo point per call" };
+    double ns[3][3];
+    for (int mode = HISTORY_OFF; mode <= HISTORY_EVERY_CALL; mode++) timeMutations(n, (HistoryMode)mode, ns[mode]);
+    printf("%d rows, ns per call\n", n);
+    printf("%-22s %12s %12s %12s\n", "", "add", "modify", "remove");
+    for (int mode = 0; mode < 3; mode++) {
+        printf("%-22s %12.1f %12.1f %12.1f\n", modes[mode], ns[mode][0], ns[mode][1], ns[mode][2]);
+    }
+
+    // Versions: O(1) to take, and each holds only what changed after it
+    StudentList list;
+    setUp(&list, n, HISTORY_ON);
+    size_t listBytes = listMemoryUsage(&list), before = historyMemoryUsage(&list);
+    unsigned seed = 5u;
+    double tagTime = 0;
+    for (int i = 0; i < 100; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "v%d", i);
+        double start = benchNow();
+        tagVersion(&list, name);
+        tagTime += benchNow() - start;
+        modifyStudent(&list, (int)(benchRand(&seed) % (unsigned)n) + 1, "", 42.0f);
+    }
+    size_t grown = historyMemoryUsage(&list) - before;
+    printf("\nlist %.1f MiB, history copy %.1f MiB\n", (double)listBytes / (1024 * 1024), (double)before / (1024 * 1024));
+    printf("100 named versions, one row changed after each: %.2f us per version, %.1f KiB each\n",
+           tagTime / 100 * 1e6, (double)grown / 100 / 1024);
+
+    // Undo and redo of typical steps
+    printf("\n%-26s %12s %12s\n", "step", "undo (s)", "redo (s)");
+    markUndoPoint(&list, "modify");
+    modifyStudent(&list, n / 2, "Someone Else", 12.5f);
+    timeUndo(&list, "modify 1 row");
+    markUndoPoint(&list, "add");
+    addStudent(&list, "Late Joiner", n + 1, 60.0f);
+    timeUndo(&list, "add 1 row");
+    markUndoPoint(&list, "remove");
+    removeStudent(&list, studentRoll(&list, list.count / 2));
+    timeUndo(&list, "remove 1 row (mid-list)");
+    markUndoPoint(&list, "sort");
+    sortStudents(&list, 0);
+    timeUndo(&list, "sort by marks");
+    freeList(&list);
+    return 0;
+}
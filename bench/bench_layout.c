@@ -0,0 +1,50 @@
+// Row vs column storage: memory footprint, a marks scan, a sort and
+// opening a snapshot, for the same dataset in both layouts.
+// Usage: bench_layout [rows]   (default 2,000,000)
+//
+// Build: make benchmarks   (build/bench_layout; the Makefile has the source list)
+
+#include "bench_util.h"
+
+static void runLayout(const char *label, StudentLayout layout, int n) {
+    StudentList list;
+    initListLayout(&list, layout);
+    benchFillList(&list, n, 4242u);
+    size_t bytes = listMemoryUsage(&list);
+
+    double start = benchNow();
+    for (int rep = 0; rep < 10; rep++) {
+        recomputeClassStats(&list); // Full pass over every mark
+    }
+    double scanTime = (benchNow() - start) / 10;
+    float average = getAverageMarks(&list);
+
+    SortKey keys[2] = { { SORT_BY_MARKS, 1 }, { SORT_BY_ROLL, 0 } };
+    start = benchNow();
+    sortStudentsBy(&list, keys, 2);
+    double sortTime = benchNow() - start;
+
+    saveSnapshot(&list, SNAPSHOT_FILENAME);
+    freeList(&list);
+    start = benchNow();
+    openSnapshot(&list, SNAPSHOT_FILENAME, 0);
+    double openTime = benchNow() - start;
+    if (list.count != n) {
+        fprintf(stderr, "%s: reopened %d rows, expected %d\n", label, list.count, n);
+        exit(EXIT_FAILURE);
+    }
+    freeList(&list);
+    remove(SNAPSHOT_FILENAME);
+
+    printf("%-8s %10.1f %12.5f %10.4f %10.4f   (avg %.2f)\n", label, (double)bytes / (1024 * 1024),
+           scanTime, sortTime, openTime, average);
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 2000000;
+    benchEnterScratchDir();
+    printf("%-8s %10s %12s %10s %10s\n", "layout", "MiB", "scan (s)", "sort (s)", "open (s)");
+    runLayout("rows", LAYOUT_ROWS, n);
+    runLayout("columns", LAYOUT_COLUMNS, n);
+    return 0;
+}
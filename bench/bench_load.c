@@ -0,0 +1,68 @@
+// Load-time scaling benchmark for loadFromFile.
+// Doubles the row count each step; with the roll index in place the
+// per-row cost (ns/row) should stay flat, i.e. load time grows linearly.
+// Then another program edits 10 rows of the file (8 modified, 1 removed,
+// 1 added) and the live-reload watch applies just those.
+//
+// Build: make benchmarks   (build/bench_load; the Makefile has the source list)
+
+#include "bench_util.h"
+#include "../student_watch.h"
+
+// Rewrites FILENAME as the list it holds with a few rows changed
+static void editFile(int n, unsigned seed) {
+    StudentList edited;
+    initList(&edited);
+    loadFromFile(&edited, FILENAME);
+    for (int k = 0; k < 8; k++) {
+        modifyStudent(&edited, (int)(benchRand(&seed) % (unsigned)n) + 1, "", 100.0f - k);
+    }
+    removeStudent(&edited, studentRoll(&edited, edited.count / 2));
+    addStudent(&edited, "Newcomer", n + 1, 50.0f);
+    saveToFile(&edited, FILENAME);
+    freeList(&edited);
+}
+
+int main(void) {
+    benchEnterScratchDir();
+
+    printf("%10s %12s %10s %14s %10s\n", "rows", "load (s)", "ns/row", "10 edits (s)", "vs load");
+    for (int n = 15625; n <= 1000000; n *= 2) {
+        StudentList list;
+        initList(&list);
+        benchFillList(&list, n, 12345u);
+        saveToFile(&list, FILENAME);
+        freeList(&list);
+
+        double start = benchNow();
+        loadFromFile(&list, FILENAME);
+        double elapsed = benchNow() - start;
+
+        if (list.count != n) {
+            fprintf(stderr, "Expected %d rows, loaded %d\n", n, list.count);
+            return 1;
+        }
+
+        FileWatch watch;
+        if (!watchOpen(&watch, FILENAME)) {
+            fprintf(stderr, "watchOpen failed\n");
+            return 1;
+        }
+        editFile(n, 777u);
+        WatchReport report;
+        start = benchNow();
+        int ok = watchApply(&watch, &list, &report);
+        double reload = benchNow() - start;
+        if (!ok || report.removed != 1 || report.added != 1 || list.count != n) {
+            fprintf(stderr, "watchApply: %d modified, %d removed, %d added\n", report.modified, report.removed,
+                    report.added);
+            return 1;
+        }
+        watchClose(&watch);
+
+        printf("%10d %12.4f %10.1f %14.5f %9.1fx\n", n, elapsed, elapsed * 1e9 / n, reload, elapsed / reload);
+        freeList(&list);
+    }
+    remove(FILENAME);
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Out-of-core costs: a paged list much bigger than its memory budget.
+// Adds in random roll order, random lookups, a stats refresh after the
+// maximum is removed, a CSV export, and external sorts, then the peak
+// resident set against the data file size.
+// Usage: bench_paged [rows] [budget MiB]   (default 5,000,000 and 32)
+//
+// Build: make benchmarks   (build/bench_paged; the Makefile has the source list)
+
+#include "bench_util.h"
+#include "../student_paged.h"
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#define LOOKUPS 100000
+
+static void fail(const char *what) {
+    fprintf(stderr, "%s failed\n", what);
+    exit(EXIT_FAILURE);
+}
+
+static void row(const char *what, double seconds) {
+    printf("  %-34s %10.4f\n", what, seconds);
+}
+
+static double peakMiB(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0; // Linux reports KiB
+}
+
+static int firstRecord(const PagedRecord *record, void *ctx) {
+    *(PagedRecord *)ctx = *record;
+    return 0;
+}
+
+static void poolRow(const PagedStudentList *list, const PagedPoolStats *before) {
+    PagedPoolStats now;
+    pagedPoolStats(list, &now);
+    long long hits = now.hits - before->hits, misses = now.misses - before->misses;
+    printf("  %-34s %9.1f%%\n", "  pool hit rate", hits + misses ? 100.0 * hits / (hits + misses) : 0.0);
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 5000000;
+    int budgetMiB = argc > 2 ? atoi(argv[2]) : 32;
+    if (n < 1 || budgetMiB < 1) {
+        fprintf(stderr, "Usage: %s [rows] [budget MiB]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    benchEnterScratchDir();
+    BenchGenerator gen;
+    if (!benchGeneratorInit(&gen, n, 4242u)) fail("Generator");
+    double baseline = peakMiB(); // The generator's roll array is not the list's
+
+    PagedStudentList list;
+    if (!pagedOpen(&list, "students.pg", (size_t)budgetMiB << 20)) fail("pagedOpen");
+    PagedPoolStats pool;
+    pagedPoolStats(&list, &pool);
+    printf("%d rows, %d MiB budget, %d pool frames\n", n, budgetMiB, pool.frames);
+    printf("  %-34s %10s\n", "", "seconds");
+
+    double start = benchNow();
+    for (int i = 0; i < n; i++) {
+        char name[64];
+        int roll;
+        float marks;
+        benchGenerate(&gen, i, name, sizeof(name), &roll, &marks);
+        if (!pagedAddStudent(&list, name, roll, marks)) fail("pagedAddStudent");
+    }
+    if (!pagedSync(&list)) fail("pagedSync");
+    row("add (random rolls) + sync", benchNow() - start);
+
+    unsigned seed = 99u;
+    PagedRecord record;
+    pagedPoolStats(&list, &pool);
+    start = benchNow();
+    for (int i = 0; i < LOOKUPS; i++) {
+        if (!pagedSearchStudent(&list, (int)(benchRand(&seed) % (unsigned)n) + 1, &record)) fail("pagedSearchStudent");
+    }
+    row("100k random lookups", benchNow() - start);
+    poolRow(&list, &pool);
+
+    ClassStats stats;
+    if (!pagedGetClassStats(&list, &stats) || stats.count != n) fail("pagedGetClassStats");
+    SortKey byMarks = { SORT_BY_MARKS, 1 };
+    start = benchNow();
+    if (!pagedSortBy(&list, &byMarks, 1)) fail("pagedSortBy");
+    row("sort by marks (external)", benchNow() - start);
+
+    // The top scorer is now first: removing it makes the max stale
+    if (!pagedScan(&list, firstRecord, &record) || record.marks != stats.max) fail("pagedScan");
+    if (!pagedRemoveStudent(&list, record.roll)) fail("pagedRemoveStudent");
+    start = benchNow();
+    if (!pagedGetClassStats(&list, &stats)) fail("pagedGetClassStats");
+    row("stats after removing the max (scan)", benchNow() - start);
+
+    start = benchNow();
+    if (!pagedExport(&list, "students.csv", EXPORT_CSV)) fail("pagedExport");
+    row("export CSV", benchNow() - start);
+
+    SortKey byRoll = { SORT_BY_ROLL, 0 };
+    start = benchNow();
+    if (!pagedSortBy(&list, &byRoll, 1)) fail("pagedSortBy");
+    row("sort by roll (external)", benchNow() - start);
+
+    start = benchNow();
+    if (!pagedClose(&list)) fail("pagedClose");
+    if (!pagedOpen(&list, "students.pg", (size_t)budgetMiB << 20)) fail("pagedOpen");
+    row("close + reopen", benchNow() - start);
+    if (list.count != n - 1) fail("count");
+
+    struct stat st;
+    double fileMiB = stat("students.pg", &st) == 0 ? st.st_size / 1048576.0 : 0;
+    printf("  %-34s %8.1f MiB\n", "data file", fileMiB);
+    printf("  %-34s %8.1f MiB\n", "peak RSS (over the generator)", peakMiB() - baseline);
+
+    pagedClose(&list);
+    remove("students.pg");
+    remove("students.pg.idx");
+    remove("students.csv");
+    benchGeneratorFree(&gen);
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Thread scaling of the parallel list operations: sorts, the full stats
+// rescan and a predicate scan, each timed at 1, 2, 4 ... 32 worker threads
+// over the same column-layout list. Speedups are against the 1-thread run,
+// so they can only be as good as the machine has cores.
+// Usage: bench_parallel [rows] [max threads]   (default 50,000,000 and 32)
+//
+// Build: make benchmarks   (build/bench_parallel; the Makefile has the source list)
+
+#include "bench_util.h"
+#include "../student_pool.h"
+#include <string.h>
+
+enum { OP_SORT_MARKS, OP_SORT_NAME, OP_SORT_COMPOUND, OP_STATS, OP_SCAN, OP_COUNT };
+
+static const char *const opNames[OP_COUNT] = {
+    "sort marks", "sort name", "sort 3 keys", "stats", "scan"
+};
+
+static int passed(const StudentList *list, int row, void *ctx) {
+    (void)ctx;
+    return marksPassed(studentMarks(list, row));
+}
+
+// Seconds for one run of op; perm is list->count of scratch.
+static double timeOp(StudentList *list, int op, int *perm) {
+    static const SortKey marks[1] = { { SORT_BY_MARKS, 1 } };
+    static const SortKey name[1] = { { SORT_BY_NAME, 0 } };
+    static const SortKey compound[3] = { { SORT_BY_MARKS, 1 }, { SORT_BY_NAME, 0 }, { SORT_BY_ROLL, 0 } };
+    double start = benchNow();
+    int ok = 1;
+    switch (op) {
+    case OP_SORT_MARKS: ok = sortPermutation(list, marks, 1, perm); break;
+    case OP_SORT_NAME: ok = sortPermutation(list, name, 1, perm); break;
+    case OP_SORT_COMPOUND: ok = sortPermutation(list, compound, 3, perm); break;
+    case OP_STATS: recomputeClassStats(list); break;
+    case OP_SCAN: ok = scanStudents(list, passed, NULL, perm) >= 0; break;
+    }
+    double elapsed = benchNow() - start;
+    if (!ok) {
+        fprintf(stderr, "%s failed (out of memory?)\n", opNames[op]);
+        exit(EXIT_FAILURE);
+    }
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 50000000;
+    int maxThreads = argc > 2 ? atoi(argv[2]) : 32;
+    if (n < 1 || maxThreads < 1) {
+        fprintf(stderr, "Usage: %s [rows] [max threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    StudentList list;
+    initListLayout(&list, LAYOUT_COLUMNS);
+    BenchGenerator gen;
+    int *perm = malloc((size_t)n * sizeof(int));
+    int *serial = malloc((size_t)n * sizeof(int));
+    if (perm == NULL || serial == NULL || !benchGeneratorInit(&gen, n, 20240611u) || !reserveStudents(&list, n)) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < n; i++) {
+        char name[64];
+        int roll;
+        float marks;
+        benchGenerate(&gen, i, name, sizeof(name), &roll, &marks);
+        addStudent(&list, name, roll, marks);
+    }
+    benchGeneratorFree(&gen);
+
+    int reps = n >= 5000000 ? 1 : 3; // Best of reps
+    double base[OP_COUNT] = { 0 };
+    printf("%d rows, %ld CPUs online\n", n, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-8s", "threads");
+    for (int op = 0; op < OP_COUNT; op++) printf(" %20s", opNames[op]);
+    printf("\n");
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        setWorkerThreads(threads);
+        printf("%-8d", threads);
+        for (int op = 0; op < OP_COUNT; op++) {
+            double best = 0;
+            for (int rep = 0; rep < reps; rep++) {
+                double t = timeOp(&list, op, perm);
+                if (rep == 0 || t < best) best = t;
+            }
+            if (threads == 1) base[op] = best;
+            printf(" %9.3fs (%5.2fx)", best, base[op] / best);
+            fflush(stdout);
+
+            // Every thread count must produce the serial order
+            if (op == OP_SORT_COMPOUND) {
+                if (threads == 1) {
+                    memcpy(serial, perm, (size_t)n * sizeof(int));
+                } else if (memcmp(serial, perm, (size_t)n * sizeof(int)) != 0) {
+                    fprintf(stderr, "\n%d threads sorted differently from 1\n", threads);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        printf("\n");
+    }
+
+    free(perm);
+    free(serial);
+    freeList(&list);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// SharedStudentList under load: a writer keeps committing edits while 1, 2,
+// 4 and 8 reader threads look students up in the snapshots they acquire.
+// One snapshot in 256 is spot-checked for consistency (the writer's edits
+// keep the row count and the marks total constant), so the timings stay
+// about lookups. The stress test that checks every snapshot is
+// tests/test_shared.c, run by `make check`.
+// Usage: bench_shared [rows] [seconds per run]   (default 200,000 and 1)
+//
+// Build: make benchmarks   (build/bench_shared; the Makefile has the source list)
+
+#include "bench_util.h"
+#include "../student_shared.h"
+#include <string.h>
+
+#define MAX_READERS 8
+#define LOOKUPS_PER_SNAPSHOT 64
+#define EDITS_PER_COMMIT 16
+
+typedef struct {
+    SharedStudentList *shared;
+    int rows;
+    double marksTotal;
+    atomic_int *stop;
+    int *nextRoll;           // Writer: next unused roll, carried across runs
+    unsigned seed;
+    long long lookups;
+    long long snapshots;
+    int failures;
+} Worker;
+
+// Full consistency check of one snapshot. Returns 0 on a violation.
+static int checkSnapshot(Worker *w, const StudentList *list) {
+    if (list->count != w->rows) return 0;
+    double total = 0;
+    for (int i = 0; i < list->count; i++) total += studentMarks(list, i);
+    if (total != w->marksTotal) return 0;
+    ClassStats stats;
+    getClassStats((StudentList *)list, &stats);
+    if (stats.count != w->rows) return 0;
+    for (int probe = 0; probe < 8; probe++) {
+        int i = (int)(benchRand(&w->seed) % (unsigned)list->count);
+        if (searchStudent(list, studentRoll(list, i)) != i) return 0;
+    }
+    return 1;
+}
+
+static void *readerMain(void *arg) {
+    Worker *w = arg;
+    unsigned long long lastVersion = 0;
+    while (!atomic_load(&w->stop[0])) {
+        const SharedVersion *version = sharedAcquire(w->shared);
+        const StudentList *list = &version->list;
+        if (version->version < lastVersion) w->failures++; // Time went backwards
+        lastVersion = version->version;
+        if (w->snapshots % 256 == 0 && !checkSnapshot(w, list)) w->failures++;
+        for (int q = 0; q < LOOKUPS_PER_SNAPSHOT; q++) {
+            int roll = (int)(benchRand(&w->seed) % (unsigned)(2 * w->rows)) + 1;
+            searchStudent(list, roll); // Half of these miss once rolls have been reissued
+        }
+        sharedRelease(w->shared, version);
+        w->lookups += LOOKUPS_PER_SNAPSHOT;
+        w->snapshots++;
+    }
+    return NULL;
+}
+
+// Each edit moves one mark between two students, then replaces a third
+// student with a new roll carrying the same marks: count and total stay put.
+// Replacements go through the batch calls, one compaction per commit.
+static void *writerMain(void *arg) {
+    Worker *w = arg;
+    int rolls[EDITS_PER_COMMIT];
+    RowResult removed[EDITS_PER_COMMIT];
+    StudentInput added[EDITS_PER_COMMIT];
+    float marks[EDITS_PER_COMMIT];
+    char names[EDITS_PER_COMMIT][32];
+    while (!atomic_load(&w->stop[0])) {
+        StudentList *list = sharedBeginWrite(w->shared);
+        if (list == NULL) {
+            w->failures++;
+            break;
+        }
+        for (int e = 0; e < EDITS_PER_COMMIT; e++) {
+            int a = (int)(benchRand(&w->seed) % (unsigned)list->count);
+            int b = (int)(benchRand(&w->seed) % (unsigned)list->count);
+            if (a != b && studentMarks(list, a) >= 1) {
+                modifyStudent(list, studentRoll(list, a), NULL, studentMarks(list, a) - 1);
+                modifyStudent(list, studentRoll(list, b), NULL, studentMarks(list, b) + 1);
+            }
+        }
+        for (int e = 0; e < EDITS_PER_COMMIT; e++) {
+            int c = (int)(benchRand(&w->seed) % (unsigned)list->count);
+            rolls[e] = studentRoll(list, c);
+            marks[e] = studentMarks(list, c);
+        }
+        removeStudents(list, rolls, EDITS_PER_COMMIT, removed);
+        int n = 0;
+        for (int e = 0; e < EDITS_PER_COMMIT; e++) {
+            if (removed[e] != ROW_OK) continue; // Picked twice
+            snprintf(names[n], sizeof(names[n]), "Student %d", *w->nextRoll);
+            added[n].name = names[n];
+            added[n].nameLen = strlen(names[n]);
+            added[n].roll = (*w->nextRoll)++;
+            added[n].marks = marks[e];
+            n++;
+        }
+        addStudents(list, added, n, NULL);
+        sharedCommit(w->shared);
+        w->snapshots++;
+    }
+    return NULL;
+}
+
+static int runReaders(SharedStudentList *shared, int readers, int rows, double marksTotal, double seconds,
+                      int *nextRoll) {
+    atomic_int stop;
+    atomic_init(&stop, 0);
+    Worker workers[MAX_READERS + 1];
+    pthread_t threads[MAX_READERS + 1];
+    for (int t = 0; t <= readers; t++) {
+        Worker init = { shared, rows, marksTotal, &stop, nextRoll, 2463534242u + (unsigned)t * 7919u, 0, 0, 0 };
+        workers[t] = init;
+    }
+    double start = benchNow();
+    pthread_create(&threads[0], NULL, writerMain, &workers[0]);
+    for (int t = 1; t <= readers; t++) {
+        pthread_create(&threads[t], NULL, readerMain, &workers[t]);
+    }
+    usleep((useconds_t)(seconds * 1e6));
+    atomic_store(&stop, 1);
+    long long lookups = 0;
+    int failures = 0;
+    for (int t = 0; t <= readers; t++) {
+        pthread_join(threads[t], NULL);
+        lookups += workers[t].lookups;
+        failures += workers[t].failures;
+    }
+    double elapsed = benchNow() - start;
+    printf("%7d %14.0f %14.0f %10.0f %9d\n", readers, lookups / elapsed, lookups / elapsed / readers,
+           workers[0].snapshots / elapsed, failures);
+    return failures;
+}
+
+int main(int argc, char *argv[]) {
+    int rows = argc > 1 ? atoi(argv[1]) : 200000;
+    double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+
+    // Whole-number marks, so the running total is exact in a double
+    StudentList seed;
+    initListLayout(&seed, LAYOUT_COLUMNS);
+    benchFillList(&seed, rows, 4242u);
+    double marksTotal = 0;
+    for (int i = 0; i < seed.count; i++) {
+        float marks = (float)(int)studentMarks(&seed, i);
+        modifyStudent(&seed, studentRoll(&seed, i), NULL, marks);
+        marksTotal += marks;
+    }
+
+    SharedStudentList shared;
+    if (!sharedInit(&shared, LAYOUT_COLUMNS) || !sharedPublishCopy(&shared, &seed)) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return EXIT_FAILURE;
+    }
+    freeList(&seed);
+
+    printf("%7s %14s %14s %10s %9s\n", "readers", "lookups/s", "per reader", "commits/s", "failures");
+    int failures = 0;
+    int nextRoll = rows + 1;
+    for (int readers = 1; readers <= MAX_READERS; readers *= 2) {
+        failures += runReaders(&shared, readers, rows, marksTotal, seconds, &nextRoll);
+    }
+    sharedDestroy(&shared);
+    return failures == 0 ? 0 : EXIT_FAILURE;
+}
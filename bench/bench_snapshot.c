@@ -0,0 +1,47 @@
+// Startup benchmark: parsing students.txt vs opening students.snap.
+// Usage: bench_snapshot [rows]   (default 2,000,000)
+//
+// Build: make benchmarks   (build/bench_snapshot; the Makefile has the source list)
+
+#include "bench_util.h"
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 2000000;
+    benchEnterScratchDir();
+
+    StudentList list;
+    initList(&list);
+    benchFillList(&list, n, 777u);
+    saveToFile(&list, FILENAME);
+    saveSnapshot(&list, SNAPSHOT_FILENAME);
+    freeList(&list);
+
+    double start = benchNow();
+    loadFromFile(&list, FILENAME);
+    double csvTime = benchNow() - start;
+    int csvCount = list.count;
+    freeList(&list);
+
+    start = benchNow();
+    openSnapshot(&list, SNAPSHOT_FILENAME, 0);
+    double snapTime = benchNow() - start;
+    int snapCount = list.count;
+    freeList(&list);
+
+    start = benchNow();
+    openSnapshot(&list, SNAPSHOT_FILENAME, SNAPSHOT_VERIFY);
+    double verifyTime = benchNow() - start;
+    freeList(&list);
+
+    if (csvCount != n || snapCount != n) {
+        fprintf(stderr, "Row count mismatch: csv %d, snapshot %d, expected %d\n", csvCount, snapCount, n);
+        return 1;
+    }
+    printf("%-28s %10s\n", "load path", "seconds");
+    printf("%-28s %10.4f\n", "CSV (loadFromFile)", csvTime);
+    printf("%-28s %10.4f\n", "snapshot (openSnapshot)", snapTime);
+    printf("%-28s %10.4f\n", "snapshot + checksum", verifyTime);
+    remove(FILENAME);
+    remove(SNAPSHOT_FILENAME);
+    return 0;
+}
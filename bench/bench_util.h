@@ -0,0 +1,135 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Small helpers shared by the benchmark programs in this folder.
+// Benchmarks run inside a scratch directory so they never touch the real
+// students.txt next to the app.
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "../student_logic.h"
+
+static inline double benchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// xorshift32: deterministic, so every run sees the same dataset
+static inline unsigned benchRand(unsigned *state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Fills list with n students whose rolls are a shuffled 1..n.
+static inline void benchFillList(StudentList *list, int n, unsigned seed) {
+    int *rolls = malloc((size_t)n * sizeof(int));
+    if (rolls == NULL) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++) {
+        rolls[i] = i + 1;
+    }
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(benchRand(&seed) % (unsigned)(i + 1));
+        int t = rolls[i];
+        rolls[i] = rolls[j];
+        rolls[j] = t;
+    }
+    for (int i = 0; i < n; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "Student %d", rolls[i]);
+        float marks = (float)(benchRand(&seed) % 10001) / 100.0f;
+        addStudent(list, name, rolls[i], marks);
+    }
+    free(rolls);
+}
+
+// --- Synthetic Students ---
+// A deterministic dataset that looks like a real class list: first and last
+// names drawn from common ones, every roll unique (a shuffled 1..n), marks
+// roughly bell-shaped around 62 and rounded to half marks. The same n and
+// seed always give the same students in the same order.
+
+static const char *const benchFirstNames[] = {
+    "Aisha", "Amelia", "Arjun", "Ben", "Carlos", "Chen", "Chloe", "Daniel",
+    "David", "Elena", "Emeka", "Emma", "Fatima", "Grace", "Hana", "Hiro",
+    "Ibrahim", "Isabel", "Jack", "James", "Jin", "Kofi", "Leah", "Liam",
+    "Lucas", "Maria", "Mei", "Mohammed", "Nadia", "Noah", "Olivia", "Omar",
+    "Priya", "Rahul", "Rosa", "Sakura", "Samuel", "Sara", "Sofia", "Tariq",
+    "Tomas", "Yusuf", "Zara", "Zhang", "Ada", "Bola", "Ngozi", "Tunde"
+};
+static const char *const benchLastNames[] = {
+    "Adeyemi", "Ali", "Anderson", "Brown", "Chen", "Costa", "Davies", "Diaz",
+    "Garcia", "Gupta", "Hassan", "Ivanova", "Johnson", "Kim", "Kowalski", "Lee",
+    "Martin", "Mensah", "Moreau", "Murphy", "Nakamura", "Nguyen", "Novak", "Okafor",
+    "Okonkwo", "Patel", "Rossi", "Santos", "Schmidt", "Silva", "Singh", "Smith",
+    "Tanaka", "Taylor", "Wang", "Williams", "Wilson", "Yamamoto", "Yilmaz", "Zhou"
+};
+
+#define BENCH_COUNT(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+typedef struct {
+    int *rolls;      // Shuffled 1..n
+    unsigned seed;
+} BenchGenerator;
+
+static inline int benchGeneratorInit(BenchGenerator *gen, int n, unsigned seed) {
+    gen->seed = seed ? seed : 1u;
+    gen->rolls = malloc((size_t)(n > 0 ? n : 1) * sizeof(int));
+    if (gen->rolls == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < n; i++) {
+        gen->rolls[i] = i + 1;
+    }
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(benchRand(&gen->seed) % (unsigned)(i + 1));
+        int t = gen->rolls[i];
+        gen->rolls[i] = gen->rolls[j];
+        gen->rolls[j] = t;
+    }
+    return 1;
+}
+
+static inline void benchGeneratorFree(BenchGenerator *gen) {
+    free(gen->rolls);
+    gen->rolls = NULL;
+}
+
+// Student i of the dataset; call with i = 0, 1, 2 ... in order.
+static inline void benchGenerate(BenchGenerator *gen, int i, char *name, size_t nameSize, int *roll, float *marks) {
+    unsigned r = benchRand(&gen->seed);
+    snprintf(name, nameSize, "%s %s", benchFirstNames[r % BENCH_COUNT(benchFirstNames)],
+             benchLastNames[(r >> 8) % BENCH_COUNT(benchLastNames)]);
+    *roll = gen->rolls[i];
+
+    // Sum of four uniforms: mean 62, spread of roughly +-15, clamped to 0..100
+    double sum = 0;
+    for (int k = 0; k < 4; k++) {
+        sum += (double)(benchRand(&gen->seed) % 10001) / 10000.0;
+    }
+    double value = 62.0 + (sum - 2.0) * 26.0;
+    if (value < 0) value = 0;
+    if (value > 100) value = 100;
+    *marks = (float)((int)(value * 2 + 0.5)) / 2.0f;
+}
+
+static inline void benchEnterScratchDir(void) {
+    char dir[] = "/tmp/srs-bench-XXXXXX";
+    if (mkdtemp(dir) == NULL || chdir(dir) != 0) {
+        perror("scratch dir");
+        exit(EXIT_FAILURE);
+    }
+}
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,33 @@
+// Writes a synthetic class list as CSV (name,roll,marks), the same format
+// saveToFile produces, so the result can be loaded by the app, imported by
+// the server or converted with snapconv. The same rows and seed always give
+// the same file.
+// Usage: gen_students rows [seed] > students.txt
+//
+// Build: make benchmarks   (build/gen_students; the Makefile has the source list)
+
+#include "bench_util.h"
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || atoi(argv[1]) < 1) {
+        fprintf(stderr, "Usage: %s rows [seed] > students.txt\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int n = atoi(argv[1]);
+    unsigned seed = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : 20240611u;
+
+    BenchGenerator gen;
+    if (!benchGeneratorInit(&gen, n, seed)) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < n; i++) {
+        char name[64];
+        int roll;
+        float marks;
+        benchGenerate(&gen, i, name, sizeof(name), &roll, &marks);
+        printf("%s,%d,%.2f\n", name, roll, marks);
+    }
+    benchGeneratorFree(&gen);
+    return ferror(stdout) ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,276 @@
+// Load generator for student_server: opens several connections, each
+// keeping a window of pipelined requests in flight, and reports requests
+// per second and latency percentiles. Latency is measured per request, from
+// the write that sent it to the read that brought its reply.
+// Usage: loadgen [-s socket] [-c connections] [-d depth] [-t seconds] [-n rows] [-w write%]
+//        (defaults: students.sock, 4, 32, 5, 100,000, 10)
+// Start the server first, e.g. with -m so the run leaves no files behind.
+//
+// Build: make benchmarks   (build/loadgen; the Makefile has the source list)
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define MAX_CONNECTIONS 256
+#define MAX_DEPTH 4096
+#define PRELOAD_BATCH 1024
+
+typedef struct {
+    const char *path;
+    int rows;
+    int depth;
+    int writePercent;
+    double seconds;
+    unsigned seed;
+    // Results
+    float *latencies;   // Microseconds
+    long long count;
+    long long capacity;
+    long long errors;   // ERR replies other than "not found"
+    int failed;
+} Connection;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static unsigned nextRand(unsigned *state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int connectTo(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror(path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int writeAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+typedef struct {
+    char data[1 << 16];
+    size_t len;
+} ReplyBuffer;
+
+// Reads replies until `expected` lines have arrived, noting when each one
+// completed. Keeps any bytes past the last line for next time.
+static int readReplies(int fd, ReplyBuffer *buf, int expected, double *doneAt, long long *errors) {
+    int seen = 0;
+    while (seen < expected) {
+        char *start = buf->data;
+        char *eol;
+        while (seen < expected && (eol = memchr(start, '\n', buf->len - (size_t)(start - buf->data))) != NULL) {
+            if (start[0] == 'E' && strncmp(start, "ERR not found", 13) != 0) (*errors)++;
+            doneAt[seen++] = now();
+            start = eol + 1;
+        }
+        size_t rest = buf->len - (size_t)(start - buf->data);
+        memmove(buf->data, start, rest);
+        buf->len = rest;
+        if (seen == expected) break;
+        ssize_t n = read(fd, buf->data + buf->len, sizeof(buf->data) - buf->len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        buf->len += (size_t)n;
+    }
+    return 1;
+}
+
+static int recordLatency(Connection *c, double micros) {
+    if (c->count == c->capacity) {
+        long long grown = c->capacity == 0 ? 65536 : c->capacity * 2;
+        float *latencies = realloc(c->latencies, (size_t)grown * sizeof(float));
+        if (latencies == NULL) return 0;
+        c->latencies = latencies;
+        c->capacity = grown;
+    }
+    c->latencies[c->count++] = (float)micros;
+    return 1;
+}
+
+static void *connectionMain(void *arg) {
+    Connection *c = arg;
+    int fd = connectTo(c->path);
+    if (fd < 0) {
+        c->failed = 1;
+        return NULL;
+    }
+    ReplyBuffer *replies = malloc(sizeof(ReplyBuffer));
+    char *requests = malloc((size_t)c->depth * 64);
+    double *doneAt = malloc((size_t)c->depth * sizeof(double));
+    if (replies == NULL || requests == NULL || doneAt == NULL) {
+        c->failed = 1;
+        free(replies);
+        free(requests);
+        free(doneAt);
+        close(fd);
+        return NULL;
+    }
+    replies->len = 0;
+
+    double end = now() + c->seconds;
+    while (now() < end) {
+        size_t len = 0;
+        for (int i = 0; i < c->depth; i++) {
+            int roll = (int)(nextRand(&c->seed) % (unsigned)c->rows) + 1;
+            if ((int)(nextRand(&c->seed) % 100) < c->writePercent)
+                len += (size_t)sprintf(requests + len, "MOD %d %u -\n", roll, nextRand(&c->seed) % 101);
+            else
+                len += (size_t)sprintf(requests + len, "GET %d\n", roll);
+        }
+        double sentAt = now();
+        if (!writeAll(fd, requests, len) || !readReplies(fd, replies, c->depth, doneAt, &c->errors)) {
+            c->failed = 1;
+            break;
+        }
+        for (int i = 0; i < c->depth; i++) {
+            if (!recordLatency(c, (doneAt[i] - sentAt) * 1e6)) {
+                c->failed = 1;
+                break;
+            }
+        }
+    }
+    free(replies);
+    free(requests);
+    free(doneAt);
+    close(fd);
+    return NULL;
+}
+
+// Adds rolls 1..rows (already-present rolls just answer "ERR duplicate").
+static int preload(const char *path, int rows) {
+    int fd = connectTo(path);
+    if (fd < 0) return 0;
+    static ReplyBuffer replies;
+    char *requests = malloc(PRELOAD_BATCH * 64);
+    double *doneAt = malloc(PRELOAD_BATCH * sizeof(double));
+    long long errors = 0;
+    int ok = requests != NULL && doneAt != NULL;
+    unsigned seed = 12345u;
+    for (int first = 1; ok && first <= rows; first += PRELOAD_BATCH) {
+        int batch = rows - first + 1 < PRELOAD_BATCH ? rows - first + 1 : PRELOAD_BATCH;
+        size_t len = 0;
+        for (int i = 0; i < batch; i++) {
+            len += (size_t)sprintf(requests + len, "ADD %d %u Student %d\n", first + i,
+                                   nextRand(&seed) % 101, first + i);
+        }
+        ok = writeAll(fd, requests, len) && readReplies(fd, &replies, batch, doneAt, &errors);
+    }
+    free(requests);
+    free(doneAt);
+    close(fd);
+    return ok;
+}
+
+static int compareFloats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = "students.sock";
+    int connections = 4, depth = 32, rows = 100000, writePercent = 10;
+    double seconds = 5;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:d:t:n:w:")) != -1) {
+        switch (opt) {
+            case 's': path = optarg; break;
+            case 'c': connections = atoi(optarg); break;
+            case 'd': depth = atoi(optarg); break;
+            case 't': seconds = atof(optarg); break;
+            case 'n': rows = atoi(optarg); break;
+            case 'w': writePercent = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-s socket] [-c connections] [-d depth] [-t seconds] [-n rows] [-w write%%]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (connections < 1 || connections > MAX_CONNECTIONS || depth < 1 || depth > MAX_DEPTH || rows < 1) {
+        fprintf(stderr, "connections must be 1..%d, depth 1..%d, rows > 0\n", MAX_CONNECTIONS, MAX_DEPTH);
+        return EXIT_FAILURE;
+    }
+
+    double start = now();
+    if (!preload(path, rows)) {
+        fprintf(stderr, "Preload failed\n");
+        return EXIT_FAILURE;
+    }
+    printf("Preloaded %d rows in %.2f s\n", rows, now() - start);
+
+    Connection conns[MAX_CONNECTIONS];
+    pthread_t threads[MAX_CONNECTIONS];
+    memset(conns, 0, sizeof(conns));
+    start = now();
+    for (int i = 0; i < connections; i++) {
+        conns[i].path = path;
+        conns[i].rows = rows;
+        conns[i].depth = depth;
+        conns[i].writePercent = writePercent;
+        conns[i].seconds = seconds;
+        conns[i].seed = 2463534242u + (unsigned)i * 7919u;
+        pthread_create(&threads[i], NULL, connectionMain, &conns[i]);
+    }
+    long long total = 0, errors = 0;
+    int failed = 0;
+    for (int i = 0; i < connections; i++) {
+        pthread_join(threads[i], NULL);
+        total += conns[i].count;
+        errors += conns[i].errors;
+        failed |= conns[i].failed;
+    }
+    double elapsed = now() - start;
+
+    float *all = malloc((size_t)(total > 0 ? total : 1) * sizeof(float));
+    if (all == NULL) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return EXIT_FAILURE;
+    }
+    long long at = 0;
+    for (int i = 0; i < connections; i++) {
+        memcpy(all + at, conns[i].latencies, (size_t)conns[i].count * sizeof(float));
+        at += conns[i].count;
+        free(conns[i].latencies);
+    }
+    qsort(all, (size_t)total, sizeof(float), compareFloats);
+
+    printf("%d connections x %d in flight, %d%% writes, %.1f s\n", connections, depth, writePercent, elapsed);
+    printf("requests: %lld   errors: %lld%s\n", total, errors, failed ? "   (a connection failed)" : "");
+    printf("throughput: %.0f req/s\n", total / elapsed);
+    if (total > 0) {
+        printf("latency (us): p50 %.1f   p99 %.1f   p99.9 %.1f   max %.1f\n", all[total / 2],
+               all[total * 99 / 100], all[total * 999 / 1000], all[total - 1]);
+    }
+    free(all);
+    return failed ? EXIT_FAILURE : 0;
+}
@@ -1,7 +1,14 @@
 #include <gtk/gtk.h>
 #include "student_logic.h"
+#include "student_model.h"
+#include "student_journal.h"
+#include "student_perf.h"
+#include "student_watch.h"
+#include <glib-unix.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <math.h>
 
 /* --- Structs --- */
 typedef struct {
@@ -10,6 +17,99 @@ typedef struct {
     GtkWidget *marks_entry;
 } StudentEntryWidgets;
 
+typedef struct {
+    StudentList *list;
+    GtkWidget *results_label;
+} NameSearchWidgets;
+
+// Filter bar of the display window; empty fields don't filter
+typedef struct {
+    StudentList *list;
+    StudentModel *model;
+    GtkWidget *marks_from, *marks_to;
+    GtkWidget *roll_from, *roll_to;
+    GtkWidget *status;       // Any / Passed / Failed
+    GtkWidget *prefix;
+    GtkWidget *match;        // All / Any of the fields
+    GtkWidget *count_label;
+} FilterBarWidgets;
+
+// Diagnostics window: one row per operation, then the I/O counters
+enum {
+    DIAG_COL_NAME,
+    DIAG_COL_CALLS,
+    DIAG_COL_TOTAL,
+    DIAG_COL_MEAN,
+    DIAG_COL_P50,
+    DIAG_COL_P99,
+    DIAG_COL_MAX,
+    DIAG_COL_COUNT
+};
+
+typedef struct {
+    GtkListStore *store;
+    GtkWidget *counters_label;
+} DiagnosticsWidgets;
+
+// Long operations that run on a worker thread
+typedef enum {
+    JOB_LOAD,
+    JOB_SAVE,
+    JOB_SORT
+} JobKind;
+
+typedef struct {
+    JobKind kind;
+    StudentList *list;       // The list on screen; only read until the job finishes
+    GtkWindow *parent;
+    Progress progress;
+    gboolean cancellable;
+    // JOB_LOAD: records are loaded into a separate list, swapped in at the end
+    StudentList loaded;
+    LoadReport report;
+    // JOB_SAVE
+    gboolean previous_ok;    // The last background checkpoint had succeeded
+    // JOB_SORT: the permutation is computed off-thread, applied at the end
+    SortKey keys[MAX_SORT_KEYS];
+    int key_count;
+    int *perm;
+} Job;
+
+typedef struct {
+    GtkWidget *box;          // Progress bar + Cancel, hidden while idle
+    GtkWidget *bar;
+    GtkWidget *cancel;
+    GPtrArray *locked;       // Buttons that would conflict with a running job
+    Job *job;                // Running job, or NULL
+    guint timer;
+    gboolean quitting;       // Window is gone: drop results quietly
+} JobControls;
+
+static JobControls job_controls;
+
+// Live reload: other programs' rewrites of FILENAME are applied as they
+// land (the list's change feed takes them to the views)
+typedef struct {
+    FileWatch watch;
+    StudentList *list;
+    GtkWidget *status_label;
+} LiveReload;
+
+static LiveReload live_reload;
+
+// Everything that shows the list follows its change feed: changes are
+// flushed once the main loop is idle, and each batch patches the open
+// display windows and refreshes the main window's summary line
+typedef struct {
+    GPtrArray *views;        // FilterBarWidgets of the open display windows
+    GtkWidget *summary_label;
+    guint flush_source;      // Idle flush scheduled, or 0
+} ListFollowers;
+
+static ListFollowers followers;
+
+static void apply_file_changes(void);
+
 /* --- Helper: Show Message --- */
 static void show_message(GtkWindow *parent, const gchar *message) {
     GtkWidget *dialog = gtk_message_dialog_new(parent,
@@ -22,6 +122,159 @@ static void show_message(GtkWindow *parent, const gchar *message) {
     gtk_widget_destroy(dialog);
 }
 
+/* --- Background Jobs --- */
+// Load, save and sort run through GTask on a worker thread so the window
+// keeps redrawing. One job runs at a time. While it does, the buttons that
+// would change the list are disabled, so the worker can read the list
+// without locks; the result is applied on the main thread in one step.
+
+static void job_thread(GTask *task, gpointer source, gpointer task_data, GCancellable *cancellable) {
+    Job *job = task_data;
+    Journal *journal = job->list->journal;
+    int ok = 0;
+
+    switch (job->kind) {
+        case JOB_LOAD:
+            ok = importCsvProgress(&job->loaded, FILENAME, &job->report, &job->progress);
+            if (ok && job->list->names) enableNameIndex(&job->loaded); // Build it here too, not on the main thread
+            break;
+        case JOB_SAVE:
+            if (journal == NULL) {
+                ok = exportCsvProgress(job->list, FILENAME, &job->progress) &&
+                     saveSnapshot(job->list, SNAPSHOT_FILENAME);
+            } else {
+                // Changes are journaled as they happen; Save compacts them into a checkpoint
+                job->previous_ok = journalWaitCheckpoint(journal);
+                ok = journalCheckpoint(journal, job->list) && journalWaitCheckpoint(journal);
+            }
+            break;
+        case JOB_SORT:
+            job->perm = g_try_new(int, job->list->count > 0 ? job->list->count : 1);
+            ok = job->perm != NULL &&
+                 sortPermutationProgress(job->list, job->keys, job->key_count, job->perm, &job->progress);
+            break;
+    }
+    g_task_return_boolean(task, ok);
+}
+
+static void job_free(gpointer data) {
+    Job *job = data;
+    freeList(&job->loaded);
+    g_free(job->perm);
+    g_free(job);
+}
+
+static gboolean job_tick(gpointer data) {
+    Job *job = job_controls.job;
+    long long total = atomic_load(&job->progress.total);
+    long long done = atomic_load(&job->progress.done);
+    if (total > 0)
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(job_controls.bar), (double)done / (double)total);
+    else
+        gtk_progress_bar_pulse(GTK_PROGRESS_BAR(job_controls.bar)); // No measure of progress
+    return G_SOURCE_CONTINUE;
+}
+
+static void set_job_running(gboolean running) {
+    if (job_controls.timer) g_source_remove(job_controls.timer);
+    job_controls.timer = 0;
+    if (job_controls.quitting) return; // Widgets are already destroyed
+    for (guint i = 0; i < job_controls.locked->len; i++)
+        gtk_widget_set_sensitive(g_ptr_array_index(job_controls.locked, i), !running);
+    gtk_widget_set_visible(job_controls.box, running);
+}
+
+static void report_load(Job *job) {
+    LoadReport *report = &job->report;
+    GString *msg = g_string_new(NULL);
+    g_string_append_printf(msg, "Loaded %d students.", report->rowsLoaded);
+    if (report->duplicateRows > 0)
+        g_string_append_printf(msg, "\nSkipped %d duplicate roll numbers.", report->duplicateRows);
+    if (report->malformedRows > 0) {
+        g_string_append_printf(msg, "\nSkipped %d malformed rows, line(s):", report->malformedRows);
+        for (int i = 0; i < report->badLineCount; i++)
+            g_string_append_printf(msg, " %d", report->badLines[i]);
+        if (report->malformedRows > report->badLineCount)
+            g_string_append(msg, " ...");
+    }
+    show_message(job->parent, msg->str);
+    g_string_free(msg, TRUE);
+}
+
+static void job_finished(GObject *source, GAsyncResult *result, gpointer data) {
+    Job *job = g_task_get_task_data(G_TASK(result));
+    gboolean ok = g_task_propagate_boolean(G_TASK(result), NULL);
+    gboolean cancelled = progressCancelled(&job->progress);
+
+    set_job_running(FALSE);
+    job_controls.job = NULL;
+    if (job_controls.quitting) return;
+
+    switch (job->kind) {
+        case JOB_LOAD:
+            if (!cancelled && ok) markUndoPoint(job->list, "Load from File");
+            if (cancelled)
+                show_message(job->parent, "Load cancelled. Records unchanged.");
+            else if (!ok)
+                show_message(job->parent, "Error loading.");
+            else if (!adoptList(job->list, &job->loaded))
+                show_message(job->parent, "Loaded, but the journal checkpoint or name index failed.");
+            else
+                report_load(job);
+            break;
+        case JOB_SAVE:
+            if (cancelled)
+                show_message(job->parent, "Save cancelled. The previous file was kept.");
+            else if (!ok)
+                show_message(job->parent, "Error saving.");
+            else
+                show_message(job->parent, job->previous_ok ? "Saved!" : "The previous save failed; saved again.");
+            break;
+        case JOB_SORT:
+            if (!cancelled && ok) markUndoPoint(job->list, "Sort Records");
+            if (cancelled)
+                show_message(job->parent, "Sort cancelled. Records unchanged.");
+            else if (!ok || !applySortOrder(job->list, job->perm, job->keys, job->key_count))
+                show_message(job->parent, "Error: not enough memory to sort.");
+            else
+                show_message(job->parent, "Records sorted.");
+            break;
+    }
+    if (live_reload.watch.pending) apply_file_changes(); // Arrived while the job had the list
+}
+
+static Job *new_job(JobKind kind, StudentList *list, GtkWidget *widget) {
+    Job *job = g_new0(Job, 1);
+    job->kind = kind;
+    job->list = list;
+    job->parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
+    job->cancellable = TRUE;
+    job->previous_ok = TRUE;
+    initListLayout(&job->loaded, list->layout);
+    return job;
+}
+
+static void start_job(Job *job, const char *label) {
+    job_controls.job = job;
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(job_controls.bar), label);
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(job_controls.bar), 0.0);
+    gtk_widget_set_sensitive(job_controls.cancel, job->cancellable);
+    set_job_running(TRUE);
+    job_controls.timer = g_timeout_add(100, job_tick, NULL);
+
+    GTask *task = g_task_new(NULL, NULL, job_finished, NULL);
+    g_task_set_task_data(task, job, job_free);
+    g_task_run_in_thread(task, job_thread);
+    g_object_unref(task); // GTask keeps itself alive until job_finished returns
+}
+
+static void on_job_cancel_clicked(GtkWidget *widget, gpointer data) {
+    if (job_controls.job == NULL) return;
+    atomic_store(&job_controls.job->progress.cancelled, 1);
+    gtk_widget_set_sensitive(widget, FALSE);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(job_controls.bar), "Cancelling...");
+}
+
 /* --- Helper: Get Integer Input (for Roll No) --- */
 // Returns -1 if cancelled, otherwise returns the integer entered
 static int pop_up_input_dialog(GtkWindow *parent, const char *title, const char *prompt) {
@@ -53,49 +306,190 @@ static int pop_up_input_dialog(GtkWindow *parent, const char *title, const char
 }
 
 /* --- Display Logic --- */
-static void update_display_window(GtkWidget *text_view, StudentList *list) {
-    GtkTextBuffer *buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(text_view));
-    GString *s = g_string_new("");
+// Marks are stored as floats; show them the way the console does
+static void marks_cell_data(GtkTreeViewColumn *column, GtkCellRenderer *cell,
+                            GtkTreeModel *model, GtkTreeIter *iter, gpointer data) {
+    (void)column;
+    (void)data;
+    gfloat marks;
+    char text[32];
+    gtk_tree_model_get(model, iter, STUDENT_COL_MARKS, &marks, -1);
+    g_snprintf(text, sizeof(text), "%.2f", marks);
+    g_object_set(cell, "text", text, NULL);
+}
 
-    if (list->count == 0) {
-        g_string_append(s, "No student records to display.\n");
-    } else {
-        g_string_append_printf(s, "%-20s %-10s %-10s %-10s\n", "Name", "Roll No", "Marks", "Status");
-        g_string_append(s, "------------------------------------------------------------\n");
-        for (int i = 0; i < list->count; i++) {
-            g_string_append_printf(s, "%-20s %-10d %-10.2f %-10s\n",
-                   list->students[i].name,
-                   list->students[i].roll,
-                   list->students[i].marks,
-                   (list->students[i].marks > 40) ? "Passed" : "Failed");
-        }
+static void add_display_column(GtkWidget *tree_view, const char *title, int column, int width,
+                               GtkTreeCellDataFunc cell_func) {
+    GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
+    GtkTreeViewColumn *view_column = cell_func
+        ? gtk_tree_view_column_new()
+        : gtk_tree_view_column_new_with_attributes(title, renderer, "text", column, NULL);
+    if (cell_func) {
+        gtk_tree_view_column_set_title(view_column, title);
+        gtk_tree_view_column_pack_start(view_column, renderer, TRUE);
+        gtk_tree_view_column_set_cell_data_func(view_column, renderer, cell_func, NULL, NULL);
     }
-    gtk_text_buffer_set_text(buffer, s->str, -1);
-    g_string_free(s, TRUE);
+    // Fixed sizing lets the view skip measuring rows it is not drawing
+    gtk_tree_view_column_set_sizing(view_column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(view_column, width);
+    gtk_tree_view_column_set_resizable(view_column, TRUE);
+    gtk_tree_view_column_set_sort_column_id(view_column, column);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view), view_column);
+}
+
+/* --- Filter Bar --- */
+static int join_filter(StudentFilter *filter, int sofar, int term, gboolean any) {
+    if (sofar < 0) return term;
+    return any ? filterOr(filter, sofar, term) : filterAnd(filter, sofar, term);
+}
+
+static gboolean entry_has_text(GtkWidget *entry) {
+    return strlen(gtk_entry_get_text(GTK_ENTRY(entry))) > 0;
+}
+
+static void update_filter_count(FilterBarWidgets *w) {
+    gchar *text = g_strdup_printf("%d of %d students",
+                                  gtk_tree_model_iter_n_children(GTK_TREE_MODEL(w->model), NULL), w->list->count);
+    gtk_label_set_text(GTK_LABEL(w->count_label), text);
+    g_free(text);
+}
+
+static void on_filter_apply(GtkWidget *widget, gpointer data) {
+    (void)widget;
+    FilterBarWidgets *w = (FilterBarWidgets*)data;
+    gboolean any = gtk_combo_box_get_active(GTK_COMBO_BOX(w->match)) == 1;
+    StudentFilter filter;
+    filterInit(&filter);
+    int root = -1;
+
+    if (entry_has_text(w->marks_from) || entry_has_text(w->marks_to)) {
+        float from = entry_has_text(w->marks_from) ? atof(gtk_entry_get_text(GTK_ENTRY(w->marks_from))) : -INFINITY;
+        float to = entry_has_text(w->marks_to) ? atof(gtk_entry_get_text(GTK_ENTRY(w->marks_to))) : INFINITY;
+        root = join_filter(&filter, root, filterMarks(&filter, from, to), any);
+    }
+    if (entry_has_text(w->roll_from) || entry_has_text(w->roll_to)) {
+        int from = entry_has_text(w->roll_from) ? atoi(gtk_entry_get_text(GTK_ENTRY(w->roll_from))) : INT_MIN;
+        int to = entry_has_text(w->roll_to) ? atoi(gtk_entry_get_text(GTK_ENTRY(w->roll_to))) : INT_MAX;
+        root = join_filter(&filter, root, filterRoll(&filter, from, to), any);
+    }
+    int status = gtk_combo_box_get_active(GTK_COMBO_BOX(w->status));
+    if (status > 0) {
+        root = join_filter(&filter, root, filterPassed(&filter, status == 1), any);
+    }
+    if (entry_has_text(w->prefix)) {
+        root = join_filter(&filter, root, filterNamePrefix(&filter, gtk_entry_get_text(GTK_ENTRY(w->prefix))), any);
+    }
+
+    student_model_set_filter(w->model, root < 0 ? NULL : &filter);
+    update_filter_count(w);
+}
+
+static void on_filter_clear(GtkWidget *widget, gpointer data) {
+    FilterBarWidgets *w = (FilterBarWidgets*)data;
+    gtk_entry_set_text(GTK_ENTRY(w->marks_from), "");
+    gtk_entry_set_text(GTK_ENTRY(w->marks_to), "");
+    gtk_entry_set_text(GTK_ENTRY(w->roll_from), "");
+    gtk_entry_set_text(GTK_ENTRY(w->roll_to), "");
+    gtk_entry_set_text(GTK_ENTRY(w->prefix), "");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(w->status), 0);
+    on_filter_apply(widget, data);
+}
+
+static GtkWidget *new_filter_entry(FilterBarWidgets *w, const char *placeholder, int width) {
+    GtkWidget *entry = gtk_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(entry), placeholder);
+    gtk_entry_set_width_chars(GTK_ENTRY(entry), width);
+    g_signal_connect(entry, "activate", G_CALLBACK(on_filter_apply), w); // Enter applies
+    return entry;
+}
+
+static GtkWidget *new_filter_bar(FilterBarWidgets *w) {
+    GtkWidget *grid = gtk_grid_new();
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 5);
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 5);
+
+    w->marks_from = new_filter_entry(w, "from", 6);
+    w->marks_to = new_filter_entry(w, "to", 6);
+    w->roll_from = new_filter_entry(w, "from", 8);
+    w->roll_to = new_filter_entry(w, "to", 8);
+    w->prefix = new_filter_entry(w, "Name starts with...", 16);
+    w->status = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(w->status), "Any status");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(w->status), "Passed");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(w->status), "Failed");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(w->status), 0);
+    w->match = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(w->match), "Match all");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(w->match), "Match any");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(w->match), 0);
+    GtkWidget *apply = gtk_button_new_with_label("Filter");
+    GtkWidget *clear = gtk_button_new_with_label("Clear");
+    g_signal_connect(apply, "clicked", G_CALLBACK(on_filter_apply), w);
+    g_signal_connect(clear, "clicked", G_CALLBACK(on_filter_clear), w);
+    w->count_label = gtk_label_new("");
+    gtk_label_set_xalign(GTK_LABEL(w->count_label), 0.0);
+
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Marks:"), 0, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), w->marks_from, 1, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), w->marks_to, 2, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Roll No:"), 3, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), w->roll_from, 4, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), w->roll_to, 5, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), w->prefix, 0, 1, 3, 1);
+    gtk_grid_attach(GTK_GRID(grid), w->status, 3, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), w->match, 4, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), apply, 5, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), clear, 6, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), w->count_label, 0, 2, 7, 1);
+    return grid;
+}
+
+static void on_display_destroy(GtkWidget *widget, gpointer data) {
+    (void)widget;
+    g_ptr_array_remove(followers.views, data);
+    g_free(data);
 }
 
 static void on_display_clicked(GtkWidget *widget, gpointer data) {
     StudentList *list = (StudentList*)data;
-    
+
+    if (list->count == 0) {
+        show_message(NULL, "No student records to display.");
+        return;
+    }
+
+    flushChanges(list); // The new model starts from the list as it is: no batch half-applied to it
     GtkWidget *display_window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(display_window), "All Students");
-    gtk_window_set_default_size(GTK_WINDOW(display_window), 500, 400);
+    gtk_window_set_default_size(GTK_WINDOW(display_window), 640, 480);
+    gtk_container_set_border_width(GTK_CONTAINER(display_window), 5);
+
+    GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    gtk_container_add(GTK_CONTAINER(display_window), vbox);
+    FilterBarWidgets *filter_bar = g_new0(FilterBarWidgets, 1);
+    filter_bar->list = list;
+    g_signal_connect(display_window, "destroy", G_CALLBACK(on_display_destroy), filter_bar);
+    gtk_box_pack_start(GTK_BOX(vbox), new_filter_bar(filter_bar), FALSE, FALSE, 0);
 
     GtkWidget *scrolled = gtk_scrolled_window_new(NULL, NULL);
-    gtk_container_add(GTK_CONTAINER(display_window), scrolled);
+    gtk_box_pack_start(GTK_BOX(vbox), scrolled, TRUE, TRUE, 0);
 
-    GtkWidget *text_view = gtk_text_view_new();
-    gtk_text_view_set_editable(GTK_TEXT_VIEW(text_view), FALSE);
-    
-    // Modern font setting
-    GtkCssProvider *provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider, "textview { font-family: monospace; font-size: 14px; }", -1, NULL);
-    GtkStyleContext *context = gtk_widget_get_style_context(text_view);
-    gtk_style_context_add_provider(context, GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-    g_object_unref(provider);
-
-    gtk_container_add(GTK_CONTAINER(scrolled), text_view);
-    update_display_window(text_view, list);
+    // The model reads rows out of the list on demand, so opening this window
+    // costs the same for ten students as for ten million
+    StudentModel *model = student_model_new(list);
+    GtkWidget *tree_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(model));
+    g_object_unref(model); // The view holds the reference now
+    filter_bar->model = model;
+    update_filter_count(filter_bar);
+    g_ptr_array_add(followers.views, filter_bar);
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(tree_view), TRUE);
+
+    add_display_column(tree_view, "Name", STUDENT_COL_NAME, 200, NULL);
+    add_display_column(tree_view, "Roll No", STUDENT_COL_ROLL, 90, NULL);
+    add_display_column(tree_view, "Marks", STUDENT_COL_MARKS, 90, marks_cell_data);
+    add_display_column(tree_view, "Status", STUDENT_COL_STATUS, 90, NULL);
+
+    gtk_container_add(GTK_CONTAINER(scrolled), tree_view);
     gtk_widget_show_all(display_window);
 }
 
@@ -132,6 +526,7 @@ static void on_add_clicked(GtkWidget *widget, gpointer data) {
         int roll = atoi(gtk_entry_get_text(GTK_ENTRY(w->roll_entry)));
         float marks = atof(gtk_entry_get_text(GTK_ENTRY(w->marks_entry)));
 
+        markUndoPoint(list, "Add Student");
         if (addStudent(list, name, roll, marks)) {
             show_message(GTK_WINDOW(dialog), "Student added successfully.");
         } else {
@@ -149,6 +544,7 @@ static void on_remove_clicked(GtkWidget *widget, gpointer data) {
     
     int roll = pop_up_input_dialog(parent, "Remove Student", "Enter Roll Number to remove:");
     if (roll != -1) {
+        markUndoPoint(list, "Remove Record");
         if (removeStudent(list, roll)) {
             show_message(parent, "Student removed successfully.");
         } else {
@@ -167,7 +563,7 @@ static void on_search_clicked(GtkWidget *widget, gpointer data) {
         int idx = searchStudent(list, roll);
         if (idx != -1) {
             gchar *info = g_strdup_printf("Found!\nName: %s\nRoll: %d\nMarks: %.2f", 
-                list->students[idx].name, list->students[idx].roll, list->students[idx].marks);
+                studentName(list, idx), studentRoll(list, idx), studentMarks(list, idx));
             show_message(parent, info);
             g_free(info);
         } else {
@@ -176,39 +572,301 @@ static void on_search_clicked(GtkWidget *widget, gpointer data) {
     }
 }
 
+/* --- Live Name Search --- */
+#define LIVE_SEARCH_RESULTS 10
+
+static void on_name_search_changed(GtkSearchEntry *entry, gpointer data) {
+    NameSearchWidgets *widgets = (NameSearchWidgets*)data;
+    StudentList *list = widgets->list;
+    const char *query = gtk_entry_get_text(GTK_ENTRY(entry));
+
+    if (strlen(query) == 0) {
+        gtk_label_set_text(GTK_LABEL(widgets->results_label), "");
+        return;
+    }
+    int rows[LIVE_SEARCH_RESULTS];
+    int found = searchByName(list, query, NAME_MATCH_SUBSTRING, 0, rows, LIVE_SEARCH_RESULTS);
+    GString *s = g_string_new("");
+    if (found == 0)
+        g_string_append(s, "No matches.");
+    for (int i = 0; i < found; i++) {
+        g_string_append_printf(s, "%s%s (Roll %d, %.2f)", i ? "\n" : "",
+                               studentName(list, rows[i]), studentRoll(list, rows[i]), studentMarks(list, rows[i]));
+    }
+    if (found == LIVE_SEARCH_RESULTS)
+        g_string_append(s, "\n...");
+    gtk_label_set_text(GTK_LABEL(widgets->results_label), s->str);
+    g_string_free(s, TRUE);
+}
+
 /* --- Average Marks --- */
 static void on_avg_clicked(GtkWidget *widget, gpointer data) {
     StudentList *list = (StudentList*)data;
     GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
 
-    float avg = getAverageMarks(list);
-    gchar *msg = g_strdup_printf("Class Average Marks: %.2f", avg);
-    show_message(parent, msg);
-    g_free(msg);
+    ClassStats stats;
+    if (!getClassStats(list, &stats)) {
+        show_message(parent, "No student records.");
+        return;
+    }
+    GString *msg = g_string_new("");
+    g_string_append_printf(msg, "Students: %d\n", stats.count);
+    g_string_append_printf(msg, "Class Average Marks: %.2f (std dev %.2f)\n", stats.average, stats.stddev);
+    g_string_append_printf(msg, "Lowest: %.2f, highest: %.2f\n", stats.min, stats.max);
+    g_string_append_printf(msg, "Passed: %d, failed: %d (%.1f%% pass rate)\n\n",
+                           stats.passCount, stats.failCount, 100.0 * stats.passCount / stats.count);
+    for (int b = 0; b < GRADE_BANDS; b++) {
+        int from = b * 10;
+        int to = b == GRADE_BANDS - 1 ? 100 : from + 9;
+        g_string_append_printf(msg, "%d-%d: %d\n", from, to, stats.bands[b]);
+    }
+    show_message(parent, msg->str);
+    g_string_free(msg, TRUE);
 }
 
 /* --- Sort Students --- */
+static GtkWidget *new_key_combo(gboolean with_none) {
+    GtkWidget *combo = gtk_combo_box_text_new();
+    if (with_none) gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), "(none)");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), "Marks");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), "Roll No");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), "Name");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(combo), 0);
+    return combo;
+}
+
+static GtkWidget *new_order_combo(void) {
+    GtkWidget *combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), "Ascending (Low->High)");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), "Descending (High->Low)");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(combo), 0);
+    return combo;
+}
+
 static void on_sort_clicked(GtkWidget *widget, gpointer data) {
     StudentList *list = (StudentList*)data;
     GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
 
     GtkWidget *dialog = gtk_dialog_new_with_buttons("Sort Records", parent, 
-        GTK_DIALOG_MODAL, "Ascending (Low->High)", 1, "Descending (High->Low)", 0, "Cancel", -1, NULL);
-    
-    GtkWidget *label = gtk_label_new("Choose sort order by marks:");
-    gtk_container_add(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), label);
+        GTK_DIALOG_MODAL, "_Sort", GTK_RESPONSE_ACCEPT, "_Cancel", GTK_RESPONSE_REJECT, NULL);
+    GtkWidget *grid = gtk_grid_new();
+    gtk_container_add(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), grid);
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 5);
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 5);
+    gtk_container_set_border_width(GTK_CONTAINER(grid), 10);
+
+    // Order of the combo entries matches the SortField enum
+    GtkWidget *key1 = new_key_combo(FALSE);
+    GtkWidget *order1 = new_order_combo();
+    GtkWidget *key2 = new_key_combo(TRUE);
+    GtkWidget *order2 = new_order_combo();
+
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Sort by:"), 0, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), key1, 1, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), order1, 2, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Then by:"), 0, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), key2, 1, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), order2, 2, 1, 1, 1);
+    gtk_widget_show_all(dialog);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        SortKey keys[2];
+        int key_count = 1;
+        keys[0].field = (SortField)gtk_combo_box_get_active(GTK_COMBO_BOX(key1));
+        keys[0].descending = gtk_combo_box_get_active(GTK_COMBO_BOX(order1));
+
+        int second = gtk_combo_box_get_active(GTK_COMBO_BOX(key2));
+        if (second > 0) {
+            keys[1].field = (SortField)(second - 1);
+            keys[1].descending = gtk_combo_box_get_active(GTK_COMBO_BOX(order2));
+            key_count = 2;
+        }
+
+        Job *job = new_job(JOB_SORT, list, widget);
+        memcpy(job->keys, keys, (size_t)key_count * sizeof(SortKey));
+        job->key_count = key_count;
+        start_job(job, "Sorting...");
+    }
+    gtk_widget_destroy(dialog);
+}
+
+/* --- Rankings --- */
+static void on_top_clicked(GtkWidget *widget, gpointer data) {
+    StudentList *list = (StudentList*)data;
+    GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
+
+    GtkWidget *dialog = gtk_dialog_new_with_buttons("Top / Bottom Students", parent,
+        GTK_DIALOG_MODAL, "_Show", GTK_RESPONSE_ACCEPT, "_Cancel", GTK_RESPONSE_REJECT, NULL);
+    GtkWidget *grid = gtk_grid_new();
+    gtk_container_add(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), grid);
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 5);
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 5);
+    gtk_container_set_border_width(GTK_CONTAINER(grid), 10);
+
+    GtkWidget *which = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(which), "Top (highest marks)");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(which), "Bottom (lowest marks)");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(which), 0);
+    GtkWidget *count_entry = gtk_entry_new();
+    gtk_entry_set_text(GTK_ENTRY(count_entry), "10");
+
+    gtk_grid_attach(GTK_GRID(grid), which, 0, 0, 2, 1);
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("How many:"), 0, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), count_entry, 1, 1, 1, 1);
     gtk_widget_show_all(dialog);
 
-    gint response = gtk_dialog_run(GTK_DIALOG(dialog));
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        int k = atoi(gtk_entry_get_text(GTK_ENTRY(count_entry)));
+        int top = gtk_combo_box_get_active(GTK_COMBO_BOX(which)) == 0;
+        if (k > list->count) k = list->count;
+        if (k <= 0) {
+            show_message(parent, list->count == 0 ? "No records." : "Enter a number above 0.");
+        } else {
+            int *rows = g_new(int, k);
+            int found = top ? topStudents(list, k, rows) : bottomStudents(list, k, rows);
+            GString *s = g_string_new("");
+            g_string_append_printf(s, "%-5s %-20s %-10s %-10s\n", "No.", "Name", "Roll", "Marks");
+            for (int i = 0; i < found; i++) {
+                int r = rows[i];
+                g_string_append_printf(s, "%-5d %-20s %-10d %-10.2f\n", i + 1,
+                                       studentName(list, r), studentRoll(list, r), studentMarks(list, r));
+            }
+            show_message(parent, s->str);
+            g_string_free(s, TRUE);
+            g_free(rows);
+        }
+    }
     gtk_widget_destroy(dialog);
+}
+
+static void on_percentile_clicked(GtkWidget *widget, gpointer data) {
+    StudentList *list = (StudentList*)data;
+    GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
+    static const double common[] = { 10, 25, 50, 75, 90 };
+
+    double value;
+    if (!medianMarks(list, &value)) {
+        show_message(parent, "No records.");
+        return;
+    }
+    GString *msg = g_string_new("");
+    g_string_append_printf(msg, "Median marks: %.2f\n\n", value);
+    for (int i = 0; i < 5; i++) {
+        if (marksPercentile(list, common[i], &value))
+            g_string_append_printf(msg, "%.0fth percentile: %.2f\n", common[i], value);
+    }
+    show_message(parent, msg->str);
+    g_string_free(msg, TRUE);
+}
+
+static void on_rank_clicked(GtkWidget *widget, gpointer data) {
+    StudentList *list = (StudentList*)data;
+    GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
+
+    int roll = pop_up_input_dialog(parent, "Rank", "Enter Roll Number:");
+    if (roll == -1) return;
 
-    if (response == 1) {
-        sortStudents(list, 1); // Ascending
-        show_message(parent, "Sorted Ascending.");
-    } else if (response == 0) {
-        sortStudents(list, 0); // Descending
-        show_message(parent, "Sorted Descending.");
+    int rank = studentRank(list, roll);
+    if (rank == 0) {
+        show_message(parent, "Student not found.");
+        return;
     }
+    gchar *msg = g_strdup_printf("%s is ranked %d of %d by marks.",
+                                 studentName(list, searchStudent(list, roll)), rank, list->count);
+    show_message(parent, msg);
+    g_free(msg);
+}
+
+/* --- Diagnostics --- */
+static void fill_diagnostics(DiagnosticsWidgets *w) {
+    gtk_list_store_clear(w->store);
+    PerfStats stats;
+    if (!getPerfStats(&stats)) {
+        gtk_label_set_text(GTK_LABEL(w->counters_label),
+                           "Performance counters were compiled out (STUDENT_NO_PERF).");
+        return;
+    }
+    for (int op = 0; op < PERF_OP_COUNT; op++) {
+        const PerfOpStats *s = &stats.ops[op];
+        if (s->calls == 0) continue;
+        char calls[32], total[32], mean[32], p50[32], p99[32], max[32];
+        g_snprintf(calls, sizeof(calls), "%llu", s->calls);
+        g_snprintf(total, sizeof(total), "%.3f", s->totalNs / 1e6);
+        g_snprintf(mean, sizeof(mean), "%.2f", s->totalNs / 1e3 / (double)s->calls);
+        g_snprintf(p50, sizeof(p50), "%.2f", perfPercentileNs(s, 50) / 1e3);
+        g_snprintf(p99, sizeof(p99), "%.2f", perfPercentileNs(s, 99) / 1e3);
+        g_snprintf(max, sizeof(max), "%.2f", s->maxNs / 1e3);
+        gtk_list_store_insert_with_values(w->store, NULL, -1,
+                                          DIAG_COL_NAME, perfOpName((PerfOp)op), DIAG_COL_CALLS, calls,
+                                          DIAG_COL_TOTAL, total, DIAG_COL_MEAN, mean, DIAG_COL_P50, p50,
+                                          DIAG_COL_P99, p99, DIAG_COL_MAX, max, -1);
+    }
+    GString *msg = g_string_new("");
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        g_string_append_printf(msg, "%s: %llu\n", perfCounterName((PerfCounter)c), stats.counters[c]);
+    }
+    g_string_append_printf(msg, "Times in ms (total) and us; percentiles are bucket upper bounds.");
+    gtk_label_set_text(GTK_LABEL(w->counters_label), msg->str);
+    g_string_free(msg, TRUE);
+}
+
+static void on_diagnostics_refresh(GtkWidget *widget, gpointer data) {
+    (void)widget;
+    fill_diagnostics((DiagnosticsWidgets*)data);
+}
+
+static void on_diagnostics_reset(GtkWidget *widget, gpointer data) {
+    (void)widget;
+    resetPerfStats();
+    fill_diagnostics((DiagnosticsWidgets*)data);
+}
+
+static void on_diagnostics_clicked(GtkWidget *widget, gpointer data) {
+    (void)widget;
+    (void)data;
+    static const char *titles[DIAG_COL_COUNT] = {
+        "Operation", "Calls", "Total ms", "Mean us", "p50 us", "p99 us", "Max us"
+    };
+
+    DiagnosticsWidgets *w = g_new0(DiagnosticsWidgets, 1);
+    GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window), "Diagnostics");
+    gtk_window_set_default_size(GTK_WINDOW(window), 640, 420);
+    gtk_container_set_border_width(GTK_CONTAINER(window), 10);
+    g_signal_connect_swapped(window, "destroy", G_CALLBACK(g_free), w);
+
+    GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    gtk_container_add(GTK_CONTAINER(window), vbox);
+
+    w->store = gtk_list_store_new(DIAG_COL_COUNT, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+                                  G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+    GtkWidget *tree_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(w->store));
+    g_object_unref(w->store); // The view holds the reference now
+    for (int col = 0; col < DIAG_COL_COUNT; col++) {
+        GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
+        if (col != DIAG_COL_NAME) g_object_set(renderer, "xalign", 1.0, NULL);
+        gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view),
+                                    gtk_tree_view_column_new_with_attributes(titles[col], renderer, "text", col, NULL));
+    }
+    GtkWidget *scrolled = gtk_scrolled_window_new(NULL, NULL);
+    gtk_container_add(GTK_CONTAINER(scrolled), tree_view);
+    gtk_box_pack_start(GTK_BOX(vbox), scrolled, TRUE, TRUE, 2);
+
+    w->counters_label = gtk_label_new("");
+    gtk_label_set_xalign(GTK_LABEL(w->counters_label), 0.0);
+    gtk_box_pack_start(GTK_BOX(vbox), w->counters_label, FALSE, FALSE, 2);
+
+    GtkWidget *buttons = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    GtkWidget *refresh = gtk_button_new_with_label("Refresh");
+    GtkWidget *reset = gtk_button_new_with_label("Reset");
+    gtk_box_pack_end(GTK_BOX(buttons), refresh, FALSE, FALSE, 0);
+    gtk_box_pack_end(GTK_BOX(buttons), reset, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), buttons, FALSE, FALSE, 2);
+    g_signal_connect(refresh, "clicked", G_CALLBACK(on_diagnostics_refresh), w);
+    g_signal_connect(reset, "clicked", G_CALLBACK(on_diagnostics_reset), w);
+
+    fill_diagnostics(w);
+    gtk_widget_show_all(window);
 }
 
 /* --- Modify Student --- */
@@ -237,7 +895,7 @@ static void on_modify_clicked(GtkWidget *widget, gpointer data) {
     GtkWidget *marks_entry = gtk_entry_new();
     
     // Pre-fill current name
-    gtk_entry_set_text(GTK_ENTRY(name_entry), list->students[idx].name);
+    gtk_entry_set_text(GTK_ENTRY(name_entry), studentName(list, idx));
 
     gtk_grid_attach(GTK_GRID(grid), gtk_label_new("New Name:"), 0, 0, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), name_entry, 1, 0, 1, 1);
@@ -251,6 +909,7 @@ static void on_modify_clicked(GtkWidget *widget, gpointer data) {
         const char *marksStr = gtk_entry_get_text(GTK_ENTRY(marks_entry));
         float newMarks = (strlen(marksStr) > 0) ? atof(marksStr) : -1;
 
+        markUndoPoint(list, "Modify Record");
         modifyStudent(list, roll, newName, newMarks);
         show_message(parent, "Record Updated.");
     }
@@ -259,26 +918,175 @@ static void on_modify_clicked(GtkWidget *widget, gpointer data) {
 
 /* --- Load/Save --- */
 static void on_save_clicked(GtkWidget *widget, gpointer data) {
-    if (saveToFile((StudentList*)data)) 
-        show_message(GTK_WINDOW(gtk_widget_get_toplevel(widget)), "Saved!");
-    else 
-        show_message(GTK_WINDOW(gtk_widget_get_toplevel(widget)), "Error saving.");
+    StudentList *list = (StudentList*)data;
+    Job *job = new_job(JOB_SAVE, list, widget);
+    job->cancellable = list->journal == NULL; // A started checkpoint just runs to the end
+    start_job(job, "Saving...");
 }
 
 static void on_load_clicked(GtkWidget *widget, gpointer data) {
-    if (loadFromFile((StudentList*)data)) 
-        show_message(GTK_WINDOW(gtk_widget_get_toplevel(widget)), "Loaded!");
-    else 
-        show_message(GTK_WINDOW(gtk_widget_get_toplevel(widget)), "Error loading.");
+    start_job(new_job(JOB_LOAD, (StudentList*)data, widget), "Loading...");
+}
+
+/* --- Undo / Named Versions --- */
+static void on_undo_clicked(GtkWidget *widget, gpointer data) {
+    StudentList *list = (StudentList*)data;
+    GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
+    const char *label = undoLabel(list);
+    if (label == NULL) {
+        show_message(parent, "Nothing to undo.");
+        return;
+    }
+    gchar *text = g_strdup_printf("Undone: %s.", label); // The label goes with the step
+    if (undoChange(list))
+        gtk_label_set_text(GTK_LABEL(live_reload.status_label), text);
+    else
+        show_message(parent, "Error: not enough memory to undo.");
+    g_free(text);
+}
+
+static void on_redo_clicked(GtkWidget *widget, gpointer data) {
+    StudentList *list = (StudentList*)data;
+    GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
+    const char *label = redoLabel(list);
+    if (label == NULL) {
+        show_message(parent, "Nothing to redo.");
+        return;
+    }
+    gchar *text = g_strdup_printf("Redone: %s.", label);
+    if (redoChange(list))
+        gtk_label_set_text(GTK_LABEL(live_reload.status_label), text);
+    else
+        show_message(parent, "Error: not enough memory to redo.");
+    g_free(text);
+}
+
+enum { VERSION_SAVE = 1, VERSION_RESTORE, VERSION_DELETE };
+
+// Save the records under a name, or go back to (or drop) a saved one.
+// Saving costs next to nothing: versions share every unchanged chunk.
+static void on_versions_clicked(GtkWidget *widget, gpointer data) {
+    StudentList *list = (StudentList*)data;
+    GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(widget));
+
+    GtkWidget *dialog = gtk_dialog_new_with_buttons("Named Versions", parent,
+        GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+        "_Save", VERSION_SAVE, "_Restore", VERSION_RESTORE, "_Delete", VERSION_DELETE,
+        "_Close", GTK_RESPONSE_CLOSE, NULL);
+    GtkWidget *grid = gtk_grid_new();
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 5);
+    gtk_container_set_border_width(GTK_CONTAINER(grid), 10);
+    gtk_container_add(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), grid);
+    GtkWidget *names = gtk_combo_box_text_new_with_entry(); // Pick a saved name or type a new one
+    for (int i = 0; i < tagCount(list); i++)
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(names), tagName(list, i));
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("Name:"), 0, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), names, 1, 0, 1, 1);
+    gtk_widget_show_all(dialog);
+
+    int response = gtk_dialog_run(GTK_DIALOG(dialog));
+    gchar *name = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(names));
+    gtk_widget_destroy(dialog);
+    if (response == VERSION_SAVE || response == VERSION_RESTORE || response == VERSION_DELETE) {
+        if (name == NULL || name[0] == '\0')
+            show_message(parent, "Enter a name.");
+        else if (response == VERSION_SAVE)
+            show_message(parent, tagVersion(list, name) ? "Version saved." : "Error: not enough memory.");
+        else if (response == VERSION_RESTORE)
+            show_message(parent, restoreTag(list, name) ? "Version restored (Undo goes back)." : "No version by that name.");
+        else
+            show_message(parent, dropTag(list, name) ? "Version deleted." : "No version by that name.");
+    }
+    g_free(name);
+}
+
+/* --- Live Reload --- */
+static void apply_file_changes(void) {
+    if (job_controls.job || job_controls.quitting) return; // job_finished applies them
+    WatchReport report;
+    markUndoPoint(live_reload.list, "Reload of " FILENAME);
+    if (!watchApply(&live_reload.watch, live_reload.list, &report)) return; // Still pending: the next event retries
+
+    if (report.added + report.modified + report.removed + report.kept + report.malformed > 0) {
+        GString *msg = g_string_new(NULL);
+        g_string_append_printf(msg, "%s changed: %d added, %d modified, %d removed.", FILENAME,
+                               report.added, report.modified, report.removed);
+        if (report.kept > 0) g_string_append_printf(msg, " Kept %d local edits.", report.kept);
+        if (report.malformed > 0) g_string_append_printf(msg, " Skipped %d malformed rows.", report.malformed);
+        gtk_label_set_text(GTK_LABEL(live_reload.status_label), msg->str);
+        g_string_free(msg, TRUE);
+    }
+}
+
+static gboolean on_file_event(gint fd, GIOCondition condition, gpointer data) {
+    (void)fd;
+    (void)condition;
+    (void)data;
+    if (watchPoll(&live_reload.watch)) apply_file_changes();
+    return G_SOURCE_CONTINUE;
+}
+
+/* --- List Followers --- */
+static void update_summary(const StudentList *list) {
+    gchar *text = list->count == 0 ? g_strdup("No students.")
+        : g_strdup_printf("%d students, average %.2f, %d passed.", list->count, getAverageMarks(list),
+                          list->stats.passCount);
+    gtk_label_set_text(GTK_LABEL(followers.summary_label), text);
+    g_free(text);
+}
+
+static void on_list_changed(const StudentList *list, const ChangeBatch *batch, void *ctx) {
+    (void)ctx;
+    if (job_controls.quitting) return; // Widgets are already destroyed
+    for (guint i = 0; i < followers.views->len; i++) {
+        FilterBarWidgets *w = g_ptr_array_index(followers.views, i);
+        student_model_apply_changes(w->model, batch);
+        update_filter_count(w);
+    }
+    update_summary(list);
+}
+
+static gboolean flush_list_changes(gpointer data) {
+    followers.flush_source = 0;
+    flushChanges((StudentList*)data);
+    return G_SOURCE_REMOVE;
+}
+
+// First change since the last flush: one idle flush covers the whole burst
+static void on_list_wake(StudentList *list, void *ctx) {
+    (void)ctx;
+    if (followers.flush_source == 0) followers.flush_source = g_idle_add(flush_list_changes, list);
 }
 
 /* --- Main --- */
 int main(int argc, char *argv[]) {
     StudentList list;
-    initList(&list);
+    initListLayout(&list, LAYOUT_COLUMNS);
+    Journal journal;
+    // Restore the last snapshot and replay the journal on top of it
+    gboolean journaled = journalOpen(&journal, &list, SNAPSHOT_FILENAME, FILENAME, JOURNAL_PREFIX);
+    enableNameIndex(&list);
+    enableHistory(&list); // Undo, Redo and Named Versions
 
     gtk_init(&argc, &argv);
 
+    if (!journaled && journal.badSnapshot) {
+        // Starting empty would soon overwrite what is left: stop instead
+        show_message(NULL, SNAPSHOT_FILENAME " is damaged and " FILENAME " cannot stand in for it.\n"
+                           "Nothing was restored or changed; restore either file from a backup and start again.");
+        journalClose(&journal);
+        freeList(&list);
+        return 1;
+    }
+    if (!journaled) {
+        show_message(NULL, "Could not open the journal: changes will not survive a crash.");
+    } else if (journal.fromCsv) {
+        gchar *text = g_strdup_printf(SNAPSHOT_FILENAME " was damaged. The records were rebuilt from " FILENAME
+                                      " plus the %d journaled changes after it.", journal.replayed);
+        show_message(NULL, text);
+        g_free(text);
+    }
+
     GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(window), "Student System");
     gtk_window_set_default_size(GTK_WINDOW(window), 300, 500); // Taller window
@@ -287,6 +1095,35 @@ int main(int argc, char *argv[]) {
     GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
     gtk_container_add(GTK_CONTAINER(window), vbox);
 
+    // Live search by name, updated as the user types
+    NameSearchWidgets search;
+    search.list = &list;
+    search.results_label = gtk_label_new("");
+    gtk_label_set_xalign(GTK_LABEL(search.results_label), 0.0);
+    GtkWidget *search_entry = gtk_search_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(search_entry), "Search by name...");
+    gtk_box_pack_start(GTK_BOX(vbox), search_entry, FALSE, FALSE, 2);
+    gtk_box_pack_start(GTK_BOX(vbox), search.results_label, FALSE, FALSE, 2);
+    g_signal_connect(search_entry, "search-changed", G_CALLBACK(on_name_search_changed), &search);
+
+    followers.views = g_ptr_array_new();
+    followers.summary_label = gtk_label_new("");
+    gtk_label_set_xalign(GTK_LABEL(followers.summary_label), 0.0);
+    gtk_box_pack_start(GTK_BOX(vbox), followers.summary_label, FALSE, FALSE, 2);
+    update_summary(&list);
+    subscribeChanges(&list, on_list_changed, NULL);
+    setChangeWake(&list, on_list_wake, NULL);
+
+    live_reload.list = &list;
+    live_reload.status_label = gtk_label_new("");
+    gtk_label_set_xalign(GTK_LABEL(live_reload.status_label), 0.0);
+    gtk_box_pack_start(GTK_BOX(vbox), live_reload.status_label, FALSE, FALSE, 2);
+    guint watch_source = 0;
+    if (watchOpen(&live_reload.watch, FILENAME)) {
+        watch_source = g_unix_fd_add(watchFd(&live_reload.watch), G_IO_IN, on_file_event, NULL);
+        gtk_label_set_text(GTK_LABEL(live_reload.status_label), "Watching " FILENAME " for changes.");
+    }
+
     // Helper macro to add buttons quickly
     #define ADD_BTN(label, callback) \
         GtkWidget *btn_##callback = gtk_button_new_with_label(label); \
@@ -302,6 +1139,38 @@ int main(int argc, char *argv[]) {
     ADD_BTN("7. Load from File", on_load_clicked);
     ADD_BTN("8. Calculate Average", on_avg_clicked);
     ADD_BTN("9. Sort Records", on_sort_clicked);
+    ADD_BTN("10. Top / Bottom Students", on_top_clicked);
+    ADD_BTN("11. Median & Percentiles", on_percentile_clicked);
+    ADD_BTN("12. Rank by Roll No", on_rank_clicked);
+    ADD_BTN("13. Diagnostics", on_diagnostics_clicked);
+    ADD_BTN("14. Undo", on_undo_clicked);
+    ADD_BTN("15. Redo", on_redo_clicked);
+    ADD_BTN("16. Named Versions", on_versions_clicked);
+
+    // Buttons that change the list (or its cached stats) wait for a running job
+    job_controls.locked = g_ptr_array_new();
+    g_ptr_array_add(job_controls.locked, btn_on_add_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_modify_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_remove_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_save_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_load_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_avg_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_sort_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_undo_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_redo_clicked);
+    g_ptr_array_add(job_controls.locked, btn_on_versions_clicked);
+
+    job_controls.box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    job_controls.bar = gtk_progress_bar_new();
+    gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(job_controls.bar), TRUE);
+    job_controls.cancel = gtk_button_new_with_label("Cancel");
+    gtk_box_pack_start(GTK_BOX(job_controls.box), job_controls.bar, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(job_controls.box), job_controls.cancel, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), job_controls.box, FALSE, FALSE, 2);
+    gtk_widget_set_no_show_all(job_controls.box, TRUE);
+    gtk_widget_show(job_controls.bar);
+    gtk_widget_show(job_controls.cancel);
+    g_signal_connect(job_controls.cancel, "clicked", G_CALLBACK(on_job_cancel_clicked), NULL);
 
     GtkWidget *quit_btn = gtk_button_new_with_label("0. Quit");
     gtk_box_pack_start(GTK_BOX(vbox), quit_btn, TRUE, TRUE, 2);
@@ -310,7 +1179,18 @@ int main(int argc, char *argv[]) {
 
     gtk_widget_show_all(window);
     gtk_main();
-    
+
+    // The worker may still be reading the list: stop it and wait
+    job_controls.quitting = TRUE;
+    if (job_controls.job) atomic_store(&job_controls.job->progress.cancelled, 1);
+    while (job_controls.job) g_main_context_iteration(NULL, TRUE);
+    g_ptr_array_free(job_controls.locked, TRUE);
+    if (watch_source) g_source_remove(watch_source);
+    watchClose(&live_reload.watch);
+    if (followers.flush_source) g_source_remove(followers.flush_source);
+    g_ptr_array_free(followers.views, TRUE);
+
+    journalClose(&journal); // Waits for a background save
     freeList(&list);
     return 0;
 }
\ No newline at end of file
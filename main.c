@@ -1,7 +1,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <math.h>
 #include "student_logic.h" // <-- Include our new header!
+#include "student_journal.h"
+#include "student_perf.h"
+#include "student_watch.h"
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 // --- Console-Specific Helper Functions ---
 
@@ -23,18 +32,50 @@ void displayStudentsConsole(const StudentList *list) {
     printf("\n%-20s %-10s %-10s %-10s\n", "Name", "Roll No", "Marks", "Status");
     for (int i = 0; i < list->count; i++) {
         printf("%-20s %-10d %-10.2f %-10s\n",
-               list->students[i].name,
-               list->students[i].roll,
-               list->students[i].marks,
-               (list->students[i].marks > 40) ? "Passed" : "Failed");
+               studentName(list, i),
+               studentRoll(list, i),
+               studentMarks(list, i),
+               marksPassed(studentMarks(list, i)) ? "Passed" : "Failed");
     }
 }
 
 void displayStudentConsole(const StudentList *list, int idx) {
-    printf("Name: %s\n", list->students[idx].name);
-    printf("Roll Number: %d\n", list->students[idx].roll);
-    printf("Marks: %.2f\n", list->students[idx].marks);
-    printf("Status: %s\n", (list->students[idx].marks > 40) ? "Passed" : "Failed");
+    printf("Name: %s\n", studentName(list, idx));
+    printf("Roll Number: %d\n", studentRoll(list, idx));
+    printf("Marks: %.2f\n", studentMarks(list, idx));
+    printf("Status: %s\n", marksPassed(studentMarks(list, idx)) ? "Passed" : "Failed");
+}
+
+void printLoadReport(const LoadReport *report) {
+    if (report->duplicateRows > 0) {
+        printf("Skipped %d rows with a duplicate roll number.\n", report->duplicateRows);
+    }
+    if (report->malformedRows > 0) {
+        printf("Skipped %d malformed rows, on line(s):", report->malformedRows);
+        for (int i = 0; i < report->badLineCount; i++) {
+            printf(" %d", report->badLines[i]);
+        }
+        printf(report->malformedRows > report->badLineCount ? " ...\n" : "\n");
+    }
+}
+
+void printClassStats(StudentList *list) {
+    ClassStats stats;
+    if (!getClassStats(list, &stats)) { // From student_logic.h
+        printf("No student records.\n");
+        return;
+    }
+    printf("Students: %d\n", stats.count);
+    printf("Average marks: %.2f (std dev %.2f)\n", stats.average, stats.stddev);
+    printf("Lowest: %.2f, highest: %.2f\n", stats.min, stats.max);
+    printf("Passed: %d, failed: %d (%.1f%% pass rate)\n",
+           stats.passCount, stats.failCount, 100.0 * stats.passCount / stats.count);
+    printf("Marks distribution:\n");
+    for (int b = 0; b < GRADE_BANDS; b++) {
+        int from = b * 10;
+        int to = b == GRADE_BANDS - 1 ? 100 : from + 9;
+        printf("  %3d-%-3d %d\n", from, to, stats.bands[b]);
+    }
 }
 
 void handleAddStudent(StudentList *list) {
@@ -56,7 +97,7 @@ void handleAddStudent(StudentList *list) {
 
     if (addStudent(list, name, roll, marks)) {
         printf("Student record added successfully.\n");
-        printf("%s has %s.\n", name, (marks > 40) ? "passed" : "failed");
+        printf("%s has %s.\n", name, marksPassed(marks) ? "passed" : "failed");
     } else {
         printf("Error: A student with roll number %d already exists.\n", roll);
     }
@@ -74,7 +115,7 @@ void handleModifyStudent(StudentList *list) {
         return;
     }
 
-    printf("Modifying record for %s (Roll %d):\n", list->students[idx].name, list->students[idx].roll);
+    printf("Modifying record for %s (Roll %d):\n", studentName(list, idx), studentRoll(list, idx));
     
     char newName[NAME_LEN];
     printf("Enter new name (leave blank to keep current): ");
@@ -106,16 +147,438 @@ void handleRemoveStudent(StudentList *list) {
     }
 }
 
+void handleSortStudents(StudentList *list) {
+    static const char *fieldNames[] = { "marks", "roll number", "name" };
+    int choice, order;
+    printf("Sort by:\n");
+    printf("  1. Marks\n");
+    printf("  2. Roll number\n");
+    printf("  3. Name\n");
+    printf("  4. Marks (high->low), then roll number (low->high)\n");
+    printf("Enter choice: ");
+    scanf("%d", &choice);
+    getchar();
+
+    if (choice == 4) {
+        SortKey keys[2] = { { SORT_BY_MARKS, 1 }, { SORT_BY_ROLL, 0 } };
+        if (sortStudentsBy(list, keys, 2)) {
+            printf("Records sorted by marks descending, then roll number ascending.\n");
+        } else {
+            printf("Error: not enough memory to sort.\n");
+        }
+        return;
+    }
+    if (choice < 1 || choice > 3) {
+        printf("Invalid choice.\n");
+        return;
+    }
+
+    printf("Enter 1 for ascending, 0 for descending: ");
+    scanf("%d", &order);
+    getchar();
+
+    SortKey key = { (SortField)(choice - 1), !order };
+    if (sortStudentsBy(list, &key, 1)) {
+        printf("Records sorted by %s %s.\n", fieldNames[choice - 1], order ? "ascending" : "descending");
+    } else {
+        printf("Error: not enough memory to sort.\n");
+    }
+}
+
+void handleTopStudents(StudentList *list) {
+    int k, top;
+    printf("How many students? ");
+    scanf("%d", &k);
+    printf("Enter 1 for the top (highest marks), 0 for the bottom: ");
+    scanf("%d", &top);
+    getchar();
+    if (k <= 0) {
+        printf("Invalid number.\n");
+        return;
+    }
+    if (k > list->count) k = list->count;
+
+    int *rows = malloc((size_t)k * sizeof(int) + 1);
+    if (rows == NULL) {
+        printf("Error: not enough memory.\n");
+        return;
+    }
+    int found = top ? topStudents(list, k, rows) : bottomStudents(list, k, rows);
+    if (found == 0) {
+        printf("No student records to display.\n");
+    } else {
+        printf("\n%-5s %-20s %-10s %-10s\n", "No.", "Name", "Roll No", "Marks");
+        for (int i = 0; i < found; i++) {
+            int r = rows[i];
+            printf("%-5d %-20s %-10d %-10.2f\n", i + 1, studentName(list, r), studentRoll(list, r), studentMarks(list, r));
+        }
+    }
+    free(rows);
+}
+
+void handlePercentiles(StudentList *list) {
+    static const double common[] = { 10, 25, 50, 75, 90 };
+    double value;
+    if (!medianMarks(list, &value)) {
+        printf("No student records.\n");
+        return;
+    }
+    printf("Median marks: %.2f\n", value);
+    for (int i = 0; i < 5; i++) {
+        if (marksPercentile(list, common[i], &value)) {
+            printf("  %2.0fth percentile: %.2f\n", common[i], value);
+        }
+    }
+
+    double p;
+    printf("Enter another percentile (0-100), or -1 to skip: ");
+    scanf("%lf", &p);
+    getchar();
+    if (p < 0) return;
+    if (marksPercentile(list, p, &value)) {
+        printf("%.1fth percentile: %.2f\n", p, value);
+    } else {
+        printf("Percentile must be between 0 and 100.\n");
+    }
+}
+
+void handleRank(StudentList *list) {
+    int roll;
+    printf("Enter roll number: ");
+    scanf("%d", &roll);
+    getchar();
+    int rank = studentRank(list, roll);
+    if (rank == 0) {
+        printf("Student with roll number %d not found.\n", roll);
+        return;
+    }
+    printf("%s is ranked %d of %d by marks.\n", studentName(list, searchStudent(list, roll)), rank, list->count);
+}
+
+void handleNameSearch(StudentList *list) {
+    enum { MAX_RESULTS = 20 };
+    char query[NAME_LEN];
+    int mode;
+    printf("Enter name or part of a name: ");
+    fgets(query, NAME_LEN, stdin);
+    query[strcspn(query, "\n")] = 0; // Remove trailing newline
+    printf("Enter 1 to match the start of the name, 2 to match anywhere: ");
+    scanf("%d", &mode);
+    getchar();
+
+    int rows[MAX_RESULTS];
+    int found = searchByName(list, query, mode == 1 ? NAME_MATCH_PREFIX : NAME_MATCH_SUBSTRING, 0, rows, MAX_RESULTS);
+    if (found == 0) {
+        printf("No students match \"%s\".\n", query);
+        return;
+    }
+    printf("\n%-20s %-10s %-10s\n", "Name", "Roll No", "Marks");
+    for (int i = 0; i < found; i++) {
+        printf("%-20s %-10d %-10.2f\n", studentName(list, rows[i]), studentRoll(list, rows[i]), studentMarks(list, rows[i]));
+    }
+    if (found == MAX_RESULTS) {
+        printf("(showing the first %d matches; refine the search to see others)\n", MAX_RESULTS);
+    }
+}
+
+void handleRollRange(StudentList *list) {
+    enum { MAX_RESULTS = 20 };
+    int from, to;
+    printf("Roll number from: ");
+    scanf("%d", &from);
+    printf("Roll number up to: ");
+    scanf("%d", &to);
+    getchar();
+
+    int rows[MAX_RESULTS];
+    int total = rollRangeCount(list, from, to);
+    int found = rollRange(list, from, to, rows, MAX_RESULTS);
+    if (total < 0 || found < 0) {
+        printf("Error: not enough memory.\n");
+        return;
+    }
+    if (total == 0) {
+        printf("No roll numbers between %d and %d.\n", from, to);
+        return;
+    }
+    printf("\n%-20s %-10s %-10s\n", "Name", "Roll No", "Marks");
+    for (int i = 0; i < found; i++) {
+        printf("%-20s %-10d %-10.2f\n", studentName(list, rows[i]), studentRoll(list, rows[i]), studentMarks(list, rows[i]));
+    }
+    if (total > found) {
+        printf("(%d students in the range; showing the first %d)\n", total, found);
+    }
+}
+
+void handleExport(StudentList *list) {
+    char path[1024];
+    printf("Export to file (.csv, .jsonl or .tsv): ");
+    fgets(path, sizeof(path), stdin);
+    path[strcspn(path, "\n")] = 0;
+    if (path[0] == '\0') return;
+    if (exportStudents(list, path, exportFormatForPath(path), NULL)) {
+        printf("Exported %d students to %s.\n", list->count, path);
+    } else {
+        printf("Error writing %s.\n", path);
+    }
+}
+
+// Adds term to the filter built so far, joined by AND or OR.
+int joinFilter(StudentFilter *filter, int sofar, int term, int any) {
+    if (sofar < 0) return term;
+    return any ? filterOr(filter, sofar, term) : filterAnd(filter, sofar, term);
+}
+
+void handleFilterStudents(StudentList *list) {
+    enum { MAX_RESULTS = 20 };
+    float marksFrom, marksTo;
+    int rollFrom, rollTo, status, any;
+    char prefix[NAME_LEN];
+
+    printf("Marks from (-1 for no limit): ");
+    scanf("%f", &marksFrom);
+    printf("Marks up to (-1 for no limit): ");
+    scanf("%f", &marksTo);
+    printf("Roll number from (-1 for no limit): ");
+    scanf("%d", &rollFrom);
+    printf("Roll number up to (-1 for no limit): ");
+    scanf("%d", &rollTo);
+    printf("Status: 0 = any, 1 = passed, 2 = failed: ");
+    scanf("%d", &status);
+    getchar();
+    printf("Name starts with (leave blank for any): ");
+    fgets(prefix, NAME_LEN, stdin);
+    prefix[strcspn(prefix, "\n")] = 0;
+    printf("Enter 1 to match all of these, 2 to match any of them: ");
+    scanf("%d", &any);
+    getchar();
+    any = any == 2;
+
+    StudentFilter filter;
+    filterInit(&filter);
+    int root = -1;
+    if (marksFrom >= 0 || marksTo >= 0) {
+        root = joinFilter(&filter, root, filterMarks(&filter, marksFrom >= 0 ? marksFrom : -INFINITY,
+                                                     marksTo >= 0 ? marksTo : INFINITY), any);
+    }
+    if (rollFrom != -1 || rollTo != -1) {
+        root = joinFilter(&filter, root, filterRoll(&filter, rollFrom != -1 ? rollFrom : INT_MIN,
+                                                    rollTo != -1 ? rollTo : INT_MAX), any);
+    }
+    if (status == 1 || status == 2) {
+        root = joinFilter(&filter, root, filterPassed(&filter, status == 1), any);
+    }
+    if (prefix[0] != '\0') {
+        root = joinFilter(&filter, root, filterNamePrefix(&filter, prefix), any);
+    }
+
+    int *rows = malloc((size_t)list->count * sizeof(int) + 1);
+    if (rows == NULL) {
+        printf("Error: not enough memory.\n");
+        return;
+    }
+    int found = filterRows(list, &filter, rows);
+    if (found == 0) {
+        printf("No students match.\n");
+    } else {
+        printf("\n%-20s %-10s %-10s %-10s\n", "Name", "Roll No", "Marks", "Status");
+        for (int i = 0; i < found && i < MAX_RESULTS; i++) {
+            int r = rows[i];
+            printf("%-20s %-10d %-10.2f %-10s\n", studentName(list, r), studentRoll(list, r), studentMarks(list, r),
+                   marksPassed(studentMarks(list, r)) ? "Passed" : "Failed");
+        }
+        if (found > MAX_RESULTS) printf("(showing the first %d)\n", MAX_RESULTS);
+        printf("%d of %d students match.\n", found, list->count);
+    }
+    free(rows);
+}
+
+void handlePerfStats(void) {
+    PerfStats stats;
+    if (!getPerfStats(&stats)) {
+        printf("Performance counters were compiled out (STUDENT_NO_PERF).\n");
+        return;
+    }
+    printf("\n%-16s %10s %12s %10s %10s %10s %10s\n", "Operation", "Calls", "Total ms", "Mean us",
+           "p50 us", "p99 us", "Max us");
+    for (int op = 0; op < PERF_OP_COUNT; op++) {
+        const PerfOpStats *s = &stats.ops[op];
+        if (s->calls == 0) continue;
+        printf("%-16s %10llu %12.3f %10.2f %10.2f %10.2f %10.2f\n", perfOpName((PerfOp)op), s->calls,
+               s->totalNs / 1e6, s->totalNs / 1e3 / (double)s->calls, perfPercentileNs(s, 50) / 1e3,
+               perfPercentileNs(s, 99) / 1e3, s->maxNs / 1e3);
+    }
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        printf("%s: %llu\n", perfCounterName((PerfCounter)c), stats.counters[c]);
+    }
+    printf("(percentiles are bucket upper bounds; %d thread(s) recorded)\n", stats.threads);
+
+    int reset;
+    printf("Enter 1 to reset the counters, 0 to keep them: ");
+    scanf("%d", &reset);
+    getchar();
+    if (reset == 1) {
+        resetPerfStats();
+        printf("Counters reset.\n");
+    }
+}
+
+// --- Live Reload ---
+
+// Applies the changes other programs made to students.txt since the last
+// look. Returns 1 if it printed anything.
+int applyWatchedChanges(FileWatch *watch, StudentList *list) {
+    if (!watchPoll(watch)) return 0;
+    WatchReport report;
+    markUndoPoint(list, "Reload of " FILENAME);
+    if (!watchApply(watch, list, &report)) {
+        printf("\n%s changed but could not be read; will try again.\n", FILENAME);
+        return 1;
+    }
+    int changes = report.added + report.modified + report.removed + report.kept + report.malformed;
+    if (changes > 0) {
+        printf("\n%s changed: %d added, %d modified, %d removed", FILENAME, report.added, report.modified,
+               report.removed);
+        if (report.kept > 0) printf(", %d local edits kept", report.kept);
+        if (report.malformed > 0) printf(", %d malformed rows skipped", report.malformed);
+        printf(".\n");
+    }
+    return changes > 0;
+}
+
+// At an interactive prompt: applies file changes while waiting for input.
+// Without inotify there is nothing to wait on, and the prompt just reads.
+void waitForInput(FileWatch *watch, StudentList *list, const char *prompt) {
+#ifdef __linux__
+    if (!isatty(STDIN_FILENO)) return; // Piped input is read straight away
+    struct pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { watchFd(watch), POLLIN, 0 } };
+    while (poll(fds, 2, -1) > 0 && !(fds[0].revents & (POLLIN | POLLHUP))) {
+        if (!applyWatchedChanges(watch, list)) continue;
+        printf("%s", prompt);
+        fflush(stdout);
+    }
+#else
+    (void)watch;
+    (void)list;
+    (void)prompt;
+#endif
+}
+
+void handleLiveReload(FileWatch *watch, int *watching) {
+    if (*watching) {
+        watchClose(watch);
+        *watching = 0;
+        printf("Stopped watching %s.\n", FILENAME);
+    } else if (watchOpen(watch, FILENAME)) {
+        *watching = 1;
+        printf("Watching %s: changes other programs make are applied as they happen.\n", FILENAME);
+        printf("Records you changed here since the file was written are kept as they are.\n");
+    } else {
+        printf("Error: cannot watch %s (needs Linux inotify).\n", FILENAME);
+    }
+}
+
+void handleUndo(StudentList *list, int redo) {
+    const char *label = redo ? redoLabel(list) : undoLabel(list);
+    if (label == NULL) {
+        printf("Nothing to %s.\n", redo ? "redo" : "undo");
+        return;
+    }
+    char step[64];
+    snprintf(step, sizeof(step), "%s", label); // The label goes with the step
+    if (redo ? redoChange(list) : undoChange(list)) {
+        printf("%s: %s (%d students now).\n", redo ? "Redone" : "Undone", step, list->count);
+    } else {
+        printf("Error: not enough memory to %s.\n", redo ? "redo" : "undo");
+    }
+}
+
+// Named versions: the records as they were at some point, kept by name.
+// Saving one is O(1); it only costs memory for the chunks changed since.
+void handleVersions(StudentList *list) {
+    int choice;
+    char name[64];
+    printf("Named versions:\n");
+    for (int i = 0; i < tagCount(list); i++) {
+        printf("  - %s\n", tagName(list, i));
+    }
+    if (tagCount(list) == 0) printf("  (none yet)\n");
+    printf("  1. Save the current records as...\n");
+    printf("  2. Restore a version\n");
+    printf("  3. Delete a version\n");
+    printf("Enter choice: ");
+    scanf("%d", &choice);
+    getchar();
+    if (choice < 1 || choice > 3) {
+        printf("Invalid choice.\n");
+        return;
+    }
+    printf("Version name: ");
+    fgets(name, sizeof(name), stdin);
+    name[strcspn(name, "\n")] = 0;
+    if (name[0] == '\0') {
+        printf("A version needs a name.\n");
+        return;
+    }
+    if (choice == 1) {
+        printf(tagVersion(list, name) ? "Saved as \"%s\".\n" : "Error: could not save \"%s\".\n", name);
+    } else if (choice == 2) {
+        if (restoreTag(list, name)) {
+            printf("Restored \"%s\" (%d students). Undo goes back.\n", name, list->count);
+        } else {
+            printf("No version named \"%s\" (or not enough memory).\n", name);
+        }
+    } else {
+        printf(dropTag(list, name) ? "Deleted \"%s\".\n" : "No version named \"%s\".\n", name);
+    }
+}
+
 // --- The Main Function (The "Controller") ---
 
 int main() {
+#ifdef __linux__
+    // At a terminal, read stdin unbuffered: stdio then never holds typed-ahead
+    // or pasted lines that waitForInput's poll() on fd 0 could not see
+    if (isatty(STDIN_FILENO)) setvbuf(stdin, NULL, _IONBF, 0);
+#endif
     greetUser();
 
     StudentList list;
-    initList(&list); // From student_logic.h
+    initListLayout(&list, LAYOUT_COLUMNS); // From student_logic.h
+
+    // Recover the last snapshot plus every change journaled since
+    Journal journal;
+    if (journalOpen(&journal, &list, SNAPSHOT_FILENAME, FILENAME, JOURNAL_PREFIX)) {
+        if (list.count > 0 || journal.replayed > 0) {
+            printf("Restored %d records (%d journaled changes replayed).\n", list.count, journal.replayed);
+        }
+        if (journal.tornTail) {
+            printf("Note: an incomplete journal entry from a crash was discarded.\n");
+        }
+        if (journal.fromCsv) {
+            printf("Warning: %s was damaged; the records were rebuilt from %s plus the %d journaled changes after it,\n"
+                   "and a new snapshot is being written.\n", SNAPSHOT_FILENAME, FILENAME, journal.replayed);
+        }
+    } else if (journal.badSnapshot) {
+        // Starting empty would soon overwrite what is left: stop instead
+        printf("Error: %s is damaged and %s cannot stand in for it. Nothing was restored or changed;\n"
+               "restore either file from a backup and start again.\n", SNAPSHOT_FILENAME, FILENAME);
+        journalClose(&journal);
+        freeList(&list);
+        return EXIT_FAILURE;
+    } else {
+        printf("Warning: could not open the journal; changes will not survive a crash.\n");
+    }
+    enableNameIndex(&list); // Search still works (by scanning) if this fails
+    if (!enableHistory(&list)) {
+        printf("Warning: not enough memory for undo.\n");
+    }
 
+    FileWatch watch;
+    int watching = 0;
     int choice;
     do {
+        if (watching) applyWatchedChanges(&watch, &list);
         printf("\n---- Student Record System ----\n");
         printf("1. Add student\n");
         printf("2. Display all students\n");
@@ -125,23 +588,43 @@ int main() {
         printf("6. Save records to file\n");
         printf("7. Load records from file\n");
         printf("8. Calculate average marks\n");
-        printf("9. Sort records by marks\n");
+        printf("9. Sort records\n");
+        printf("10. Top / bottom students\n");
+        printf("11. Median and percentiles\n");
+        printf("12. Rank of a student\n");
+        printf("13. Search students by name\n");
+        printf("14. Performance counters\n");
+        printf("15. Filter students\n");
+        printf("16. Students in a roll number range\n");
+        printf("17. Export records (CSV, JSON lines or TSV)\n");
+        printf("18. %s live reload of %s\n", watching ? "Stop" : "Start", FILENAME);
+        const char *undo = undoLabel(&list), *redo = redoLabel(&list);
+        printf("19. Undo%s%s\n", undo ? ": " : "", undo ? undo : "");
+        printf("20. Redo%s%s\n", redo ? ": " : "", redo ? redo : "");
+        printf("21. Named versions (save / restore)\n");
         printf("0. Exit\n");
         printf("Enter choice: ");
+        if (watching) {
+            fflush(stdout);
+            waitForInput(&watch, &list, "Enter choice: ");
+        }
         scanf("%d", &choice);
         getchar(); // consume newline
 
         switch (choice) {
             case 1:
+                markUndoPoint(&list, "Add student");
                 handleAddStudent(&list);
                 break;
             case 2:
                 displayStudentsConsole(&list);
                 break;
             case 3:
+                markUndoPoint(&list, "Modify student");
                 handleModifyStudent(&list);
                 break;
             case 4:
+                markUndoPoint(&list, "Remove student");
                 handleRemoveStudent(&list);
                 break;
             case 5: {
@@ -154,40 +637,78 @@ int main() {
                     displayStudentConsole(&list, idx);
                 } else {
                     printf("Student with roll number %d not found.\n", roll);
+                    int below = previousStudent(&list, roll), above = nextStudent(&list, roll);
+                    if (below != -1) printf("Next lower roll number: %d\n", studentRoll(&list, below));
+                    if (above != -1) printf("Next higher roll number: %d\n", studentRoll(&list, above));
                 }
                 break;
             }
             case 6:
-                if (saveToFile(&list)) { // From student_logic.h
-                    printf("Records saved to file.\n");
+                // Every change is already journaled; a checkpoint compacts the
+                // journal into a fresh snapshot (and students.txt) in the background
+                if (!journalWaitCheckpoint(&journal)) {
+                    printf("Warning: the previous save failed; retrying.\n");
+                }
+                if (journalCheckpoint(&journal, &list)) {
+                    printf("Saving records in the background.\n");
                 } else {
                     printf("Error saving file.\n");
                 }
                 break;
-            case 7:
-                if (loadFromFile(&list)) { // From student_logic.h
-                    printf("Records loaded from file.\n");
+            case 7: {
+                LoadReport report;
+                markUndoPoint(&list, "Load from file");
+                if (loadFromFileReport(&list, FILENAME, &report)) { // From student_logic.h
+                    printf("Records loaded from file (%d students).\n", report.rowsLoaded);
+                    printLoadReport(&report);
                 } else {
                     printf("Error opening file for reading.\n");
                 }
                 break;
-            case 8: {
-                float avg = getAverageMarks(&list); // From student_logic.h
-                if (list.count > 0) {
-                    printf("Average marks: %.2f\n", avg);
-                } else {
-                    printf("No student records.\n");
-                }
-                break;
             }
-            case 9: {
-                int order;
-                printf("Enter 1 for ascending, 0 for descending: ");
-                scanf("%d", &order);
-                sortStudents(&list, order); // From student_logic.h
-                printf("Records sorted by marks %s.\n", order ? "ascending" : "descending");
+            case 8:
+                printClassStats(&list);
+                break;
+            case 9:
+                markUndoPoint(&list, "Sort");
+                handleSortStudents(&list);
+                break;
+            case 10:
+                handleTopStudents(&list);
+                break;
+            case 11:
+                handlePercentiles(&list);
+                break;
+            case 12:
+                handleRank(&list);
+                break;
+            case 13:
+                handleNameSearch(&list);
+                break;
+            case 14:
+                handlePerfStats();
+                break;
+            case 15:
+                handleFilterStudents(&list);
+                break;
+            case 16:
+                handleRollRange(&list);
+                break;
+            case 17:
+                handleExport(&list);
+                break;
+            case 18:
+                handleLiveReload(&watch, &watching);
+                break;
+            case 19:
+                handleUndo(&list, 0);
+                break;
+            case 20:
+                handleUndo(&list, 1);
+                break;
+            case 21:
+                handleVersions(&list);
                 break;
-            }
             case 0:
                 printf("Exiting...\n");
                 break;
@@ -196,6 +717,11 @@ int main() {
         }
     } while (choice != 0);
 
+    if (!journalWaitCheckpoint(&journal)) { // Let a background save finish
+        printf("Warning: the last save failed; your changes are still in the journal.\n");
+    }
+    if (watching) watchClose(&watch);
+    journalClose(&journal);
     freeList(&list); // From student_logic.h
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,476 @@
+// Headless record server: owns one StudentList (recovered from the journal
+// like the console app) and serves it over a Unix-domain socket.
+//
+// Protocol: one request per line, one reply line per request, replies in
+// request order. Clients may pipeline as many requests as they like; every
+// request that has arrived is answered before the server writes, so replies
+// go out in batches.
+//
+//   ADD <roll> <marks> <name>        OK | ERR duplicate
+//   MOD <roll> <marks|-> [<name>]    OK | ERR not found   ("-" keeps the marks)
+//   DEL <roll>                       OK | ERR not found
+//   GET <roll>                       OK <roll> <marks> <name> | ERR not found
+//   FIND <text>                      OK <n> <roll>...     (names containing text, any case)
+//   STATS                            OK <count> <average> <stddev> <min> <max> <passed> <failed>
+//   SORT <field> <asc|desc> ...      OK                   (field: marks, roll or name)
+//   SAVE                             OK | ERR save failed
+//   QUIT                             OK, then the server hangs up
+//
+// Failures that are not the client's fault answer "ERR no memory".
+//
+// Usage: student_server [-s socket] [-m]   (-m: memory only, no journal)
+//
+// Build: make   (build/student_server; the Makefile has the source list)
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "student_logic.h"
+#include "student_journal.h"
+
+#define DEFAULT_SOCKET "students.sock"
+#define MAX_EVENTS 64
+#define READ_CHUNK 65536
+#define MAX_LINE 4096             // Longer requests get an error and a hang-up
+#define OUT_HIGH_WATER (1 << 20)  // Stop reading from a client that isn't reading its replies
+#define FIND_LIMIT 20
+
+typedef struct {
+    char *data;
+    size_t start;   // Consumed up to here
+    size_t len;
+    size_t cap;
+} Buffer;
+
+typedef struct {
+    int fd;
+    Buffer in;
+    Buffer out;
+    unsigned events; // What epoll is watching for
+    int closing;     // Hang up once out is flushed
+} Client;
+
+typedef struct {
+    StudentList *list;
+    int epfd;
+} Server;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int sig) {
+    (void)sig;
+    stopRequested = 1;
+}
+
+// --- Buffers ---
+
+static int bufferReserve(Buffer *buf, size_t extra) {
+    if (buf->start > 0 && buf->len + extra > buf->cap) {
+        // Slide the unconsumed bytes down before growing
+        memmove(buf->data, buf->data + buf->start, buf->len - buf->start);
+        buf->len -= buf->start;
+        buf->start = 0;
+    }
+    if (buf->len + extra <= buf->cap) {
+        return 1;
+    }
+    size_t cap = buf->cap == 0 ? 4096 : buf->cap;
+    while (cap < buf->len + extra) {
+        cap *= 2;
+    }
+    char *data = realloc(buf->data, cap);
+    if (data == NULL) {
+        return 0; // Failure: out of memory
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return 1;
+}
+
+static int replyf(Client *client, const char *fmt, ...) {
+    Buffer *out = &client->out;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (n < 0 || !bufferReserve(out, (size_t)n + 1)) {
+        return 0;
+    }
+    va_start(args, fmt);
+    vsnprintf(out->data + out->len, (size_t)n + 1, fmt, args);
+    va_end(args);
+    out->len += (size_t)n;
+    return 1;
+}
+
+// --- Requests ---
+
+static int parseRoll(char **cursor, int *roll) {
+    char *end;
+    errno = 0;
+    long value = strtol(*cursor, &end, 10);
+    if (end == *cursor || errno != 0 || value < -2147483647L - 1 || value > 2147483647L) {
+        return 0;
+    }
+    *roll = (int)value;
+    *cursor = end;
+    return 1;
+}
+
+static int parseMarks(char **cursor, float *marks) {
+    char *end;
+    *marks = strtof(*cursor, &end);
+    if (end == *cursor) {
+        return 0;
+    }
+    *cursor = end;
+    return 1;
+}
+
+// Skips the single space that separates a field from the name after it.
+static char *restOfLine(char *p) {
+    return *p == ' ' ? p + 1 : p;
+}
+
+static int parseSortKeys(char *p, SortKey *keys) {
+    int count = 0;
+    char *save = NULL;
+    for (char *word = strtok_r(p, " ", &save); word != NULL; word = strtok_r(NULL, " ", &save)) {
+        if (count == MAX_SORT_KEYS) return 0;
+        if (strcmp(word, "marks") == 0) keys[count].field = SORT_BY_MARKS;
+        else if (strcmp(word, "roll") == 0) keys[count].field = SORT_BY_ROLL;
+        else if (strcmp(word, "name") == 0) keys[count].field = SORT_BY_NAME;
+        else return 0;
+
+        char *order = strtok_r(NULL, " ", &save);
+        if (order == NULL || (strcmp(order, "asc") != 0 && strcmp(order, "desc") != 0)) return 0;
+        keys[count].descending = order[0] == 'd';
+        count++;
+    }
+    return count;
+}
+
+// Answers one request line (NUL-terminated, no newline). Returns 0 only if
+// the reply could not be buffered.
+static int handleRequest(Server *server, Client *client, char *line) {
+    StudentList *list = server->list;
+    char *p = strchr(line, ' ');
+    if (p != NULL) *p++ = '\0';
+    else p = line + strlen(line);
+
+    if (strcmp(line, "GET") == 0) {
+        int roll;
+        if (!parseRoll(&p, &roll)) return replyf(client, "ERR bad request\n");
+        int i = searchStudent(list, roll);
+        if (i == -1) return replyf(client, "ERR not found\n");
+        return replyf(client, "OK %d %.2f %s\n", studentRoll(list, i), studentMarks(list, i), studentName(list, i));
+    }
+    if (strcmp(line, "ADD") == 0) {
+        StudentInput row;
+        RowResult result;
+        if (!parseRoll(&p, &row.roll) || !parseMarks(&p, &row.marks)) return replyf(client, "ERR bad request\n");
+        row.name = restOfLine(p);
+        row.nameLen = strlen(row.name);
+        if (row.nameLen == 0) return replyf(client, "ERR bad request\n");
+        addStudents(list, &row, 1, &result);
+        if (result == ROW_DUPLICATE) return replyf(client, "ERR duplicate\n");
+        return replyf(client, result == ROW_OK ? "OK\n" : "ERR no memory\n");
+    }
+    if (strcmp(line, "MOD") == 0) {
+        StudentUpdate update;
+        RowResult result;
+        if (!parseRoll(&p, &update.roll)) return replyf(client, "ERR bad request\n");
+        while (*p == ' ') p++;
+        if (*p == '-' && (p[1] == ' ' || p[1] == '\0')) {
+            update.newMarks = -1; // Keep
+            p++;
+        } else if (!parseMarks(&p, &update.newMarks)) {
+            return replyf(client, "ERR bad request\n");
+        }
+        update.newName = restOfLine(p); // "" keeps the name
+        modifyStudents(list, &update, 1, &result);
+        if (result == ROW_NOT_FOUND) return replyf(client, "ERR not found\n");
+        return replyf(client, result == ROW_OK ? "OK\n" : "ERR no memory\n");
+    }
+    if (strcmp(line, "DEL") == 0) {
+        int roll;
+        RowResult result;
+        if (!parseRoll(&p, &roll)) return replyf(client, "ERR bad request\n");
+        removeStudents(list, &roll, 1, &result);
+        if (result == ROW_NOT_FOUND) return replyf(client, "ERR not found\n");
+        return replyf(client, result == ROW_OK ? "OK\n" : "ERR no memory\n");
+    }
+    if (strcmp(line, "FIND") == 0) {
+        int rows[FIND_LIMIT];
+        if (*p == '\0') return replyf(client, "ERR bad request\n");
+        int n = searchByName(list, p, NAME_MATCH_SUBSTRING, 0, rows, FIND_LIMIT);
+        if (!replyf(client, "OK %d", n)) return 0;
+        for (int i = 0; i < n; i++) {
+            if (!replyf(client, " %d", studentRoll(list, rows[i]))) return 0;
+        }
+        return replyf(client, "\n");
+    }
+    if (strcmp(line, "STATS") == 0) {
+        ClassStats stats;
+        if (!getClassStats(list, &stats)) return replyf(client, "OK 0 0 0 0 0 0 0\n");
+        return replyf(client, "OK %d %.4f %.4f %.2f %.2f %d %d\n", stats.count, stats.average, stats.stddev,
+                      stats.min, stats.max, stats.passCount, stats.failCount);
+    }
+    if (strcmp(line, "SORT") == 0) {
+        SortKey keys[MAX_SORT_KEYS];
+        int count = parseSortKeys(p, keys);
+        if (count == 0) return replyf(client, "ERR bad request\n");
+        return replyf(client, sortStudentsBy(list, keys, count) ? "OK\n" : "ERR no memory\n");
+    }
+    if (strcmp(line, "SAVE") == 0) {
+        int ok = list->journal ? journalCheckpoint(list->journal, list) // Finishes in the background
+                               : saveToFile(list, FILENAME) && saveSnapshot(list, SNAPSHOT_FILENAME);
+        return replyf(client, ok ? "OK\n" : "ERR save failed\n");
+    }
+    if (strcmp(line, "QUIT") == 0) {
+        client->closing = 1;
+        return replyf(client, "OK\n");
+    }
+    return replyf(client, "ERR unknown command\n");
+}
+
+// Answers every complete line buffered so far, unless the replies back up.
+static void handleInput(Server *server, Client *client) {
+    Buffer *in = &client->in;
+    while (!client->closing && client->out.len - client->out.start < OUT_HIGH_WATER) {
+        char *begin = in->data + in->start;
+        char *eol = memchr(begin, '\n', in->len - in->start);
+        if (eol == NULL) {
+            if (in->len - in->start > MAX_LINE) {
+                replyf(client, "ERR line too long\n");
+                client->closing = 1;
+            }
+            break;
+        }
+        in->start = (size_t)(eol + 1 - in->data);
+        if (eol > begin && eol[-1] == '\r') eol--;
+        *eol = '\0';
+        if (begin == eol) continue; // Blank line
+        if (!handleRequest(server, client, begin)) {
+            client->closing = 1; // Can't even say why: just hang up
+            break;
+        }
+    }
+    if (in->start == in->len) {
+        in->start = in->len = 0;
+    }
+}
+
+// --- Connections ---
+
+static size_t pendingReplies(const Client *client) {
+    return client->out.len - client->out.start;
+}
+
+static int wantsInput(const Client *client) {
+    return !client->closing && pendingReplies(client) < OUT_HIGH_WATER;
+}
+
+static int hasCompleteLine(const Client *client) {
+    const Buffer *in = &client->in;
+    return memchr(in->data + in->start, '\n', in->len - in->start) != NULL;
+}
+
+static void closeClient(Server *server, Client *client) {
+    epoll_ctl(server->epfd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    free(client->in.data);
+    free(client->out.data);
+    free(client);
+}
+
+// Watch for input only while replies aren't backing up, and for
+// writability only while some are waiting.
+static void updateInterest(Server *server, Client *client) {
+    unsigned events = (wantsInput(client) ? EPOLLIN : 0) | (pendingReplies(client) ? EPOLLOUT : 0);
+    if (events == client->events) return;
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = client;
+    epoll_ctl(server->epfd, EPOLL_CTL_MOD, client->fd, &ev);
+    client->events = events;
+}
+
+// Writes as much of the pending replies as the socket takes. Returns 0 if
+// the client is gone.
+static int flushClient(Client *client) {
+    Buffer *out = &client->out;
+    while (out->start < out->len) {
+        ssize_t n = write(client->fd, out->data + out->start, out->len - out->start);
+        if (n > 0) {
+            out->start += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK); // Full for now, or gone
+        }
+    }
+    out->start = out->len = 0;
+    return 1;
+}
+
+// Reads whatever has arrived, answering as it goes so the input buffer
+// stays small under pipelining.
+static void readRequests(Server *server, Client *client) {
+    while (wantsInput(client)) {
+        if (!bufferReserve(&client->in, READ_CHUNK)) {
+            client->closing = 1;
+            return;
+        }
+        ssize_t n = read(client->fd, client->in.data + client->in.len, READ_CHUNK);
+        if (n > 0) {
+            client->in.len += (size_t)n;
+            handleInput(server, client);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) client->closing = 1; // Hung up
+            return;
+        }
+    }
+}
+
+static void acceptClients(Server *server, int listener) {
+    for (;;) {
+        int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return; // EAGAIN: accepted everyone waiting
+        }
+        Client *client = calloc(1, sizeof(Client));
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = client;
+        if (client == NULL || epoll_ctl(server->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            free(client);
+            close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->events = EPOLLIN;
+    }
+}
+
+// Reads, answers and writes back for one ready client.
+static void serviceClient(Server *server, Client *client, unsigned events) {
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        readRequests(server, client);
+    }
+    for (;;) {
+        handleInput(server, client); // Also picks up requests held back by a full socket
+        if (!flushClient(client)) {
+            closeClient(server, client);
+            return;
+        }
+        if (pendingReplies(client) > 0 || client->closing || !hasCompleteLine(client)) break;
+    }
+    if (client->closing && pendingReplies(client) == 0) {
+        closeClient(server, client);
+        return;
+    }
+    updateInterest(server, client);
+}
+
+static int openListener(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path); // A stale socket from an earlier run
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        perror(path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char *argv[]) {
+    const char *socketPath = DEFAULT_SOCKET;
+    int memoryOnly = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:m")) != -1) {
+        if (opt == 's') socketPath = optarg;
+        else if (opt == 'm') memoryOnly = 1;
+        else {
+            fprintf(stderr, "Usage: %s [-s socket] [-m]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    StudentList list;
+    initListLayout(&list, LAYOUT_COLUMNS);
+    Journal journal;
+    int journaled = 0;
+    if (!memoryOnly) {
+        journaled = journalOpen(&journal, &list, SNAPSHOT_FILENAME, FILENAME, JOURNAL_PREFIX);
+        if (!journaled && journal.badSnapshot) {
+            fprintf(stderr, "Error: %s is damaged and %s cannot stand in for it; not serving.\n", SNAPSHOT_FILENAME, FILENAME);
+            journalClose(&journal);
+            freeList(&list);
+            return EXIT_FAILURE;
+        }
+        if (!journaled) fprintf(stderr, "Warning: could not open the journal; changes will not survive a crash.\n");
+        if (journal.fromCsv) fprintf(stderr, "Warning: %s was damaged; rebuilt from %s and %d journaled changes.\n",
+                                     SNAPSHOT_FILENAME, FILENAME, journal.replayed);
+    }
+    enableNameIndex(&list);
+
+    Server server;
+    server.list = &list;
+    server.epfd = epoll_create1(EPOLL_CLOEXEC);
+    int listener = openListener(socketPath);
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // The listener
+    if (server.epfd < 0 || listener < 0 || epoll_ctl(server.epfd, EPOLL_CTL_ADD, listener, &ev) != 0) {
+        if (journaled) journalClose(&journal);
+        freeList(&list);
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN); // A client that hangs up mid-reply is just closed
+    printf("Serving %d records on %s\n", list.count, socketPath);
+    fflush(stdout);
+
+    struct epoll_event events[MAX_EVENTS];
+    while (!stopRequested) {
+        int n = epoll_wait(server.epfd, events, MAX_EVENTS, -1);
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == NULL) acceptClients(&server, listener);
+            else serviceClient(&server, events[i].data.ptr, events[i].events);
+        }
+    }
+
+    // Open connections are dropped; only the records matter
+    close(listener);
+    close(server.epfd);
+    unlink(socketPath);
+    if (journaled) journalClose(&journal); // Waits for a background save
+    freeList(&list);
+    return 0;
+}
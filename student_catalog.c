@@ -0,0 +1,539 @@
+#include "student_catalog.h"
+#include "student_pool.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define makeDirectory(path) _mkdir(path)
+#else
+#define makeDirectory(path) mkdir(path, 0777)
+#endif
+
+#define MANIFEST_LINE 256
+
+// --- Helpers ---
+
+static int validName(const char *name) {
+    size_t len = strlen(name);
+    if (len == 0 || len >= CATALOG_NAME_LEN || name[0] == '.') return 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+              || c == '_' || c == '-' || c == '.')) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void shardPath(const StudentCatalog *catalog, const CatalogShard *shard, char *path, size_t size) {
+    snprintf(path, size, "%s/%s", catalog->dir, shard->file);
+}
+
+static int fileExists(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+static int isSnapshotFile(const char *file) {
+    size_t len = strlen(file);
+    return len >= 5 && strcmp(file + len - 5, ".snap") == 0;
+}
+
+static int lowerAscii(int c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+// --- Shards ---
+
+static void freeShard(CatalogShard *shard) {
+    freeList(&shard->list);
+    free(shard);
+}
+
+static void freeDataset(CatalogDataset *dataset) {
+    for (int s = 0; s < dataset->shardCount; s++) freeShard(dataset->shards[s]);
+    free(dataset->shards);
+    free(dataset);
+}
+
+// First shard whose range ends at or after roll
+static int shardAtOrAfter(const CatalogDataset *dataset, int roll) {
+    int lo = 0, hi = dataset->shardCount;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (dataset->shards[mid]->rollMax < roll) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static CatalogShard *shardFor(const CatalogDataset *dataset, int roll) {
+    int s = shardAtOrAfter(dataset, roll);
+    if (s == dataset->shardCount || dataset->shards[s]->rollMin > roll) return NULL;
+    return dataset->shards[s];
+}
+
+// Inserts a shard in roll order; the caller has checked it overlaps none.
+static CatalogShard *insertShard(CatalogDataset *dataset, int rollMin, int rollMax, int rows, const char *file) {
+    if (dataset->shardCount == dataset->shardCapacity) {
+        int capacity = dataset->shardCapacity == 0 ? 4 : dataset->shardCapacity * 2;
+        CatalogShard **grown = realloc(dataset->shards, (size_t)capacity * sizeof(*grown));
+        if (grown == NULL) return NULL;
+        dataset->shards = grown;
+        dataset->shardCapacity = capacity;
+    }
+    CatalogShard *shard = calloc(1, sizeof(*shard));
+    if (shard == NULL) return NULL;
+    shard->rollMin = rollMin;
+    shard->rollMax = rollMax;
+    shard->rows = rows;
+    snprintf(shard->file, sizeof(shard->file), "%s", file);
+    initListLayout(&shard->list, LAYOUT_COLUMNS);
+
+    int at = shardAtOrAfter(dataset, rollMin);
+    memmove(dataset->shards + at + 1, dataset->shards + at, (size_t)(dataset->shardCount - at) * sizeof(*dataset->shards));
+    dataset->shards[at] = shard;
+    dataset->shardCount++;
+    return shard;
+}
+
+// A new, empty shard for the block of shardWidth rolls holding roll
+static CatalogShard *newShard(StudentCatalog *catalog, CatalogDataset *dataset, int roll) {
+    long long width = dataset->shardWidth > 0 ? dataset->shardWidth : 1LL << 32;
+    long long block = roll >= 0 ? roll / width : -((-(long long)roll + width - 1) / width);
+    long long rollMin = dataset->shardWidth > 0 ? block * width : INT_MIN;
+    long long rollMax = dataset->shardWidth > 0 ? rollMin + width - 1 : INT_MAX;
+    char file[sizeof(((CatalogShard *)0)->file)];
+    const char *extension = dataset->snapshots ? "snap" : "csv";
+    if (dataset->shardWidth > 0) {
+        snprintf(file, sizeof(file), "%s.%lld.%s", dataset->name, block, extension);
+    } else {
+        snprintf(file, sizeof(file), "%s.%s", dataset->name, extension);
+    }
+    CatalogShard *shard = insertShard(dataset, (int)(rollMin < INT_MIN ? INT_MIN : rollMin),
+                                      (int)(rollMax > INT_MAX ? INT_MAX : rollMax), 0, file);
+    if (shard == NULL) return NULL;
+    shard->loaded = 1; // Nothing on disk yet
+    shard->dirty = 1;
+    catalog->manifestDirty = 1;
+    return shard;
+}
+
+static int loadShard(const StudentCatalog *catalog, CatalogShard *shard) {
+    if (shard->loaded) return 1;
+    char path[1024];
+    shardPath(catalog, shard, path, sizeof(path));
+    int ok;
+    if (shard->rows == 0 && !fileExists(path)) {
+        ok = 1; // Created but never saved
+    } else if (isSnapshotFile(shard->file)) {
+        ok = openSnapshot(&shard->list, path, 0);
+    } else {
+        ok = loadFromFile(&shard->list, path);
+    }
+    if (!ok) return 0;
+    shard->loaded = 1;
+    shard->rows = shard->list.count;
+    return 1;
+}
+
+static int saveShard(const StudentCatalog *catalog, CatalogShard *shard) {
+    char path[1024];
+    shardPath(catalog, shard, path, sizeof(path));
+    if (!(isSnapshotFile(shard->file) ? saveSnapshot(&shard->list, path) : saveToFile(&shard->list, path))) return 0;
+    shard->dirty = 0;
+    shard->rows = shard->list.count;
+    return 1;
+}
+
+// Loading or saving a set of shards, one task per shard
+typedef struct {
+    const StudentCatalog *catalog;
+    CatalogShard **shards;
+    int (*run)(const StudentCatalog *catalog, CatalogShard *shard);
+    atomic_int failed;
+} ShardJob;
+
+static void shardTask(void *ctx, long long begin, long long end) {
+    ShardJob *job = ctx;
+    for (long long i = begin; i < end; i++) {
+        if (!job->run(job->catalog, job->shards[i])) atomic_store(&job->failed, 1);
+    }
+}
+
+// Runs run over the shards that want it, in parallel. 0 if any failed.
+static int runShards(const StudentCatalog *catalog, CatalogShard **shards, int count,
+                     int (*run)(const StudentCatalog *, CatalogShard *)) {
+    ShardJob job = { catalog, shards, run, 0 };
+    parallelFor(count, 1, shardTask, &job);
+    return !atomic_load(&job.failed);
+}
+
+// --- Manifest ---
+// One line per dataset, followed by one per shard:
+//   dataset <name> <shard width> <csv|snap>
+//   shard <roll min> <roll max> <rows> <file>
+
+static int writeManifest(StudentCatalog *catalog) {
+    char path[1024], tmpPath[1040];
+    snprintf(path, sizeof(path), "%s/%s", catalog->dir, CATALOG_MANIFEST);
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE *fp = fopen(tmpPath, "w");
+    if (fp == NULL) return 0;
+    int ok = fprintf(fp, "# Student catalog\n") > 0;
+    for (int d = 0; d < catalog->datasetCount && ok; d++) {
+        const CatalogDataset *dataset = catalog->datasets[d];
+        ok = fprintf(fp, "dataset %s %d %s\n", dataset->name, dataset->shardWidth,
+                     dataset->snapshots ? "snap" : "csv") > 0;
+        for (int s = 0; s < dataset->shardCount && ok; s++) {
+            const CatalogShard *shard = dataset->shards[s];
+            ok = fprintf(fp, "shard %d %d %d %s\n", shard->rollMin, shard->rollMax, shard->rows, shard->file) > 0;
+        }
+    }
+    ok = ok && flushToDisk(fp);
+    ok = (fclose(fp) == 0) && ok;
+    ok = ok && rename(tmpPath, path) == 0;
+    if (!ok) remove(tmpPath);
+    if (ok) catalog->manifestDirty = 0;
+    return ok;
+}
+
+static int addDataset(StudentCatalog *catalog, CatalogDataset *dataset) {
+    if (catalog->datasetCount == catalog->datasetCapacity) {
+        int capacity = catalog->datasetCapacity == 0 ? 8 : catalog->datasetCapacity * 2;
+        CatalogDataset **grown = realloc(catalog->datasets, (size_t)capacity * sizeof(*grown));
+        if (grown == NULL) return 0;
+        catalog->datasets = grown;
+        catalog->datasetCapacity = capacity;
+    }
+    int at = catalog->datasetCount;
+    while (at > 0 && strcmp(catalog->datasets[at - 1]->name, dataset->name) > 0) at--;
+    memmove(catalog->datasets + at + 1, catalog->datasets + at,
+            (size_t)(catalog->datasetCount - at) * sizeof(*catalog->datasets));
+    catalog->datasets[at] = dataset;
+    catalog->datasetCount++;
+    return 1;
+}
+
+static int readManifest(StudentCatalog *catalog, FILE *fp) {
+    char line[MANIFEST_LINE];
+    CatalogDataset *dataset = NULL;
+    while (fgets(line, sizeof(line), fp)) {
+        char name[CATALOG_NAME_LEN], kind[8], file[sizeof(((CatalogShard *)0)->file)];
+        int width, rollMin, rollMax, rows;
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "dataset %63s %d %7s", name, &width, kind) == 3) {
+            if (!validName(name) || width < 0 || catalogDataset(catalog, name) != NULL) return 0;
+            dataset = calloc(1, sizeof(*dataset));
+            if (dataset == NULL) return 0;
+            snprintf(dataset->name, sizeof(dataset->name), "%s", name);
+            dataset->shardWidth = width;
+            dataset->snapshots = strcmp(kind, "snap") == 0;
+            if (!addDataset(catalog, dataset)) {
+                freeDataset(dataset);
+                return 0;
+            }
+        } else if (sscanf(line, "shard %d %d %d %95s", &rollMin, &rollMax, &rows, file) == 4) {
+            if (dataset == NULL || rollMin > rollMax || rows < 0 || strchr(file, '/') != NULL) return 0;
+            // Ranges must not overlap an earlier shard
+            int at = shardAtOrAfter(dataset, rollMin);
+            if (at < dataset->shardCount && dataset->shards[at]->rollMin <= rollMax) return 0;
+            if (insertShard(dataset, rollMin, rollMax, rows, file) == NULL) return 0;
+        } else {
+            return 0; // Malformed
+        }
+    }
+    return 1;
+}
+
+// --- Public ---
+
+int catalogOpen(StudentCatalog *catalog, const char *dir) {
+    memset(catalog, 0, sizeof(*catalog));
+    snprintf(catalog->dir, sizeof(catalog->dir), "%s", dir);
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", dir, CATALOG_MANIFEST);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        // A new catalog: just make sure the directory is there
+        makeDirectory(dir);
+        return fileExists(dir);
+    }
+    int ok = readManifest(catalog, fp);
+    fclose(fp);
+    if (!ok) catalogClose(catalog);
+    return ok;
+}
+
+void catalogClose(StudentCatalog *catalog) {
+    for (int d = 0; d < catalog->datasetCount; d++) freeDataset(catalog->datasets[d]);
+    free(catalog->datasets);
+    catalog->datasets = NULL;
+    catalog->datasetCount = catalog->datasetCapacity = 0;
+}
+
+int catalogSave(StudentCatalog *catalog) {
+    int dirty = 0;
+    for (int d = 0; d < catalog->datasetCount; d++) {
+        for (int s = 0; s < catalog->datasets[d]->shardCount; s++) dirty += catalog->datasets[d]->shards[s]->dirty;
+    }
+    CatalogShard **shards = malloc((size_t)dirty * sizeof(*shards) + 1);
+    if (shards == NULL) return 0;
+    int count = 0;
+    for (int d = 0; d < catalog->datasetCount; d++) {
+        for (int s = 0; s < catalog->datasets[d]->shardCount; s++) {
+            if (catalog->datasets[d]->shards[s]->dirty) shards[count++] = catalog->datasets[d]->shards[s];
+        }
+    }
+    int ok = runShards(catalog, shards, count, saveShard);
+    free(shards);
+    // Row counts changed with the shards; the manifest is written even if
+    // a shard failed, so the ones that did save are recorded
+    if (count > 0 || catalog->manifestDirty) ok = writeManifest(catalog) && ok;
+    return ok;
+}
+
+CatalogDataset *catalogDataset(StudentCatalog *catalog, const char *name) {
+    int lo = 0, hi = catalog->datasetCount;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(catalog->datasets[mid]->name, name);
+        if (cmp == 0) return catalog->datasets[mid];
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return NULL;
+}
+
+CatalogDataset *catalogCreateDataset(StudentCatalog *catalog, const char *name, int shardWidth, int snapshots) {
+    if (!validName(name) || shardWidth < 0 || catalogDataset(catalog, name) != NULL) return NULL;
+    CatalogDataset *dataset = calloc(1, sizeof(*dataset));
+    if (dataset == NULL) return NULL;
+    snprintf(dataset->name, sizeof(dataset->name), "%s", name);
+    dataset->shardWidth = shardWidth;
+    dataset->snapshots = snapshots;
+    if ((shardWidth == 0 && newShard(catalog, dataset, 0) == NULL) || !addDataset(catalog, dataset)) {
+        freeDataset(dataset);
+        return NULL;
+    }
+    catalog->manifestDirty = 1;
+    return dataset;
+}
+
+int catalogDropDataset(StudentCatalog *catalog, const char *name) {
+    CatalogDataset *dataset = catalogDataset(catalog, name);
+    if (dataset == NULL) return 0;
+    int at = 0;
+    while (catalog->datasets[at] != dataset) at++;
+    memmove(catalog->datasets + at, catalog->datasets + at + 1,
+            (size_t)(catalog->datasetCount - at - 1) * sizeof(*catalog->datasets));
+    catalog->datasetCount--;
+    // Forget it first: a crash in between leaves stray files, not a
+    // manifest naming files that are gone
+    int ok = writeManifest(catalog);
+    if (ok) {
+        for (int s = 0; s < dataset->shardCount; s++) {
+            char path[1024];
+            shardPath(catalog, dataset->shards[s], path, sizeof(path));
+            remove(path);
+        }
+    }
+    freeDataset(dataset);
+    return ok;
+}
+
+int catalogCount(const CatalogDataset *dataset) {
+    int total = 0;
+    for (int s = 0; s < dataset->shardCount; s++) {
+        const CatalogShard *shard = dataset->shards[s];
+        total += shard->loaded ? shard->list.count : shard->rows;
+    }
+    return total;
+}
+
+int catalogLoadDataset(StudentCatalog *catalog, CatalogDataset *dataset) {
+    CatalogShard **shards = malloc((size_t)dataset->shardCount * sizeof(*shards) + 1);
+    if (shards == NULL) return 0;
+    int count = 0;
+    for (int s = 0; s < dataset->shardCount; s++) {
+        if (!dataset->shards[s]->loaded) shards[count++] = dataset->shards[s];
+    }
+    int ok = runShards(catalog, shards, count, loadShard);
+    free(shards);
+    return ok;
+}
+
+void catalogEvictDataset(CatalogDataset *dataset) {
+    for (int s = 0; s < dataset->shardCount; s++) {
+        CatalogShard *shard = dataset->shards[s];
+        if (!shard->loaded || shard->dirty) continue;
+        shard->rows = shard->list.count;
+        freeList(&shard->list);
+        shard->loaded = 0;
+    }
+}
+
+StudentList *catalogShardList(StudentCatalog *catalog, CatalogDataset *dataset, int roll) {
+    CatalogShard *shard = shardFor(dataset, roll);
+    return shard != NULL && loadShard(catalog, shard) ? &shard->list : NULL;
+}
+
+int catalogAddStudent(StudentCatalog *catalog, CatalogDataset *dataset, const char *name, int roll, float marks) {
+    CatalogShard *shard = shardFor(dataset, roll);
+    if (shard == NULL) shard = newShard(catalog, dataset, roll);
+    if (shard == NULL || !loadShard(catalog, shard)) return 0;
+    if (!addStudent(&shard->list, name, roll, marks)) return 0; // Duplicate roll (or out of memory)
+    shard->dirty = 1;
+    return 1;
+}
+
+int catalogRemoveStudent(StudentCatalog *catalog, CatalogDataset *dataset, int roll) {
+    CatalogShard *shard = shardFor(dataset, roll);
+    if (shard == NULL || !loadShard(catalog, shard) || !removeStudent(&shard->list, roll)) return 0;
+    shard->dirty = 1;
+    return 1;
+}
+
+int catalogModifyStudent(StudentCatalog *catalog, CatalogDataset *dataset, int roll, const char *newName, float newMarks) {
+    CatalogShard *shard = shardFor(dataset, roll);
+    if (shard == NULL || !loadShard(catalog, shard) || !modifyStudent(&shard->list, roll, newName, newMarks)) return 0;
+    shard->dirty = 1;
+    return 1;
+}
+
+int catalogSearchStudent(StudentCatalog *catalog, CatalogDataset *dataset, int roll, CatalogRow *out) {
+    StudentList *list = catalogShardList(catalog, dataset, roll);
+    int row = list != NULL ? searchStudent(list, roll) : -1;
+    if (row == -1) return 0;
+    out->list = list;
+    out->row = row;
+    return 1;
+}
+
+// --- Scatter-Gather ---
+
+int catalogStats(StudentCatalog *catalog, CatalogDataset *dataset, ClassStats *out) {
+    memset(out, 0, sizeof(*out));
+    ClassStats *parts = malloc((size_t)dataset->shardCount * sizeof(ClassStats) + 1);
+    if (parts == NULL || !catalogLoadDataset(catalog, dataset)) {
+        free(parts);
+        return 0;
+    }
+    double sum = 0;
+    for (int s = 0; s < dataset->shardCount; s++) {
+        const ClassStats *part = &parts[s];
+        if (!getClassStats(&dataset->shards[s]->list, &parts[s])) continue; // Empty: count stays 0
+        if (out->count == 0 || part->min < out->min) out->min = part->min;
+        if (out->count == 0 || part->max > out->max) out->max = part->max;
+        out->count += part->count;
+        out->passCount += part->passCount;
+        out->failCount += part->failCount;
+        for (int b = 0; b < GRADE_BANDS; b++) out->bands[b] += part->bands[b];
+        sum += part->average * part->count;
+    }
+    if (out->count > 0) {
+        // Pooled variance: each shard's own spread plus its mean's distance
+        // from the overall mean
+        out->average = sum / out->count;
+        double spread = 0;
+        for (int s = 0; s < dataset->shardCount; s++) {
+            double offset = parts[s].average - out->average;
+            spread += parts[s].count * (parts[s].stddev * parts[s].stddev + offset * offset);
+        }
+        out->stddev = sqrt(spread / out->count);
+    }
+    free(parts);
+    return out->count > 0;
+}
+
+typedef struct {
+    CatalogShard **shards;
+    const char *query;
+    NameMatch mode;
+    int caseSensitive;
+    int limit;
+    int *rows;      // limit per shard
+    int *found;     // Per shard
+} NameJob;
+
+static void nameTask(void *ctx, long long begin, long long end) {
+    NameJob *job = ctx;
+    for (long long s = begin; s < end; s++) {
+        job->found[s] = searchByName(&job->shards[s]->list, job->query, job->mode, job->caseSensitive,
+                                     job->rows + s * job->limit, job->limit);
+    }
+}
+
+// searchByName's order: name ignoring ASCII case, then roll
+static int compareNameRows(const void *a, const void *b) {
+    const CatalogRow *x = a, *y = b;
+    const char *p = studentName(x->list, x->row), *q = studentName(y->list, y->row);
+    for (; *p && lowerAscii(*p) == lowerAscii(*q); p++, q++) {}
+    int diff = (unsigned char)lowerAscii(*p) - (unsigned char)lowerAscii(*q);
+    if (diff != 0) return diff;
+    int r = studentRoll(x->list, x->row), t = studentRoll(y->list, y->row);
+    return (r > t) - (r < t);
+}
+
+int catalogSearchByName(StudentCatalog *catalog, CatalogDataset *dataset, const char *query, NameMatch mode,
+                        int caseSensitive, CatalogRow *rows, int limit) {
+    if (limit <= 0) return 0;
+    if (!catalogLoadDataset(catalog, dataset)) return -1;
+    int shards = dataset->shardCount;
+    NameJob job = { dataset->shards, query, mode, caseSensitive, limit,
+                    malloc((size_t)shards * (size_t)limit * sizeof(int) + 1), malloc((size_t)shards * sizeof(int) + 1) };
+    CatalogRow *hits = malloc((size_t)shards * (size_t)limit * sizeof(CatalogRow) + 1);
+    if (job.rows == NULL || job.found == NULL || hits == NULL) {
+        free(job.rows);
+        free(job.found);
+        free(hits);
+        return -1;
+    }
+    parallelFor(shards, 1, nameTask, &job);
+
+    int total = 0;
+    for (int s = 0; s < shards; s++) {
+        for (int i = 0; i < job.found[s]; i++) {
+            hits[total].list = &dataset->shards[s]->list;
+            hits[total].row = job.rows[(size_t)s * (size_t)limit + (size_t)i];
+            total++;
+        }
+    }
+    qsort(hits, (size_t)total, sizeof(CatalogRow), compareNameRows);
+    if (total > limit) total = limit;
+    memcpy(rows, hits, (size_t)total * sizeof(CatalogRow));
+    free(job.rows);
+    free(job.found);
+    free(hits);
+    return total;
+}
+
+int catalogRollRange(StudentCatalog *catalog, CatalogDataset *dataset, int from, int to,
+                     CatalogRow *rows, int limit) {
+    int *shardRows = malloc((size_t)(limit > 0 ? limit : 0) * sizeof(int) + 1);
+    if (shardRows == NULL) return -1;
+    int found = 0;
+    // Shards never overlap, so their ranges concatenate in roll order
+    for (int s = shardAtOrAfter(dataset, from); s < dataset->shardCount && found < limit; s++) {
+        CatalogShard *shard = dataset->shards[s];
+        if (shard->rollMin > to) break;
+        int n = loadShard(catalog, shard) ? rollRange(&shard->list, from, to, shardRows, limit - found) : -1;
+        if (n < 0) {
+            found = -1;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            rows[found + i].list = &shard->list;
+            rows[found + i].row = shardRows[i];
+        }
+        found += n;
+    }
+    free(shardRows);
+    return found;
+}
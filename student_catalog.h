@@ -0,0 +1,82 @@
+#ifndef STUDENT_CATALOG_H
+#define STUDENT_CATALOG_H
+
+#include "student_logic.h"
+
+// Many named datasets (one per cohort, say) kept in one directory.
+//
+// A dataset is stored as one file, or sharded by roll range: with a shard
+// width w, the rolls [k*w, (k+1)*w - 1] go in a file of their own, created
+// when the first of them is added. The manifest (CATALOG_MANIFEST in the
+// directory) lists every dataset and shard with its roll range and row
+// count, so catalogOpen reads that one file and nothing else, however many
+// shards there are. A shard is loaded the first time a call needs it:
+// calls on one roll route to its shard alone, and calls over a whole
+// dataset (catalogLoadDataset, catalogStats, catalogSearchByName) load the
+// missing shards in parallel on the worker pool and gather the results.
+// catalogSave writes the changed shards in parallel, then the manifest.
+//
+// Shard files ending in .snap are binary snapshots, the rest CSV. Like a
+// StudentList, a catalog is for one thread at a time.
+
+#define CATALOG_MANIFEST "catalog.txt"
+#define CATALOG_NAME_LEN 64   // Dataset names: letters, digits, '_', '-' and '.'
+
+typedef struct {
+    int rollMin, rollMax;   // Inclusive
+    int rows;               // In the file, as of the last load or save
+    char file[CATALOG_NAME_LEN + 32]; // Relative to the catalog directory
+    int loaded;             // list holds the file's records
+    int dirty;              // Changed since it was loaded or saved
+    StudentList list;
+} CatalogShard;
+
+typedef struct {
+    char name[CATALOG_NAME_LEN];
+    int shardWidth;         // 0 = not sharded: one shard holds every roll
+    int snapshots;          // Shards are .snap files rather than CSV
+    CatalogShard **shards;  // By roll range, never overlapping
+    int shardCount, shardCapacity;
+} CatalogDataset;
+
+typedef struct {
+    char dir[512];
+    CatalogDataset **datasets; // By name
+    int datasetCount, datasetCapacity;
+    int manifestDirty;
+} StudentCatalog;
+
+// A row found by a catalog query. Valid until the shard's list changes.
+typedef struct {
+    StudentList *list;
+    int row;
+} CatalogRow;
+
+// Opens (or, with no manifest yet, starts) the catalog in dir. Opens no shard.
+int catalogOpen(StudentCatalog *catalog, const char *dir);
+int catalogSave(StudentCatalog *catalog);   // Changed shards (in parallel), then the manifest
+void catalogClose(StudentCatalog *catalog); // Unsaved changes are lost
+
+// Datasets
+CatalogDataset *catalogDataset(StudentCatalog *catalog, const char *name); // NULL if there is none
+CatalogDataset *catalogCreateDataset(StudentCatalog *catalog, const char *name, int shardWidth, int snapshots); // NULL if the name is taken or invalid
+int catalogDropDataset(StudentCatalog *catalog, const char *name); // Rewrites the manifest, then deletes its files
+int catalogCount(const CatalogDataset *dataset); // Rows in all shards, without loading any
+int catalogLoadDataset(StudentCatalog *catalog, CatalogDataset *dataset); // Every shard not yet loaded, in parallel
+void catalogEvictDataset(CatalogDataset *dataset); // Unloads the shards with no unsaved changes
+
+// Records: routed to the shard that holds roll, loading it if needed
+int catalogAddStudent(StudentCatalog *catalog, CatalogDataset *dataset, const char *name, int roll, float marks);
+int catalogRemoveStudent(StudentCatalog *catalog, CatalogDataset *dataset, int roll);
+int catalogModifyStudent(StudentCatalog *catalog, CatalogDataset *dataset, int roll, const char *newName, float newMarks);
+int catalogSearchStudent(StudentCatalog *catalog, CatalogDataset *dataset, int roll, CatalogRow *out); // 0 if not found
+StudentList *catalogShardList(StudentCatalog *catalog, CatalogDataset *dataset, int roll); // NULL if no shard holds roll (or it can't be loaded)
+
+// Across shards
+int catalogStats(StudentCatalog *catalog, CatalogDataset *dataset, ClassStats *out); // 0 if empty or a shard can't be loaded
+int catalogSearchByName(StudentCatalog *catalog, CatalogDataset *dataset, const char *query, NameMatch mode,
+                        int caseSensitive, CatalogRow *rows, int limit); // As searchByName; -1 if a shard can't be loaded
+int catalogRollRange(StudentCatalog *catalog, CatalogDataset *dataset, int from, int to,
+                     CatalogRow *rows, int limit); // Ascending by roll, from the overlapping shards only; -1 on failure
+
+#endif // STUDENT_CATALOG_H
@@ -0,0 +1,267 @@
+#include "student_logic.h"
+#include <stdlib.h>
+#include <string.h>
+
+// --- Change Feed ---
+// The pending batch is kept against the list as it was at the last
+// delivery (the baseline): removed[] and changed[] hold baseline rows, and
+// the rows past the baseline's survivors are the appended ones. A current
+// row maps back to the baseline by counting the removed rows below it
+// (binary search), so noting a change never renumbers what is already
+// noted. Delivery turns changed[] into current rows in one merge pass.
+
+#define CHANGE_LIMIT_FLOOR 1024 // Past 1024 + baseline/8 listed rows, a reset is cheaper for everyone
+
+typedef struct {
+    int id;
+    ChangeListener listener; // NULL once unsubscribed
+    void *ctx;
+} ChangeSubscriber;
+
+struct ChangeFeed {
+    ChangeSubscriber *subscribers;
+    int subscriberCount, subscriberCapacity;
+    int nextId;
+    int delivering;
+    ChangeWake wake;
+    void *wakeCtx;
+    StudentList *list;
+
+    int pending;            // Something was noted since the last delivery
+    int reset;
+    int baseCount;          // list->count at the last delivery
+    int *removed;           // Baseline rows, ascending
+    int removedCount, removedCapacity;
+    int *changed;           // Baseline rows, any order, maybe repeated
+    int changedCount, changedCapacity;
+    int appended;
+};
+
+static void notePending(struct ChangeFeed *feed) {
+    if (feed->pending) return;
+    feed->pending = 1;
+    if (feed->wake) feed->wake(feed->list, feed->wakeCtx);
+}
+
+void changeFeedReset(struct ChangeFeed *feed) {
+    feed->reset = 1;
+    feed->removedCount = feed->changedCount = feed->appended = 0;
+    notePending(feed);
+}
+
+static int changeLimit(const struct ChangeFeed *feed) {
+    return CHANGE_LIMIT_FLOOR + feed->baseCount / 8;
+}
+
+static int currentCount(const struct ChangeFeed *feed) {
+    return feed->baseCount - feed->removedCount + feed->appended;
+}
+
+// Removed rows below baseline row i + k, for current row i: the k with
+// removed[j] - j <= i for every j < k (removed[j] - j never decreases)
+static int removedBelow(const struct ChangeFeed *feed, int row) {
+    int lo = 0, hi = feed->removedCount;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (feed->removed[mid] - mid <= row) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int growInts(int **array, int *capacity, int needed) {
+    if (needed <= *capacity) return 1;
+    int grown = *capacity ? *capacity : 64;
+    while (grown < needed) grown *= 2;
+    int *resized = realloc(*array, (size_t)grown * sizeof(int));
+    if (resized == NULL) return 0;
+    *array = resized;
+    *capacity = grown;
+    return 1;
+}
+
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts changed[] and drops repeats; returns how many are left
+static int settleChanged(struct ChangeFeed *feed) {
+    if (feed->changedCount == 0) return 0;
+    qsort(feed->changed, (size_t)feed->changedCount, sizeof(int), compareInts);
+    int out = 0;
+    for (int i = 0; i < feed->changedCount; i++) {
+        if (out == 0 || feed->changed[out - 1] != feed->changed[i]) feed->changed[out++] = feed->changed[i];
+    }
+    feed->changedCount = out;
+    return out;
+}
+
+void changeFeedAdded(struct ChangeFeed *feed) {
+    if (!feed->reset) feed->appended++;
+    notePending(feed);
+}
+
+void changeFeedChanged(struct ChangeFeed *feed, int row) {
+    notePending(feed);
+    if (feed->reset || row >= currentCount(feed) - feed->appended) return; // New since the baseline anyway
+    if (feed->changedCount == feed->changedCapacity && feed->changedCount > 0) {
+        settleChanged(feed); // The same rows edited over and over
+    }
+    if (feed->removedCount + feed->changedCount >= changeLimit(feed) ||
+        !growInts(&feed->changed, &feed->changedCapacity, feed->changedCount + 1)) {
+        changeFeedReset(feed);
+        return;
+    }
+    feed->changed[feed->changedCount++] = row + removedBelow(feed, row);
+}
+
+void changeFeedRemoved(struct ChangeFeed *feed, int row) {
+    notePending(feed);
+    if (feed->reset) return;
+    if (row >= currentCount(feed) - feed->appended) {
+        feed->appended--;
+        return;
+    }
+    if (feed->removedCount + feed->changedCount >= changeLimit(feed) ||
+        !growInts(&feed->removed, &feed->removedCapacity, feed->removedCount + 1)) {
+        changeFeedReset(feed);
+        return;
+    }
+    int k = removedBelow(feed, row);
+    memmove(feed->removed + k + 1, feed->removed + k, (size_t)(feed->removedCount - k) * sizeof(int));
+    feed->removed[k] = row + k;
+    feed->removedCount++;
+}
+
+void changeFeedRemovedRows(struct ChangeFeed *feed, const unsigned char *doomed, int from, int to) {
+    notePending(feed);
+    if (feed->reset) return;
+    int firstAppended = currentCount(feed) - feed->appended;
+    int fresh = 0, appendedGone = 0;
+    for (int i = from; i < to; i++) {
+        if (!doomed[i]) continue;
+        if (i >= firstAppended) appendedGone++;
+        else fresh++;
+    }
+    int total = feed->removedCount + fresh;
+    int *merged = NULL, capacity = 0;
+    if (total + feed->changedCount > changeLimit(feed) || !growInts(&merged, &capacity, total + 1)) {
+        changeFeedReset(feed);
+        return;
+    }
+
+    // Map the doomed rows (ascending) to the baseline and merge them in
+    int k = 0, out = 0;
+    for (int i = from; i < to && i < firstAppended; i++) {
+        if (!doomed[i]) continue;
+        while (k < feed->removedCount && feed->removed[k] <= i + k) merged[out++] = feed->removed[k++];
+        merged[out++] = i + k;
+    }
+    while (k < feed->removedCount) merged[out++] = feed->removed[k++];
+    free(feed->removed);
+    feed->removed = merged;
+    feed->removedCount = out;
+    feed->removedCapacity = capacity;
+    feed->appended -= appendedGone;
+}
+
+static struct ChangeFeed *feedFor(StudentList *list) {
+    if (list->changes == NULL) {
+        list->changes = calloc(1, sizeof(struct ChangeFeed));
+        if (list->changes == NULL) return NULL;
+        list->changes->nextId = 1;
+        list->changes->baseCount = list->count;
+    }
+    list->changes->list = list; // The list may have been moved since (adoptList)
+    return list->changes;
+}
+
+int subscribeChanges(StudentList *list, ChangeListener listener, void *ctx) {
+    struct ChangeFeed *feed = feedFor(list);
+    if (feed == NULL) return 0;
+    if (feed->subscriberCount == feed->subscriberCapacity) {
+        int capacity = feed->subscriberCapacity ? feed->subscriberCapacity * 2 : 4;
+        ChangeSubscriber *grown = realloc(feed->subscribers, (size_t)capacity * sizeof(ChangeSubscriber));
+        if (grown == NULL) return 0;
+        feed->subscribers = grown;
+        feed->subscriberCapacity = capacity;
+    }
+    ChangeSubscriber *subscriber = &feed->subscribers[feed->subscriberCount++];
+    *subscriber = (ChangeSubscriber){ feed->nextId++, listener, ctx };
+    return subscriber->id;
+}
+
+void unsubscribeChanges(StudentList *list, int id) {
+    struct ChangeFeed *feed = list->changes;
+    if (feed == NULL) return;
+    for (int i = 0; i < feed->subscriberCount; i++) {
+        if (feed->subscribers[i].id == id) feed->subscribers[i].listener = NULL; // Dropped after any delivery
+    }
+}
+
+void setChangeWake(StudentList *list, ChangeWake wake, void *ctx) {
+    struct ChangeFeed *feed = feedFor(list);
+    if (feed == NULL) return;
+    feed->wake = wake;
+    feed->wakeCtx = ctx;
+}
+
+void flushChanges(StudentList *list) {
+    struct ChangeFeed *feed = list->changes;
+    if (feed == NULL || !feed->pending || feed->delivering) return;
+    feed->list = list;
+
+    // Changed rows as numbered now, without the removed ones
+    int changed = feed->reset ? 0 : settleChanged(feed);
+    int out = 0, k = 0;
+    for (int i = 0; i < changed; i++) {
+        int row = feed->changed[i];
+        while (k < feed->removedCount && feed->removed[k] < row) k++;
+        if (k < feed->removedCount && feed->removed[k] == row) continue;
+        feed->changed[out++] = row - k;
+    }
+    ChangeBatch batch = { feed->reset, feed->removed, feed->reset ? 0 : feed->removedCount,
+                          feed->changed, out, feed->reset ? 0 : feed->appended };
+
+    // Start the next batch before anyone sees this one: a listener may change the list
+    int *removed = feed->removed, *changedRows = feed->changed;
+    int removedCapacity = feed->removedCapacity, changedCapacity = feed->changedCapacity;
+    feed->removed = feed->changed = NULL;
+    feed->removedCount = feed->removedCapacity = feed->changedCount = feed->changedCapacity = 0;
+    feed->appended = feed->reset = feed->pending = 0;
+    feed->baseCount = list->count;
+
+    feed->delivering = 1;
+    for (int i = 0; i < feed->subscriberCount; i++) {
+        if (feed->subscribers[i].listener) feed->subscribers[i].listener(list, &batch, feed->subscribers[i].ctx);
+    }
+    feed->delivering = 0;
+    int live = 0;
+    for (int i = 0; i < feed->subscriberCount; i++) {
+        if (feed->subscribers[i].listener) feed->subscribers[live++] = feed->subscribers[i];
+    }
+    feed->subscriberCount = live;
+
+    if (feed->removed == NULL) { // Keep the arrays for the next batch
+        feed->removed = removed;
+        feed->removedCapacity = removedCapacity;
+    } else {
+        free(removed);
+    }
+    if (feed->changed == NULL) {
+        feed->changed = changedRows;
+        feed->changedCapacity = changedCapacity;
+    } else {
+        free(changedRows);
+    }
+}
+
+void freeChangeFeed(StudentList *list) {
+    if (list->changes == NULL) return;
+    free(list->changes->subscribers);
+    free(list->changes->removed);
+    free(list->changes->changed);
+    free(list->changes);
+    list->changes = NULL;
+}
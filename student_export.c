@@ -0,0 +1,262 @@
+#include "student_logic.h"
+#include "student_perf.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define EXPORT_BLOCK (1 << 20)      // Bytes per write; every write but the last is a whole block
+#define EXPORT_SLACK (64 << 10)     // Room past the block for the row that crosses it
+#define EXPORT_ALIGN 4096
+#define ROW_FIXED_BYTES 96          // Everything in a row but the name: punctuation, roll, marks
+#define EXPORT_PROGRESS_ROWS 4096
+
+// --- Number Formatting ---
+// printf parses its format and consults the locale on every call; these
+// write the digits straight into the buffer and return the end.
+
+static const char digitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static char *putUnsigned(char *out, unsigned long long value) {
+    char digits[20];
+    char *p = digits + sizeof(digits);
+    while (value >= 100) {
+        p -= 2;
+        memcpy(p, digitPairs + value % 100 * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, digitPairs + value * 2, 2);
+    } else {
+        *--p = (char)('0' + value);
+    }
+    size_t len = (size_t)(digits + sizeof(digits) - p);
+    memcpy(out, p, len);
+    return out + len;
+}
+
+static char *putInt(char *out, int value) {
+    if (value < 0) {
+        *out++ = '-';
+        return putUnsigned(out, 0ull - (unsigned long long)(long long)value);
+    }
+    return putUnsigned(out, (unsigned long long)value);
+}
+
+// Same text as "%.2f". A float has 24 significant bits, so marks * 100 is
+// exact in a double and rounding it to an integer (ties to even, as printf
+// does) is rounding marks to two places.
+static char *putMarks(char *out, float marks) {
+    double scaled = (double)marks * 100.0;
+    if (!(fabs(scaled) < 1e15)) { // NaN, infinities and the absurdly large
+        return out + sprintf(out, "%.2f", marks);
+    }
+    if (signbit(marks)) {
+        *out++ = '-';
+        scaled = -scaled;
+    }
+    unsigned long long hundredths = (unsigned long long)scaled;
+    double fraction = scaled - (double)hundredths;
+    if (fraction > 0.5 || (fraction == 0.5 && (hundredths & 1))) hundredths++;
+    out = putUnsigned(out, hundredths / 100);
+    *out++ = '.';
+    memcpy(out, digitPairs + hundredths % 100 * 2, 2);
+    return out + 2;
+}
+
+// --- Formats ---
+// One row per record. A format says how much a name can grow when written
+// (for sizing the buffer) and formats a row into room for that.
+
+typedef struct {
+    const char *header;     // Written once before the rows
+    size_t nameExpansion;   // Output bytes per name byte, at worst
+    char *(*row)(char *out, const char *name, size_t nameLen, int roll, float marks);
+} ExportWriter;
+
+// name,roll,marks: the loadFromFile format, byte for byte as fprintf wrote it
+static char *csvRow(char *out, const char *name, size_t nameLen, int roll, float marks) {
+    memcpy(out, name, nameLen);
+    out += nameLen;
+    *out++ = ',';
+    out = putInt(out, roll);
+    *out++ = ',';
+    out = putMarks(out, marks);
+    *out++ = '\n';
+    return out;
+}
+
+// Tabs and line breaks can't appear inside a TSV field; they become spaces
+static char *tsvRow(char *out, const char *name, size_t nameLen, int roll, float marks) {
+    for (size_t i = 0; i < nameLen; i++) {
+        char c = name[i];
+        *out++ = c == '\t' || c == '\n' || c == '\r' ? ' ' : c;
+    }
+    *out++ = '\t';
+    out = putInt(out, roll);
+    *out++ = '\t';
+    out = putMarks(out, marks);
+    *out++ = '\n';
+    return out;
+}
+
+// {"name":"...","roll":N,"marks":N.NN}; names are passed through as UTF-8
+static char *jsonRow(char *out, const char *name, size_t nameLen, int roll, float marks) {
+    static const char hex[] = "0123456789abcdef";
+    memcpy(out, "{\"name\":\"", 9);
+    out += 9;
+    for (size_t i = 0; i < nameLen; i++) {
+        unsigned char c = (unsigned char)name[i];
+        if (c == '"' || c == '\\') {
+            *out++ = '\\';
+            *out++ = (char)c;
+        } else if (c < 0x20) {
+            memcpy(out, "\\u00", 4);
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 15];
+            out += 6;
+        } else {
+            *out++ = (char)c;
+        }
+    }
+    memcpy(out, "\",\"roll\":", 9);
+    out = putInt(out + 9, roll);
+    memcpy(out, ",\"marks\":", 9);
+    if (isfinite(marks)) {
+        out = putMarks(out + 9, marks);
+    } else {
+        memcpy(out + 9, "null", 4); // JSON has no NaN or infinity
+        out += 13;
+    }
+    memcpy(out, "}\n", 2);
+    return out + 2;
+}
+
+static const ExportWriter writers[] = {
+    [EXPORT_CSV] = { "", 1, csvRow },
+    [EXPORT_JSONL] = { "", 6, jsonRow },
+    [EXPORT_TSV] = { "name\troll\tmarks\n", 1, tsvRow },
+};
+
+ExportFormat exportFormatForPath(const char *path) {
+    const char *dot = strrchr(path, '.');
+    if (dot == NULL || strchr(dot, '/') != NULL) return EXPORT_CSV;
+    if (strcmp(dot, ".jsonl") == 0 || strcmp(dot, ".json") == 0 || strcmp(dot, ".ndjson") == 0) return EXPORT_JSONL;
+    if (strcmp(dot, ".tsv") == 0 || strcmp(dot, ".tab") == 0) return EXPORT_TSV;
+    return EXPORT_CSV;
+}
+
+// --- Output Buffer ---
+// Rows are formatted into one page-aligned buffer. Whenever it holds at
+// least a block, the whole blocks go out in one unbuffered write and the
+// remainder moves to the front, so the file is written in block-sized,
+// block-aligned pieces.
+
+static int drainBuffer(ExportStream *stream, int all) {
+    size_t n = all ? stream->used : stream->used / EXPORT_BLOCK * EXPORT_BLOCK;
+    if (n == 0) return 1;
+    if (fwrite(stream->data, 1, n, stream->fp) != n) return 0;
+    stream->written += n;
+    stream->used -= n;
+    memmove(stream->data, stream->data + n, stream->used);
+    return 1;
+}
+
+// Makes room for a row of up to need bytes. Only a huge name needs more
+// than the slack, and then the buffer grows.
+static int reserveRow(ExportStream *stream, size_t need) {
+    if (stream->used + need <= stream->capacity) return 1;
+    if (!drainBuffer(stream, 0)) return 0;
+    if (stream->used + need <= stream->capacity) return 1;
+    size_t capacity = (stream->used + need + EXPORT_ALIGN - 1) / EXPORT_ALIGN * EXPORT_ALIGN;
+    char *grown = aligned_alloc(EXPORT_ALIGN, capacity);
+    if (grown == NULL) return 0;
+    memcpy(grown, stream->data, stream->used);
+    free(stream->data);
+    stream->data = grown;
+    stream->capacity = capacity;
+    return 1;
+}
+
+// --- Streams ---
+// Written to path.tmp and renamed over path by exportEnd, so a crash
+// mid-export leaves the previous file intact instead of a truncated one.
+
+int exportBegin(ExportStream *stream, const char *path, ExportFormat format) {
+    memset(stream, 0, sizeof(*stream));
+    if (format < 0 || format >= (int)(sizeof(writers) / sizeof(writers[0]))) return 0;
+    stream->format = format;
+    snprintf(stream->path, sizeof(stream->path), "%s", path);
+    snprintf(stream->tmpPath, sizeof(stream->tmpPath), "%s.tmp", path);
+    stream->capacity = EXPORT_BLOCK + EXPORT_SLACK;
+    stream->data = aligned_alloc(EXPORT_ALIGN, stream->capacity);
+    stream->fp = stream->data != NULL ? fopen(stream->tmpPath, "wb") : NULL;
+    if (stream->fp == NULL) {
+        free(stream->data);
+        return 0; // Failure
+    }
+    setvbuf(stream->fp, NULL, _IONBF, 0); // The buffer here is the only one
+    const char *header = writers[format].header;
+    stream->used = strlen(header);
+    memcpy(stream->data, header, stream->used);
+    return 1;
+}
+
+int exportRow(ExportStream *stream, const char *name, size_t nameLen, int roll, float marks) {
+    const ExportWriter *writer = &writers[stream->format];
+    if (stream->failed || !reserveRow(stream, nameLen * writer->nameExpansion + ROW_FIXED_BYTES)) {
+        stream->failed = 1;
+        return 0;
+    }
+    char *end = writer->row(stream->data + stream->used, name, nameLen, roll, marks);
+    stream->used = (size_t)(end - stream->data);
+    return 1;
+}
+
+int exportEnd(ExportStream *stream, int keep) {
+    int ok = keep && !stream->failed && drainBuffer(stream, 1);
+    ok = ok && flushToDisk(stream->fp);
+    ok = (fclose(stream->fp) == 0) && ok;
+    ok = ok && rename(stream->tmpPath, stream->path) == 0;
+    if (!ok) remove(stream->tmpPath);
+    PERF_COUNT(PERF_BYTES_WRITTEN, stream->written);
+    free(stream->data);
+    stream->data = NULL;
+    return ok;
+}
+
+// --- Export ---
+
+int exportStudents(const StudentList *list, const char *path, ExportFormat format, Progress *progress) {
+    PERF_BEGIN();
+    ExportStream stream;
+    int ok = exportBegin(&stream, path, format);
+    if (ok) {
+        progressStart(progress, list->count);
+        for (int i = 0; i < list->count && ok; i++) {
+            const char *name = studentName(list, i);
+            size_t nameLen = list->layout == LAYOUT_COLUMNS ? list->nameLengths[i] : strlen(name);
+            ok = exportRow(&stream, name, nameLen, studentRoll(list, i), studentMarks(list, i));
+            if (i % EXPORT_PROGRESS_ROWS == EXPORT_PROGRESS_ROWS - 1) {
+                progressAdvance(progress, EXPORT_PROGRESS_ROWS);
+                ok = ok && !progressCancelled(progress);
+            }
+        }
+        ok = exportEnd(&stream, ok);
+        if (ok) progressAdvance(progress, list->count % EXPORT_PROGRESS_ROWS); // The last partial block
+    }
+    PERF_END(PERF_SAVE);
+    return ok;
+}
+
+int exportCsv(const StudentList *list, const char *path) {
+    return exportStudents(list, path, EXPORT_CSV, NULL);
+}
+
+// Progress counts rows written.
+int exportCsvProgress(const StudentList *list, const char *path, Progress *progress) {
+    return exportStudents(list, path, EXPORT_CSV, progress);
+}
@@ -0,0 +1,692 @@
+#include "student_logic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Undo History ---
+// The history keeps its own copy of the records as a persistent vector: a
+// version is a spine of pointers to chunks of up to HISTORY_CHUNK rows, and
+// chunks are shared between versions by reference count. Taking a version
+// (an undo point or a tag) is a reference count bump. The first write after
+// that copies the spine once, and each chunk it writes to once; everything
+// else stays shared, so a step costs memory in proportion to the chunks it
+// touched.
+//
+// The copy follows the list through the same hooks as the change feed. A
+// sort, load or layout change drops it, and it is rebuilt from the list
+// when next needed (which is where such a step pays for a full copy).
+//
+// Going back to a version compares its spine with the current one: the
+// chunks both share are skipped, and the rows in between become one
+// removeStudents, one modifyStudents and one addStudents. When that can't
+// reproduce the order (rows coming back mid-list, a sort) the list is
+// rebuilt from the version and swapped in with adoptList.
+
+#define HISTORY_CHUNK 256   // Rows per chunk
+#define HISTORY_DEPTH 100   // Undo (and redo) steps kept
+#define STEP_LABEL 64
+
+typedef struct {
+    int refs;               // Versions holding it
+    int count;
+    int rolls[HISTORY_CHUNK];
+    float marks[HISTORY_CHUNK];
+    unsigned nameOffsets[HISTORY_CHUNK];
+    unsigned nameLengths[HISTORY_CHUNK];
+    char *names;            // NUL-terminated names
+    size_t namesUsed, namesCapacity, namesGarbage;
+} HistoryChunk;
+
+typedef struct {
+    int refs;               // Steps, tags and the history's current version
+    int count;              // Rows
+    HistoryChunk **chunks;
+    int *firsts;            // First row of each chunk
+    int chunkCount, chunkCapacity;
+} Version;
+
+typedef struct {
+    Version *version;
+    char label[STEP_LABEL];
+} HistoryStep;
+
+struct History {
+    Version *current;       // The list as it is now; NULL when it must be rebuilt
+    HistoryStep undo[HISTORY_DEPTH];
+    int undoCount;
+    HistoryStep redo[HISTORY_DEPTH];
+    int redoCount;
+    HistoryStep *tags;
+    int tagCount, tagCapacity;
+    int replaying;          // Going back or forward: the list calls are ours
+    size_t bytes;
+};
+
+// --- Chunks and Versions ---
+
+static HistoryChunk *newChunk(struct History *history) {
+    HistoryChunk *chunk = calloc(1, sizeof(HistoryChunk));
+    if (chunk == NULL) return NULL;
+    chunk->refs = 1;
+    history->bytes += sizeof(HistoryChunk);
+    return chunk;
+}
+
+static void releaseChunk(struct History *history, HistoryChunk *chunk) {
+    if (--chunk->refs > 0) return;
+    history->bytes -= sizeof(HistoryChunk) + chunk->namesCapacity;
+    free(chunk->names);
+    free(chunk);
+}
+
+static int reserveNames(struct History *history, HistoryChunk *chunk, size_t extra) {
+    if (chunk->namesUsed + extra <= chunk->namesCapacity) return 1;
+    size_t capacity = chunk->namesCapacity ? chunk->namesCapacity : 1024;
+    while (capacity < chunk->namesUsed + extra) capacity *= 2;
+    char *grown = realloc(chunk->names, capacity);
+    if (grown == NULL) return 0;
+    history->bytes += capacity - chunk->namesCapacity;
+    chunk->names = grown;
+    chunk->namesCapacity = capacity;
+    return 1;
+}
+
+// Stores name for row i of the chunk, appending it (the old one, if any, is garbage)
+static int putName(struct History *history, HistoryChunk *chunk, int i, const char *name, size_t len) {
+    if (!reserveNames(history, chunk, len + 1)) return 0;
+    memcpy(chunk->names + chunk->namesUsed, name, len);
+    chunk->names[chunk->namesUsed + len] = '\0';
+    chunk->nameOffsets[i] = (unsigned)chunk->namesUsed;
+    chunk->nameLengths[i] = (unsigned)len;
+    chunk->namesUsed += len + 1;
+    return 1;
+}
+
+// A private copy of a shared chunk, with its names packed
+static HistoryChunk *copyChunk(struct History *history, const HistoryChunk *from) {
+    HistoryChunk *chunk = newChunk(history);
+    if (chunk == NULL) return NULL;
+    if (!reserveNames(history, chunk, from->namesUsed - from->namesGarbage)) {
+        releaseChunk(history, chunk);
+        return NULL;
+    }
+    chunk->count = from->count;
+    memcpy(chunk->rolls, from->rolls, (size_t)from->count * sizeof(int));
+    memcpy(chunk->marks, from->marks, (size_t)from->count * sizeof(float));
+    for (int i = 0; i < from->count; i++) {
+        putName(history, chunk, i, from->names + from->nameOffsets[i], from->nameLengths[i]); // Reserved above
+    }
+    return chunk;
+}
+
+static Version *newVersion(int chunkCapacity) {
+    Version *version = calloc(1, sizeof(Version));
+    if (version == NULL) return NULL;
+    version->refs = 1;
+    version->chunkCapacity = chunkCapacity > 0 ? chunkCapacity : 1;
+    version->chunks = malloc((size_t)version->chunkCapacity * sizeof(HistoryChunk *));
+    version->firsts = malloc((size_t)version->chunkCapacity * sizeof(int));
+    if (version->chunks == NULL || version->firsts == NULL) {
+        free(version->chunks);
+        free(version->firsts);
+        free(version);
+        return NULL;
+    }
+    return version;
+}
+
+static void spineBytes(struct History *history, const Version *version, int sign) {
+    size_t bytes = sizeof(Version) + (size_t)version->chunkCapacity * (sizeof(HistoryChunk *) + sizeof(int));
+    if (sign > 0) history->bytes += bytes;
+    else history->bytes -= bytes;
+}
+
+static void releaseVersion(struct History *history, Version *version) {
+    if (version == NULL || --version->refs > 0) return;
+    for (int k = 0; k < version->chunkCount; k++) releaseChunk(history, version->chunks[k]);
+    spineBytes(history, version, -1);
+    free(version->chunks);
+    free(version->firsts);
+    free(version);
+}
+
+static int growSpine(struct History *history, Version *version, int needed) {
+    if (needed <= version->chunkCapacity) return 1;
+    int capacity = version->chunkCapacity * 2;
+    while (capacity < needed) capacity *= 2;
+    HistoryChunk **chunks = realloc(version->chunks, (size_t)capacity * sizeof(HistoryChunk *));
+    if (chunks == NULL) return 0;
+    version->chunks = chunks;
+    int *firsts = realloc(version->firsts, (size_t)capacity * sizeof(int));
+    if (firsts == NULL) return 0;
+    version->firsts = firsts;
+    spineBytes(history, version, -1);
+    version->chunkCapacity = capacity;
+    spineBytes(history, version, 1);
+    return 1;
+}
+
+// The chunk holding row: the last one starting at or before it
+static int chunkOf(const Version *version, int row) {
+    int lo = 0, hi = version->chunkCount;
+    while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        if (version->firsts[mid] <= row) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static const char *rowName(const StudentList *list, int i, size_t *len) {
+    const char *name = studentName(list, i);
+    *len = list->layout == LAYOUT_COLUMNS ? list->nameLengths[i] : strlen(name);
+    return name;
+}
+
+// A version holding the list as it is now, in fresh chunks
+static Version *versionOfList(struct History *history, const StudentList *list) {
+    Version *version = newVersion((list->count + HISTORY_CHUNK - 1) / HISTORY_CHUNK);
+    if (version == NULL) return NULL;
+    spineBytes(history, version, 1);
+    for (int row = 0; row < list->count; row += HISTORY_CHUNK) {
+        HistoryChunk *chunk = newChunk(history);
+        int n = list->count - row < HISTORY_CHUNK ? list->count - row : HISTORY_CHUNK;
+        size_t nameBytes = 0;
+        for (int i = 0; i < n; i++) {
+            size_t len;
+            rowName(list, row + i, &len);
+            nameBytes += len + 1;
+        }
+        if (chunk == NULL || !reserveNames(history, chunk, nameBytes)) {
+            if (chunk) releaseChunk(history, chunk);
+            releaseVersion(history, version);
+            return NULL;
+        }
+        for (int i = 0; i < n; i++) {
+            size_t len;
+            const char *name = rowName(list, row + i, &len);
+            chunk->rolls[i] = studentRoll(list, row + i);
+            chunk->marks[i] = studentMarks(list, row + i);
+            putName(history, chunk, i, name, len);
+        }
+        chunk->count = n;
+        version->firsts[version->chunkCount] = row;
+        version->chunks[version->chunkCount++] = chunk;
+    }
+    version->count = list->count;
+    return version;
+}
+
+// --- Following the List ---
+
+static void dropSteps(struct History *history, HistoryStep *steps, int *count) {
+    for (int i = 0; i < *count; i++) releaseVersion(history, steps[i].version);
+    *count = 0;
+}
+
+// Out of memory part way through a write: forget the copy, rebuild it later
+static void loseCurrent(struct History *history) {
+    releaseVersion(history, history->current);
+    history->current = NULL;
+}
+
+// Called before every write: a change of our own ends the redo chain, and a
+// version that is also an undo step or a tag gets a spine of its own
+static Version *writableVersion(struct History *history) {
+    if (history->redoCount > 0) dropSteps(history, history->redo, &history->redoCount);
+    Version *shared = history->current;
+    if (shared == NULL || shared->refs == 1) return shared;
+    Version *version = newVersion(shared->chunkCapacity);
+    if (version == NULL) {
+        loseCurrent(history);
+        return NULL;
+    }
+    spineBytes(history, version, 1);
+    memcpy(version->chunks, shared->chunks, (size_t)shared->chunkCount * sizeof(HistoryChunk *));
+    memcpy(version->firsts, shared->firsts, (size_t)shared->chunkCount * sizeof(int));
+    version->chunkCount = shared->chunkCount;
+    version->count = shared->count;
+    for (int k = 0; k < version->chunkCount; k++) version->chunks[k]->refs++;
+    shared->refs--;
+    history->current = version;
+    return version;
+}
+
+static HistoryChunk *writableChunk(struct History *history, Version *version, int k) {
+    HistoryChunk *chunk = version->chunks[k];
+    if (chunk->refs == 1) return chunk;
+    HistoryChunk *copy = copyChunk(history, chunk);
+    if (copy == NULL) return NULL;
+    releaseChunk(history, chunk);
+    version->chunks[k] = copy;
+    return copy;
+}
+
+static void packNames(struct History *history, HistoryChunk *chunk) {
+    if (chunk->namesGarbage < 1024 || chunk->namesGarbage * 2 < chunk->namesUsed) return;
+    HistoryChunk *packed = copyChunk(history, chunk);
+    if (packed == NULL) return; // Not fatal: the garbage just stays around a while longer
+    history->bytes -= chunk->namesCapacity;
+    free(chunk->names);
+    *chunk = *packed;
+    chunk->refs = 1;
+    packed->names = NULL;
+    packed->namesCapacity = 0;
+    releaseChunk(history, packed);
+}
+
+void historyAdded(struct History *history, const StudentList *list) {
+    if (history->replaying) return;
+    Version *version = writableVersion(history);
+    if (version == NULL) return;
+    int k = version->chunkCount - 1;
+    HistoryChunk *chunk = NULL;
+    if (k >= 0 && version->chunks[k]->count < HISTORY_CHUNK) {
+        chunk = writableChunk(history, version, k);
+    } else if (growSpine(history, version, version->chunkCount + 1) && (chunk = newChunk(history)) != NULL) {
+        version->firsts[version->chunkCount] = version->count;
+        version->chunks[version->chunkCount++] = chunk;
+    }
+    int row = list->count - 1;
+    size_t len;
+    const char *name = rowName(list, row, &len);
+    if (chunk == NULL || !putName(history, chunk, chunk->count, name, len)) {
+        loseCurrent(history);
+        return;
+    }
+    chunk->rolls[chunk->count] = studentRoll(list, row);
+    chunk->marks[chunk->count] = studentMarks(list, row);
+    chunk->count++;
+    version->count++;
+}
+
+void historyChanged(struct History *history, const StudentList *list, int row) {
+    if (history->replaying) return;
+    Version *version = writableVersion(history);
+    if (version == NULL) return;
+    int k = chunkOf(version, row);
+    HistoryChunk *chunk = writableChunk(history, version, k);
+    if (chunk == NULL) {
+        loseCurrent(history);
+        return;
+    }
+    int i = row - version->firsts[k];
+    size_t len;
+    const char *name = rowName(list, row, &len);
+    chunk->marks[i] = studentMarks(list, row);
+    if (len == chunk->nameLengths[i] && memcmp(name, chunk->names + chunk->nameOffsets[i], len) == 0) return;
+    chunk->namesGarbage += chunk->nameLengths[i] + 1;
+    if (!putName(history, chunk, i, name, len)) {
+        loseCurrent(history);
+        return;
+    }
+    packNames(history, chunk);
+}
+
+// Takes chunk k out of the spine once it is empty
+static void dropChunk(struct History *history, Version *version, int k) {
+    releaseChunk(history, version->chunks[k]);
+    int tail = version->chunkCount - k - 1;
+    memmove(version->chunks + k, version->chunks + k + 1, (size_t)tail * sizeof(HistoryChunk *));
+    memmove(version->firsts + k, version->firsts + k + 1, (size_t)tail * sizeof(int));
+    version->chunkCount--;
+}
+
+static void removeFromChunk(HistoryChunk *chunk, int i) {
+    int tail = chunk->count - i - 1;
+    chunk->namesGarbage += chunk->nameLengths[i] + 1;
+    memmove(chunk->rolls + i, chunk->rolls + i + 1, (size_t)tail * sizeof(int));
+    memmove(chunk->marks + i, chunk->marks + i + 1, (size_t)tail * sizeof(float));
+    memmove(chunk->nameOffsets + i, chunk->nameOffsets + i + 1, (size_t)tail * sizeof(unsigned));
+    memmove(chunk->nameLengths + i, chunk->nameLengths + i + 1, (size_t)tail * sizeof(unsigned));
+    chunk->count--;
+}
+
+void historyRemoved(struct History *history, int row) {
+    if (history->replaying) return;
+    Version *version = writableVersion(history);
+    if (version == NULL) return;
+    int k = chunkOf(version, row);
+    HistoryChunk *chunk = writableChunk(history, version, k);
+    if (chunk == NULL) {
+        loseCurrent(history);
+        return;
+    }
+    removeFromChunk(chunk, row - version->firsts[k]);
+    version->count--;
+    for (int j = k + 1; j < version->chunkCount; j++) version->firsts[j]--;
+    if (chunk->count == 0) dropChunk(history, version, k);
+}
+
+// The rows flagged in doomed[from, to), in one pass over the chunks they are in
+void historyRemovedRows(struct History *history, const unsigned char *doomed, int from, int to) {
+    if (history->replaying || from >= to) return;
+    Version *version = writableVersion(history);
+    if (version == NULL) return;
+    int k = chunkOf(version, from), out = k, row = version->firsts[k];
+    for (; k < version->chunkCount; k++) {
+        HistoryChunk *chunk = version->chunks[k];
+        int first = version->firsts[k], gone = 0;
+        for (int i = 0; i < chunk->count; i++) gone += first + i >= from && first + i < to && doomed[first + i];
+        if (gone > 0) {
+            if ((chunk = writableChunk(history, version, k)) == NULL) {
+                loseCurrent(history);
+                return;
+            }
+            int kept = 0;
+            for (int i = 0; i < chunk->count; i++) {
+                if (first + i >= from && first + i < to && doomed[first + i]) {
+                    chunk->namesGarbage += chunk->nameLengths[i] + 1;
+                    continue;
+                }
+                chunk->rolls[kept] = chunk->rolls[i];
+                chunk->marks[kept] = chunk->marks[i];
+                chunk->nameOffsets[kept] = chunk->nameOffsets[i];
+                chunk->nameLengths[kept] = chunk->nameLengths[i];
+                kept++;
+            }
+            chunk->count = kept;
+            version->count -= gone;
+        }
+        if (chunk->count == 0) {
+            releaseChunk(history, chunk);
+            continue;
+        }
+        version->chunks[out] = chunk;
+        version->firsts[out++] = row;
+        row += chunk->count;
+    }
+    version->chunkCount = out;
+}
+
+void historyReset(struct History *history) {
+    if (history->replaying) return;
+    if (history->redoCount > 0) dropSteps(history, history->redo, &history->redoCount);
+    loseCurrent(history);
+}
+
+// --- Undo and Redo ---
+
+static int ensureCurrent(struct History *history, const StudentList *list) {
+    if (history->current == NULL) history->current = versionOfList(history, list);
+    return history->current != NULL;
+}
+
+static void pushStep(struct History *history, HistoryStep *steps, int *count, Version *version, const char *label) {
+    if (*count == HISTORY_DEPTH) { // Forget the oldest
+        releaseVersion(history, steps[0].version);
+        memmove(steps, steps + 1, (HISTORY_DEPTH - 1) * sizeof(HistoryStep));
+        (*count)--;
+    }
+    steps[*count].version = version;
+    snprintf(steps[*count].label, STEP_LABEL, "%s", label ? label : "");
+    (*count)++;
+}
+
+typedef struct {
+    const Version *version;
+    int k, i;
+} RowCursor;
+
+static void cursorAt(RowCursor *cursor, const Version *version, int row) {
+    cursor->version = version;
+    cursor->k = version->chunkCount > 0 ? chunkOf(version, row) : 0;
+    cursor->i = version->chunkCount > 0 ? row - version->firsts[cursor->k] : 0;
+}
+
+static const HistoryChunk *cursorChunk(const RowCursor *cursor) {
+    return cursor->version->chunks[cursor->k];
+}
+
+static void cursorNext(RowCursor *cursor) {
+    if (++cursor->i == cursor->version->chunks[cursor->k]->count) {
+        cursor->k++;
+        cursor->i = 0;
+    }
+}
+
+// Turns the list (holding from) into to with removeStudents, modifyStudents
+// and addStudents over the rows the two don't share. 0 if it can't keep
+// to's order that way, or memory ran out (the list may then be part way).
+static int patchList(StudentList *list, const Version *from, const Version *to) {
+    int prefix = 0, suffix = 0, head = 0, tail = 0;
+    while (head < from->chunkCount && head < to->chunkCount && from->chunks[head] == to->chunks[head]) {
+        prefix += from->chunks[head++]->count;
+    }
+    while (tail < from->chunkCount - head && tail < to->chunkCount - head &&
+           from->chunks[from->chunkCount - 1 - tail] == to->chunks[to->chunkCount - 1 - tail]) {
+        suffix += from->chunks[from->chunkCount - 1 - tail++]->count;
+    }
+    int fromRows = from->count - suffix - prefix, toRows = to->count - suffix - prefix;
+    if (fromRows + toRows > list->count / 2 + 4096) return 0; // A rebuild is cheaper
+
+    int *removes = malloc((size_t)(fromRows + 1) * sizeof(int));
+    StudentUpdate *updates = malloc((size_t)(toRows + 1) * sizeof(StudentUpdate));
+    StudentInput *adds = malloc((size_t)(toRows + 1) * sizeof(StudentInput));
+    RowResult *results = malloc((size_t)(fromRows + toRows + 1) * sizeof(RowResult));
+    int ok = removes && updates && adds && results;
+    int removeCount = 0, updateCount = 0, addCount = 0;
+
+    // Walk both in step: a row of from that isn't the next row of to goes;
+    // whatever is left of to must be new rows at the very end
+    RowCursor a, b;
+    cursorAt(&a, from, prefix);
+    cursorAt(&b, to, prefix);
+    int i = 0, j = 0;
+    for (; ok && i < fromRows; i++, cursorNext(&a)) {
+        const HistoryChunk *was = cursorChunk(&a);
+        if (j == toRows || was->rolls[a.i] != cursorChunk(&b)->rolls[b.i]) {
+            removes[removeCount++] = was->rolls[a.i];
+            continue;
+        }
+        const HistoryChunk *now = cursorChunk(&b);
+        const char *name = now->names + now->nameOffsets[b.i];
+        int sameName = was->nameLengths[a.i] == now->nameLengths[b.i] &&
+                       memcmp(was->names + was->nameOffsets[a.i], name, now->nameLengths[b.i]) == 0;
+        int sameMarks = was->marks[a.i] == now->marks[b.i];
+        if (!sameName || !sameMarks) {
+            // modifyStudent reads an empty name or negative marks as "keep"
+            ok = (sameName || now->nameLengths[b.i] > 0) && (sameMarks || now->marks[b.i] >= 0);
+            updates[updateCount++] = (StudentUpdate){ now->rolls[b.i], sameName ? NULL : name,
+                                                      sameMarks ? -1.0f : now->marks[b.i] };
+        }
+        j++;
+        cursorNext(&b);
+    }
+    ok = ok && (j == toRows || suffix == 0);
+    for (; ok && j < toRows; j++, cursorNext(&b)) {
+        const HistoryChunk *now = cursorChunk(&b);
+        adds[addCount++] = (StudentInput){ now->names + now->nameOffsets[b.i], now->nameLengths[b.i],
+                                           now->rolls[b.i], now->marks[b.i] };
+    }
+
+    if (ok) ok = removeStudents(list, removes, removeCount, results);
+    for (int r = 0; ok && r < removeCount; r++) ok = results[r] == ROW_OK;
+    if (ok) ok = modifyStudents(list, updates, updateCount, results);
+    for (int r = 0; ok && r < updateCount; r++) ok = results[r] == ROW_OK;
+    if (ok) ok = addStudents(list, adds, addCount, results);
+    for (int r = 0; ok && r < addCount; r++) ok = results[r] == ROW_OK;
+    free(removes);
+    free(updates);
+    free(adds);
+    free(results);
+    return ok;
+}
+
+// Replaces the list's records with to's, keeping its attachments
+static int rebuildList(StudentList *list, const Version *to) {
+    StudentList fresh;
+    initListLayout(&fresh, list->layout);
+    StudentInput rows[HISTORY_CHUNK];
+    int ok = reserveStudents(&fresh, to->count);
+    for (int k = 0; ok && k < to->chunkCount; k++) {
+        const HistoryChunk *chunk = to->chunks[k];
+        for (int i = 0; i < chunk->count; i++) {
+            rows[i] = (StudentInput){ chunk->names + chunk->nameOffsets[i], chunk->nameLengths[i],
+                                      chunk->rolls[i], chunk->marks[i] };
+        }
+        ok = addStudents(&fresh, rows, chunk->count, NULL);
+    }
+    if (!ok) {
+        freeList(&fresh);
+        return 0;
+    }
+    return adoptList(list, &fresh);
+}
+
+// Brings the list from the current version to target, which becomes current
+// (the caller's reference to it passes to the history)
+static int restoreVersion(StudentList *list, Version *target) {
+    struct History *history = list->history;
+    Version *from = history->current;
+    history->current = NULL; // The list is in between while we work
+    history->replaying = 1;
+    int ok = from == target || patchList(list, from, target) || rebuildList(list, target);
+    history->replaying = 0;
+    releaseVersion(history, from);
+    if (!ok) {
+        releaseVersion(history, target);
+        return 0;
+    }
+    history->current = target;
+    return 1;
+}
+
+int enableHistory(StudentList *list) {
+    if (list->history == NULL) list->history = calloc(1, sizeof(struct History));
+    return list->history != NULL; // The copy of the records is made at the first undo point
+}
+
+void disableHistory(StudentList *list) {
+    struct History *history = list->history;
+    if (history == NULL) return;
+    dropSteps(history, history->undo, &history->undoCount);
+    dropSteps(history, history->redo, &history->redoCount);
+    dropSteps(history, history->tags, &history->tagCount);
+    loseCurrent(history);
+    free(history->tags);
+    free(history);
+    list->history = NULL;
+}
+
+int markUndoPoint(StudentList *list, const char *label) {
+    struct History *history = list->history;
+    if (history == NULL) return 1;
+    if (!ensureCurrent(history, list)) return 0;
+    if (history->undoCount > 0 && history->undo[history->undoCount - 1].version == history->current) {
+        HistoryStep *step = &history->undo[history->undoCount - 1]; // Nothing changed since: relabel it
+        snprintf(step->label, STEP_LABEL, "%s", label ? label : "");
+        return 1;
+    }
+    history->current->refs++;
+    pushStep(history, history->undo, &history->undoCount, history->current, label);
+    return 1;
+}
+
+// Steps that changed nothing are skipped
+static void dropEmptySteps(struct History *history) {
+    while (history->undoCount > 0 && history->undo[history->undoCount - 1].version == history->current) {
+        releaseVersion(history, history->undo[--history->undoCount].version);
+    }
+}
+
+int undoChange(StudentList *list) {
+    struct History *history = list->history;
+    if (history == NULL || !ensureCurrent(history, list)) return 0;
+    dropEmptySteps(history);
+    if (history->undoCount == 0) return 0;
+    HistoryStep step = history->undo[--history->undoCount];
+    pushStep(history, history->redo, &history->redoCount, history->current, step.label);
+    history->current->refs++; // One for the redo step, one still current until restored
+    return restoreVersion(list, step.version);
+}
+
+int redoChange(StudentList *list) {
+    struct History *history = list->history;
+    if (history == NULL || history->redoCount == 0 || !ensureCurrent(history, list)) return 0;
+    HistoryStep step = history->redo[--history->redoCount];
+    pushStep(history, history->undo, &history->undoCount, history->current, step.label);
+    history->current->refs++;
+    return restoreVersion(list, step.version);
+}
+
+const char *undoLabel(const StudentList *list) {
+    const struct History *history = list->history;
+    if (history == NULL) return NULL;
+    for (int i = history->undoCount - 1; i >= 0; i--) {
+        if (history->undo[i].version != history->current) return history->undo[i].label;
+    }
+    return NULL;
+}
+
+const char *redoLabel(const StudentList *list) {
+    const struct History *history = list->history;
+    if (history == NULL || history->redoCount == 0) return NULL;
+    return history->redo[history->redoCount - 1].label;
+}
+
+// --- Tagged Versions ---
+
+static int findTag(const struct History *history, const char *name) {
+    for (int i = 0; i < history->tagCount; i++) {
+        if (strncmp(history->tags[i].label, name, STEP_LABEL - 1) == 0) return i; // Names are kept that long
+    }
+    return -1;
+}
+
+int tagVersion(StudentList *list, const char *name) {
+    struct History *history = list->history;
+    if (history == NULL || !ensureCurrent(history, list)) return 0;
+    int i = findTag(history, name);
+    if (i == -1) {
+        if (history->tagCount == history->tagCapacity) {
+            int capacity = history->tagCapacity ? history->tagCapacity * 2 : 8;
+            HistoryStep *grown = realloc(history->tags, (size_t)capacity * sizeof(HistoryStep));
+            if (grown == NULL) return 0;
+            history->tags = grown;
+            history->tagCapacity = capacity;
+        }
+        i = history->tagCount++;
+        snprintf(history->tags[i].label, STEP_LABEL, "%s", name);
+    } else {
+        releaseVersion(history, history->tags[i].version); // Same name: moves to now
+    }
+    history->tags[i].version = history->current;
+    history->current->refs++;
+    return 1;
+}
+
+int restoreTag(StudentList *list, const char *name) {
+    struct History *history = list->history;
+    int i = history ? findTag(history, name) : -1;
+    if (i == -1) return 0;
+    char label[STEP_LABEL + 16];
+    snprintf(label, sizeof(label), "Restore %s", name);
+    if (!markUndoPoint(list, label)) return 0;
+    dropSteps(history, history->redo, &history->redoCount);
+    Version *target = history->tags[i].version;
+    target->refs++;
+    return restoreVersion(list, target);
+}
+
+int dropTag(StudentList *list, const char *name) {
+    struct History *history = list->history;
+    int i = history ? findTag(history, name) : -1;
+    if (i == -1) return 0;
+    releaseVersion(history, history->tags[i].version);
+    memmove(history->tags + i, history->tags + i + 1, (size_t)(history->tagCount - i - 1) * sizeof(HistoryStep));
+    history->tagCount--;
+    return 1;
+}
+
+int tagCount(const StudentList *list) {
+    return list->history ? list->history->tagCount : 0;
+}
+
+const char *tagName(const StudentList *list, int i) {
+    return list->history->tags[i].label;
+}
+
+size_t historyMemoryUsage(const StudentList *list) {
+    return list->history ? sizeof(struct History) + list->history->bytes : 0;
+}
@@ -0,0 +1,452 @@
+#include "student_logic.h"
+#include "student_journal.h"
+#include "student_perf.h"
+#include "student_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define MIN_CHUNK_BYTES (1 << 20) // Don't bother splitting below ~1 MB per thread
+#define MAX_LOAD_THREADS 64
+#define PROGRESS_LINES 65536       // Parsers report progress (and look for a cancel) this often
+#define INSERT_BATCH 65536         // Rows per addStudents call when importing
+#define STREAM_CHUNK_BYTES (4 << 20) // Parsed per batch by streamCsv
+
+// --- File Mapping ---
+
+static int mapFileMode(const char *path, MappedFile *file, int writable) {
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = 0;
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0; // Failure
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+    if (st.st_size > 0) {
+        // MAP_PRIVATE: with PROT_WRITE, writes copy the page instead of touching the file
+        int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *p = mmap(NULL, (size_t)st.st_size, prot, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return 0;
+        }
+        if (!writable) madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+        file->data = p;
+        file->size = (size_t)st.st_size;
+        file->mapped = 1;
+    }
+    close(fd);
+    return 1; // Success
+#else
+    (void)writable; // The heap copy is writable anyway
+    // No mmap here: fall back to a single read of the whole file
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return 0;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size > 0) {
+        char *buf = malloc((size_t)size);
+        if (buf == NULL || fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+            free(buf);
+            fclose(fp);
+            return 0;
+        }
+        file->data = buf;
+        file->size = (size_t)size;
+    }
+    fclose(fp);
+    return 1;
+#endif
+}
+
+int mapFile(const char *path, MappedFile *file) {
+    return mapFileMode(path, file, 0);
+}
+
+int mapFilePrivate(const char *path, MappedFile *file) {
+    return mapFileMode(path, file, 1);
+}
+
+void unmapFile(MappedFile *file) {
+#ifndef _WIN32
+    if (file->mapped) {
+        munmap((void *)file->data, file->size);
+    }
+#else
+    free((void *)file->data);
+#endif
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = 0;
+}
+
+int flushToDisk(FILE *fp) {
+    if (fflush(fp) != 0) {
+        return 0;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(fp)) == 0;
+#else
+    return fsync(fileno(fp)) == 0;
+#endif
+}
+
+// --- CSV Parsing ---
+// Each line is "name,roll,marks". Rows are parsed in place, straight into
+// the StudentInput records addStudents takes: each points at its name inside
+// the mapped file, so nothing is copied until insertion.
+
+typedef struct {
+    const char *begin;   // First byte of this chunk (always at a line start)
+    const char *end;
+    StudentInput *rows;
+    int rowCount;
+    int rowCapacity;
+    int lineCount;       // Lines seen in this chunk, for global line numbers
+    int malformed;
+    int badLines[MAX_REPORTED_LINES]; // Chunk-local, 1-based
+    int badLineCount;
+    int failed;          // Out of memory
+    Progress *progress;  // Shared by every chunk; may be NULL
+} ParseChunk;
+
+static const char *skipSpaces(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+// Parses an optionally signed decimal int. Returns NULL on error or overflow.
+static const char *parseInt(const char *p, const char *end, int *out) {
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return NULL;
+    }
+    long long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        if (value > (long long)INT_MAX + 1) {
+            return NULL;
+        }
+        p++;
+    }
+    if (negative) value = -value;
+    if (value > INT_MAX || value < INT_MIN) {
+        return NULL;
+    }
+    *out = (int)value;
+    return p;
+}
+
+// Parses "123", "123.45" or ".5" as a fixed-point number. Returns NULL on error.
+static const char *parseFixed(const char *p, const char *end, float *out) {
+    static const double scale[] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    long long whole = 0, frac = 0;
+    int wholeDigits = 0, fracDigits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (wholeDigits < 18) whole = whole * 10 + (*p - '0');
+        else return NULL; // Far outside any sensible mark
+        wholeDigits++;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (fracDigits < 9) { // Extra digits are below float precision anyway
+                frac = frac * 10 + (*p - '0');
+                fracDigits++;
+            }
+            p++;
+        }
+    }
+    if (wholeDigits == 0 && fracDigits == 0) {
+        return NULL;
+    }
+    double value = (double)whole + (double)frac / scale[fracDigits];
+    *out = (float)(negative ? -value : value);
+    return p;
+}
+
+static int parseLine(const char *p, const char *end, StudentInput *row) {
+    const char *comma = memchr(p, ',', (size_t)(end - p));
+    if (comma == NULL || comma == p) {
+        return 0; // No name
+    }
+    row->name = p;
+    row->nameLen = (size_t)(comma - p);
+
+    p = skipSpaces(comma + 1, end);
+    p = parseInt(p, end, &row->roll);
+    if (p == NULL) return 0;
+    p = skipSpaces(p, end);
+    if (p == end || *p != ',') return 0;
+
+    p = skipSpaces(p + 1, end);
+    p = parseFixed(p, end, &row->marks);
+    if (p == NULL) return 0;
+    p = skipSpaces(p, end);
+    return p == end; // Trailing garbage (or a 4th field) is an error
+}
+
+int parseCsvLine(const char *p, const char *end, StudentInput *row) {
+    if (end > p && end[-1] == '\r') end--;
+    return parseLine(p, end, row);
+}
+
+static void *parseChunk(void *arg) {
+    ParseChunk *chunk = arg;
+    const char *p = chunk->begin;
+    const char *reported = p;
+
+    while (p < chunk->end) {
+        if ((chunk->lineCount & (PROGRESS_LINES - 1)) == PROGRESS_LINES - 1) {
+            progressAdvance(chunk->progress, p - reported);
+            reported = p;
+            if (progressCancelled(chunk->progress)) return NULL;
+        }
+        const char *eol = memchr(p, '\n', (size_t)(chunk->end - p));
+        const char *next = eol ? eol + 1 : chunk->end;
+        if (eol == NULL) eol = chunk->end;
+        chunk->lineCount++;
+
+        const char *lineEnd = eol;
+        if (lineEnd > p && lineEnd[-1] == '\r') lineEnd--;
+
+        if (skipSpaces(p, lineEnd) != lineEnd) { // Blank lines are ignored
+            if (chunk->rowCount == chunk->rowCapacity) {
+                int grown = chunk->rowCapacity == 0 ? 1024 : chunk->rowCapacity * 2;
+                StudentInput *rows = realloc(chunk->rows, (size_t)grown * sizeof(StudentInput));
+                if (rows == NULL) {
+                    chunk->failed = 1;
+                    return NULL;
+                }
+                chunk->rows = rows;
+                chunk->rowCapacity = grown;
+            }
+            if (parseLine(p, lineEnd, &chunk->rows[chunk->rowCount])) {
+                chunk->rowCount++;
+            } else {
+                if (chunk->badLineCount < MAX_REPORTED_LINES)
+                    chunk->badLines[chunk->badLineCount++] = chunk->lineCount;
+                chunk->malformed++;
+            }
+        }
+        p = next;
+    }
+    progressAdvance(chunk->progress, p - reported);
+    return NULL;
+}
+
+static void parseTask(void *ctx, long long begin, long long end) {
+    ParseChunk *chunks = ctx;
+    for (long long t = begin; t < end; t++) {
+        parseChunk(&chunks[t]);
+    }
+}
+
+static int loadThreadCount(size_t bytes) {
+    long cpus = workerThreads();
+    size_t bySize = bytes / MIN_CHUNK_BYTES + 1;
+    long n = cpus < (long)bySize ? cpus : (long)bySize;
+    if (n > MAX_LOAD_THREADS) n = MAX_LOAD_THREADS;
+    return n < 1 ? 1 : (int)n;
+}
+
+// --- File I/O ---
+
+int saveToFile(const StudentList *list, const char *path) {
+    return exportCsv(list, path);
+}
+
+int loadFromFile(StudentList *list, const char *path) {
+    return loadFromFileReport(list, path, NULL);
+}
+
+int loadFromFileReport(StudentList *list, const char *path, LoadReport *report) {
+    return importCsv(list, path, report);
+}
+
+int importCsv(StudentList *list, const char *path, LoadReport *report) {
+    return importCsvProgress(list, path, report, NULL);
+}
+
+static int readCsv(StudentList *list, const char *path, LoadReport *report, Progress *progress) {
+    MappedFile file;
+    if (!mapFile(path, &file)) {
+        return 0; // Failure
+    }
+    PERF_COUNT(PERF_BYTES_READ, file.size);
+    progressStart(progress, 2 * (long long)file.size);
+
+    // Split into newline-aligned chunks, one per thread
+    int threads = loadThreadCount(file.size);
+    ParseChunk chunks[MAX_LOAD_THREADS];
+    memset(chunks, 0, sizeof(chunks));
+    const char *data = file.data;
+    const char *end = file.data + file.size;
+    const char *start = data;
+    for (int t = 0; t < threads; t++) {
+        const char *stop = (t == threads - 1) ? end : data + file.size / (size_t)threads * (size_t)(t + 1);
+        if (stop < start) stop = start;
+        if (stop < end) {
+            const char *nl = memchr(stop, '\n', (size_t)(end - stop));
+            stop = nl ? nl + 1 : end;
+        }
+        chunks[t].begin = start;
+        chunks[t].end = stop;
+        chunks[t].progress = progress;
+        start = stop;
+    }
+
+    parallelFor(threads, 1, parseTask, chunks);
+
+    int failed = 0;
+    long long total = 0;
+    for (int t = 0; t < threads; t++) {
+        failed |= chunks[t].failed;
+        total += chunks[t].rowCount;
+    }
+    if (failed || total > INT_MAX / 2 || progressCancelled(progress)) {
+        for (int t = 0; t < threads; t++) free(chunks[t].rows);
+        unmapFile(&file);
+        return 0;
+    }
+
+    if (report) memset(report, 0, sizeof(*report));
+
+    struct Journal *journal = list->journal;
+    clearList(list); // Clear the current list before loading
+    list->journal = NULL; // Rows are recorded by the checkpoint below, not one by one
+    int ok = reserveStudents(list, (int)total);
+
+    // Insert in file order; addStudents still rejects repeated rolls
+    int lineBase = 0;
+    for (int t = 0; t < threads; t++) {
+        ParseChunk *chunk = &chunks[t];
+        int before = list->count;
+        long long bytes = chunk->end - chunk->begin, reported = 0;
+        for (int at = 0; at < chunk->rowCount && ok; at += INSERT_BATCH) {
+            int batch = chunk->rowCount - at < INSERT_BATCH ? chunk->rowCount - at : INSERT_BATCH;
+            ok = !progressCancelled(progress) && addStudents(list, chunk->rows + at, batch, NULL);
+            long long due = bytes * (at + batch) / chunk->rowCount;
+            progressAdvance(progress, due - reported);
+            reported = due;
+        }
+        progressAdvance(progress, bytes - reported); // Chunks with no rows still count
+        if (report) {
+            report->duplicateRows += chunk->rowCount - (list->count - before);
+            report->malformedRows += chunk->malformed;
+            for (int i = 0; i < chunk->badLineCount && report->badLineCount < MAX_REPORTED_LINES; i++)
+                report->badLines[report->badLineCount++] = lineBase + chunk->badLines[i];
+        }
+        lineBase += chunk->lineCount;
+        free(chunk->rows);
+    }
+    if (!ok) {
+        clearList(list); // Out of memory or cancelled: don't leave half a file loaded
+        list->journal = journal;
+        unmapFile(&file);
+        return 0;
+    }
+    if (report) report->rowsLoaded = list->count;
+    buildRollOrder(list); // One sort now, not on the first range query (which retries if memory is short)
+
+    list->journal = journal;
+    if (journal) journalCheckpoint(journal, list);
+
+    unmapFile(&file);
+    return 1; // Success
+}
+
+// Progress runs to twice the file size: parsing counts bytes, inserting
+// counts each chunk's bytes again as its rows go in.
+int importCsvProgress(StudentList *list, const char *path, LoadReport *report, Progress *progress) {
+    PERF_BEGIN();
+    int ok = readCsv(list, path, report, progress);
+    PERF_END(PERF_LOAD);
+    return ok;
+}
+
+// --- Streaming ---
+// For stores that can't hold a whole file's rows (student_paged.c): parse
+// STREAM_CHUNK_BYTES at a time and hand each batch to add. The names point
+// into the mapped file, which is let go of as the chunks are used up, so
+// memory stays at about one chunk however big the file is.
+
+int streamCsv(const char *path, CsvBatch add, void *ctx, LoadReport *report) {
+    MappedFile file;
+    if (!mapFile(path, &file)) {
+        return 0; // Failure
+    }
+    PERF_COUNT(PERF_BYTES_READ, file.size);
+    if (report) memset(report, 0, sizeof(*report));
+
+    ParseChunk chunk;
+    memset(&chunk, 0, sizeof(chunk));
+    const char *start = file.data;
+    const char *end = file.data + file.size;
+    const char *released = file.data;
+    int lineBase = 0;
+    int ok = 1;
+    while (ok && start < end) {
+        const char *stop = (size_t)(end - start) > STREAM_CHUNK_BYTES ? start + STREAM_CHUNK_BYTES : end;
+        if (stop < end) {
+            const char *nl = memchr(stop, '\n', (size_t)(end - stop));
+            stop = nl ? nl + 1 : end;
+        }
+        chunk.begin = start;
+        chunk.end = stop;
+        chunk.rowCount = chunk.lineCount = chunk.malformed = chunk.badLineCount = 0;
+        parseChunk(&chunk);
+        int kept = chunk.failed ? -1 : add(ctx, chunk.rows, chunk.rowCount);
+        ok = kept >= 0;
+        if (ok && report) {
+            report->rowsLoaded += kept;
+            report->duplicateRows += chunk.rowCount - kept;
+            report->malformedRows += chunk.malformed;
+            for (int i = 0; i < chunk.badLineCount && report->badLineCount < MAX_REPORTED_LINES; i++)
+                report->badLines[report->badLineCount++] = lineBase + chunk.badLines[i];
+        }
+        lineBase += chunk.lineCount;
+        start = stop;
+#ifndef _WIN32
+        // Whole pages behind us go back to the kernel
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        const char *upTo = file.data + (size_t)(start - file.data) / page * page;
+        if (file.mapped && upTo > released) {
+            madvise((void *)released, (size_t)(upTo - released), MADV_DONTNEED);
+            released = upTo;
+        }
+#endif
+    }
+    free(chunk.rows);
+    unmapFile(&file);
+    (void)released;
+    return ok;
+}
@@ -0,0 +1,405 @@
+#include "student_journal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define truncateFile(fp, size) _chsize(_fileno(fp), (long)(size))
+#else
+#include <unistd.h>
+#define truncateFile(fp, size) ftruncate(fileno(fp), (off_t)(size))
+#endif
+
+// --- Record Format ---
+// Each record is  uint32 payloadLength | uint32 checksum | payload
+// and the payload starts with one opcode byte:
+//   OP_ADD     roll:int32 marks:float32 name:bytes
+//   OP_MODIFY  roll:int32 marks:float32 name:bytes (empty = keep, marks < 0 = keep)
+//   OP_REMOVE  roll:int32
+//   OP_SORT    keyCount:uint8 then keyCount x (field:uint8 descending:uint8)
+// A record whose length or checksum doesn't add up marks the torn end of a
+// journal that was being written when the process died.
+
+enum { OP_ADD = 1, OP_MODIFY = 2, OP_REMOVE = 3, OP_SORT = 4 };
+
+#define MAX_PAYLOAD (1 + 4 + 4 + 65536)
+
+static uint32_t payloadChecksum(const unsigned char *p, uint32_t len) {
+    uint32_t h = 2166136261U; // FNV-1a
+    for (uint32_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619U;
+    }
+    return h;
+}
+
+static void journalPath(const Journal *journal, unsigned long long generation, char *out, size_t size) {
+    snprintf(out, size, "%s.%llu", journal->prefix, generation);
+}
+
+static int fileExists(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (fp) fclose(fp);
+    return fp != NULL;
+}
+
+// --- Appending ---
+
+static void appendRecord(Journal *journal, const unsigned char *payload, uint32_t len) {
+    uint32_t header[2] = { len, payloadChecksum(payload, len) };
+
+    pthread_mutex_lock(&journal->lock);
+    if (journal->fp == NULL
+        || fwrite(header, sizeof(header), 1, journal->fp) != 1
+        || fwrite(payload, 1, len, journal->fp) != len) {
+        journal->failed = 1;
+    } else {
+        journal->bytesSinceCheckpoint += (long)(sizeof(header) + len);
+        journal->unsynced++;
+        if (journal->unsynced >= journal->syncEvery) {
+            if (!flushToDisk(journal->fp)) journal->failed = 1;
+            journal->unsynced = 0;
+        } else {
+            pthread_cond_signal(&journal->wake); // Let the flusher start its timer
+        }
+    }
+    // The list is still mid-update here: journalCheckpointIfDue runs it
+    // once the call that logged this record has finished
+    if (journal->bytesSinceCheckpoint > JOURNAL_AUTO_CHECKPOINT_BYTES) journal->checkpointDue = 1;
+    pthread_mutex_unlock(&journal->lock);
+}
+
+static uint32_t packHeader(unsigned char *buf, int op, int roll, float marks) {
+    buf[0] = (unsigned char)op;
+    memcpy(buf + 1, &roll, 4);
+    memcpy(buf + 5, &marks, 4);
+    return 9;
+}
+
+static void logRow(Journal *journal, int op, const char *name, int roll, float marks) {
+    unsigned char buf[MAX_PAYLOAD];
+    uint32_t len = packHeader(buf, op, roll, marks);
+    size_t nameLen = name ? strlen(name) : 0;
+    if (nameLen > MAX_PAYLOAD - len) nameLen = MAX_PAYLOAD - len;
+    memcpy(buf + len, name, nameLen);
+    appendRecord(journal, buf, len + (uint32_t)nameLen);
+}
+
+void journalLogAdd(Journal *journal, const char *name, int roll, float marks) {
+    logRow(journal, OP_ADD, name, roll, marks);
+}
+
+void journalLogModify(Journal *journal, int roll, const char *newName, float newMarks) {
+    logRow(journal, OP_MODIFY, newName, roll, newMarks);
+}
+
+void journalLogRemove(Journal *journal, int roll) {
+    unsigned char buf[9];
+    appendRecord(journal, buf, packHeader(buf, OP_REMOVE, roll, 0.0f) - 4);
+}
+
+void journalLogSort(Journal *journal, const SortKey *keys, int keyCount) {
+    unsigned char buf[2 + 2 * MAX_SORT_KEYS];
+    if (keyCount > MAX_SORT_KEYS) keyCount = MAX_SORT_KEYS;
+    buf[0] = OP_SORT;
+    buf[1] = (unsigned char)keyCount;
+    for (int k = 0; k < keyCount; k++) {
+        buf[2 + 2 * k] = (unsigned char)keys[k].field;
+        buf[3 + 2 * k] = (unsigned char)(keys[k].descending ? 1 : 0);
+    }
+    appendRecord(journal, buf, 2 + 2 * (uint32_t)keyCount);
+}
+
+// --- Group Commit ---
+
+static void *flusherMain(void *arg) {
+    Journal *journal = arg;
+    pthread_mutex_lock(&journal->lock);
+    while (!journal->stopping) {
+        if (journal->unsynced == 0) {
+            pthread_cond_wait(&journal->wake, &journal->lock);
+            continue;
+        }
+        // Give the batch syncDelayMs to fill up, then commit whatever is there
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += journal->syncDelayMs / 1000;
+        deadline.tv_nsec += (long)(journal->syncDelayMs % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&journal->wake, &journal->lock, &deadline);
+        if (journal->unsynced > 0 && journal->fp) {
+            if (!flushToDisk(journal->fp)) journal->failed = 1;
+            journal->unsynced = 0;
+        }
+    }
+    pthread_mutex_unlock(&journal->lock);
+    return NULL;
+}
+
+static void stopFlusher(Journal *journal) {
+    if (!journal->flusherRunning) return;
+    pthread_mutex_lock(&journal->lock);
+    journal->stopping = 1;
+    pthread_cond_signal(&journal->wake);
+    pthread_mutex_unlock(&journal->lock);
+    pthread_join(journal->flusher, NULL);
+    journal->flusherRunning = 0;
+    journal->stopping = 0;
+}
+
+void journalSetGroupCommit(Journal *journal, int syncEvery, int syncDelayMs) {
+    stopFlusher(journal);
+    journal->syncEvery = syncEvery < 1 ? 1 : syncEvery;
+    journal->syncDelayMs = syncDelayMs;
+    if (journal->syncEvery > 1 && syncDelayMs > 0) {
+        journal->flusherRunning = pthread_create(&journal->flusher, NULL, flusherMain, journal) == 0;
+    }
+}
+
+int journalSync(Journal *journal) {
+    pthread_mutex_lock(&journal->lock);
+    if (journal->fp && !flushToDisk(journal->fp)) journal->failed = 1;
+    journal->unsynced = 0;
+    int ok = !journal->failed;
+    pthread_mutex_unlock(&journal->lock);
+    return ok;
+}
+
+// --- Checkpoints ---
+
+static void *checkpointMain(void *arg) {
+    Journal *journal = arg;
+    StudentList *copy = &journal->checkpointCopy;
+
+    int ok = saveSnapshotAt(copy, journal->snapshotPath, journal->checkpointGeneration);
+    if (ok && journal->csvPath[0] != '\0') {
+        ok = exportCsv(copy, journal->csvPath);
+    }
+    if (ok) {
+        // The new snapshot covers every older journal
+        char path[600];
+        for (unsigned long long g = journal->baseGeneration; g < journal->checkpointGeneration; g++) {
+            journalPath(journal, g, path, sizeof(path));
+            remove(path);
+        }
+    }
+    freeList(copy);
+    journal->checkpointResult = ok;
+    return NULL;
+}
+
+int journalWaitCheckpoint(Journal *journal) {
+    if (journal->checkpointActive) {
+        pthread_join(journal->checkpointer, NULL);
+        pthread_mutex_lock(&journal->lock);
+        journal->checkpointActive = 0;
+        if (journal->checkpointResult) journal->baseGeneration = journal->checkpointGeneration;
+        pthread_mutex_unlock(&journal->lock);
+    }
+    return journal->checkpointResult;
+}
+
+int journalCheckpoint(Journal *journal, StudentList *list) {
+    journalWaitCheckpoint(journal);
+    journal->list = list;
+    list->journal = journal;
+
+    // Take a private copy first: it is the state the snapshot will hold
+    StudentList *copy = &journal->checkpointCopy;
+    initList(copy);
+    if (!copyList(copy, list)) {
+        return 0; // Failure: the journal still has everything
+    }
+
+    // Rotate, so appends made while the snapshot is written land in a
+    // journal that the snapshot does not claim to cover
+    char path[600];
+    pthread_mutex_lock(&journal->lock);
+    if (journal->fp) {
+        if (!flushToDisk(journal->fp)) journal->failed = 1;
+        fclose(journal->fp);
+    }
+    journal->generation++;
+    journalPath(journal, journal->generation, path, sizeof(path));
+    journal->fp = fopen(path, "wb"); // A new generation starts empty
+    if (journal->fp == NULL) journal->failed = 1;
+    journal->unsynced = 0;
+    journal->bytesSinceCheckpoint = 0;
+    journal->checkpointGeneration = journal->generation;
+    journal->checkpointResult = 0;
+    journal->checkpointActive = 1;
+    pthread_mutex_unlock(&journal->lock);
+
+    if (pthread_create(&journal->checkpointer, NULL, checkpointMain, journal) != 0) {
+        checkpointMain(journal); // No thread available: checkpoint inline
+        journal->checkpointActive = 0;
+        if (journal->checkpointResult) journal->baseGeneration = journal->checkpointGeneration;
+        return journal->checkpointResult;
+    }
+    return 1; // Started
+}
+
+void journalCheckpointIfDue(Journal *journal) {
+    pthread_mutex_lock(&journal->lock);
+    int due = journal->checkpointDue && journal->list != NULL;
+    journal->checkpointDue = 0;
+    pthread_mutex_unlock(&journal->lock);
+    if (due) journalCheckpoint(journal, journal->list); // Waits for a previous one first
+}
+
+// --- Recovery ---
+
+static int applyRecord(StudentList *list, const unsigned char *p, uint32_t len) {
+    int roll;
+    float marks;
+    char name[MAX_PAYLOAD];
+
+    switch (p[0]) {
+        case OP_ADD:
+        case OP_MODIFY:
+            if (len < 9) return 0;
+            memcpy(&roll, p + 1, 4);
+            memcpy(&marks, p + 5, 4);
+            memcpy(name, p + 9, len - 9);
+            name[len - 9] = '\0';
+            if (p[0] == OP_ADD) addStudent(list, name, roll, marks);
+            else modifyStudent(list, roll, name, marks);
+            return 1;
+        case OP_REMOVE:
+            if (len < 5) return 0;
+            memcpy(&roll, p + 1, 4);
+            removeStudent(list, roll);
+            return 1;
+        case OP_SORT: {
+            SortKey keys[MAX_SORT_KEYS];
+            int keyCount = len >= 2 ? p[1] : 0;
+            if (keyCount > MAX_SORT_KEYS || len != 2 + 2 * (uint32_t)keyCount) return 0;
+            for (int k = 0; k < keyCount; k++) {
+                if (p[2 + 2 * k] > SORT_BY_NAME) return 0;
+                keys[k].field = (SortField)p[2 + 2 * k];
+                keys[k].descending = p[3 + 2 * k];
+            }
+            sortStudentsBy(list, keys, keyCount);
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+// Applies every intact record of one journal file. A torn or corrupt tail is
+// cut off so that new appends start from a clean record boundary.
+static long replayFile(Journal *journal, StudentList *list, const char *path) {
+    FILE *fp = fopen(path, "rb+");
+    if (!fp) {
+        return 0;
+    }
+    unsigned char *payload = malloc(MAX_PAYLOAD);
+    long good = 0;
+    uint32_t header[2];
+    while (payload && fread(header, sizeof(header), 1, fp) == 1) {
+        if (header[0] == 0 || header[0] > MAX_PAYLOAD
+            || fread(payload, 1, header[0], fp) != header[0]
+            || payloadChecksum(payload, header[0]) != header[1]
+            || !applyRecord(list, payload, header[0])) {
+            break;
+        }
+        good += (long)sizeof(header) + (long)header[0];
+        journal->replayed++;
+    }
+    fseek(fp, 0, SEEK_END);
+    if (ftell(fp) > good) {
+        journal->tornTail = 1;
+        fflush(fp);
+        if (truncateFile(fp, good) != 0) journal->failed = 1;
+    }
+    free(payload);
+    fclose(fp);
+    return good;
+}
+
+int journalOpen(Journal *journal, StudentList *list, const char *snapshotPath,
+                const char *csvPath, const char *prefix) {
+    memset(journal, 0, sizeof(*journal));
+    snprintf(journal->snapshotPath, sizeof(journal->snapshotPath), "%s", snapshotPath);
+    snprintf(journal->csvPath, sizeof(journal->csvPath), "%s", csvPath ? csvPath : "");
+    snprintf(journal->prefix, sizeof(journal->prefix), "%s", prefix);
+    pthread_mutex_init(&journal->lock, NULL);
+    pthread_cond_init(&journal->wake, NULL);
+    journal->syncEvery = 1;
+    journal->checkpointResult = 1; // Nothing has failed yet
+    initList(&journal->checkpointCopy);
+
+    list->journal = NULL; // Replay must not log itself
+    unsigned long long sequence = 0;
+    char path[600];
+    if (!openSnapshotAt(list, snapshotPath, SNAPSHOT_VERIFY, &sequence)) { // A torn snapshot is not trusted
+        clearList(list);
+        sequence = 0;
+        if (fileExists(snapshotPath)) {
+            // The journals it covers were deleted when it was written. The CSV
+            // written by the same checkpoint stands in for it, and replay starts
+            // at the oldest journal kept since (older ones survive when that
+            // checkpoint's cleanup or CSV export did not finish; records the
+            // CSV already holds replay as refused adds and repeated updates).
+            journal->badSnapshot = 1;
+            if (!snapshotSequence(snapshotPath, &sequence) || journal->csvPath[0] == '\0'
+                || !loadFromFile(list, journal->csvPath)) {
+                clearList(list);
+                return 0; // Failure: nothing to replay the journals onto; no file touched
+            }
+            journal->fromCsv = 1;
+            while (sequence > 0) {
+                journalPath(journal, sequence - 1, path, sizeof(path));
+                if (!fileExists(path)) break;
+                sequence--;
+            }
+        }
+    }
+
+    // Leftovers from a checkpoint that died between its rename and cleanup
+    for (unsigned long long g = sequence; g > 0 && !journal->fromCsv; g--) {
+        journalPath(journal, g - 1, path, sizeof(path));
+        if (remove(path) != 0) break;
+    }
+
+    unsigned long long generation = sequence;
+    for (;;) {
+        journalPath(journal, generation, path, sizeof(path));
+        if (!fileExists(path)) break;
+        journal->bytesSinceCheckpoint += replayFile(journal, list, path);
+        generation++;
+    }
+
+    // A fresh generation: nothing this session logs may follow records
+    // that were just replayed (or skipped as torn)
+    journal->baseGeneration = sequence;
+    journal->generation = generation;
+    journalPath(journal, generation, path, sizeof(path));
+    journal->fp = fopen(path, "wb");
+    if (journal->fp == NULL) {
+        return 0; // Failure: list is recovered but not journaled
+    }
+    journal->list = list;
+    list->journal = journal;
+    if (journal->fromCsv) {
+        journalCheckpoint(journal, list); // Replace the damaged snapshot now
+    }
+    return 1; // Success
+}
+
+void journalClose(Journal *journal) {
+    stopFlusher(journal);
+    journalWaitCheckpoint(journal);
+    journalSync(journal);
+    if (journal->fp) fclose(journal->fp);
+    journal->fp = NULL;
+    if (journal->list) journal->list->journal = NULL;
+    journal->list = NULL;
+    pthread_mutex_destroy(&journal->lock);
+    pthread_cond_destroy(&journal->wake);
+}
@@ -0,0 +1,80 @@
+#ifndef STUDENT_JOURNAL_H
+#define STUDENT_JOURNAL_H
+
+#include <pthread.h>
+#include "student_logic.h"
+
+// Write-ahead journal for a StudentList.
+//
+// Every successful addStudent / modifyStudent / removeStudent / sortStudentsBy
+// on a list with an attached journal appends one small record to
+// <prefix>.<generation>. A checkpoint rotates to the next generation, writes a
+// fresh snapshot (tagged with that generation) plus the CSV in a background
+// thread, then deletes the journals the snapshot now covers. Recovery is
+// "open snapshot, replay every journal from its generation onwards".
+
+#define JOURNAL_PREFIX "students.wal"
+#define JOURNAL_AUTO_CHECKPOINT_BYTES (64L * 1024 * 1024) // Compact once the log gets this big
+
+typedef struct Journal {
+    char snapshotPath[512];
+    char csvPath[512];          // Also rewritten by checkpoints; "" to skip
+    char prefix[512];
+    unsigned long long baseGeneration; // Generation the current snapshot starts replay from
+    unsigned long long generation;     // Generation being appended to
+    FILE *fp;
+    long bytesSinceCheckpoint;
+    StudentList *list;          // The list this journal is attached to
+
+    // Group commit: fsync once syncEvery records are pending, or once the
+    // oldest pending record is syncDelayMs old (checked by a flusher thread)
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t flusher;
+    int flusherRunning;
+    int stopping;
+    int syncEvery;
+    int syncDelayMs;
+    int unsynced;
+
+    // Background checkpoint
+    pthread_t checkpointer;
+    int checkpointActive;
+    int checkpointResult;
+    StudentList checkpointCopy;
+    unsigned long long checkpointGeneration;
+    int checkpointDue;   // The log outgrew JOURNAL_AUTO_CHECKPOINT_BYTES
+
+    int failed;          // Sticky: an append or sync failed
+    int replayed;        // Records replayed by journalOpen
+    int tornTail;        // journalOpen found (and cut off) a partial last record
+    int badSnapshot;     // journalOpen found a snapshot that failed its checksum
+    int fromCsv;         // ... and rebuilt the list from the CSV plus the journals kept since
+} Journal;
+
+// Recovers list from snapshot + journals and attaches the journal to it.
+// A damaged snapshot is replaced by the CSV of the same checkpoint (then a
+// new checkpoint is taken); if even that is not possible it returns 0 with
+// badSnapshot set, an empty list, and no file changed.
+int journalOpen(Journal *journal, StudentList *list, const char *snapshotPath,
+                const char *csvPath, const char *prefix);
+void journalClose(Journal *journal); // Syncs, waits for any checkpoint, detaches
+
+void journalSetGroupCommit(Journal *journal, int syncEvery, int syncDelayMs);
+int journalSync(Journal *journal);
+
+// Starts a background checkpoint (waits for a previous one first).
+// Also (re)attaches the journal to list.
+int journalCheckpoint(Journal *journal, StudentList *list);
+int journalWaitCheckpoint(Journal *journal); // 1 if the last checkpoint succeeded (or none ran)
+// Starts the automatic checkpoint once the log has grown too big. Called by
+// the public list calls after their mutation is complete, never mid-update.
+void journalCheckpointIfDue(Journal *journal);
+
+// Called by student_logic.c / student_sort.c after a mutation succeeds
+void journalLogAdd(Journal *journal, const char *name, int roll, float marks);
+void journalLogModify(Journal *journal, int roll, const char *newName, float newMarks);
+void journalLogRemove(Journal *journal, int roll);
+void journalLogSort(Journal *journal, const SortKey *keys, int keyCount);
+
+#endif // STUDENT_JOURNAL_H
@@ -1,164 +1,759 @@
 #include "student_logic.h"
+#include "student_journal.h"
+#include "student_perf.h"
 #include <stdlib.h>
 #include <string.h>
 
 // --- List Management ---
 
 void initList(StudentList *list) {
-    list->students = NULL;
-    list->count = 0;
-    list->capacity = 0;
+    initListLayout(list, LAYOUT_ROWS);
+}
+
+void initListLayout(StudentList *list, StudentLayout layout) {
+    memset(list, 0, sizeof(*list));
+    list->layout = layout;
+}
+
+// Grows array to count elements. On failure the old block is left as it was.
+static int growArray(void **array, size_t count, size_t elemSize) {
+    void *grown = realloc(*array, count * elemSize);
+    if (grown == NULL) {
+        return 0; // Failure: out of memory
+    }
+    *array = grown;
+    return 1;
+}
+
+// A list opened from a snapshot points straight into the mapped file.
+// Before any column has to be reallocated, copy everything to the heap and
+// drop the mapping (in-place writes before that hit private, copy-on-write
+// pages and never reach the file).
+static int detachMapping(StudentList *list) {
+    if (list->mapping.data == NULL) {
+        return 1;
+    }
+    size_t n = (size_t)list->capacity; // Keep room for a row being added right now
+    size_t used = (size_t)list->count;
+    int *rolls = malloc(n * sizeof(int) + 1);
+    float *marks = malloc(n * sizeof(float) + 1);
+    unsigned *offsets = malloc(n * sizeof(unsigned) + 1);
+    unsigned *lengths = malloc(n * sizeof(unsigned) + 1);
+    char *arena = malloc(list->arenaUsed + 1);
+    if (!rolls || !marks || !offsets || !lengths || !arena) {
+        free(rolls); free(marks); free(offsets); free(lengths); free(arena);
+        return 0; // Failure: still mapped, nothing changed
+    }
+    memcpy(rolls, list->rolls, used * sizeof(int));
+    memcpy(marks, list->marks, used * sizeof(float));
+    memcpy(offsets, list->nameOffsets, used * sizeof(unsigned));
+    memcpy(lengths, list->nameLengths, used * sizeof(unsigned));
+    memcpy(arena, list->nameArena, list->arenaUsed);
+    list->rolls = rolls;
+    list->marks = marks;
+    list->nameOffsets = offsets;
+    list->nameLengths = lengths;
+    list->nameArena = arena;
+    list->arenaCapacity = list->arenaUsed;
+    unmapFile(&list->mapping);
+    return 1;
 }
 
 void freeList(StudentList *list) {
+    StudentLayout layout = list->layout;
+    if (list->mapping.data != NULL) {
+        unmapFile(&list->mapping); // Columns live inside the mapping
+    } else {
+        free(list->rolls);
+        free(list->marks);
+        free(list->nameOffsets);
+        free(list->nameLengths);
+        free(list->nameArena);
+    }
     free(list->students);
-    list->students = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
-
-void ensureCapacity(StudentList *list) {
-    if (list->count >= list->capacity) {
-        list->capacity = list->capacity == 0 ? 4 : list->capacity * 2;
-        list->students = realloc(list->students, list->capacity * sizeof(Student));
-        if (list->students == NULL) {
-            fprintf(stderr, "Memory allocation failed!\n"); // Error to stderr
-            exit(EXIT_FAILURE);
+    free(list->index);
+    disableNameIndex(list);
+    freeRollOrder(list);
+    freeChangeFeed(list);
+    disableHistory(list);
+    initListLayout(list, layout);
+}
+
+void clearList(StudentList *list) {
+    struct Journal *journal = list->journal;
+    struct NameIndex *names = list->names;
+    struct ChangeFeed *changes = list->changes;
+    struct History *history = list->history;
+    list->names = NULL;
+    list->changes = NULL;
+    list->history = NULL;
+    freeList(list);
+    list->journal = journal;
+    list->names = names;
+    list->changes = changes;
+    list->history = history;
+    if (names) nameIndexReset(names); // Stays enabled, now empty
+    if (changes) changeFeedReset(changes);
+    if (history) historyReset(history);
+}
+
+// Swaps in a list built elsewhere (typically loaded on another thread) in
+// one step. If src already carries a name index it replaces list's, so the
+// caller can build it off the main thread too. With a journal attached the
+// new contents are checkpointed, as after a load.
+int adoptList(StudentList *list, StudentList *src) {
+    struct Journal *journal = list->journal;
+    struct ChangeFeed *changes = list->changes;
+    struct History *history = list->history;
+    int indexed = list->names != NULL;
+    if (!indexed) disableNameIndex(src); // list had no index; don't start one
+    src->journal = NULL;
+    freeChangeFeed(src);
+    disableHistory(src);
+    list->changes = NULL;
+    list->history = NULL;
+    freeList(list); // Drops list's old name index too
+
+    *list = *src;
+    initListLayout(src, src->layout);
+    list->journal = journal;
+    list->changes = changes;
+    list->history = history;
+    if (changes) changeFeedReset(changes);
+    if (history) historyReset(history);
+    int ok = !indexed || list->names != NULL || enableNameIndex(list);
+    if (journal) ok = journalCheckpoint(journal, list) && ok;
+    return ok;
+}
+
+int ensureCapacity(StudentList *list) {
+    if (list->count < list->capacity) {
+        return 1;
+    }
+    return reserveStudents(list, list->capacity == 0 ? 4 : list->capacity * 2);
+}
+
+// Makes room for `extra` more name bytes (plus NUL) in the arena.
+static int reserveArena(StudentList *list, size_t extra) {
+    if (list->arenaUsed + extra + 1 <= list->arenaCapacity) {
+        return 1;
+    }
+    if (!detachMapping(list)) {
+        return 0;
+    }
+    size_t capacity = list->arenaCapacity == 0 ? 256 : list->arenaCapacity;
+    while (capacity < list->arenaUsed + extra + 1) {
+        capacity *= 2;
+    }
+    if (!growArray((void **)&list->nameArena, capacity, 1)) {
+        return 0;
+    }
+    list->arenaCapacity = capacity;
+    return 1;
+}
+
+static int arenaAppend(StudentList *list, const char *name, size_t len, unsigned *offset) {
+    // The name may itself live in the arena (e.g. copied from another row)
+    const char *arena = list->nameArena;
+    int inArena = arena != NULL && name >= arena && name < arena + list->arenaUsed;
+    size_t from = inArena ? (size_t)(name - arena) : 0;
+    if (!reserveArena(list, len)) {
+        return 0;
+    }
+    if (inArena) name = list->nameArena + from;
+    *offset = (unsigned)list->arenaUsed;
+    memcpy(list->nameArena + *offset, name, len);
+    list->nameArena[*offset + len] = '\0';
+    list->arenaUsed += len + 1;
+    return 1;
+}
+
+// Rewrites the arena with only the live names, in row order. Run once
+// replaced/removed names take up more than half of it.
+static void compactArena(StudentList *list) {
+    size_t live = list->arenaUsed - list->arenaGarbage;
+    char *arena = malloc(live + 1);
+    if (arena == NULL || !detachMapping(list)) {
+        free(arena);
+        return; // Not fatal: the garbage just stays around a while longer
+    }
+    size_t at = 0;
+    for (int i = 0; i < list->count; i++) {
+        size_t len = list->nameLengths[i];
+        memcpy(arena + at, list->nameArena + list->nameOffsets[i], len + 1);
+        list->nameOffsets[i] = (unsigned)at;
+        at += len + 1;
+    }
+    free(list->nameArena);
+    list->nameArena = arena;
+    list->arenaUsed = at;
+    list->arenaCapacity = live + 1;
+    list->arenaGarbage = 0;
+}
+
+static void releaseName(StudentList *list, int i) {
+    list->arenaGarbage += list->nameLengths[i] + 1;
+}
+
+static void maybeCompactArena(StudentList *list) {
+    if (list->arenaGarbage > 4096 && list->arenaGarbage * 2 > list->arenaUsed) {
+        compactArena(list);
+    }
+}
+
+// Stores name for row i, truncating only in the row layout. Fails (leaving
+// row i as it was) only if the arena cannot grow.
+static int setName(StudentList *list, int i, const char *name, size_t len) {
+    if (list->layout == LAYOUT_ROWS) {
+        if (len > NAME_LEN - 1) len = NAME_LEN - 1;
+        memcpy(list->students[i].name, name, len);
+        list->students[i].name[len] = '\0'; // Ensure null termination
+    } else if (i < list->count && len <= list->nameLengths[i]) {
+        // Fits over the old name: overwrite in place
+        char *slot = list->nameArena + list->nameOffsets[i];
+        memcpy(slot, name, len);
+        slot[len] = '\0';
+        list->arenaGarbage += list->nameLengths[i] - len;
+        list->nameLengths[i] = (unsigned)len;
+    } else {
+        unsigned offset;
+        if (!arenaAppend(list, name, len, &offset)) { // May move the columns
+            return 0;
         }
+        if (i < list->count) releaseName(list, i);
+        list->nameOffsets[i] = offset;
+        list->nameLengths[i] = (unsigned)len;
     }
+    return 1;
 }
 
-// --- Core Data Operations ---
+int copyList(StudentList *dst, const StudentList *src) {
+    dst->layout = src->layout;
+    dst->count = 0;     // dst may hold an earlier copy: overwrite it in place
+    dst->arenaUsed = 0;
+    dst->arenaGarbage = 0;
+    if (src->count > 0) {
+        if (!reserveStudents(dst, src->count)) {
+            return 0; // Failure: out of memory
+        }
+        if (src->layout == LAYOUT_ROWS) {
+            memcpy(dst->students, src->students, (size_t)src->count * sizeof(Student));
+        } else {
+            if (!reserveArena(dst, src->arenaUsed)) {
+                return 0;
+            }
+            memcpy(dst->rolls, src->rolls, (size_t)src->count * sizeof(int));
+            memcpy(dst->marks, src->marks, (size_t)src->count * sizeof(float));
+            memcpy(dst->nameOffsets, src->nameOffsets, (size_t)src->count * sizeof(unsigned));
+            memcpy(dst->nameLengths, src->nameLengths, (size_t)src->count * sizeof(unsigned));
+            memcpy(dst->nameArena, src->nameArena, src->arenaUsed);
+            dst->arenaUsed = src->arenaUsed;
+            dst->arenaGarbage = src->arenaGarbage;
+        }
+    }
+    dst->count = src->count;
+    dst->stats = src->stats;
+    if (dst->changes) changeFeedReset(dst->changes);
+    if (dst->history) historyReset(dst->history);
+    copyRollOrder(dst, src); // If memory runs out it is rebuilt on first use
+    return rebuildIndex(dst);
+}
 
-int addStudent(StudentList *list, const char* name, int roll, float marks) {
-    // Check if roll number already exists
-    if (searchStudent(list, roll) != -1) {
-        return 0; // Failure: Roll number already exists
-    }
-    
-    ensureCapacity(list);
-    Student s;
-    strncpy(s.name, name, NAME_LEN - 1);
-    s.name[NAME_LEN - 1] = '\0'; // Ensure null termination
-    s.roll = roll;
-    s.marks = marks;
-
-    list->students[list->count++] = s;
-    return 1; // Success
+int setListLayout(StudentList *list, StudentLayout layout) {
+    if (list->layout == layout) {
+        return 1;
+    }
+    StudentList converted;
+    initListLayout(&converted, layout);
+    if (!reserveStudents(&converted, list->count)) {
+        freeList(&converted);
+        return 0; // Failure: list left as it was
+    }
+    for (int i = 0; i < list->count; i++) {
+        const char *name = studentName(list, i);
+        if (!setName(&converted, i, name, strlen(name))) {
+            freeList(&converted);
+            return 0;
+        }
+        if (layout == LAYOUT_ROWS) {
+            converted.students[i].roll = list->rolls[i];
+            converted.students[i].marks = list->marks[i];
+        } else {
+            converted.rolls[i] = list->students[i].roll;
+            converted.marks[i] = list->students[i].marks;
+        }
+        converted.count = i + 1;
+    }
+    converted.stats = list->stats;
+    converted.journal = list->journal;
+    converted.names = list->names; // Keyed by roll, so still valid
+    converted.order = list->order;
+    converted.changes = list->changes;
+    converted.history = list->history;
+    list->names = NULL;
+    list->order = NULL;
+    list->changes = NULL;
+    list->history = NULL;
+    if (converted.changes) changeFeedReset(converted.changes); // Name pointers moved
+    if (converted.history) historyReset(converted.history); // Row names may have been cut to NAME_LEN
+    freeList(list);
+    *list = converted;
+    return rebuildIndex(list); // Reserved above, so this rebuilds in place
 }
 
-int modifyStudent(StudentList *list, int roll, const char* newName, float newMarks) {
-    int idx = searchStudent(list, roll);
-    if (idx == -1) {
-        return 0; // Failure: Student not found
+size_t listMemoryUsage(const StudentList *list) {
+    if (list->layout == LAYOUT_ROWS) {
+        return (size_t)list->capacity * sizeof(Student);
     }
+    return (size_t)list->capacity * (sizeof(int) + sizeof(float) + 2 * sizeof(unsigned))
+         + list->arenaCapacity;
+}
 
-    // Only update if newName is not empty
-    if (newName != NULL && strlen(newName) > 0) {
-        strncpy(list->students[idx].name, newName, NAME_LEN - 1);
-        list->students[idx].name[NAME_LEN - 1] = '\0';
+// --- Roll Number Index ---
+// Open-addressing hash table (linear probing) from roll number to slot in
+// list->students. It is kept at most half full so probe chains stay short,
+// and deletions use backward shifting so no tombstones ever accumulate.
+
+static unsigned hashRoll(int roll) {
+    unsigned h = (unsigned)roll; // Integer mixer so clustered rolls still spread out
+    h ^= h >> 16;
+    h *= 0x7feb352dU;
+    h ^= h >> 15;
+    h *= 0x846ca68bU;
+    h ^= h >> 16;
+    return h;
+}
+
+// Returns the bucket holding roll, or -1 if it is not indexed.
+static int indexFind(const StudentList *list, int roll) {
+    if (list->indexCapacity == 0) {
+        return -1;
+    }
+    unsigned mask = (unsigned)list->indexCapacity - 1;
+    unsigned i = hashRoll(roll) & mask;
+    while (list->index[i].slot != -1) {
+        if (list->index[i].roll == roll)
+            return (int)i;
+        i = (i + 1) & mask;
+    }
+    return -1;
+}
+
+static void indexPut(StudentList *list, int roll, int slot) {
+    unsigned mask = (unsigned)list->indexCapacity - 1;
+    unsigned i = hashRoll(roll) & mask;
+    while (list->index[i].slot != -1) {
+        i = (i + 1) & mask;
+    }
+    list->index[i].roll = roll;
+    list->index[i].slot = slot;
+}
+
+// Empties the table and re-inserts every student currently in the list.
+static void indexRefill(StudentList *list) {
+    for (int i = 0; i < list->indexCapacity; i++) {
+        list->index[i].slot = -1;
+    }
+    for (int i = 0; i < list->count; i++) {
+        indexPut(list, studentRoll(list, i), i);
+    }
+}
+
+// Reallocates the table so that it can hold `needed` entries at <= 50% load,
+// then refills it. On failure the old table is kept untouched.
+static int indexResize(StudentList *list, int needed) {
+    int newCapacity = 16;
+    while (newCapacity < needed * 2) {
+        newCapacity *= 2;
+    }
+    RollIndexEntry *table = malloc((size_t)newCapacity * sizeof(RollIndexEntry));
+    if (table == NULL) {
+        return 0; // Failure: out of memory
+    }
+    free(list->index);
+    list->index = table;
+    list->indexCapacity = newCapacity;
+    indexRefill(list);
+    return 1;
+}
+
+static void indexRemove(StudentList *list, int roll) {
+    int pos = indexFind(list, roll);
+    if (pos == -1) {
+        return;
+    }
+    // Backward-shift deletion: pull later entries of the probe chain into
+    // the hole unless they already sit between their home bucket and it.
+    unsigned mask = (unsigned)list->indexCapacity - 1;
+    unsigned i = (unsigned)pos;
+    unsigned j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (list->index[j].slot == -1)
+            break;
+        unsigned home = hashRoll(list->index[j].roll) & mask;
+        int staysPut = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (staysPut)
+            continue;
+        list->index[i] = list->index[j];
+        i = j;
+    }
+    list->index[i].slot = -1;
+}
+
+// After rows above `row` moved down one place: fixes their slots. A short
+// tail is re-probed row by row; otherwise one sequential pass over the
+// table is cheaper than a random probe per shifted row.
+static void indexShiftDown(StudentList *list, int row) {
+    if ((list->count - row) * 16 < list->indexCapacity) {
+        for (int i = row; i < list->count; i++) {
+            list->index[indexFind(list, studentRoll(list, i))].slot = i;
+        }
+        return;
+    }
+    for (int i = 0; i < list->indexCapacity; i++) {
+        if (list->index[i].slot > row) list->index[i].slot--;
     }
-    
-    // Only update if newMarks is not the signal value (-1)
-    if (newMarks >= 0) {
-        list->students[idx].marks = newMarks;
+}
+
+int rebuildIndex(StudentList *list) {
+    // A reorder keeps the count, so the existing table is normally big
+    // enough and needs no allocation
+    if (list->indexCapacity > 0 && list->count * 2 <= list->indexCapacity) {
+        indexRefill(list);
+        return 1;
     }
+    return indexResize(list, list->count);
+}
 
+// Grows the storage and the roll index up front so that `capacity` students
+// can be added without any further reallocation (used by bulk loads).
+// Returns 0, with the list unchanged, if memory runs out.
+int reserveStudents(StudentList *list, int capacity) {
+    if (capacity > list->capacity) {
+        size_t n = (size_t)capacity;
+        if (list->layout == LAYOUT_ROWS) {
+            if (!growArray((void **)&list->students, n, sizeof(Student))) return 0;
+        } else {
+            // A column that grows before a later one fails is harmless:
+            // capacity only moves once they all have
+            if (!detachMapping(list)
+                || !growArray((void **)&list->rolls, n, sizeof(int))
+                || !growArray((void **)&list->marks, n, sizeof(float))
+                || !growArray((void **)&list->nameOffsets, n, sizeof(unsigned))
+                || !growArray((void **)&list->nameLengths, n, sizeof(unsigned))) {
+                return 0;
+            }
+        }
+        list->capacity = capacity;
+        PERF_COUNT(PERF_REALLOCS, 1);
+    }
+    if (capacity * 2 > list->indexCapacity) {
+        return indexResize(list, capacity);
+    }
     return 1; // Success
 }
 
-int removeStudent(StudentList *list, int roll) {
-    int idx = searchStudent(list, roll);
+// --- Core Data Operations ---
+
+// Appends one row. Shared by addStudentLen and addStudents.
+static RowResult insertRow(StudentList *list, const char *name, size_t nameLen, int roll, float marks) {
+    // Check if roll number already exists
+    if (findStudentRow(list, roll) != -1) {
+        return ROW_DUPLICATE;
+    }
+    if (!ensureCapacity(list)) {
+        return ROW_NO_MEMORY;
+    }
+    if ((list->count + 1) * 2 > list->indexCapacity && !indexResize(list, list->count + 1)) {
+        return ROW_NO_MEMORY;
+    }
+    int i = list->count;
+    if (!setName(list, i, name, nameLen)) {
+        return ROW_NO_MEMORY;
+    }
+    if (list->layout == LAYOUT_ROWS) {
+        list->students[i].roll = roll;
+        list->students[i].marks = marks;
+    } else {
+        list->rolls[i] = roll;
+        list->marks[i] = marks;
+    }
+    indexPut(list, roll, i);
+    list->count++;
+    statsAdd(&list->stats, marks);
+    if (list->changes) changeFeedAdded(list->changes);
+    if (list->history) historyAdded(list->history, list);
+    if (list->names) nameIndexAdd(list->names, studentName(list, i), strlen(studentName(list, i)), roll);
+    if (list->order) rollOrderAdd(list->order, roll);
+
+    if (list->journal) journalLogAdd(list->journal, studentName(list, i), roll, marks);
+    return ROW_OK;
+}
+
+int addStudent(StudentList *list, const char* name, int roll, float marks) {
+    return addStudentLen(list, name, strlen(name), roll, marks);
+}
+
+int addStudentLen(StudentList *list, const char *name, size_t nameLen, int roll, float marks) {
+    PERF_BEGIN_SAMPLED();
+    int ok = insertRow(list, name, nameLen, roll, marks) == ROW_OK; // 0: duplicate roll (or out of memory)
+    PERF_END(PERF_ADD);
+    if (list->journal) journalCheckpointIfDue(list->journal); // Now that the list is consistent
+    return ok;
+}
+
+static int modifyRows(StudentList *list, const StudentUpdate *updates, int n, RowResult *results);
+
+int modifyStudent(StudentList *list, int roll, const char* newName, float newMarks) {
+    PERF_BEGIN_SAMPLED();
+    StudentUpdate update = { roll, newName, newMarks };
+    RowResult result;
+    modifyRows(list, &update, 1, &result);
+    PERF_END(PERF_MODIFY);
+    if (list->journal) journalCheckpointIfDue(list->journal);
+    return result == ROW_OK;
+}
+
+static int removeRow(StudentList *list, int roll) {
+    int idx = findStudentRow(list, roll);
     if (idx == -1) {
         return 0; // Failure: Student not found
     }
-    for (int i = idx; i < list->count - 1; i++) {
-        list->students[i] = list->students[i + 1];
+    indexRemove(list, roll);
+    statsRemove(&list->stats, studentMarks(list, idx));
+    if (list->names) nameIndexRemove(list->names, studentName(list, idx), strlen(studentName(list, idx)), roll);
+    if (list->order) rollOrderRemove(list->order, roll);
+    size_t tail = (size_t)(list->count - idx - 1);
+    if (list->layout == LAYOUT_ROWS) {
+        memmove(&list->students[idx], &list->students[idx + 1], tail * sizeof(Student));
+    } else {
+        releaseName(list, idx);
+        memmove(&list->rolls[idx], &list->rolls[idx + 1], tail * sizeof(int));
+        memmove(&list->marks[idx], &list->marks[idx + 1], tail * sizeof(float));
+        memmove(&list->nameOffsets[idx], &list->nameOffsets[idx + 1], tail * sizeof(unsigned));
+        memmove(&list->nameLengths[idx], &list->nameLengths[idx + 1], tail * sizeof(unsigned));
     }
     list->count--;
+    if (list->changes) changeFeedRemoved(list->changes, idx);
+    if (list->history) historyRemoved(list->history, idx);
+
+    indexShiftDown(list, idx); // Everything after idx moved down one slot
+    if (list->layout == LAYOUT_COLUMNS) maybeCompactArena(list);
+
+    if (list->journal) journalLogRemove(list->journal, roll);
     return 1; // Success
 }
 
-int searchStudent(const StudentList *list, int roll) {
-    for (int i = 0; i < list->count; i++) {
-        if (list->students[i].roll == roll)
-            return i;
+int removeStudent(StudentList *list, int roll) {
+    PERF_BEGIN();
+    int ok = removeRow(list, roll);
+    PERF_END(PERF_REMOVE);
+    if (list->journal) journalCheckpointIfDue(list->journal);
+    return ok;
+}
+
+int findStudentRow(const StudentList *list, int roll) {
+    int pos = indexFind(list, roll);
+    if (pos == -1) {
+        return -1; // Not found
     }
-    return -1; // Not found
+    return list->index[pos].slot;
 }
 
-// --- Data Processing ---
+int searchStudent(const StudentList *list, int roll) {
+    PERF_BEGIN_SAMPLED();
+    int row = findStudentRow(list, roll);
+    PERF_END(PERF_SEARCH);
+    return row;
+}
 
-void sortStudents(StudentList *list, int ascending) {
-    for (int i = 0; i < list->count - 1; i++) {
-        for (int j = i + 1; j < list->count; j++) {
-            int condition = ascending
-                ? (list->students[i].marks > list->students[j].marks)
-                : (list->students[i].marks < list->students[j].marks);
-            
-            if (condition) {
-                Student temp = list->students[i];
-                list->students[i] = list->students[j];
-                list->students[j] = temp;
-            }
-        }
-    }
-    // No printf message! The GUI/console will handle that.
+// --- Batch Operations ---
+// Same effect as calling the single-row functions in a loop, but storage is
+// reserved once up front and removals compact the list in a single pass.
+// results[] (optional) gets one RowResult per input row. They return 0 only
+// when memory ran out; the rows not applied are then marked ROW_NO_MEMORY
+// and the list stays consistent.
+
+static void fillResults(RowResult *results, int from, int n, RowResult value) {
+    if (results == NULL) return;
+    for (int i = from; i < n; i++) results[i] = value;
 }
 
-float getAverageMarks(const StudentList *list) {
-    if (list->count == 0) {
-        return 0.0f; // Return 0 if no students
+static int addRows(StudentList *list, const StudentInput *rows, int n, RowResult *results) {
+    if (n <= 0) {
+        return 1;
     }
-    float sum = 0;
-    for (int i = 0; i < list->count; i++) {
-        sum += list->students[i].marks;
+    if (list->count > 0x7fffffff / 2 - n || !reserveStudents(list, list->count + n)) {
+        fillResults(results, 0, n, ROW_NO_MEMORY);
+        return 0; // Failure: nothing added
+    }
+    if (list->layout == LAYOUT_COLUMNS) {
+        size_t nameBytes = 0;
+        for (int i = 0; i < n; i++) nameBytes += rows[i].nameLen + 1;
+        reserveArena(list, nameBytes); // Best effort: insertRow grows it again if this failed
+    }
+    for (int i = 0; i < n; i++) {
+        RowResult result = insertRow(list, rows[i].name, rows[i].nameLen, rows[i].roll, rows[i].marks);
+        if (results) results[i] = result;
+        if (result == ROW_NO_MEMORY) {
+            fillResults(results, i + 1, n, ROW_NO_MEMORY);
+            return 0;
+        }
     }
-    return sum / list->count;
+    return 1; // Success
 }
 
+static int removeRows(StudentList *list, const int *rolls, int n, RowResult *results) {
+    if (n <= 0 || list->count == 0) {
+        fillResults(results, 0, n, ROW_NOT_FOUND);
+        return 1;
+    }
+    unsigned char *doomed = calloc((size_t)list->count, 1);
+    int *goneRolls = NULL; // Journaled once the list is consistent again
+    if (doomed == NULL || (list->journal && (goneRolls = malloc((size_t)n * sizeof(int))) == NULL)) {
+        free(doomed);
+        fillResults(results, 0, n, ROW_NO_MEMORY);
+        return 0; // Failure: nothing removed
+    }
+    int goneCount = 0;
+    int first = list->count;
+    for (int k = 0; k < n; k++) {
+        int idx = findStudentRow(list, rolls[k]);
+        RowResult result = ROW_NOT_FOUND; // Also for a roll repeated in the batch
+        if (idx != -1 && !doomed[idx]) {
+            doomed[idx] = 1;
+            if (idx < first) first = idx;
+            result = ROW_OK;
+        }
+        if (results) results[k] = result;
+    }
 
-// --- File I/O ---
+    if (list->changes) changeFeedRemovedRows(list->changes, doomed, first, list->count);
+    if (list->history) historyRemovedRows(list->history, doomed, first, list->count);
 
-int saveToFile(const StudentList *list) {
-    // Note: Your original used "./records.txt", but the #define used "students.txt"
-    // I'll use the FILENAME define from the header.
-    FILE *fp = fopen(FILENAME, "w");  
-    if (!fp) {
-        return 0; // Failure
+    // One compaction pass: every kept row moves down at most once
+    int out = first;
+    for (int i = first; i < list->count; i++) {
+        if (doomed[i]) {
+            int roll = studentRoll(list, i);
+            indexRemove(list, roll);
+            statsRemove(&list->stats, studentMarks(list, i));
+            if (list->names) nameIndexRemove(list->names, studentName(list, i), strlen(studentName(list, i)), roll);
+            if (list->order) rollOrderRemove(list->order, roll);
+            if (list->layout == LAYOUT_COLUMNS) releaseName(list, i);
+            if (goneRolls) goneRolls[goneCount++] = roll;
+            continue;
+        }
+        if (out != i) {
+            if (list->layout == LAYOUT_ROWS) {
+                list->students[out] = list->students[i];
+            } else {
+                list->rolls[out] = list->rolls[i];
+                list->marks[out] = list->marks[i];
+                list->nameOffsets[out] = list->nameOffsets[i];
+                list->nameLengths[out] = list->nameLengths[i];
+            }
+        }
+        out++;
     }
-    for (int i = 0; i < list->count; i++) {
-        fprintf(fp, "%s,%d,%.2f\n", list->students[i].name, list->students[i].roll, list->students[i].marks);
+    list->count = out;
+    free(doomed);
+
+    for (int i = first; i < list->count; i++) {
+        list->index[indexFind(list, studentRoll(list, i))].slot = i;
     }
-    fclose(fp);
+    if (list->layout == LAYOUT_COLUMNS) maybeCompactArena(list);
+
+    for (int k = 0; k < goneCount; k++) journalLogRemove(list->journal, goneRolls[k]);
+    free(goneRolls);
     return 1; // Success
 }
 
-int loadFromFile(StudentList *list) {
-    FILE *fp = fopen(FILENAME, "r");
-    if (!fp) {
-        return 0; // Failure
-    }
-    
-    freeList(list); // Clear the current list before loading
-    initList(list);
-    
-    char line[NAME_LEN + 30];
-    while (fgets(line, sizeof(line), fp)) {
-        char name[NAME_LEN];
-        int roll;
-        float marks;
-
-        char *token = strtok(line, ",");
-        if (token) strncpy(name, token, NAME_LEN);
-        token = strtok(NULL, ",");
-        if (token) roll = atoi(token);
-        token = strtok(NULL, ",");
-        if (token) marks = atof(token);
-        
-        // Use our safe addStudent function
-        addStudent(list, name, roll, marks);
-    }
-    fclose(fp);
+static int modifyRows(StudentList *list, const StudentUpdate *updates, int n, RowResult *results) {
+    if (list->layout == LAYOUT_COLUMNS) {
+        // New names longer than the old ones are appended to the arena
+        size_t nameBytes = 0;
+        for (int i = 0; i < n; i++) {
+            if (updates[i].newName != NULL) nameBytes += strlen(updates[i].newName) + 1;
+        }
+        reserveArena(list, nameBytes); // Best effort, as in addStudents
+    }
+    for (int k = 0; k < n; k++) {
+        const StudentUpdate *u = &updates[k];
+        int idx = findStudentRow(list, u->roll);
+        if (idx == -1) {
+            if (results) results[k] = ROW_NOT_FOUND;
+            continue;
+        }
+
+        // Only update if newName is not empty
+        if (u->newName != NULL && u->newName[0] != '\0') {
+            size_t len = strlen(u->newName);
+            if (list->layout == LAYOUT_ROWS && len > NAME_LEN - 1) len = NAME_LEN - 1; // What setName keeps
+            // The name index is renamed only once setName has succeeded,
+            // and needs the old name, which setName may overwrite
+            char shortName[NAME_LEN], *oldName = NULL;
+            if (list->names) {
+                const char *current = studentName(list, idx);
+                size_t oldLen = strlen(current);
+                oldName = oldLen < sizeof(shortName) ? shortName : malloc(oldLen + 1);
+                if (oldName != NULL) memcpy(oldName, current, oldLen + 1);
+            }
+            if ((list->names && oldName == NULL) || !setName(list, idx, u->newName, len)) {
+                if (oldName != shortName) free(oldName);
+                fillResults(results, k, n, ROW_NO_MEMORY);
+                return 0;
+            }
+            if (list->names) nameIndexRename(list->names, oldName, u->newName, len, u->roll);
+            if (oldName != shortName) free(oldName);
+        }
+
+        // Only update if newMarks is not the signal value (-1)
+        if (u->newMarks >= 0) {
+            statsRemove(&list->stats, studentMarks(list, idx));
+            statsAdd(&list->stats, u->newMarks);
+            if (list->layout == LAYOUT_ROWS) list->students[idx].marks = u->newMarks;
+            else list->marks[idx] = u->newMarks;
+        }
+
+        if (list->journal) journalLogModify(list->journal, u->roll, u->newName, u->newMarks);
+        if (list->changes) changeFeedChanged(list->changes, idx);
+        if (list->history) historyChanged(list->history, list, idx);
+        if (results) results[k] = ROW_OK;
+    }
+    if (list->layout == LAYOUT_COLUMNS) maybeCompactArena(list);
     return 1; // Success
-}
\ No newline at end of file
+}
+
+int addStudents(StudentList *list, const StudentInput *rows, int n, RowResult *results) {
+    PERF_BEGIN();
+    int ok = addRows(list, rows, n, results);
+    PERF_END(PERF_ADD_BATCH);
+    if (list->journal) journalCheckpointIfDue(list->journal);
+    return ok;
+}
+
+int removeStudents(StudentList *list, const int *rolls, int n, RowResult *results) {
+    PERF_BEGIN();
+    int ok = removeRows(list, rolls, n, results);
+    PERF_END(PERF_REMOVE_BATCH);
+    if (list->journal) journalCheckpointIfDue(list->journal);
+    return ok;
+}
+
+int modifyStudents(StudentList *list, const StudentUpdate *updates, int n, RowResult *results) {
+    PERF_BEGIN();
+    int ok = modifyRows(list, updates, n, results);
+    PERF_END(PERF_MODIFY_BATCH);
+    if (list->journal) journalCheckpointIfDue(list->journal);
+    return ok;
+}
+
+// --- Data Processing ---
+
+void sortStudents(StudentList *list, int ascending) {
+    SortKey key = { SORT_BY_MARKS, !ascending };
+    sortStudentsBy(list, &key, 1); // The sort engine lives in student_sort.c
+    // No printf message! The GUI/console will handle that.
+}
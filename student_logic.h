@@ -2,9 +2,12 @@
 #define STUDENT_LOGIC_H
 
 #include <stdio.h> // For FILE type
+#include <stddef.h>
+#include <stdatomic.h>
 
 #define NAME_LEN 100
 #define FILENAME "students.txt" // Using the original filename
+#define SNAPSHOT_FILENAME "students.snap" // Binary image of the same records
 
 // --- Struct Definitions ---
 
@@ -14,31 +17,437 @@ typedef struct {
     float marks;
 } Student;
 
+// One slot of the roll-number hash index (open addressing, linear probing).
+// slot == -1 marks an empty bucket.
+typedef struct {
+    int roll;
+    int slot; // Row number in the StudentList
+} RollIndexEntry;
+
+typedef struct {
+    const char *data;
+    size_t size;
+    int mapped; // 1 = mmap'ed, 0 = heap copy (or empty file)
+} MappedFile;
+
+struct Journal; // student_journal.h
+struct NameIndex; // student_names.c
+struct RollOrder; // student_order.c
+struct ChangeFeed; // student_changes.c
+struct History; // student_history.c
+
+// --- Class Statistics ---
+
+#define PASS_MARK 40.0f   // A student passes with marks above this
+#define GRADE_BANDS 10    // Bands of 10 marks: [0,10), [10,20) ... [90,100]
+
+// Running aggregates kept up to date by every add / modify / remove, so the
+// statistics never need a scan. Sums are Kahan-compensated doubles.
 typedef struct {
-    Student *students;
+    int count;
+    double sum, sumCompensation;
+    double sumSquares, sumSquaresCompensation;
+    float min, max;
+    int minMaxStale;        // A removal took out the min or max; rescanned on read
+    int passCount;
+    int bands[GRADE_BANDS];
+} RunningStats;
+
+// What getClassStats reports
+typedef struct {
+    int count;
+    double average;
+    double stddev;          // Population standard deviation
+    float min, max;
+    int passCount;
+    int failCount;
+    int bands[GRADE_BANDS];
+} ClassStats;
+
+// How a StudentList stores its records.
+//   LAYOUT_ROWS:    one Student struct per record (the original layout)
+//   LAYOUT_COLUMNS: one array per field, names packed in a bump-allocated
+//                   arena (no length limit). Scans over marks or rolls only
+//                   touch the bytes they need.
+typedef enum {
+    LAYOUT_ROWS,
+    LAYOUT_COLUMNS
+} StudentLayout;
+
+typedef struct {
+    StudentLayout layout;
     int count;
     int capacity;
+
+    // LAYOUT_ROWS
+    Student *students;
+
+    // LAYOUT_COLUMNS
+    int *rolls;
+    float *marks;
+    unsigned *nameOffsets;  // Start of each name in nameArena
+    unsigned *nameLengths;  // Name length, excluding the NUL
+    char *nameArena;        // NUL-terminated names
+    size_t arenaUsed;
+    size_t arenaCapacity;
+    size_t arenaGarbage;    // Bytes of names that were replaced or removed
+    MappedFile mapping;     // Snapshot the columns point into (until they must grow)
+
+    RunningStats stats;     // Maintained alongside every mutation
+    RollIndexEntry *index;  // roll -> slot, kept in sync by every mutation
+    int indexCapacity;      // Always a power of two (or 0 when empty)
+    struct Journal *journal; // When set, every mutation is appended to it
+    struct NameIndex *names; // Optional name search index (enableNameIndex)
+    struct RollOrder *order; // Rolls in ascending order; built on first use (student_order.c)
+    struct ChangeFeed *changes; // Subscribers to row changes (subscribeChanges)
+    struct History *history; // Undo steps and tagged versions (enableHistory)
 } StudentList;
 
+// --- Accessors ---
+// Read row i whatever the layout. A name pointer stays valid until the next
+// change to the list.
+
+static inline const char *studentName(const StudentList *list, int i) {
+    return list->layout == LAYOUT_COLUMNS ? list->nameArena + list->nameOffsets[i] : list->students[i].name;
+}
+
+static inline int studentRoll(const StudentList *list, int i) {
+    return list->layout == LAYOUT_COLUMNS ? list->rolls[i] : list->students[i].roll;
+}
+
+static inline float studentMarks(const StudentList *list, int i) {
+    return list->layout == LAYOUT_COLUMNS ? list->marks[i] : list->students[i].marks;
+}
+
+static inline int marksPassed(float marks) {
+    return marks > PASS_MARK;
+}
+
+// Fields a list can be sorted on (see sortStudentsBy)
+typedef enum {
+    SORT_BY_MARKS,
+    SORT_BY_ROLL,
+    SORT_BY_NAME
+} SortField;
+
+typedef struct {
+    SortField field;
+    int descending; // 0 = ascending, 1 = descending
+} SortKey;
+
+#define MAX_SORT_KEYS 3
+
+// Outcome of loadFromFileReport. Line numbers are 1-based.
+#define MAX_REPORTED_LINES 16
+
+typedef struct {
+    int rowsLoaded;
+    int malformedRows;
+    int duplicateRows;                    // Rows skipped because the roll was already loaded
+    int badLines[MAX_REPORTED_LINES];     // First few malformed line numbers, ascending
+    int badLineCount;                     // How many entries of badLines are filled
+} LoadReport;
+
+// Progress and cancellation for the long-running *Progress variants below.
+// The operation moves done towards total as it works; any thread may read
+// them, and may set cancelled to make the operation stop early and return 0.
+// A NULL Progress is always allowed.
+typedef struct {
+    atomic_int cancelled;
+    atomic_llong done;
+    atomic_llong total;
+} Progress;
+
+static inline void progressStart(Progress *progress, long long total) {
+    if (progress == NULL) return;
+    atomic_store(&progress->done, 0);
+    atomic_store(&progress->total, total);
+}
+
+static inline void progressAdvance(Progress *progress, long long amount) {
+    if (progress) atomic_fetch_add_explicit(&progress->done, amount, memory_order_relaxed);
+}
+
+static inline int progressCancelled(Progress *progress) {
+    return progress != NULL && atomic_load_explicit(&progress->cancelled, memory_order_relaxed);
+}
+
+// --- Filters ---
+// A filter is a small expression over the records, built term by term:
+// every builder returns the new term's index (or -1 if the filter is full),
+// and AND / OR join two earlier terms. The last term added is the whole
+// filter; a filter with no terms matches every row.
+//
+//   StudentFilter f;
+//   filterInit(&f);
+//   int marks = filterMarks(&f, 60, 100);
+//   filterAnd(&f, marks, filterNamePrefix(&f, "an"));
+
+#define MAX_FILTER_TERMS 16
+
+typedef enum {
+    FILTER_MARKS,        // marksMin <= marks <= marksMax
+    FILTER_ROLL,         // rollMin <= roll <= rollMax
+    FILTER_PASSED,       // marksPassed
+    FILTER_FAILED,
+    FILTER_NAME_PREFIX,  // Name starts with prefix, ignoring ASCII case
+    FILTER_AND,          // Terms left and right both match
+    FILTER_OR            // Either matches
+} FilterOp;
+
+typedef struct {
+    FilterOp op;
+    float marksMin, marksMax;
+    int rollMin, rollMax;
+    char prefix[NAME_LEN];  // Lowercased
+    int left, right;
+} FilterTerm;
+
+typedef struct {
+    FilterTerm terms[MAX_FILTER_TERMS];
+    int count;
+} StudentFilter;
+
+// How searchByName matches the query
+typedef enum {
+    NAME_MATCH_PREFIX,
+    NAME_MATCH_SUBSTRING
+} NameMatch;
+
+// --- Batch Operations ---
+
+// Per-row outcome of addStudents / removeStudents / modifyStudents
+typedef enum {
+    ROW_OK,
+    ROW_DUPLICATE,   // Roll already in the list (or earlier in the same batch)
+    ROW_NOT_FOUND,   // No student with that roll
+    ROW_NO_MEMORY    // Not applied: memory ran out
+} RowResult;
+
+typedef struct {
+    const char *name;
+    size_t nameLen;  // name need not be NUL-terminated
+    int roll;
+    float marks;
+} StudentInput;
+
+typedef struct {
+    int roll;
+    const char *newName; // NULL or "" keeps the name
+    float newMarks;      // Negative keeps the marks
+} StudentUpdate;
+
 // --- Function Prototypes (The API) ---
 
 // List management
-void initList(StudentList *list);
-void freeList(StudentList *list);
-void ensureCapacity(StudentList *list); // This is internal, but GUI might need it
+void initList(StudentList *list); // Row layout
+void initListLayout(StudentList *list, StudentLayout layout);
+int setListLayout(StudentList *list, StudentLayout layout); // Converts the records in place
+void freeList(StudentList *list); // Releases everything; the list keeps its layout
+void clearList(StudentList *list); // Drop all records but keep attachments (journal, name index)
+int adoptList(StudentList *list, StudentList *src); // Take over src's records (src ends up empty); list keeps its attachments
+int copyList(StudentList *dst, const StudentList *src); // Deep copy into dst (empty, or an earlier copy: its buffers are reused)
+size_t listMemoryUsage(const StudentList *list); // Bytes held for records (excluding the index)
+int ensureCapacity(StudentList *list); // This is internal, but GUI might need it
+int rebuildIndex(StudentList *list);   // Internal: re-derive the roll index after reordering
+int reserveStudents(StudentList *list, int capacity); // Pre-size for bulk inserts; 0 if out of memory
 
 // Core data operations
 int addStudent(StudentList *list, const char* name, int roll, float marks);
+int addStudentLen(StudentList *list, const char *name, size_t nameLen, int roll, float marks); // name need not be NUL-terminated
 int removeStudent(StudentList *list, int roll);
 int modifyStudent(StudentList *list, int roll, const char* newName, float newMarks);
 int searchStudent(const StudentList *list, int roll); // This was already perfect
+int findStudentRow(const StudentList *list, int roll); // Internal: searchStudent without the perf counters
+
+// Batch operations: results[] (may be NULL) gets one entry per row.
+// Return 0 only if memory ran out, never exit.
+int addStudents(StudentList *list, const StudentInput *rows, int n, RowResult *results);
+int removeStudents(StudentList *list, const int *rolls, int n, RowResult *results); // One compaction pass
+int modifyStudents(StudentList *list, const StudentUpdate *updates, int n, RowResult *results);
 
 // Data processing
-void sortStudents(StudentList *list, int ascending);
-float getAverageMarks(const StudentList *list);
+void sortStudents(StudentList *list, int ascending); // Marks only, kept for old callers
+int sortStudentsBy(StudentList *list, const SortKey *keys, int keyCount); // Stable, keys[0] most significant
+int sortPermutation(const StudentList *list, const SortKey *keys, int keyCount, int *perm); // Fills perm[count], list untouched
+int sortPermutationProgress(const StudentList *list, const SortKey *keys, int keyCount, int *perm, Progress *progress);
+int applySortOrder(StudentList *list, const int *perm, const SortKey *keys, int keyCount); // Second half of sortStudentsBy
+int applyPermutation(StudentList *list, const int *perm); // Internal: reorder rows to perm
+float getAverageMarks(const StudentList *list); // O(1), from the running stats
+
+// Class statistics (student_stats.c)
+int getClassStats(StudentList *list, ClassStats *out); // 0 if the list is empty
+int recomputeClassStats(StudentList *list); // Full rescan; 1 if the running stats agreed
+void statsAdd(RunningStats *stats, float marks);    // Internal: called by the list operations
+void statsRemove(RunningStats *stats, float marks); // Internal
+int statsReport(const RunningStats *stats, ClassStats *out); // Internal: min/max must be fresh
+
+// Order statistics by marks (student_stats.c). None of these reorder the list.
+int topStudents(const StudentList *list, int k, int *rows);    // Highest marks first (ties: lower roll first); returns rows filled
+int bottomStudents(const StudentList *list, int k, int *rows); // Lowest marks first (ties: lower roll first)
+int marksPercentile(const StudentList *list, double percentile, double *out); // 0..100, interpolated; 0 if empty
+int medianMarks(const StudentList *list, double *out);
+int studentRank(const StudentList *list, int roll); // 1 = top marks, ties share a rank; 0 if not found
+
+// Predicate scans (student_stats.c). match must only read the list: on big
+// lists it is called from several threads at once.
+typedef int (*StudentPredicate)(const StudentList *list, int row, void *ctx);
+int scanStudents(const StudentList *list, StudentPredicate match, void *ctx, int *rows); // rows[list->count] (or NULL to count) gets the matches in list order; returns how many
+
+// Filters (student_query.c). Evaluated on the worker pool for big lists.
+void filterInit(StudentFilter *filter);
+int filterMarks(StudentFilter *filter, float min, float max);
+int filterRoll(StudentFilter *filter, int min, int max);
+int filterPassed(StudentFilter *filter, int passed); // 1 = passed, 0 = failed
+int filterNamePrefix(StudentFilter *filter, const char *prefix);
+int filterAnd(StudentFilter *filter, int left, int right);
+int filterOr(StudentFilter *filter, int left, int right);
+int filterCount(const StudentList *list, const StudentFilter *filter);
+int filterRows(const StudentList *list, const StudentFilter *filter, int *rows); // rows[list->count] gets the matches in list order; returns how many
+int filterSelect(const StudentList *list, const StudentFilter *filter, unsigned long long *bitmap); // Bit i of bitmap[(count + 63) / 64] = row i; returns how many
+int filterMatch(const StudentList *list, const StudentFilter *filter, int row); // One row, for keeping a filtered view up to date
+
+// Name search (student_names.c). Works without an index too, by scanning.
+int enableNameIndex(StudentList *list);  // Builds the index and keeps it in sync from then on
+void disableNameIndex(StudentList *list);
+int searchByName(StudentList *list, const char *query, NameMatch mode, int caseSensitive,
+                 int *rows, int limit); // Fills the first limit matches by name, sorted; returns how many
+void nameIndexAdd(struct NameIndex *index, const char *name, size_t len, int roll); // Internal hooks
+void nameIndexRemove(struct NameIndex *index, const char *name, size_t len, int roll);
+void nameIndexRename(struct NameIndex *index, const char *oldName, const char *newName, size_t newLen, int roll);
+void nameIndexReset(struct NameIndex *index);
+
+// Roll order (student_order.c): ordered queries on roll, whatever order the
+// rows are stored in. Built on first use and after a CSV load, then kept up
+// to date by add and remove. Like searchByName these may update the order,
+// so they take a non-const list. Each returns -1 if memory ran out.
+int rollRange(StudentList *list, int from, int to, int *rows, int limit); // Rows with from <= roll <= to, ascending by roll; fills up to limit, returns how many
+int rollRangeCount(StudentList *list, int from, int to);
+int nextStudent(StudentList *list, int roll);     // Row of the next higher roll (roll need not exist), or -1
+int previousStudent(StudentList *list, int roll); // Row of the next lower roll, or -1
+int buildRollOrder(StudentList *list);            // Internal: bulk build from the records
+int settleRollOrder(StudentList *list);           // Internal: bring the order up to date, so reads need not
+int copyRollOrder(StudentList *dst, const StudentList *src); // Internal: for copyList
+void freeRollOrder(StudentList *list);
+void rollOrderAdd(struct RollOrder *order, int roll); // Internal hooks
+void rollOrderRemove(struct RollOrder *order, int roll);
+
+// Change notifications (student_changes.c). Every add, modify and remove
+// is noted in a pending batch, and flushChanges hands the batch to each
+// subscriber in one call. Batches are coalesced: however many operations
+// ran, a row is listed once, and a bulk call is one batch like any other.
+// A sort, a load or a batch too big to be worth listing is a reset.
+typedef struct {
+    int reset;              // Re-read everything; nothing else is set
+    const int *removedRows; // Rows as numbered at the last delivery, ascending
+    int removed;
+    const int *changedRows; // Rows as numbered now (after the removals), ascending
+    int changed;
+    int appended;           // The last `appended` rows are new
+} ChangeBatch;
+
+typedef void (*ChangeListener)(const StudentList *list, const ChangeBatch *batch, void *ctx);
+typedef void (*ChangeWake)(StudentList *list, void *ctx);
+
+int subscribeChanges(StudentList *list, ChangeListener listener, void *ctx); // Returns an id for unsubscribeChanges, 0 if out of memory
+void unsubscribeChanges(StudentList *list, int id);
+void setChangeWake(StudentList *list, ChangeWake wake, void *ctx); // Called at the first change after a delivery, to schedule flushChanges
+void flushChanges(StudentList *list);       // Delivers the pending batch, if there is one
+void freeChangeFeed(StudentList *list);
+void changeFeedAdded(struct ChangeFeed *feed); // Internal hooks
+void changeFeedRemoved(struct ChangeFeed *feed, int row);
+void changeFeedRemovedRows(struct ChangeFeed *feed, const unsigned char *doomed, int from, int to);
+void changeFeedChanged(struct ChangeFeed *feed, int row);
+void changeFeedReset(struct ChangeFeed *feed);
+
+// Undo history (student_history.c). While enabled, the history keeps the
+// records as a persistent, chunked copy: an undo point or a tagged version
+// is O(1) and holds only the chunks changed since on top of what it shares.
+// markUndoPoint starts a step (call it before each user action); undoChange
+// puts the list back as it was at the last point, and redoChange goes
+// forward again until something else changes the list. Going back applies
+// the difference through the batch calls (so the journal, indexes and
+// change feed follow), or swaps in a rebuilt list when rows must come back
+// mid-list or the step was a sort or load.
+int enableHistory(StudentList *list); // 0 if out of memory
+void disableHistory(StudentList *list);
+int markUndoPoint(StudentList *list, const char *label); // 0 if out of memory (the step is then not recorded)
+int undoChange(StudentList *list);    // 0 if there is nothing to undo (or memory ran out)
+int redoChange(StudentList *list);
+const char *undoLabel(const StudentList *list); // What undoChange would undo, or NULL
+const char *redoLabel(const StudentList *list);
+int tagVersion(StudentList *list, const char *name);  // Names the list as it is now (replacing an older tag of that name)
+int restoreTag(StudentList *list, const char *name);  // An undoable step back (or forward) to the tagged version
+int dropTag(StudentList *list, const char *name);
+int tagCount(const StudentList *list);
+const char *tagName(const StudentList *list, int i);  // Oldest first
+size_t historyMemoryUsage(const StudentList *list);   // Bytes held by every version (shared chunks once)
+void historyAdded(struct History *history, const StudentList *list); // Internal hooks
+void historyRemoved(struct History *history, int row);
+void historyRemovedRows(struct History *history, const unsigned char *doomed, int from, int to);
+void historyChanged(struct History *history, const StudentList *list, int row);
+void historyReset(struct History *history);
+
+// File I/O (student_io.c, exports in student_export.c)
+// The app's own file is FILENAME; catalogs (student_catalog.h) keep many.
+int saveToFile(const StudentList *list, const char *path);
+int loadFromFile(StudentList *list, const char *path);
+int loadFromFileReport(StudentList *list, const char *path, LoadReport *report); // Same, plus malformed-row details
+int importCsv(StudentList *list, const char *path, LoadReport *report); // Same as loadFromFileReport
+int exportCsv(const StudentList *list, const char *path);               // Same as saveToFile
+// Cancelling an import while it parses leaves list as it was; once rows are
+// going in, list ends up empty as with any failed load. Cancelling an export
+// leaves the old file in place.
+int importCsvProgress(StudentList *list, const char *path, LoadReport *report, Progress *progress);
+int exportCsvProgress(const StudentList *list, const char *path, Progress *progress);
+
+// Parses a CSV file a batch at a time without loading it, handing the rows
+// to add: it returns how many it kept (the rest count as duplicates), or -1
+// to stop. report gets the same totals as a load.
+typedef int (*CsvBatch)(void *ctx, const StudentInput *rows, int n);
+int streamCsv(const char *path, CsvBatch add, void *ctx, LoadReport *report);
+int parseCsvLine(const char *p, const char *end, StudentInput *row); // One line, without its '\n'; row->name points into it
+
+// Export (student_export.c): every row, in list order, through one large
+// buffer written in whole blocks. exportCsv* are exportStudents with EXPORT_CSV.
+typedef enum {
+    EXPORT_CSV,     // name,roll,marks (what loadFromFile reads)
+    EXPORT_JSONL,   // One {"name":...,"roll":...,"marks":...} object per line
+    EXPORT_TSV      // Header line, then name<TAB>roll<TAB>marks
+} ExportFormat;
+
+int exportStudents(const StudentList *list, const char *path, ExportFormat format, Progress *progress);
+ExportFormat exportFormatForPath(const char *path); // By extension: .jsonl / .json, .tsv, anything else CSV
+
+// The same, a row at a time, for records that aren't in a StudentList.
+// exportEnd(stream, 0) abandons the export and leaves the old file alone.
+typedef struct {
+    FILE *fp;
+    char *data;
+    size_t used, capacity;
+    unsigned long long written;
+    ExportFormat format;
+    int failed;
+    char path[1024];
+    char tmpPath[1040];
+} ExportStream;
+
+int exportBegin(ExportStream *stream, const char *path, ExportFormat format);
+int exportRow(ExportStream *stream, const char *name, size_t nameLen, int roll, float marks);
+int exportEnd(ExportStream *stream, int keep); // 1 if the file was written and is in place
+
+// Binary snapshots (student_snapshot.c)
+#define SNAPSHOT_VERIFY 1 // openSnapshot flag: also check the payload checksum
+int saveSnapshot(const StudentList *list, const char *path);
+int saveSnapshotAt(const StudentList *list, const char *path, unsigned long long sequence);
+int openSnapshot(StudentList *list, const char *path, int flags);
+int openSnapshotAt(StudentList *list, const char *path, int flags, unsigned long long *sequence);
+int snapshotSequence(const char *path, unsigned long long *sequence); // Header only, not verified
 
-// File I/O
-int saveToFile(const StudentList *list);
-int loadFromFile(StudentList *list);
+// Read-only view of a whole file (mmap where available)
+int mapFile(const char *path, MappedFile *file);
+int mapFilePrivate(const char *path, MappedFile *file); // Writable; writes stay private (copy-on-write)
+void unmapFile(MappedFile *file);
+int flushToDisk(FILE *fp); // fflush + fsync, so the data survives a crash
 
 #endif // STUDENT_LOGIC_H
\ No newline at end of file
@@ -0,0 +1,608 @@
+#include "student_model.h"
+#include <stdlib.h>
+#include <string.h>
+
+// --- StudentModel ---
+// A flat GtkTreeModel + GtkTreeSortable over a StudentList. An iter is just
+// a position (stored in user_data); order[] maps positions to list slots
+// when a header sort or a filter is active, otherwise position == slot.
+
+struct _StudentModel {
+    GObject parent_instance;
+    StudentList *list;
+    gint stamp;             // Bumped whenever iters become invalid
+    int rows;               // Row count the view has been told about
+    int *order;             // position -> slot, or NULL for storage order
+    int list_rows;          // list->count at the last reload
+    StudentFilter *filter;  // Rows to show, or NULL for all
+    gint sort_column;       // GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID when unsorted
+    GtkSortType sort_order;
+};
+
+static void student_model_tree_init(GtkTreeModelIface *iface);
+static void student_model_sortable_init(GtkTreeSortableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(StudentModel, student_model, G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL, student_model_tree_init)
+    G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_SORTABLE, student_model_sortable_init))
+
+static void student_model_finalize(GObject *object) {
+    StudentModel *model = STUDENT_MODEL(object);
+    g_free(model->order);
+    g_free(model->filter);
+    G_OBJECT_CLASS(student_model_parent_class)->finalize(object);
+}
+
+static void student_model_class_init(StudentModelClass *klass) {
+    G_OBJECT_CLASS(klass)->finalize = student_model_finalize;
+}
+
+static void student_model_init(StudentModel *model) {
+    model->stamp = g_random_int();
+    model->sort_column = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+    model->sort_order = GTK_SORT_ASCENDING;
+}
+
+static int position_of(StudentModel *model, GtkTreeIter *iter) {
+    g_return_val_if_fail(iter->stamp == model->stamp, -1);
+    return GPOINTER_TO_INT(iter->user_data);
+}
+
+static void set_iter(StudentModel *model, GtkTreeIter *iter, int position) {
+    iter->stamp = model->stamp;
+    iter->user_data = GINT_TO_POINTER(position);
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+}
+
+int student_model_get_slot(StudentModel *model, GtkTreeIter *iter) {
+    int position = position_of(model, iter);
+    if (position < 0 || position >= model->rows) return -1;
+    int slot = model->order ? model->order[position] : position;
+    return slot >= 0 && slot < model->list->count ? slot : -1; // List shrank since the last reload
+}
+
+/* --- GtkTreeModel --- */
+
+static GtkTreeModelFlags student_model_get_flags(GtkTreeModel *tree_model) {
+    (void)tree_model;
+    return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint student_model_get_n_columns(GtkTreeModel *tree_model) {
+    (void)tree_model;
+    return STUDENT_N_COLUMNS;
+}
+
+static GType student_model_get_column_type(GtkTreeModel *tree_model, gint column) {
+    (void)tree_model;
+    switch (column) {
+        case STUDENT_COL_ROLL:  return G_TYPE_INT;
+        case STUDENT_COL_MARKS: return G_TYPE_FLOAT;
+        default:                return G_TYPE_STRING;
+    }
+}
+
+static gboolean student_model_get_iter(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path) {
+    StudentModel *model = STUDENT_MODEL(tree_model);
+    if (gtk_tree_path_get_depth(path) != 1) return FALSE;
+    int position = gtk_tree_path_get_indices(path)[0];
+    if (position < 0 || position >= model->rows) return FALSE;
+    set_iter(model, iter, position);
+    return TRUE;
+}
+
+static GtkTreePath *student_model_get_path(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    return gtk_tree_path_new_from_indices(position_of(STUDENT_MODEL(tree_model), iter), -1);
+}
+
+static void student_model_get_value(GtkTreeModel *tree_model, GtkTreeIter *iter, gint column, GValue *value) {
+    StudentModel *model = STUDENT_MODEL(tree_model);
+    StudentList *list = model->list;
+    int slot = student_model_get_slot(model, iter);
+
+    g_value_init(value, student_model_get_column_type(tree_model, column));
+    if (slot == -1) return; // Leave the default (empty) value
+    switch (column) {
+        case STUDENT_COL_NAME:
+            g_value_set_static_string(value, studentName(list, slot)); // No copy; valid until the list changes
+            break;
+        case STUDENT_COL_ROLL:
+            g_value_set_int(value, studentRoll(list, slot));
+            break;
+        case STUDENT_COL_MARKS:
+            g_value_set_float(value, studentMarks(list, slot));
+            break;
+        case STUDENT_COL_STATUS:
+            g_value_set_static_string(value, marksPassed(studentMarks(list, slot)) ? "Passed" : "Failed");
+            break;
+    }
+}
+
+static gboolean student_model_iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    StudentModel *model = STUDENT_MODEL(tree_model);
+    int position = position_of(model, iter) + 1;
+    if (position >= model->rows) {
+        iter->stamp = 0; // Invalidate, as GTK expects when there is no next row
+        return FALSE;
+    }
+    set_iter(model, iter, position);
+    return TRUE;
+}
+
+static gboolean student_model_iter_previous(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    StudentModel *model = STUDENT_MODEL(tree_model);
+    int position = position_of(model, iter) - 1;
+    if (position < 0) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+    set_iter(model, iter, position);
+    return TRUE;
+}
+
+static gboolean student_model_iter_nth_child(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                             GtkTreeIter *parent, gint n) {
+    StudentModel *model = STUDENT_MODEL(tree_model);
+    if (parent != NULL || n < 0 || n >= model->rows) return FALSE; // Flat list
+    set_iter(model, iter, n);
+    return TRUE;
+}
+
+static gboolean student_model_iter_children(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent) {
+    return student_model_iter_nth_child(tree_model, iter, parent, 0);
+}
+
+static gboolean student_model_iter_has_child(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    (void)tree_model;
+    (void)iter;
+    return FALSE;
+}
+
+static gint student_model_iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    return iter == NULL ? STUDENT_MODEL(tree_model)->rows : 0;
+}
+
+static gboolean student_model_iter_parent(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *child) {
+    (void)tree_model;
+    (void)iter;
+    (void)child;
+    return FALSE;
+}
+
+static void student_model_tree_init(GtkTreeModelIface *iface) {
+    iface->get_flags = student_model_get_flags;
+    iface->get_n_columns = student_model_get_n_columns;
+    iface->get_column_type = student_model_get_column_type;
+    iface->get_iter = student_model_get_iter;
+    iface->get_path = student_model_get_path;
+    iface->get_value = student_model_get_value;
+    iface->iter_next = student_model_iter_next;
+    iface->iter_previous = student_model_iter_previous;
+    iface->iter_children = student_model_iter_children;
+    iface->iter_has_child = student_model_iter_has_child;
+    iface->iter_n_children = student_model_iter_n_children;
+    iface->iter_nth_child = student_model_iter_nth_child;
+    iface->iter_parent = student_model_iter_parent;
+}
+
+/* --- Sorting --- */
+
+// The rows to show in display order: the filter's matches (or every row),
+// sorted by the current sort column. Uses the list's filter and sort
+// engines, so the list itself is never reordered. *order is NULL for every
+// row in storage order. Returns the row count, or -1 if out of memory.
+static int visible_rows(StudentModel *model, int **order) {
+    StudentList *list = model->list;
+    int n = list->count;
+    *order = NULL;
+    if (model->sort_column < 0) {
+        if (model->filter == NULL) return n;
+        int *rows = g_try_new(int, n > 0 ? n : 1);
+        if (rows == NULL) return -1;
+        *order = rows;
+        return filterRows(list, model->filter, rows);
+    }
+
+    SortKey keys[2];
+    keys[0].field = model->sort_column == STUDENT_COL_NAME ? SORT_BY_NAME
+                  : model->sort_column == STUDENT_COL_ROLL ? SORT_BY_ROLL
+                  : SORT_BY_MARKS; // Status sorts with marks
+    keys[0].descending = model->sort_order == GTK_SORT_DESCENDING;
+    keys[1].field = SORT_BY_ROLL; // Stable tie-break
+    keys[1].descending = 0;
+    int *sorted = g_try_new(int, n > 0 ? n : 1);
+    if (sorted == NULL || !sortPermutation(list, keys, 2, sorted)) {
+        g_free(sorted);
+        return -1;
+    }
+    *order = sorted;
+    if (model->filter == NULL) return n;
+
+    // Keep the matching rows, in sorted order
+    guint64 *selected = g_try_new(guint64, n / 64 + 1);
+    if (selected == NULL) {
+        g_free(sorted);
+        *order = NULL;
+        return -1;
+    }
+    filterSelect(list, model->filter, selected);
+    int count = 0;
+    for (int p = 0; p < n; p++) {
+        int slot = sorted[p];
+        if (selected[slot / 64] >> (slot % 64) & 1) sorted[count++] = slot;
+    }
+    g_free(selected);
+    return count;
+}
+
+// Recomputes order[] for a new sort column and tells the view where every
+// row went.
+static void resort(StudentModel *model) {
+    int n = model->list->count;
+    int *order;
+    if (n != model->list_rows) return; // Stale row count; student_model_reload resorts
+    int count = visible_rows(model, &order);
+    if (count == -1) return; // Out of memory: keep the current order
+
+    // new_order[new position] = old position
+    int *inverse = g_try_new(int, n > 0 ? n : 1);
+    int *new_order = g_try_new(int, count > 0 ? count : 1);
+    if (inverse == NULL || new_order == NULL) {
+        g_free(inverse);
+        g_free(new_order);
+        g_free(order);
+        return;
+    }
+    for (int slot = 0; slot < n; slot++) inverse[slot] = -1;
+    for (int p = 0; p < model->rows; p++) inverse[model->order ? model->order[p] : p] = p;
+    gboolean same_rows = count == model->rows;
+    for (int p = 0; p < count && same_rows; p++) {
+        new_order[p] = inverse[order ? order[p] : p];
+        same_rows = new_order[p] != -1;
+    }
+    if (!same_rows) {
+        // A modify moved rows in or out of the filter since the last reload
+        g_free(inverse);
+        g_free(new_order);
+        g_free(order);
+        student_model_reload(model);
+        return;
+    }
+
+    g_free(model->order);
+    model->order = order;
+    if (count > 0) {
+        GtkTreePath *root = gtk_tree_path_new();
+        gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), root, NULL, new_order);
+        gtk_tree_path_free(root);
+    }
+    g_free(inverse);
+    g_free(new_order);
+}
+
+static gboolean student_model_get_sort_column_id(GtkTreeSortable *sortable, gint *sort_column_id, GtkSortType *order) {
+    StudentModel *model = STUDENT_MODEL(sortable);
+    if (sort_column_id) *sort_column_id = model->sort_column;
+    if (order) *order = model->sort_order;
+    return model->sort_column >= 0;
+}
+
+static void student_model_set_sort_column_id(GtkTreeSortable *sortable, gint sort_column_id, GtkSortType order) {
+    StudentModel *model = STUDENT_MODEL(sortable);
+    if (model->sort_column == sort_column_id && model->sort_order == order) return;
+    model->sort_column = sort_column_id;
+    model->sort_order = order;
+    gtk_tree_sortable_sort_column_changed(sortable);
+    resort(model);
+}
+
+static void student_model_set_sort_func(GtkTreeSortable *sortable, gint sort_column_id,
+                                        GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy) {
+    (void)sortable;
+    (void)sort_column_id;
+    (void)func;
+    if (destroy) destroy(data);
+    g_warning("StudentModel sorts with the list's own sort engine; custom sort functions are not supported");
+}
+
+static void student_model_set_default_sort_func(GtkTreeSortable *sortable, GtkTreeIterCompareFunc func,
+                                                gpointer data, GDestroyNotify destroy) {
+    student_model_set_sort_func(sortable, GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID, func, data, destroy);
+}
+
+static gboolean student_model_has_default_sort_func(GtkTreeSortable *sortable) {
+    (void)sortable;
+    return FALSE;
+}
+
+static void student_model_sortable_init(GtkTreeSortableIface *iface) {
+    iface->get_sort_column_id = student_model_get_sort_column_id;
+    iface->set_sort_column_id = student_model_set_sort_column_id;
+    iface->set_sort_func = student_model_set_sort_func;
+    iface->set_default_sort_func = student_model_set_default_sort_func;
+    iface->has_default_sort_func = student_model_has_default_sort_func;
+}
+
+/* --- Patching --- */
+
+// Display order of two rows under the current sort: the column, then roll
+static int compare_slots(StudentModel *model, int a, int b) {
+    StudentList *list = model->list;
+    int c;
+    if (model->sort_column == STUDENT_COL_NAME) {
+        c = strcmp(studentName(list, a), studentName(list, b));
+    } else if (model->sort_column == STUDENT_COL_ROLL) {
+        c = (studentRoll(list, a) > studentRoll(list, b)) - (studentRoll(list, a) < studentRoll(list, b));
+    } else {
+        float x = studentMarks(list, a), y = studentMarks(list, b);
+        c = (x > y) - (x < y);
+    }
+    if (model->sort_order == GTK_SORT_DESCENDING) c = -c;
+    if (c == 0) c = (studentRoll(list, a) > studentRoll(list, b)) - (studentRoll(list, a) < studentRoll(list, b));
+    return c;
+}
+
+// Where slot goes in order[]: by the sort, or by slot when only filtered
+static int insert_position(StudentModel *model, int slot) {
+    int lo = 0, hi = model->rows;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        gboolean before = model->sort_column >= 0 ? compare_slots(model, model->order[mid], slot) < 0
+                                                  : model->order[mid] < slot;
+        if (before) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static gboolean shows(StudentModel *model, int slot) {
+    return model->filter == NULL || filterMatch(model->list, model->filter, slot);
+}
+
+static void emit_changed(StudentModel *model, int position) {
+    GtkTreeIter iter;
+    set_iter(model, &iter, position);
+    GtkTreePath *path = gtk_tree_path_new_from_indices(position, -1);
+    gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+}
+
+static void emit_inserted(StudentModel *model, int position) {
+    GtkTreeIter iter;
+    set_iter(model, &iter, position);
+    GtkTreePath *path = gtk_tree_path_new_from_indices(position, -1);
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+}
+
+static void emit_deleted(StudentModel *model, int position) {
+    GtkTreePath *path = gtk_tree_path_new_from_indices(position, -1);
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+    gtk_tree_path_free(path);
+}
+
+static void remove_at(StudentModel *model, int position) {
+    memmove(model->order + position, model->order + position + 1, (size_t)(model->rows - position - 1) * sizeof(int));
+    model->rows--;
+    emit_deleted(model, position);
+}
+
+static void insert_at(StudentModel *model, int position, int slot) {
+    memmove(model->order + position + 1, model->order + position, (size_t)(model->rows - position) * sizeof(int));
+    model->order[position] = slot;
+    model->rows++;
+    emit_inserted(model, position);
+}
+
+// Index of value in sorted[0..n), or where it would go
+static int lower_bound(const int *sorted, int n, int value) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (sorted[mid] < value) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static gboolean is_changed(const int *changed, int count, int slot) {
+    int k = lower_bound(changed, count, slot);
+    return k < count && changed[k] == slot;
+}
+
+// A changed row can stay where it is if its neighbours are rows that did
+// not change and it still sorts between them
+static gboolean in_place(StudentModel *model, int position, const int *changed, int count) {
+    int slot = model->order[position];
+    if (position > 0) {
+        int prev = model->order[position - 1];
+        if (is_changed(changed, count, prev) || compare_slots(model, prev, slot) > 0) return FALSE;
+    }
+    if (position + 1 < model->rows) {
+        int next = model->order[position + 1];
+        if (is_changed(changed, count, next) || compare_slots(model, slot, next) > 0) return FALSE;
+    }
+    return TRUE;
+}
+
+// Changed rows of a sorted view: the ones that left the filter or no longer
+// sort where they are come out, then go back in by binary search
+static void patch_sorted(StudentModel *model, const int *changed, int count) {
+    gboolean *kept = g_new0(gboolean, count > 0 ? count : 1);
+    for (int p = model->rows - 1; p >= 0; p--) {
+        int slot = model->order[p];
+        int k = lower_bound(changed, count, slot);
+        if (k == count || changed[k] != slot) continue;
+        if (shows(model, slot) && in_place(model, p, changed, count)) {
+            kept[k] = TRUE;
+            emit_changed(model, p);
+        } else {
+            remove_at(model, p);
+        }
+    }
+    for (int k = 0; k < count; k++) {
+        if (!kept[k] && shows(model, changed[k])) insert_at(model, insert_position(model, changed[k]), changed[k]);
+    }
+    g_free(kept);
+}
+
+// Changed rows of a filtered view in storage order never move; they can
+// only enter or leave the filter
+static void patch_filtered(StudentModel *model, const int *changed, int count) {
+    for (int k = 0; k < count; k++) {
+        int slot = changed[k];
+        int p = insert_position(model, slot);
+        gboolean present = p < model->rows && model->order[p] == slot;
+        gboolean now = shows(model, slot);
+        if (present && now) emit_changed(model, p);
+        else if (present) remove_at(model, p);
+        else if (now) insert_at(model, p, slot);
+    }
+}
+
+/* --- Public --- */
+
+StudentModel *student_model_new(StudentList *list) {
+    StudentModel *model = g_object_new(STUDENT_TYPE_MODEL, NULL);
+    model->list = list;
+    model->rows = list->count;
+    model->list_rows = list->count;
+    return model;
+}
+
+void student_model_reload(StudentModel *model) {
+    int *order;
+    int count = visible_rows(model, &order);
+    if (count == -1) count = model->list->count; // Out of memory: every row, unsorted
+    GtkTreePath *path;
+
+    // Drop the old order first: it describes the old set of rows
+    g_free(model->order);
+    model->order = NULL;
+    model->list_rows = model->list->count;
+    model->stamp++;
+
+    while (model->rows > count) {
+        model->rows--;
+        path = gtk_tree_path_new_from_indices(model->rows, -1);
+        gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+        gtk_tree_path_free(path);
+    }
+    while (model->rows < count) {
+        GtkTreeIter iter;
+        set_iter(model, &iter, model->rows);
+        model->rows++;
+        path = gtk_tree_path_new_from_indices(model->rows - 1, -1);
+        gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+        gtk_tree_path_free(path);
+    }
+    model->order = order;
+
+    // Every position may show a different student now: redraw them all
+    if (count > 0) {
+        int *same = g_try_new(int, count);
+        if (same != NULL) {
+            for (int p = 0; p < count; p++) same[p] = p;
+            path = gtk_tree_path_new();
+            gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path, NULL, same);
+            gtk_tree_path_free(path);
+            g_free(same);
+        }
+    }
+}
+
+void student_model_patch(StudentModel *model, const int *removed, int removed_count,
+                         const int *changed, int changed_count, int appended) {
+    int n = model->list->count;
+    // Each row that moves costs a memmove of order[]: past a point one
+    // sort of the whole list is cheaper
+    int touched = removed_count + changed_count + appended;
+    if (model->list_rows != n - appended + removed_count || touched > 64 + n / 16) {
+        student_model_reload(model);
+        return;
+    }
+    int *sorted = g_try_new(int, changed_count > 0 ? changed_count : 1);
+    int *order = model->order ? g_try_new(int, model->rows + changed_count + appended + 1) : NULL;
+    if (sorted == NULL || (model->order && order == NULL)) {
+        g_free(sorted);
+        g_free(order);
+        student_model_reload(model);
+        return;
+    }
+    model->list_rows = n;
+    model->stamp++; // Positions past the first change now show other rows
+
+    if (model->order == NULL) {
+        // Every row in storage order: position == slot
+        for (int k = removed_count - 1; k >= 0; k--) {
+            model->rows--;
+            emit_deleted(model, removed[k]);
+        }
+        for (int k = 0; k < changed_count; k++) emit_changed(model, changed[k]);
+        while (model->rows < n) {
+            model->rows++;
+            emit_inserted(model, model->rows - 1);
+        }
+        g_free(sorted);
+        return;
+    }
+
+    // Renumber what stays (a slot moves down by the removed slots below
+    // it), then tell the view about the removed rows from the bottom up.
+    // Until the last one is out, the positions past the kept rows read as
+    // empty.
+    int *gone = g_new(int, removed_count + 1);
+    int kept = 0, gone_count = 0;
+    for (int p = 0; p < model->rows; p++) {
+        int slot = model->order[p];
+        int below = lower_bound(removed, removed_count, slot);
+        if (below < removed_count && removed[below] == slot) gone[gone_count++] = p;
+        else order[kept++] = slot - below;
+    }
+    for (int p = kept; p < model->rows; p++) order[p] = -1;
+    g_free(model->order);
+    model->order = order;
+    for (int k = gone_count - 1; k >= 0; k--) {
+        model->rows--;
+        emit_deleted(model, gone[k]);
+    }
+    g_free(gone);
+
+    int count = 0;
+    if (changed_count > 0) {
+        memcpy(sorted, changed, (size_t)changed_count * sizeof(int));
+        qsort(sorted, (size_t)changed_count, sizeof(int), compare_ints);
+        for (int k = 0; k < changed_count; k++) {
+            if (count == 0 || sorted[count - 1] != sorted[k]) sorted[count++] = sorted[k];
+        }
+    }
+    if (model->sort_column >= 0) patch_sorted(model, sorted, count);
+    else patch_filtered(model, sorted, count);
+    g_free(sorted);
+
+    for (int slot = n - appended; slot < n; slot++) {
+        if (shows(model, slot)) insert_at(model, insert_position(model, slot), slot);
+    }
+}
+
+void student_model_apply_changes(StudentModel *model, const ChangeBatch *batch) {
+    if (batch->reset) student_model_reload(model);
+    else student_model_patch(model, batch->removedRows, batch->removed, batch->changedRows, batch->changed,
+                             batch->appended);
+}
+
+void student_model_set_filter(StudentModel *model, const StudentFilter *filter) {
+    g_free(model->filter);
+    model->filter = NULL;
+    if (filter) {
+        model->filter = g_new(StudentFilter, 1);
+        *model->filter = *filter;
+    }
+    student_model_reload(model);
+}
@@ -0,0 +1,41 @@
+#ifndef STUDENT_MODEL_H
+#define STUDENT_MODEL_H
+
+#include <gtk/gtk.h>
+#include "student_logic.h"
+
+// GtkTreeModel that reads rows straight out of a StudentList. Nothing is
+// copied per row: the view asks for the handful of rows it is drawing and
+// gets pointers into the list. Sorting by a column header only permutes the
+// model's own row order; the list keeps its storage order.
+//
+// The model captures the row count when it is created. Pass it the list's
+// change batches (subscribeChanges) with student_model_apply_changes, or
+// tell it which rows changed with student_model_patch: either only touches
+// those rows. student_model_reload re-reads everything. A filter narrows
+// the rows shown to its matches; reload and patch re-evaluate it.
+
+enum {
+    STUDENT_COL_NAME,
+    STUDENT_COL_ROLL,
+    STUDENT_COL_MARKS,
+    STUDENT_COL_STATUS,   // "Passed" / "Failed", computed
+    STUDENT_N_COLUMNS
+};
+
+#define STUDENT_TYPE_MODEL (student_model_get_type())
+G_DECLARE_FINAL_TYPE(StudentModel, student_model, STUDENT, MODEL, GObject)
+
+StudentModel *student_model_new(StudentList *list);
+void student_model_reload(StudentModel *model); // Re-read the list after it changed
+int student_model_get_slot(StudentModel *model, GtkTreeIter *iter); // Row in the list, or -1
+// The list changed since the model last saw it: removed[] are the removed
+// rows as numbered before the removals (ascending), changed[] rows modified
+// in place (numbered after them), and the last `appended` rows are new.
+// Emits signals for those rows only; a big change falls back to a reload.
+void student_model_patch(StudentModel *model, const int *removed, int removed_count,
+                         const int *changed, int changed_count, int appended);
+void student_model_apply_changes(StudentModel *model, const ChangeBatch *batch); // Patch, or reload on a reset
+void student_model_set_filter(StudentModel *model, const StudentFilter *filter); // Copied; NULL shows every row
+
+#endif // STUDENT_MODEL_H
@@ -0,0 +1,400 @@
+#include "student_logic.h"
+#include "student_perf.h"
+#include <stdlib.h>
+#include <string.h>
+
+// --- Name Index ---
+// Trigram index over lowercased names. Each name is indexed as "\x02name",
+// so the grams starting with the \x02 marker only match at the start of a
+// name. The same table therefore answers both prefix and substring queries:
+// pick the query gram with the shortest posting list, then check each
+// candidate against its real name.
+//
+// Postings hold rolls, which (unlike slots) survive removals and sorts.
+// Removing or renaming a student leaves its old entries behind as stale;
+// candidates are verified anyway, and once stale entries outnumber live ones
+// the next query rebuilds the table from the list.
+
+#define NAME_START '\x02'      // Marks the start of a name in its grams
+#define SMALL_NAME 256         // Names up to this long are lowercased on the stack
+
+typedef struct {
+    unsigned key;              // Three lowercased bytes; 0 = empty bucket
+    int count;
+    int capacity;
+    int *rolls;
+} Posting;
+
+struct NameIndex {
+    Posting *table;
+    int tableCapacity;         // Power of two
+    int used;
+    long liveEntries;
+    long staleEntries;
+    int broken;                // An allocation failed: rebuild before trusting it
+};
+
+static char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static unsigned gramKey(const char *g) {
+    return ((unsigned)(unsigned char)g[0] << 16) | ((unsigned)(unsigned char)g[1] << 8) | (unsigned char)g[2];
+}
+
+static int compareKeys(const void *a, const void *b) {
+    unsigned x = *(const unsigned *)a, y = *(const unsigned *)b;
+    return (x > y) - (x < y);
+}
+
+// Distinct gram keys of "\x02" + lower(name), sorted. Returns how many, or
+// -1 if out of memory. *keys must be freed by the caller.
+static int nameGrams(const char *name, size_t len, int anchored, unsigned **keys) {
+    char small[SMALL_NAME + 1];
+    char *padded = len < SMALL_NAME ? small : malloc(len + 2);
+    *keys = NULL;
+    if (padded == NULL) return -1;
+    size_t plen = 0;
+    if (anchored) padded[plen++] = NAME_START;
+    for (size_t i = 0; i < len; i++) padded[plen++] = lowerAscii(name[i]);
+
+    int count = 0;
+    if (plen >= 3) {
+        *keys = malloc((plen - 2) * sizeof(unsigned));
+        if (*keys == NULL) {
+            if (padded != small) free(padded);
+            return -1;
+        }
+        for (size_t i = 0; i + 3 <= plen; i++) (*keys)[count++] = gramKey(padded + i);
+        qsort(*keys, (size_t)count, sizeof(unsigned), compareKeys);
+        int unique = 0;
+        for (int i = 0; i < count; i++) {
+            if (unique == 0 || (*keys)[unique - 1] != (*keys)[i]) (*keys)[unique++] = (*keys)[i];
+        }
+        count = unique;
+    }
+    if (padded != small) free(padded);
+    return count;
+}
+
+static unsigned hashGram(unsigned key) {
+    return key * 0x9E3779B1U;
+}
+
+static Posting *findPosting(const struct NameIndex *index, unsigned key) {
+    if (index->tableCapacity == 0) return NULL;
+    unsigned mask = (unsigned)index->tableCapacity - 1;
+    for (unsigned i = hashGram(key) & mask; index->table[i].key != 0; i = (i + 1) & mask) {
+        if (index->table[i].key == key) return &index->table[i];
+    }
+    return NULL;
+}
+
+static int growTable(struct NameIndex *index) {
+    int capacity = index->tableCapacity == 0 ? 1024 : index->tableCapacity * 2;
+    Posting *table = calloc((size_t)capacity, sizeof(Posting));
+    if (table == NULL) return 0;
+    unsigned mask = (unsigned)capacity - 1;
+    for (int i = 0; i < index->tableCapacity; i++) {
+        Posting *p = &index->table[i];
+        if (p->key == 0) continue;
+        unsigned j = hashGram(p->key) & mask;
+        while (table[j].key != 0) j = (j + 1) & mask;
+        table[j] = *p;
+    }
+    free(index->table);
+    index->table = table;
+    index->tableCapacity = capacity;
+    return 1;
+}
+
+static int postRoll(struct NameIndex *index, unsigned key, int roll) {
+    Posting *p = findPosting(index, key);
+    if (p == NULL) {
+        if ((index->used + 1) * 2 > index->tableCapacity && !growTable(index)) return 0;
+        unsigned mask = (unsigned)index->tableCapacity - 1;
+        unsigned i = hashGram(key) & mask;
+        while (index->table[i].key != 0) i = (i + 1) & mask;
+        p = &index->table[i];
+        p->key = key;
+        index->used++;
+    }
+    if (p->count == p->capacity) {
+        int capacity = p->capacity == 0 ? 4 : p->capacity * 2;
+        int *rolls = realloc(p->rolls, (size_t)capacity * sizeof(int));
+        if (rolls == NULL) return 0;
+        p->rolls = rolls;
+        p->capacity = capacity;
+    }
+    p->rolls[p->count++] = roll;
+    return 1;
+}
+
+// Posts roll under every key of keys[] that is not in skip[] (both sorted).
+static void postGrams(struct NameIndex *index, const unsigned *keys, int n,
+                      const unsigned *skip, int skipCount, int roll) {
+    int s = 0;
+    for (int i = 0; i < n; i++) {
+        while (s < skipCount && skip[s] < keys[i]) s++;
+        if (s < skipCount && skip[s] == keys[i]) continue;
+        if (!postRoll(index, keys[i], roll)) {
+            index->broken = 1;
+            return;
+        }
+        index->liveEntries++;
+    }
+}
+
+// Number of keys in a[] that are not in b[] (both sorted)
+static int countMissing(const unsigned *a, int n, const unsigned *b, int m) {
+    int missing = 0, j = 0;
+    for (int i = 0; i < n; i++) {
+        while (j < m && b[j] < a[i]) j++;
+        if (j == m || b[j] != a[i]) missing++;
+    }
+    return missing;
+}
+
+// --- Hooks (called by student_logic.c) ---
+
+void nameIndexAdd(struct NameIndex *index, const char *name, size_t len, int roll) {
+    unsigned *keys;
+    int n = nameGrams(name, len, 1, &keys);
+    if (n < 0) {
+        index->broken = 1;
+        return;
+    }
+    postGrams(index, keys, n, NULL, 0, roll);
+    free(keys);
+}
+
+void nameIndexRemove(struct NameIndex *index, const char *name, size_t len, int roll) {
+    (void)roll; // Left in its postings; queries skip it
+    unsigned *keys;
+    int n = nameGrams(name, len, 1, &keys);
+    if (n < 0) {
+        index->broken = 1;
+        return;
+    }
+    index->liveEntries -= n;
+    index->staleEntries += n;
+    free(keys);
+}
+
+void nameIndexRename(struct NameIndex *index, const char *oldName, const char *newName, size_t newLen, int roll) {
+    unsigned *oldKeys, *newKeys;
+    int oldCount = nameGrams(oldName, strlen(oldName), 1, &oldKeys);
+    int newCount = nameGrams(newName, newLen, 1, &newKeys);
+    if (oldCount >= 0 && newCount >= 0) {
+        // Grams the names share stay posted; only the differences move
+        int dropped = countMissing(oldKeys, oldCount, newKeys, newCount);
+        index->liveEntries -= dropped;
+        index->staleEntries += dropped;
+        postGrams(index, newKeys, newCount, oldKeys, oldCount, roll);
+    } else {
+        index->broken = 1;
+    }
+    free(oldKeys);
+    free(newKeys);
+}
+
+void nameIndexReset(struct NameIndex *index) {
+    for (int i = 0; i < index->tableCapacity; i++) {
+        free(index->table[i].rolls);
+    }
+    free(index->table);
+    memset(index, 0, sizeof(*index));
+}
+
+// --- Building ---
+
+static int rebuildNameIndex(StudentList *list) {
+    struct NameIndex *index = list->names;
+    nameIndexReset(index);
+    for (int i = 0; i < list->count && !index->broken; i++) {
+        const char *name = studentName(list, i);
+        nameIndexAdd(index, name, strlen(name), studentRoll(list, i));
+    }
+    if (index->broken) {
+        nameIndexReset(index);
+        index->broken = 1; // Queries scan until a later rebuild succeeds
+        return 0;
+    }
+    return 1;
+}
+
+int enableNameIndex(StudentList *list) {
+    if (list->names == NULL) {
+        list->names = calloc(1, sizeof(struct NameIndex));
+        if (list->names == NULL) {
+            return 0; // Failure: out of memory
+        }
+    }
+    return rebuildNameIndex(list);
+}
+
+void disableNameIndex(StudentList *list) {
+    if (list->names != NULL) {
+        nameIndexReset(list->names);
+        free(list->names);
+        list->names = NULL;
+    }
+}
+
+// --- Queries ---
+
+static int nameMatches(const char *name, const char *query, size_t qlen, NameMatch mode, int caseSensitive) {
+    size_t nlen = strlen(name);
+    if (nlen < qlen) return 0;
+    size_t last = mode == NAME_MATCH_PREFIX ? 0 : nlen - qlen;
+    for (size_t at = 0; at <= last; at++) {
+        size_t i = 0;
+        if (caseSensitive) {
+            while (i < qlen && name[at + i] == query[i]) i++;
+        } else {
+            while (i < qlen && lowerAscii(name[at + i]) == lowerAscii(query[i])) i++;
+        }
+        if (i == qlen) return 1;
+    }
+    return 0;
+}
+
+// Small open-addressing set of rolls, so a roll posted twice is listed once
+typedef struct {
+    int *slots;
+    char *used;
+    unsigned mask;
+} RollSet;
+
+static int rollSetInsert(RollSet *set, int roll) {
+    unsigned i = ((unsigned)roll * 0x9E3779B1U) & set->mask;
+    while (set->used[i]) {
+        if (set->slots[i] == roll) return 0;
+        i = (i + 1) & set->mask;
+    }
+    set->used[i] = 1;
+    set->slots[i] = roll;
+    return 1;
+}
+
+typedef struct {
+    const char *name;
+    int roll;
+    int row;
+} NameHit;
+
+static int compareHits(const void *a, const void *b) {
+    const NameHit *x = a, *y = b;
+    const char *p = x->name, *q = y->name;
+    for (; *p && lowerAscii(*p) == lowerAscii(*q); p++, q++) {}
+    int diff = (unsigned char)lowerAscii(*p) - (unsigned char)lowerAscii(*q);
+    if (diff != 0) return diff;
+    return (x->roll > y->roll) - (x->roll < y->roll);
+}
+
+// hits[0..count) is a max-heap under compareHits: hits[0] is the match
+// that sorts last, the first to go when a better one turns up
+static void siftDown(NameHit *hits, int count, int i) {
+    for (;;) {
+        int largest = i, left = 2 * i + 1, right = left + 1;
+        if (left < count && compareHits(&hits[left], &hits[largest]) > 0) largest = left;
+        if (right < count && compareHits(&hits[right], &hits[largest]) > 0) largest = right;
+        if (largest == i) return;
+        NameHit tmp = hits[i];
+        hits[i] = hits[largest];
+        hits[largest] = tmp;
+        i = largest;
+    }
+}
+
+static void keepBest(NameHit *hits, int *count, int limit, NameHit hit) {
+    if (*count == limit) {
+        if (compareHits(&hit, &hits[0]) >= 0) return;
+        hits[0] = hit;
+        siftDown(hits, limit, 0);
+        return;
+    }
+    int i = (*count)++;
+    hits[i] = hit;
+    while (i > 0 && compareHits(&hits[(i - 1) / 2], &hits[i]) < 0) {
+        NameHit tmp = hits[i];
+        hits[i] = hits[(i - 1) / 2];
+        hits[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+static int findByName(StudentList *list, const char *query, NameMatch mode, int caseSensitive, int *rows, int limit) {
+    size_t qlen = strlen(query);
+    if (limit <= 0 || qlen == 0) {
+        return 0;
+    }
+
+    struct NameIndex *index = list->names;
+    if (index != NULL && (index->broken || index->staleEntries > index->liveEntries + 1024)) {
+        rebuildNameIndex(list);
+    }
+
+    // Pick the rarest gram of the query; prefix queries may use the start marker
+    const Posting *candidates = NULL;
+    int useIndex = 0;
+    if (index != NULL && !index->broken && qlen + (mode == NAME_MATCH_PREFIX) >= 3) {
+        unsigned *keys;
+        int n = nameGrams(query, qlen, mode == NAME_MATCH_PREFIX, &keys);
+        if (n > 0) {
+            useIndex = 1;
+            for (int i = 0; i < n; i++) {
+                const Posting *p = findPosting(index, keys[i]);
+                if (p == NULL) {
+                    candidates = NULL; // Some gram appears in no name at all
+                    break;
+                }
+                if (candidates == NULL || p->count < candidates->count) candidates = p;
+            }
+        }
+        free(keys);
+        if (useIndex && candidates == NULL) {
+            return 0;
+        }
+    }
+
+    int total = useIndex ? candidates->count : list->count;
+    int most = limit < total ? limit : total;
+    int setSize = 16; // Every candidate is looked at, so the set may see them all
+    while (useIndex && setSize < 2 * total) setSize *= 2;
+    RollSet seen = { malloc((size_t)setSize * sizeof(int)), calloc((size_t)setSize, 1), (unsigned)setSize - 1 };
+    NameHit *hits = malloc((size_t)most * sizeof(NameHit) + 1);
+    if (seen.slots == NULL || seen.used == NULL || hits == NULL) {
+        free(seen.slots);
+        free(seen.used);
+        free(hits);
+        return 0; // Out of memory
+    }
+
+    // Every match is considered, and the `limit` that sort first are kept
+    int found = 0;
+    for (int i = 0; i < total; i++) {
+        int row = useIndex ? findStudentRow(list, candidates->rolls[i]) : i;
+        if (row == -1) continue; // Stale: student was removed
+        const char *name = studentName(list, row);
+        if (!nameMatches(name, query, qlen, mode, caseSensitive)) continue;
+        if (useIndex && !rollSetInsert(&seen, studentRoll(list, row))) continue;
+        NameHit hit = { name, studentRoll(list, row), row };
+        keepBest(hits, &found, most, hit);
+    }
+
+    // Alphabetical, case-insensitive, for display
+    qsort(hits, (size_t)found, sizeof(NameHit), compareHits);
+    for (int i = 0; i < found; i++) rows[i] = hits[i].row;
+    free(hits);
+    free(seen.slots);
+    free(seen.used);
+    return found;
+}
+
+int searchByName(StudentList *list, const char *query, NameMatch mode, int caseSensitive, int *rows, int limit) {
+    PERF_BEGIN();
+    int found = findByName(list, query, mode, caseSensitive, rows, limit);
+    PERF_END(PERF_NAME_SEARCH);
+    return found;
+}
@@ -0,0 +1,349 @@
+#include "student_logic.h"
+#include "student_perf.h"
+#include <stdlib.h>
+#include <string.h>
+
+// --- Roll Order ---
+// Every roll in the list, ascending, kept apart from the storage order: a
+// sorted array plus a delta buffer. Adds are appended to the buffer
+// unsorted; removals flag the roll's key as dead (or drop it from the
+// buffer). A query first sorts whatever the buffer gained since the last
+// one, and once dead keys and buffered rolls together pass an eighth of the
+// array, merges everything back into one sorted array. Between merges a
+// scan walks the array and the buffer side by side, skipping dead keys.
+//
+// Like the name index it holds rolls rather than slots, so sorting the list
+// leaves it untouched; rows are looked up through the roll hash index as the
+// scan produces them.
+
+#define SMALL_SORT 64   // Insertion sort below this
+
+struct RollOrder {
+    int *keys;                  // Ascending
+    unsigned long long *dead;   // Bit per key: removed since the last merge
+    int count, capacity;
+    int deadCount;
+    int *pending;               // Added since the last merge
+    int pendingCount, pendingCapacity;
+    int pendingSorted;          // pending[0..pendingSorted) is ascending
+    int broken;                 // An allocation failed: rebuild before trusting it
+};
+
+static int growInts(int **array, int *capacity, int needed) {
+    if (needed <= *capacity) return 1;
+    int grown = *capacity < 16 ? 16 : *capacity;
+    while (grown < needed) grown = grown > 0x3fffffff ? needed : grown * 2;
+    int *bigger = realloc(*array, (size_t)grown * sizeof(int));
+    if (bigger == NULL) return 0;
+    *array = bigger;
+    *capacity = grown;
+    return 1;
+}
+
+static int isDead(const struct RollOrder *order, int i) {
+    return (order->dead[i / 64] >> (i % 64)) & 1;
+}
+
+// Stable LSD radix sort of rolls (signed), 8 bits per pass; tmp holds n.
+static void sortRolls(int *rolls, int *tmp, int n) {
+    if (n < SMALL_SORT) {
+        for (int i = 1; i < n; i++) {
+            int v = rolls[i], j = i - 1;
+            while (j >= 0 && rolls[j] > v) {
+                rolls[j + 1] = rolls[j];
+                j--;
+            }
+            rolls[j + 1] = v;
+        }
+        return;
+    }
+    for (int shift = 0; shift < 32; shift += 8) {
+        int counts[257] = { 0 };
+        for (int i = 0; i < n; i++) counts[((((unsigned)rolls[i] ^ 0x80000000U) >> shift) & 0xFF) + 1]++;
+        if (counts[((((unsigned)rolls[0] ^ 0x80000000U) >> shift) & 0xFF) + 1] == n) continue;
+        for (int b = 0; b < 256; b++) counts[b + 1] += counts[b];
+        for (int i = 0; i < n; i++) tmp[counts[(((unsigned)rolls[i] ^ 0x80000000U) >> shift) & 0xFF]++] = rolls[i];
+        memcpy(rolls, tmp, (size_t)n * sizeof(int));
+    }
+}
+
+// First index in a[0..n) whose value is >= roll
+static int lowerBound(const int *a, int n, int roll) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (a[mid] < roll) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void freeOrder(struct RollOrder *order) {
+    if (order == NULL) return;
+    free(order->keys);
+    free(order->dead);
+    free(order->pending);
+    free(order);
+}
+
+void freeRollOrder(StudentList *list) {
+    freeOrder(list->order);
+    list->order = NULL;
+}
+
+int buildRollOrder(StudentList *list) {
+    int n = list->count;
+    struct RollOrder *order = calloc(1, sizeof(*order));
+    int *tmp = malloc((size_t)n * sizeof(int) + 1);
+    if (order != NULL) {
+        order->keys = malloc((size_t)n * sizeof(int) + 1);
+        order->dead = calloc((size_t)n / 64 + 1, sizeof(unsigned long long));
+    }
+    if (order == NULL || tmp == NULL || order->keys == NULL || order->dead == NULL) {
+        freeOrder(order);
+        free(tmp);
+        return 0; // Failure: the old order (if any) stays
+    }
+    if (list->layout == LAYOUT_COLUMNS) {
+        memcpy(order->keys, list->rolls, (size_t)n * sizeof(int));
+    } else {
+        for (int i = 0; i < n; i++) order->keys[i] = list->students[i].roll;
+    }
+    sortRolls(order->keys, tmp, n);
+    free(tmp);
+    order->count = n;
+    order->capacity = n;
+    freeRollOrder(list);
+    list->order = order;
+    return 1;
+}
+
+// Folds the live keys and the (sorted) buffer into a fresh array.
+static int mergeOrder(struct RollOrder *order) {
+    int n = order->count - order->deadCount + order->pendingCount;
+    int *keys = malloc((size_t)n * sizeof(int) + 1);
+    unsigned long long *dead = calloc((size_t)n / 64 + 1, sizeof(unsigned long long));
+    if (keys == NULL || dead == NULL) {
+        free(keys);
+        free(dead);
+        return 0;
+    }
+    int i = 0, j = 0, k = 0;
+    while (i < order->count || j < order->pendingCount) {
+        if (i < order->count && isDead(order, i)) {
+            i++;
+        } else if (j == order->pendingCount || (i < order->count && order->keys[i] < order->pending[j])) {
+            keys[k++] = order->keys[i++];
+        } else {
+            keys[k++] = order->pending[j++];
+        }
+    }
+    free(order->keys);
+    free(order->dead);
+    order->keys = keys;
+    order->dead = dead;
+    order->count = order->capacity = n;
+    order->deadCount = 0;
+    order->pendingCount = order->pendingSorted = 0;
+    return 1;
+}
+
+// Makes the order ready to read: built, buffer sorted, and merged when
+// dead keys or the buffer have grown too big. 0 if out of memory.
+int settleRollOrder(StudentList *list) {
+    struct RollOrder *order = list->order;
+    if (order == NULL || order->broken) {
+        return buildRollOrder(list);
+    }
+    if (order->pendingSorted < order->pendingCount) {
+        // Sort the new tail, then merge it with the sorted front
+        int sorted = order->pendingSorted, n = order->pendingCount;
+        int *tmp = malloc((size_t)n * sizeof(int));
+        if (tmp == NULL) return 0;
+        sortRolls(order->pending + sorted, tmp, n - sorted);
+        int i = 0, j = sorted, k = 0;
+        while (i < sorted && j < n) {
+            tmp[k++] = order->pending[i] < order->pending[j] ? order->pending[i++] : order->pending[j++];
+        }
+        while (i < sorted) tmp[k++] = order->pending[i++];
+        while (j < n) tmp[k++] = order->pending[j++];
+        memcpy(order->pending, tmp, (size_t)n * sizeof(int));
+        free(tmp);
+        order->pendingSorted = n;
+    }
+    if (order->deadCount + order->pendingCount > order->count / 8 + SMALL_SORT) {
+        mergeOrder(order); // Not merging only costs some speed
+    }
+    return 1;
+}
+
+int copyRollOrder(StudentList *dst, const StudentList *src) {
+    const struct RollOrder *from = src->order;
+    if (from == NULL || from->broken) {
+        freeRollOrder(dst);
+        return 1; // Built on first use
+    }
+    struct RollOrder *order = dst->order;
+    if (order == NULL) {
+        order = dst->order = calloc(1, sizeof(*order));
+        if (order == NULL) return 0;
+    }
+    int keyCapacity = order->capacity;
+    if (!growInts(&order->keys, &keyCapacity, from->count)) {
+        freeRollOrder(dst);
+        return 0;
+    }
+    if (keyCapacity != order->capacity || order->dead == NULL) {
+        unsigned long long *dead = realloc(order->dead, ((size_t)keyCapacity / 64 + 1) * sizeof(unsigned long long));
+        if (dead == NULL) {
+            freeRollOrder(dst);
+            return 0;
+        }
+        order->dead = dead;
+        order->capacity = keyCapacity;
+    }
+    if (!growInts(&order->pending, &order->pendingCapacity, from->pendingCount)) {
+        freeRollOrder(dst);
+        return 0;
+    }
+    if (from->count > 0) {
+        memcpy(order->keys, from->keys, (size_t)from->count * sizeof(int));
+        memcpy(order->dead, from->dead, ((size_t)from->count / 64 + 1) * sizeof(unsigned long long));
+    }
+    if (from->pendingCount > 0) {
+        memcpy(order->pending, from->pending, (size_t)from->pendingCount * sizeof(int));
+    }
+    order->count = from->count;
+    order->deadCount = from->deadCount;
+    order->pendingCount = from->pendingCount;
+    order->pendingSorted = from->pendingSorted;
+    order->broken = 0;
+    return 1;
+}
+
+// --- Incremental Updates ---
+
+void rollOrderAdd(struct RollOrder *order, int roll) {
+    if (order->broken) return;
+    if (!growInts(&order->pending, &order->pendingCapacity, order->pendingCount + 1)) {
+        order->broken = 1;
+        return;
+    }
+    order->pending[order->pendingCount++] = roll;
+}
+
+void rollOrderRemove(struct RollOrder *order, int roll) {
+    if (order->broken) return;
+    int i = lowerBound(order->keys, order->count, roll);
+    if (i < order->count && order->keys[i] == roll && !isDead(order, i)) {
+        order->dead[i / 64] |= 1ull << (i % 64);
+        order->deadCount++;
+        return;
+    }
+    // Added since the last merge
+    int at = lowerBound(order->pending, order->pendingSorted, roll);
+    if (at < order->pendingSorted && order->pending[at] == roll) {
+        memmove(order->pending + at, order->pending + at + 1,
+                (size_t)(order->pendingCount - at - 1) * sizeof(int));
+        order->pendingSorted--;
+        order->pendingCount--;
+        return;
+    }
+    for (at = order->pendingSorted; at < order->pendingCount; at++) {
+        if (order->pending[at] == roll) {
+            order->pending[at] = order->pending[--order->pendingCount]; // Tail is unsorted anyway
+            return;
+        }
+    }
+}
+
+// --- Queries ---
+
+typedef struct {
+    const struct RollOrder *order;
+    int i, j;   // Next key, next buffered roll
+} RollWalk;
+
+// Positions walk at the first roll >= from.
+static void walkStart(RollWalk *walk, const struct RollOrder *order, int from) {
+    walk->order = order;
+    walk->i = lowerBound(order->keys, order->count, from);
+    walk->j = lowerBound(order->pending, order->pendingCount, from);
+}
+
+// Next roll in ascending order; 0 at the end.
+static int walkNext(RollWalk *walk, int *roll) {
+    const struct RollOrder *order = walk->order;
+    while (walk->i < order->count && isDead(order, walk->i)) walk->i++;
+    int haveKey = walk->i < order->count, havePending = walk->j < order->pendingCount;
+    if (!haveKey && !havePending) return 0;
+    if (haveKey && (!havePending || order->keys[walk->i] < order->pending[walk->j])) {
+        *roll = order->keys[walk->i++];
+    } else {
+        *roll = order->pending[walk->j++];
+    }
+    return 1;
+}
+
+// Largest roll < before; 0 if there is none.
+static int walkBack(const struct RollOrder *order, int before, int *roll) {
+    int i = lowerBound(order->keys, order->count, before) - 1;
+    while (i >= 0 && isDead(order, i)) i--;
+    int j = lowerBound(order->pending, order->pendingCount, before) - 1;
+    if (i < 0 && j < 0) return 0;
+    *roll = i < 0 ? order->pending[j] : j < 0 ? order->keys[i]
+          : order->keys[i] > order->pending[j] ? order->keys[i] : order->pending[j];
+    return 1;
+}
+
+int rollRange(StudentList *list, int from, int to, int *rows, int limit) {
+    PERF_BEGIN();
+    int found = 0;
+    if (!settleRollOrder(list)) {
+        found = -1;
+    } else {
+        RollWalk walk;
+        int roll;
+        walkStart(&walk, list->order, from);
+        while (found < limit && walkNext(&walk, &roll) && roll <= to) {
+            rows[found++] = findStudentRow(list, roll);
+        }
+    }
+    PERF_END(PERF_ROLL_RANGE);
+    return found;
+}
+
+int rollRangeCount(StudentList *list, int from, int to) {
+    if (from > to) return 0;
+    if (!settleRollOrder(list)) return -1;
+    const struct RollOrder *order = list->order;
+    int lo = lowerBound(order->keys, order->count, from);
+    int hi = to == 0x7fffffff ? order->count : lowerBound(order->keys, order->count, to + 1);
+    int found = hi - lo;
+    for (int i = lo; i < hi; ) {
+        if (i % 64 == 0 && hi - i >= 64) {
+            found -= __builtin_popcountll(order->dead[i / 64]); // A whole word at a time
+            i += 64;
+        } else {
+            found -= isDead(order, i);
+            i++;
+        }
+    }
+    int plo = lowerBound(order->pending, order->pendingCount, from);
+    int phi = to == 0x7fffffff ? order->pendingCount : lowerBound(order->pending, order->pendingCount, to + 1);
+    return found + phi - plo;
+}
+
+int nextStudent(StudentList *list, int roll) {
+    if (roll == 0x7fffffff || !settleRollOrder(list)) return -1;
+    RollWalk walk;
+    int next;
+    walkStart(&walk, list->order, roll + 1);
+    return walkNext(&walk, &next) ? findStudentRow(list, next) : -1;
+}
+
+int previousStudent(StudentList *list, int roll) {
+    int previous;
+    if (!settleRollOrder(list)) return -1;
+    return walkBack(list->order, roll, &previous) ? findStudentRow(list, previous) : -1;
+}
@@ -0,0 +1,1205 @@
+#include "student_paged.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// --- File Layout ---
+// <path>:     page 0 is the header, then pages of RECORDS_PER_PAGE records.
+//             Slot s is record s % RECORDS_PER_PAGE of page 1 + s / RECORDS_PER_PAGE.
+// <path>.idx: RollIndexEntry pairs sorted by roll, INDEX_PER_PAGE to a page.
+
+#define PAGED_MAGIC "SRSPAGE1"
+#define RECORDS_PER_PAGE ((long long)(PAGED_PAGE_SIZE / sizeof(PagedRecord)))
+#define INDEX_PER_PAGE ((long long)(PAGED_PAGE_SIZE / sizeof(RollIndexEntry)))
+#define MIN_FRAMES 16
+#define SCAN_PAGES 16           // Pages per read when scanning
+#define STREAM_BYTES 65536      // Buffer per sequential reader / writer
+#define DELTA_EMPTY (-1)
+#define DELTA_REMOVED (-2)
+
+typedef struct {
+    char magic[8];
+    unsigned pageSize, recordSize;
+    long long slots, indexEntries;
+    int count;
+    int clean;
+    RunningStats stats;
+} PagedHeader;
+
+_Static_assert(sizeof(PagedHeader) <= PAGED_PAGE_SIZE, "header must fit in page 0");
+
+// pread/pwrite the whole range. readAt returns the bytes read (short at end
+// of file), or -1.
+static long long readAt(int fd, void *buffer, size_t size, long long offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, (char *)buffer + done, size - done, (off_t)(offset + (long long)done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) break;
+        done += (size_t)n;
+    }
+    return (long long)done;
+}
+
+static int writeAt(int fd, const void *buffer, size_t size, long long offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pwrite(fd, (const char *)buffer + done, size - done, (off_t)(offset + (long long)done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        done += (size_t)n;
+    }
+    return 1;
+}
+
+static void suffixedPath(char *out, size_t size, const char *path, const char *suffix) {
+    snprintf(out, size, "%s%s", path, suffix);
+}
+
+// --- Buffer Pool ---
+// Frames are found by (fd, page) through an open-addressing table; a freed
+// table slot is filled by shifting later entries back, so there are no
+// tombstones. Victims are chosen by CLOCK. A page pointer stays valid until
+// the next call that can evict (the next poolPage).
+
+typedef struct {
+    int fd;          // -1: free
+    int dirty;
+    int referenced;  // Used since the hand last passed
+    long long page;
+} Frame;
+
+struct PagePool {
+    char *memory;    // frameCount pages
+    Frame *frames;
+    int frameCount, hand;
+    int *table;      // Frame numbers; -1 = empty
+    unsigned tableMask;
+    PagedPoolStats stats;
+};
+
+static unsigned frameHash(int fd, long long page) {
+    unsigned long long h = ((unsigned long long)page << 10 ^ (unsigned)fd) * 0x9E3779B97F4A7C15ull;
+    return (unsigned)(h >> 32);
+}
+
+static struct PagePool *poolCreate(int frameCount) {
+    struct PagePool *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) return NULL;
+    unsigned tableSize = 1;
+    while (tableSize < (unsigned)frameCount * 2) tableSize <<= 1;
+    pool->frames = malloc((size_t)frameCount * sizeof(Frame));
+    pool->table = malloc(tableSize * sizeof(int));
+    if (posix_memalign((void **)&pool->memory, 4096, (size_t)frameCount * PAGED_PAGE_SIZE) != 0) pool->memory = NULL;
+    if (pool->frames == NULL || pool->table == NULL || pool->memory == NULL) {
+        free(pool->frames);
+        free(pool->table);
+        free(pool->memory);
+        free(pool);
+        return NULL;
+    }
+    for (int f = 0; f < frameCount; f++) pool->frames[f] = (Frame){ -1, 0, 0, 0 };
+    memset(pool->table, -1, tableSize * sizeof(int));
+    pool->tableMask = tableSize - 1;
+    pool->frameCount = frameCount;
+    pool->stats.frames = frameCount;
+    return pool;
+}
+
+static void poolDestroy(struct PagePool *pool) {
+    if (pool == NULL) return;
+    free(pool->frames);
+    free(pool->table);
+    free(pool->memory);
+    free(pool);
+}
+
+static int poolFind(const struct PagePool *pool, int fd, long long page) {
+    for (unsigned i = frameHash(fd, page) & pool->tableMask;; i = (i + 1) & pool->tableMask) {
+        int f = pool->table[i];
+        if (f < 0) return -1;
+        if (pool->frames[f].fd == fd && pool->frames[f].page == page) return f;
+    }
+}
+
+static void poolForget(struct PagePool *pool, int f) {
+    Frame *frame = &pool->frames[f];
+    unsigned mask = pool->tableMask;
+    unsigned hole = frameHash(frame->fd, frame->page) & mask;
+    while (pool->table[hole] != f) hole = (hole + 1) & mask;
+    pool->table[hole] = -1;
+    // Backward shift: move up any entry whose probe run crossed the hole
+    for (unsigned j = (hole + 1) & mask; pool->table[j] >= 0; j = (j + 1) & mask) {
+        const Frame *moved = &pool->frames[pool->table[j]];
+        unsigned home = frameHash(moved->fd, moved->page) & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            pool->table[hole] = pool->table[j];
+            pool->table[j] = -1;
+            hole = j;
+        }
+    }
+    frame->fd = -1;
+    frame->dirty = 0;
+}
+
+static int poolWriteBack(struct PagePool *pool, int f) {
+    Frame *frame = &pool->frames[f];
+    if (!frame->dirty) return 1;
+    if (!writeAt(frame->fd, pool->memory + (size_t)f * PAGED_PAGE_SIZE, PAGED_PAGE_SIZE,
+                 frame->page * PAGED_PAGE_SIZE)) {
+        return 0;
+    }
+    frame->dirty = 0;
+    pool->stats.writes++;
+    return 1;
+}
+
+// Page `page` of fd, read in if needed (zeros past the end of the file).
+// forWrite marks it dirty. NULL on an I/O error.
+static char *poolPage(struct PagePool *pool, int fd, long long page, int forWrite) {
+    int f = poolFind(pool, fd, page);
+    if (f >= 0) {
+        pool->stats.hits++;
+    } else {
+        pool->stats.misses++;
+        while (pool->frames[pool->hand].fd >= 0 && pool->frames[pool->hand].referenced) {
+            pool->frames[pool->hand].referenced = 0; // Second chance
+            pool->hand = (pool->hand + 1) % pool->frameCount;
+        }
+        f = pool->hand;
+        pool->hand = (pool->hand + 1) % pool->frameCount;
+        if (pool->frames[f].fd >= 0) {
+            if (!poolWriteBack(pool, f)) return NULL;
+            poolForget(pool, f);
+        }
+        char *data = pool->memory + (size_t)f * PAGED_PAGE_SIZE;
+        long long n = readAt(fd, data, PAGED_PAGE_SIZE, page * PAGED_PAGE_SIZE);
+        if (n < 0) return NULL;
+        memset(data + n, 0, (size_t)(PAGED_PAGE_SIZE - n));
+        pool->stats.reads++;
+        pool->frames[f] = (Frame){ fd, 0, 0, page };
+        unsigned i = frameHash(fd, page) & pool->tableMask;
+        while (pool->table[i] >= 0) i = (i + 1) & pool->tableMask;
+        pool->table[i] = f;
+    }
+    pool->frames[f].referenced = 1;
+    if (forWrite) pool->frames[f].dirty = 1;
+    return pool->memory + (size_t)f * PAGED_PAGE_SIZE;
+}
+
+static int poolFlush(struct PagePool *pool, int fd) {
+    for (int f = 0; f < pool->frameCount; f++) {
+        if (pool->frames[f].fd == fd && !poolWriteBack(pool, f)) return 0;
+    }
+    return 1;
+}
+
+static void poolDiscard(struct PagePool *pool, int fd) { // fd's file was replaced
+    for (int f = 0; f < pool->frameCount; f++) {
+        if (pool->frames[f].fd == fd) poolForget(pool, f);
+    }
+}
+
+// Writes back and drops every page, and hands the frames' memory back to
+// the system, so a sort can use the same amount. Pages fault back in on use.
+static int poolRelease(struct PagePool *pool) {
+    for (int f = 0; f < pool->frameCount; f++) {
+        if (pool->frames[f].fd < 0) continue;
+        if (!poolWriteBack(pool, f)) return 0;
+        poolForget(pool, f);
+    }
+    madvise(pool->memory, (size_t)pool->frameCount * PAGED_PAGE_SIZE, MADV_DONTNEED);
+    return 1;
+}
+
+// --- Sequential I/O ---
+// Readers and writers of fixed-size items stored back to back from offset
+// 0 (index files and sort runs), STREAM_BYTES at a time.
+
+typedef struct {
+    int fd;
+    size_t size;
+    char *buffer;
+    size_t capacity, have, pos;  // In items
+    long long next, end;         // Items in the file
+    int failed;
+} BlockReader;
+
+static int readerInit(BlockReader *r, int fd, size_t size, long long first, long long end) {
+    memset(r, 0, sizeof(*r));
+    r->fd = fd;
+    r->size = size;
+    r->capacity = STREAM_BYTES / size;
+    r->next = first;
+    r->end = end;
+    r->buffer = malloc(r->capacity * size);
+    return r->buffer != NULL;
+}
+
+static const void *readerNext(BlockReader *r) {
+    if (r->pos == r->have) {
+        if (r->next >= r->end) return NULL;
+        long long n = r->end - r->next;
+        if (n > (long long)r->capacity) n = (long long)r->capacity;
+        if (readAt(r->fd, r->buffer, (size_t)n * r->size, r->next * (long long)r->size) != n * (long long)r->size) {
+            r->failed = 1;
+            return NULL;
+        }
+        r->next += n;
+        r->have = (size_t)n;
+        r->pos = 0;
+    }
+    return r->buffer + r->pos++ * r->size;
+}
+
+typedef struct {
+    int fd;
+    size_t size;
+    char *buffer;
+    size_t capacity, used;       // In items
+    long long written;           // Items flushed to the file
+    int failed;
+} BlockWriter;
+
+static int writerInit(BlockWriter *w, int fd, size_t size, long long first) {
+    memset(w, 0, sizeof(*w));
+    w->fd = fd;
+    w->size = size;
+    w->capacity = STREAM_BYTES / size;
+    w->written = first;
+    w->buffer = malloc(w->capacity * size);
+    return w->buffer != NULL;
+}
+
+static int writerFlush(BlockWriter *w) {
+    if (w->used > 0 && !w->failed) {
+        if (!writeAt(w->fd, w->buffer, w->used * w->size, w->written * (long long)w->size)) w->failed = 1;
+        w->written += (long long)w->used;
+    }
+    w->used = 0;
+    return !w->failed;
+}
+
+static int writerPut(BlockWriter *w, const void *item) {
+    if (w->used == w->capacity && !writerFlush(w)) return 0;
+    memcpy(w->buffer + w->used++ * w->size, item, w->size);
+    return 1;
+}
+
+// Reads the data file a few pages at a time, bypassing the pool (which must
+// be flushed first).
+typedef struct {
+    int fd;
+    char *pages;             // SCAN_PAGES pages
+    long long slot, slots;   // Next slot, end
+    long long firstPage;     // Of the data pages in `pages`; -1 = none
+    int failed;
+} DataReader;
+
+static int dataReaderInit(DataReader *r, int fd, long long slots) {
+    memset(r, 0, sizeof(*r));
+    r->fd = fd;
+    r->slots = slots;
+    r->firstPage = -1;
+    r->pages = malloc((size_t)SCAN_PAGES * PAGED_PAGE_SIZE);
+    return r->pages != NULL;
+}
+
+// The next live record and its slot; NULL at the end (or on failure)
+static const PagedRecord *dataReaderNext(DataReader *r, long long *slotOut) {
+    for (; r->slot < r->slots; r->slot++) {
+        long long page = r->slot / RECORDS_PER_PAGE;
+        if (r->firstPage < 0 || page >= r->firstPage + SCAN_PAGES) {
+            long long n = readAt(r->fd, r->pages, (size_t)SCAN_PAGES * PAGED_PAGE_SIZE, (1 + page) * PAGED_PAGE_SIZE);
+            if (n < 0) {
+                r->failed = 1;
+                return NULL;
+            }
+            memset(r->pages + n, 0, (size_t)((long long)SCAN_PAGES * PAGED_PAGE_SIZE - n));
+            r->firstPage = page;
+        }
+        const PagedRecord *record = (const PagedRecord *)(r->pages + (page - r->firstPage) * PAGED_PAGE_SIZE)
+                                    + r->slot % RECORDS_PER_PAGE;
+        if (record->live) {
+            *slotOut = r->slot++;
+            return record;
+        }
+    }
+    return NULL;
+}
+
+// Writes records densely from slot 0 into a data file being built
+typedef struct {
+    int fd;
+    char *pages;             // SCAN_PAGES pages
+    long long slots;         // Written so far
+    int failed;
+} DataWriter;
+
+static int dataWriterInit(DataWriter *w, int fd) {
+    memset(w, 0, sizeof(*w));
+    w->fd = fd;
+    w->pages = calloc(SCAN_PAGES, PAGED_PAGE_SIZE);
+    return w->pages != NULL;
+}
+
+static int dataWriterFlush(DataWriter *w) {
+    long long inBuffer = w->slots % (SCAN_PAGES * RECORDS_PER_PAGE);
+    if (inBuffer == 0 && w->slots > 0) inBuffer = SCAN_PAGES * RECORDS_PER_PAGE;
+    long long pages = (inBuffer + RECORDS_PER_PAGE - 1) / RECORDS_PER_PAGE;
+    long long firstPage = (w->slots - inBuffer) / RECORDS_PER_PAGE;
+    if (pages > 0 && !w->failed &&
+        !writeAt(w->fd, w->pages, (size_t)pages * PAGED_PAGE_SIZE, (1 + firstPage) * PAGED_PAGE_SIZE)) {
+        w->failed = 1;
+    }
+    memset(w->pages, 0, (size_t)SCAN_PAGES * PAGED_PAGE_SIZE);
+    return !w->failed;
+}
+
+static int dataWriterPut(DataWriter *w, const PagedRecord *record) {
+    long long at = w->slots % (SCAN_PAGES * RECORDS_PER_PAGE);
+    if (at == 0 && w->slots > 0 && !dataWriterFlush(w)) return 0;
+    PagedRecord *slot = (PagedRecord *)(w->pages + at / RECORDS_PER_PAGE * PAGED_PAGE_SIZE) + at % RECORDS_PER_PAGE;
+    *slot = *record;
+    w->slots++;
+    return 1;
+}
+
+// --- External Merge Sort ---
+// Reads the source into runs of as many items as fit in `memory`, sorts
+// each (stable merge sort of pointers) and appends it to a run file, then
+// merges up to the fan-in at a time, through a second run file when there
+// are more runs than that. Ties go to the earlier run, so the whole sort
+// is stable. A source that fits in one run never touches the disk.
+
+typedef int (*ItemCompare)(const void *a, const void *b, void *ctx);
+typedef const void *(*ItemSource)(void *ctx);         // NULL at the end
+typedef int (*ItemSink)(void *ctx, const void *item); // 0 stops the sort
+
+typedef struct {
+    size_t size;
+    ItemCompare compare;
+    void *compareCtx;
+    size_t memory;
+    const char *runPath;     // Temporary files runPath.0 and runPath.1
+} SortSpec;
+
+static void sortItems(char **items, char **scratch, size_t n, ItemCompare compare, void *ctx) {
+    if (n <= 16) {
+        for (size_t i = 1; i < n; i++) {
+            char *item = items[i];
+            size_t j = i;
+            for (; j > 0 && compare(item, items[j - 1], ctx) < 0; j--) items[j] = items[j - 1];
+            items[j] = item;
+        }
+        return;
+    }
+    size_t half = n / 2;
+    sortItems(items, scratch, half, compare, ctx);
+    sortItems(items + half, scratch, n - half, compare, ctx);
+    if (compare(items[half - 1], items[half], ctx) <= 0) return; // Already in order
+    memcpy(scratch, items, half * sizeof(char *));
+    size_t i = 0, j = half, k = 0;
+    while (i < half && j < n) items[k++] = compare(items[j], scratch[i], ctx) < 0 ? items[j++] : scratch[i++];
+    while (i < half) items[k++] = scratch[i++];
+}
+
+typedef struct {
+    BlockReader reader;
+    const void *item;
+} RunCursor;
+
+static int cursorBefore(const SortSpec *spec, const RunCursor *cursors, int a, int b) {
+    int c = spec->compare(cursors[a].item, cursors[b].item, spec->compareCtx);
+    return c != 0 ? c < 0 : a < b;
+}
+
+static void heapDown(const SortSpec *spec, const RunCursor *cursors, int *heap, int n, int i) {
+    for (;;) {
+        int least = i, l = 2 * i + 1, r = l + 1;
+        if (l < n && cursorBefore(spec, cursors, heap[l], heap[least])) least = l;
+        if (r < n && cursorBefore(spec, cursors, heap[r], heap[least])) least = r;
+        if (least == i) return;
+        int t = heap[i];
+        heap[i] = heap[least];
+        heap[least] = t;
+        i = least;
+    }
+}
+
+// Merges runs [first, first + k) of fd (bounds[i] = first item of run i)
+static int mergeRuns(const SortSpec *spec, int fd, const long long *bounds, int first, int k,
+                     ItemSink emit, void *emitCtx) {
+    RunCursor *cursors = calloc((size_t)k, sizeof(RunCursor));
+    int *heap = malloc((size_t)k * sizeof(int));
+    int ok = cursors != NULL && heap != NULL, n = 0;
+    for (int i = 0; ok && i < k; i++) {
+        ok = readerInit(&cursors[i].reader, fd, spec->size, bounds[first + i], bounds[first + i + 1]);
+        if (ok) cursors[i].item = readerNext(&cursors[i].reader);
+        if (ok && cursors[i].item != NULL) heap[n++] = i;
+        ok = ok && !cursors[i].reader.failed;
+    }
+    for (int i = n / 2 - 1; ok && i >= 0; i--) heapDown(spec, cursors, heap, n, i);
+    while (ok && n > 0) {
+        RunCursor *top = &cursors[heap[0]];
+        ok = emit(emitCtx, top->item);
+        top->item = readerNext(&top->reader);
+        if (top->reader.failed) ok = 0;
+        if (top->item == NULL) heap[0] = heap[--n];
+        heapDown(spec, cursors, heap, n, 0);
+    }
+    for (int i = 0; cursors != NULL && i < k; i++) free(cursors[i].reader.buffer);
+    free(cursors);
+    free(heap);
+    return ok;
+}
+
+static int sinkToWriter(void *ctx, const void *item) {
+    return writerPut(ctx, item);
+}
+
+static int externalSort(const SortSpec *spec, ItemSource next, void *sourceCtx, ItemSink emit, void *emitCtx) {
+    size_t perRun = spec->memory / (spec->size + 2 * sizeof(char *));
+    if (perRun < 64) perRun = 64;
+    char *items = malloc(perRun * spec->size);
+    char **order = malloc(perRun * sizeof(char *));
+    char **scratch = malloc(perRun / 2 * sizeof(char *));
+    long long *bounds = malloc(2 * sizeof(long long));
+    int boundCapacity = 2, runs = 0, ok = items && order && scratch && bounds, fds[2] = { -1, -1 };
+    char paths[2][600];
+    BlockWriter out = { .buffer = NULL };
+    if (ok) bounds[0] = 0;
+
+    // Runs
+    for (int done = 0; ok && !done;) {
+        size_t n = 0;
+        for (const void *item; n < perRun && (item = next(sourceCtx)) != NULL; n++) {
+            memcpy(items + n * spec->size, item, spec->size);
+            order[n] = items + n * spec->size;
+        }
+        done = n < perRun;
+        if (n == 0) break;
+        sortItems(order, scratch, n, spec->compare, spec->compareCtx);
+        if (runs == 0 && done) { // Fits in memory
+            for (size_t i = 0; ok && i < n; i++) ok = emit(emitCtx, order[i]);
+            goto finish;
+        }
+        if (fds[0] < 0) {
+            suffixedPath(paths[0], sizeof(paths[0]), spec->runPath, ".0");
+            fds[0] = open(paths[0], O_RDWR | O_CREAT | O_TRUNC, 0644);
+            ok = fds[0] >= 0 && writerInit(&out, fds[0], spec->size, 0);
+        }
+        for (size_t i = 0; ok && i < n; i++) ok = writerPut(&out, order[i]);
+        ok = ok && writerFlush(&out);
+        if (ok && runs + 2 > boundCapacity) {
+            long long *grown = realloc(bounds, (size_t)boundCapacity * 2 * sizeof(long long));
+            if (grown != NULL) {
+                bounds = grown;
+                boundCapacity *= 2;
+            }
+            ok = grown != NULL;
+        }
+        if (ok) bounds[++runs] = out.written;
+    }
+    free(items);
+    free(order);
+    free(scratch);
+    items = NULL;
+    order = scratch = NULL;
+
+    // Passes over the run files until one merge can finish the job
+    int fanIn = (int)(spec->memory / STREAM_BYTES) - 1;
+    if (fanIn < 2) fanIn = 2;
+    int from = 0;
+    while (ok && runs > fanIn) {
+        if (fds[1 - from] < 0) {
+            suffixedPath(paths[1 - from], sizeof(paths[1 - from]), spec->runPath, ".1");
+            fds[1 - from] = open(paths[1 - from], O_RDWR | O_CREAT | O_TRUNC, 0644);
+            ok = fds[1 - from] >= 0;
+        }
+        free(out.buffer);
+        ok = ok && writerInit(&out, fds[1 - from], spec->size, 0);
+        int merged = 0;
+        for (int first = 0; ok && first < runs; first += fanIn) {
+            int k = runs - first < fanIn ? runs - first : fanIn;
+            ok = mergeRuns(spec, fds[from], bounds, first, k, sinkToWriter, &out) && writerFlush(&out);
+            bounds[++merged] = out.written; // merged <= first, so the bounds still needed are intact
+        }
+        runs = merged;
+        from = 1 - from;
+    }
+    if (ok && runs > 0) ok = mergeRuns(spec, fds[from], bounds, 0, runs, emit, emitCtx);
+
+finish:
+    free(items);
+    free(order);
+    free(scratch);
+    free(bounds);
+    free(out.buffer);
+    for (int i = 0; i < 2; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+            remove(paths[i]);
+        }
+    }
+    return ok;
+}
+
+// --- Header, Index and Delta ---
+
+static int writeHeader(PagedStudentList *list, int fd) {
+    PagedHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PAGED_MAGIC, sizeof(header.magic));
+    header.pageSize = PAGED_PAGE_SIZE;
+    header.recordSize = sizeof(PagedRecord);
+    header.slots = list->slots;
+    header.indexEntries = list->indexEntries;
+    header.count = list->count;
+    header.clean = list->clean;
+    header.stats = list->stats;
+    return writeAt(fd, &header, sizeof(header), 0);
+}
+
+// The first change after a sync marks the file on disk as not clean, so a
+// crash before the next sync makes pagedOpen rebuild from the records.
+static int touch(PagedStudentList *list) {
+    if (!list->clean) return 1;
+    list->clean = 0;
+    return writeHeader(list, list->dataFd) && fsync(list->dataFd) == 0;
+}
+
+static PagedRecord *recordIn(PagedStudentList *list, int dataFd, long long slot, int forWrite) {
+    char *page = poolPage(list->pool, dataFd, 1 + slot / RECORDS_PER_PAGE, forWrite);
+    return page == NULL ? NULL : (PagedRecord *)page + slot % RECORDS_PER_PAGE;
+}
+
+static PagedRecord *recordAt(PagedStudentList *list, long long slot, int forWrite) {
+    return recordIn(list, list->dataFd, slot, forWrite);
+}
+
+static RollIndexEntry *deltaFind(PagedStudentList *list, int roll) {
+    unsigned i = ((unsigned)roll * 2654435761u) & list->deltaMask;
+    while (list->delta[i].slot != DELTA_EMPTY && list->delta[i].roll != roll) i = (i + 1) & list->deltaMask;
+    return &list->delta[i];
+}
+
+static void deltaPut(PagedStudentList *list, int roll, int slot) {
+    RollIndexEntry *entry = deltaFind(list, roll);
+    if (entry->slot == DELTA_EMPTY) list->deltaCount++;
+    entry->roll = roll;
+    entry->slot = slot;
+}
+
+static void deltaClear(PagedStudentList *list) {
+    for (unsigned i = 0; i <= list->deltaMask; i++) list->delta[i].slot = DELTA_EMPTY;
+    list->deltaCount = 0;
+}
+
+// Slot of roll's record: -1 if there is none, -2 on an I/O error
+static long long findSlot(PagedStudentList *list, int roll) {
+    if (list->broken) return -2;
+    const RollIndexEntry *recent = deltaFind(list, roll);
+    if (recent->slot != DELTA_EMPTY) return recent->slot == DELTA_REMOVED ? -1 : recent->slot;
+    long long pages = (list->indexEntries + INDEX_PER_PAGE - 1) / INDEX_PER_PAGE;
+    long long lo = 0, hi = pages;
+    while (lo < hi) { // Last page whose first roll is <= roll
+        long long mid = lo + (hi - lo) / 2;
+        if (list->fences[mid] <= roll) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return -1;
+    long long page = lo - 1;
+    const RollIndexEntry *entries = (const RollIndexEntry *)poolPage(list->pool, list->indexFd, page, 0);
+    if (entries == NULL) return -2;
+    long long n = list->indexEntries - page * INDEX_PER_PAGE;
+    if (n > INDEX_PER_PAGE) n = INDEX_PER_PAGE;
+    long long a = 0, b = n;
+    while (a < b) {
+        long long mid = a + (b - a) / 2;
+        if (entries[mid].roll < roll) a = mid + 1;
+        else b = mid;
+    }
+    return a < n && entries[a].roll == roll && entries[a].slot < list->slots ? entries[a].slot : -1;
+}
+
+// Writes a new index file for the records in dataFd, noting the first roll
+// of each page. Sorted input may repeat a roll only after a crash (the
+// record was re-added before its removal reached the disk): the later slot
+// wins and the earlier one is removed.
+typedef struct {
+    PagedStudentList *list;
+    int dataFd;
+    BlockWriter out;
+    int *fences;
+    long long fenceCapacity;
+    RollIndexEntry pending;
+    int hasPending;
+    int failed;
+} IndexBuild;
+
+static int indexBuildEmit(IndexBuild *build, const RollIndexEntry *entry) {
+    long long at = build->out.written + (long long)build->out.used;
+    if (at % INDEX_PER_PAGE == 0) {
+        long long page = at / INDEX_PER_PAGE;
+        if (page >= build->fenceCapacity) {
+            long long capacity = build->fenceCapacity ? build->fenceCapacity * 2 : 64;
+            int *grown = realloc(build->fences, (size_t)capacity * sizeof(int));
+            if (grown == NULL) return 0;
+            build->fences = grown;
+            build->fenceCapacity = capacity;
+        }
+        build->fences[page] = entry->roll;
+    }
+    return writerPut(&build->out, entry);
+}
+
+static int indexBuildPut(void *ctx, const void *item) {
+    IndexBuild *build = ctx;
+    const RollIndexEntry *entry = item;
+    if (build->hasPending && build->pending.roll == entry->roll) {
+        PagedRecord *stale = recordIn(build->list, build->dataFd, build->pending.slot, 1);
+        if (stale == NULL) return 0;
+        stale->live = 0;
+    } else if (build->hasPending && !indexBuildEmit(build, &build->pending)) {
+        return 0;
+    }
+    build->pending = *entry;
+    build->hasPending = 1;
+    return 1;
+}
+
+static int indexBuildBegin(IndexBuild *build, PagedStudentList *list, int dataFd, char *tmpPath, size_t size) {
+    memset(build, 0, sizeof(*build));
+    build->list = list;
+    build->dataFd = dataFd;
+    suffixedPath(tmpPath, size, list->path, ".idx.tmp");
+    int fd = open(tmpPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return 0;
+    if (!writerInit(&build->out, fd, sizeof(RollIndexEntry), 0)) {
+        close(fd);
+        return 0;
+    }
+    return 1;
+}
+
+// Writes out the rest of the new index; 0 if it is not all on disk
+static int indexBuildFinish(IndexBuild *build, int ok) {
+    if (ok && build->hasPending) ok = indexBuildEmit(build, &build->pending);
+    return ok && writerFlush(&build->out) && fsync(build->out.fd) == 0;
+}
+
+// The finished index, already renamed into place, replaces the list's
+static void indexBuildAdopt(IndexBuild *build) {
+    PagedStudentList *list = build->list;
+    poolDiscard(list->pool, list->indexFd);
+    close(list->indexFd);
+    list->indexFd = build->out.fd;
+    free(list->fences);
+    list->fences = build->fences;
+    list->fenceCapacity = build->fenceCapacity;
+    list->indexEntries = build->out.written;
+    deltaClear(list);
+    free(build->out.buffer);
+}
+
+static void indexBuildDiscard(IndexBuild *build, const char *tmpPath) {
+    close(build->out.fd);
+    remove(tmpPath);
+    free(build->fences);
+    free(build->out.buffer);
+}
+
+// Puts the new index in place of the old one (or throws it away)
+static int indexBuildEnd(IndexBuild *build, const char *tmpPath, int ok) {
+    char indexPath[600];
+    suffixedPath(indexPath, sizeof(indexPath), build->list->path, ".idx");
+    if (indexBuildFinish(build, ok) && rename(tmpPath, indexPath) == 0) {
+        indexBuildAdopt(build);
+        return 1;
+    }
+    indexBuildDiscard(build, tmpPath);
+    return 0;
+}
+
+static int compareEntries(const void *a, const void *b) {
+    const RollIndexEntry *x = a, *y = b;
+    return (x->roll > y->roll) - (x->roll < y->roll);
+}
+
+// Folds the delta into the index file: one sequential pass over both.
+// The delta is left alone unless the new index is in place.
+static int mergeDelta(PagedStudentList *list) {
+    int n = 0;
+    RollIndexEntry *sorted = malloc((size_t)list->deltaCount * sizeof(RollIndexEntry) + 1);
+    if (sorted == NULL) return 0;
+    for (unsigned i = 0; i <= list->deltaMask; i++) {
+        if (list->delta[i].slot != DELTA_EMPTY) sorted[n++] = list->delta[i];
+    }
+    qsort(sorted, (size_t)n, sizeof(RollIndexEntry), compareEntries);
+
+    IndexBuild build;
+    BlockReader old = { .buffer = NULL };
+    char tmpPath[600];
+    if (!indexBuildBegin(&build, list, list->dataFd, tmpPath, sizeof(tmpPath))) {
+        free(sorted);
+        return 0;
+    }
+    int ok = readerInit(&old, list->indexFd, sizeof(RollIndexEntry), 0, list->indexEntries);
+    const RollIndexEntry *entry = ok ? readerNext(&old) : NULL;
+    for (int j = 0; ok && (entry != NULL || j < n);) {
+        if (j == n || (entry != NULL && entry->roll < sorted[j].roll)) {
+            ok = indexBuildEmit(&build, entry);
+            entry = readerNext(&old);
+            continue;
+        }
+        if (entry != NULL && entry->roll == sorted[j].roll) entry = readerNext(&old); // Superseded
+        if (sorted[j].slot != DELTA_REMOVED) ok = indexBuildEmit(&build, &sorted[j]);
+        j++;
+    }
+    ok = ok && !old.failed;
+    free(old.buffer);
+    free(sorted);
+    return indexBuildEnd(&build, tmpPath, ok);
+}
+
+static int deltaRoom(PagedStudentList *list) {
+    return list->deltaCount < list->deltaLimit || mergeDelta(list);
+}
+
+// --- Rebuilding From the Records ---
+
+typedef struct {
+    DataReader data;
+    RollIndexEntry entry;
+} PairSource;
+
+static const void *nextPair(void *ctx) {
+    PairSource *source = ctx;
+    long long slot;
+    const PagedRecord *record = dataReaderNext(&source->data, &slot);
+    if (record == NULL) return NULL;
+    source->entry.roll = record->roll;
+    source->entry.slot = (int)slot;
+    return &source->entry;
+}
+
+static int comparePairs(const void *a, const void *b, void *ctx) {
+    (void)ctx;
+    const RollIndexEntry *x = a, *y = b;
+    if (x->roll != y->roll) return (x->roll > y->roll) - (x->roll < y->roll);
+    return (x->slot > y->slot) - (x->slot < y->slot);
+}
+
+static size_t sortMemory(const PagedStudentList *list) {
+    return (size_t)list->pool->frameCount * PAGED_PAGE_SIZE;
+}
+
+// Feeds build the pairs of the first slots records in its data file.
+// sortedByRoll: the records are already in roll order, so the pairs need
+// no sort.
+static int indexFromRecords(IndexBuild *build, long long slots, int sortedByRoll) {
+    PairSource source;
+    if (!dataReaderInit(&source.data, build->dataFd, slots)) return 0;
+    int ok = 1;
+    if (sortedByRoll) {
+        for (const void *pair; ok && (pair = nextPair(&source)) != NULL;) ok = indexBuildPut(build, pair);
+    } else {
+        char runPath[600];
+        suffixedPath(runPath, sizeof(runPath), build->list->path, ".runs");
+        SortSpec spec = { sizeof(RollIndexEntry), comparePairs, NULL, sortMemory(build->list), runPath };
+        ok = externalSort(&spec, nextPair, &source, indexBuildPut, build);
+    }
+    ok = ok && !source.data.failed;
+    free(source.data.pages);
+    return ok;
+}
+
+// A new index from the data file
+static int rebuildRollIndex(PagedStudentList *list, int sortedByRoll) {
+    if (!poolRelease(list->pool)) return 0;
+    IndexBuild build;
+    char tmpPath[600];
+    if (!indexBuildBegin(&build, list, list->dataFd, tmpPath, sizeof(tmpPath))) return 0;
+    return indexBuildEnd(&build, tmpPath, indexFromRecords(&build, list->slots, sortedByRoll));
+}
+
+// Count, stats and last used slot from the records, after a crash
+static int recount(PagedStudentList *list, long long scanSlots) {
+    if (!poolFlush(list->pool, list->dataFd)) return 0;
+    DataReader reader;
+    if (!dataReaderInit(&reader, list->dataFd, scanSlots)) return 0;
+    memset(&list->stats, 0, sizeof(list->stats));
+    list->count = 0;
+    long long slot, last = -1;
+    for (const PagedRecord *record; (record = dataReaderNext(&reader, &slot)) != NULL;) {
+        statsAdd(&list->stats, record->marks);
+        list->count++;
+        last = slot;
+    }
+    int ok = !reader.failed;
+    free(reader.pages);
+    list->slots = last + 1;
+    return ok;
+}
+
+static int loadFences(PagedStudentList *list) {
+    long long pages = (list->indexEntries + INDEX_PER_PAGE - 1) / INDEX_PER_PAGE;
+    list->fences = malloc((size_t)(pages > 0 ? pages : 1) * sizeof(int));
+    if (list->fences == NULL) return 0;
+    list->fenceCapacity = pages > 0 ? pages : 1;
+    for (long long p = 0; p < pages; p++) {
+        if (readAt(list->indexFd, &list->fences[p], sizeof(int), p * PAGED_PAGE_SIZE) != sizeof(int)) return 0;
+    }
+    return 1;
+}
+
+// --- Opening and Closing ---
+
+static void releaseList(PagedStudentList *list) {
+    poolDestroy(list->pool);
+    free(list->fences);
+    free(list->delta);
+    if (list->dataFd >= 0) close(list->dataFd);
+    if (list->indexFd >= 0) close(list->indexFd);
+    list->pool = NULL;
+    list->fences = NULL;
+    list->delta = NULL;
+    list->dataFd = list->indexFd = -1;
+}
+
+int pagedOpen(PagedStudentList *list, const char *path, size_t memoryBudget) {
+    memset(list, 0, sizeof(*list));
+    list->dataFd = list->indexFd = -1;
+    if (strlen(path) >= sizeof(list->path) - 16) return 0;
+    strcpy(list->path, path);
+    if (memoryBudget < PAGED_MIN_BUDGET) memoryBudget = PAGED_MIN_BUDGET;
+    list->budget = memoryBudget;
+
+    char indexPath[600];
+    suffixedPath(indexPath, sizeof(indexPath), path, ".idx");
+    list->dataFd = open(path, O_RDWR | O_CREAT, 0644);
+    list->indexFd = open(indexPath, O_RDWR | O_CREAT, 0644);
+    if (list->dataFd < 0 || list->indexFd < 0) goto fail;
+
+    // A quarter of the budget for the delta (half full at most), the rest for pages
+    unsigned deltaCapacity = 1024;
+    while ((size_t)deltaCapacity * 2 * sizeof(RollIndexEntry) <= memoryBudget / 4) deltaCapacity *= 2;
+    list->delta = malloc(deltaCapacity * sizeof(RollIndexEntry));
+    list->deltaMask = deltaCapacity - 1;
+    list->deltaLimit = (int)(deltaCapacity / 2);
+    size_t frames = (memoryBudget - deltaCapacity * sizeof(RollIndexEntry)) / PAGED_PAGE_SIZE;
+    list->pool = poolCreate(frames < MIN_FRAMES ? MIN_FRAMES : (int)frames);
+    if (list->delta == NULL || list->pool == NULL) goto fail;
+    deltaClear(list);
+
+    PagedHeader header;
+    long long got = readAt(list->dataFd, &header, sizeof(header), 0);
+    if (got == 0) { // New file
+        list->clean = 1;
+        if (!writeHeader(list, list->dataFd) || !loadFences(list)) goto fail;
+        return 1;
+    }
+    if (got != (long long)sizeof(header) || memcmp(header.magic, PAGED_MAGIC, sizeof(header.magic)) != 0 ||
+        header.pageSize != PAGED_PAGE_SIZE || header.recordSize != sizeof(PagedRecord)) {
+        goto fail; // Not ours
+    }
+    list->slots = header.slots;
+    list->count = header.count;
+    list->stats = header.stats;
+    list->indexEntries = header.indexEntries;
+    list->clean = header.clean;
+
+    struct stat st;
+    if (list->clean && fstat(list->indexFd, &st) == 0 &&
+        st.st_size >= list->indexEntries * (long long)sizeof(RollIndexEntry) && loadFences(list)) {
+        return 1;
+    }
+
+    // Not closed cleanly: trust only the records
+    if (fstat(list->dataFd, &st) != 0) goto fail;
+    long long pages = st.st_size > PAGED_PAGE_SIZE ? (st.st_size - 1) / PAGED_PAGE_SIZE : 0;
+    free(list->fences);
+    list->fences = NULL;
+    list->indexEntries = 0;
+    list->slots = pages * RECORDS_PER_PAGE;
+    list->clean = 0;
+    if (!rebuildRollIndex(list, 0) || !recount(list, pages * RECORDS_PER_PAGE) || !pagedSync(list)) goto fail;
+    return 1;
+
+fail:
+    releaseList(list);
+    return 0;
+}
+
+int pagedSync(PagedStudentList *list) {
+    if (list->broken) return 0; // Leaves the file unclean, so pagedOpen rebuilds the index
+    if (list->clean) return 1;
+    if (list->deltaCount > 0 && !mergeDelta(list)) return 0;
+    if (!poolFlush(list->pool, list->dataFd) || fsync(list->dataFd) != 0 || fsync(list->indexFd) != 0) {
+        return 0;
+    }
+    list->clean = 1; // Only once everything it describes is on disk
+    if (!writeHeader(list, list->dataFd) || fsync(list->dataFd) != 0) {
+        list->clean = 0;
+        return 0;
+    }
+    return 1;
+}
+
+int pagedClose(PagedStudentList *list) {
+    int ok = list->pool != NULL && pagedSync(list);
+    releaseList(list);
+    return ok;
+}
+
+void pagedPoolStats(const PagedStudentList *list, PagedPoolStats *out) {
+    *out = list->pool->stats;
+}
+
+// --- Records ---
+
+static int addRecord(PagedStudentList *list, const char *name, size_t nameLen, int roll, float marks) {
+    long long existing = findSlot(list, roll);
+    if (existing != -1) return existing == -2 ? -1 : 0; // 0: duplicate roll
+    if (list->slots >= INT_MAX || !touch(list) || !deltaRoom(list)) return -1;
+    PagedRecord *record = recordAt(list, list->slots, 1);
+    if (record == NULL) return -1;
+    memset(record, 0, sizeof(*record));
+    if (nameLen > NAME_LEN - 1) nameLen = NAME_LEN - 1;
+    memcpy(record->name, name, nameLen);
+    record->roll = roll;
+    record->marks = marks;
+    record->live = 1;
+    deltaPut(list, roll, (int)list->slots++);
+    list->count++;
+    statsAdd(&list->stats, marks);
+    return 1;
+}
+
+int pagedAddStudent(PagedStudentList *list, const char *name, int roll, float marks) {
+    return addRecord(list, name, strlen(name), roll, marks) == 1;
+}
+
+// roll's record, checked against the index; NULL if missing
+static PagedRecord *findRecord(PagedStudentList *list, int roll, int forWrite) {
+    long long slot = findSlot(list, roll);
+    if (slot < 0) return NULL;
+    PagedRecord *record = recordAt(list, slot, forWrite);
+    return record != NULL && record->live && record->roll == roll ? record : NULL;
+}
+
+int pagedRemoveStudent(PagedStudentList *list, int roll) {
+    if (findSlot(list, roll) < 0 || !touch(list) || !deltaRoom(list)) return 0;
+    PagedRecord *record = findRecord(list, roll, 1);
+    if (record == NULL) return 0;
+    record->live = 0;
+    statsRemove(&list->stats, record->marks);
+    list->count--;
+    deltaPut(list, roll, DELTA_REMOVED);
+    return 1;
+}
+
+int pagedModifyStudent(PagedStudentList *list, int roll, const char *newName, float newMarks) {
+    if (findSlot(list, roll) < 0 || !touch(list)) return 0;
+    PagedRecord *record = findRecord(list, roll, 1);
+    if (record == NULL) return 0;
+    if (newName != NULL && newName[0] != '\0') {
+        size_t len = strlen(newName);
+        if (len > NAME_LEN - 1) len = NAME_LEN - 1;
+        memset(record->name, 0, sizeof(record->name));
+        memcpy(record->name, newName, len);
+    }
+    if (newMarks >= 0) {
+        statsRemove(&list->stats, record->marks);
+        statsAdd(&list->stats, newMarks);
+        record->marks = newMarks;
+    }
+    return 1;
+}
+
+int pagedSearchStudent(PagedStudentList *list, int roll, PagedRecord *out) {
+    const PagedRecord *record = findRecord(list, roll, 0);
+    if (record == NULL) return 0;
+    *out = *record;
+    return 1;
+}
+
+// --- Scans ---
+
+int pagedScan(PagedStudentList *list, PagedVisit visit, void *ctx) {
+    if (list->broken || !poolFlush(list->pool, list->dataFd)) return 0;
+    DataReader reader;
+    if (!dataReaderInit(&reader, list->dataFd, list->slots)) return 0;
+    long long slot;
+    for (const PagedRecord *record; (record = dataReaderNext(&reader, &slot)) != NULL;) {
+        if (!visit(record, ctx)) break;
+    }
+    int ok = !reader.failed;
+    free(reader.pages);
+    return ok;
+}
+
+static int visitMinMax(const PagedRecord *record, void *ctx) {
+    RunningStats *stats = ctx;
+    if (record->marks < stats->min) stats->min = record->marks;
+    if (record->marks > stats->max) stats->max = record->marks;
+    return 1;
+}
+
+int pagedGetClassStats(PagedStudentList *list, ClassStats *out) {
+    if (list->stats.count > 0 && list->stats.minMaxStale) {
+        RunningStats fresh = list->stats;
+        fresh.min = INFINITY;
+        fresh.max = -INFINITY;
+        if (!pagedScan(list, visitMinMax, &fresh)) {
+            memset(out, 0, sizeof(*out));
+            return 0;
+        }
+        fresh.minMaxStale = 0;
+        list->stats = fresh;
+    }
+    return statsReport(&list->stats, out);
+}
+
+float pagedAverageMarks(const PagedStudentList *list) {
+    return list->stats.count == 0 ? 0.0f : (float)(list->stats.sum / list->stats.count);
+}
+
+typedef struct {
+    const SortKey *keys;
+    int keyCount;
+} RecordOrder;
+
+static int compareRecords(const void *a, const void *b, void *ctx) {
+    const RecordOrder *order = ctx;
+    const PagedRecord *x = a, *y = b;
+    for (int k = 0; k < order->keyCount; k++) {
+        int c;
+        switch (order->keys[k].field) {
+        case SORT_BY_MARKS: c = (x->marks > y->marks) - (x->marks < y->marks); break;
+        case SORT_BY_ROLL:  c = (x->roll > y->roll) - (x->roll < y->roll); break;
+        default:            c = strcmp(x->name, y->name); break;
+        }
+        if (c != 0) return order->keys[k].descending ? -c : c;
+    }
+    return 0;
+}
+
+static const void *nextRecord(void *ctx) {
+    long long slot;
+    return dataReaderNext(ctx, &slot);
+}
+
+static int sinkToData(void *ctx, const void *item) {
+    return dataWriterPut(ctx, item);
+}
+
+// Rewrites the file in the new order (dropping removed slots) and builds
+// its index, both next to the old ones, and only then renames them over.
+// Until the first rename the list is left as it was on any failure. If the
+// second rename fails, the sorted file (marked unclean) is in place with
+// the old index: the list then fails every call until pagedOpen rebuilds.
+int pagedSortBy(PagedStudentList *list, const SortKey *keys, int keyCount) {
+    if (list->broken || keyCount < 1 || keyCount > MAX_SORT_KEYS) return 0;
+    for (int k = 0; k < keyCount; k++) {
+        if (keys[k].field != SORT_BY_MARKS && keys[k].field != SORT_BY_ROLL && keys[k].field != SORT_BY_NAME) return 0;
+    }
+    if (!touch(list) || !poolRelease(list->pool)) return 0;
+
+    char sortedPath[600], runPath[600], indexTmp[600], indexPath[600];
+    suffixedPath(sortedPath, sizeof(sortedPath), list->path, ".sorting");
+    suffixedPath(runPath, sizeof(runPath), list->path, ".runs");
+    int fd = open(sortedPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return 0;
+    DataReader reader;
+    DataWriter writer;
+    int ok = dataReaderInit(&reader, list->dataFd, list->slots);
+    if (ok && !dataWriterInit(&writer, fd)) {
+        free(reader.pages);
+        ok = 0;
+    }
+    if (ok) {
+        RecordOrder order = { keys, keyCount };
+        SortSpec spec = { sizeof(PagedRecord), compareRecords, &order, sortMemory(list), runPath };
+        ok = externalSort(&spec, nextRecord, &reader, sinkToData, &writer) && !reader.failed &&
+             dataWriterFlush(&writer) && writer.slots == list->count;
+        free(reader.pages);
+        free(writer.pages);
+    }
+    long long slots = list->slots;
+    list->slots = list->count;
+    ok = ok && writeHeader(list, fd);
+    list->slots = slots;
+    IndexBuild build;
+    if (!ok || !indexBuildBegin(&build, list, fd, indexTmp, sizeof(indexTmp))) {
+        close(fd);
+        remove(sortedPath);
+        return 0;
+    }
+    ok = indexFromRecords(&build, list->count, keys[0].field == SORT_BY_ROLL && !keys[0].descending);
+    ok = indexBuildFinish(&build, ok) && poolFlush(list->pool, fd) && fsync(fd) == 0 &&
+         rename(sortedPath, list->path) == 0;
+    if (!ok) {
+        indexBuildDiscard(&build, indexTmp);
+        poolDiscard(list->pool, fd);
+        close(fd);
+        remove(sortedPath);
+        return 0;
+    }
+    close(list->dataFd);
+    list->dataFd = fd;
+    list->slots = list->count;
+    suffixedPath(indexPath, sizeof(indexPath), list->path, ".idx");
+    if (rename(indexTmp, indexPath) != 0) {
+        indexBuildDiscard(&build, indexTmp);
+        list->broken = 1;
+        return 0;
+    }
+    indexBuildAdopt(&build);
+    return 1;
+}
+
+// --- Import / Export ---
+
+typedef struct {
+    PagedStudentList *list;
+    int failed;
+} ImportState;
+
+static int importBatch(void *ctx, const StudentInput *rows, int n) {
+    ImportState *state = ctx;
+    int kept = 0;
+    for (int i = 0; i < n; i++) {
+        int added = addRecord(state->list, rows[i].name, rows[i].nameLen, rows[i].roll, rows[i].marks);
+        if (added < 0) {
+            state->failed = 1;
+            return -1;
+        }
+        kept += added;
+    }
+    return kept;
+}
+
+int pagedImportCsv(PagedStudentList *list, const char *path, LoadReport *report) {
+    ImportState state = { list, 0 };
+    return streamCsv(path, importBatch, &state, report) && !state.failed;
+}
+
+static int visitExport(const PagedRecord *record, void *ctx) {
+    return exportRow(ctx, record->name, strlen(record->name), record->roll, record->marks);
+}
+
+int pagedExport(PagedStudentList *list, const char *path, ExportFormat format) {
+    ExportStream stream;
+    if (!exportBegin(&stream, path, format)) return 0;
+    int ok = pagedScan(list, visitExport, &stream) && !stream.failed;
+    return exportEnd(&stream, ok) && ok;
+}
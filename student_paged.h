@@ -0,0 +1,85 @@
+#ifndef STUDENT_PAGED_H
+#define STUDENT_PAGED_H
+
+#include "student_logic.h"
+
+// A student list that lives on disk, for archives bigger than memory.
+//
+// Records sit in fixed-size pages of <path>, and only the pages in the
+// buffer pool are in memory: the pool is sized from the budget given to
+// pagedOpen and evicts with CLOCK (a page that was used since the hand last
+// passed gets one more sweep). Rolls are found through <path>.idx, the
+// (roll, slot) pairs sorted by roll with the first roll of every index page
+// kept in memory, so a lookup costs one index page and one record page.
+// Adds and removes since the index was written go to an in-memory delta
+// (a quarter of the budget) that is merged into the file when it fills.
+//
+// A removal only flags its slot. pagedSortBy is an external merge sort:
+// sorted runs the size of the budget go to a temporary file and are merged
+// into a new data file, without the gaps, and a second sort rebuilds the
+// index. Stats are kept running as for StudentList; a stale min/max is
+// refreshed by a scan that reads the file a few pages at a time.
+//
+// pagedSync / pagedClose write everything back. If the process dies in
+// between, the next pagedOpen rescans the file and rebuilds the index and
+// stats from the records it finds. One thread at a time; POSIX only.
+
+#define PAGED_PAGE_SIZE 16384
+#define PAGED_MIN_BUDGET (64 * PAGED_PAGE_SIZE)
+
+typedef struct {
+    int roll;
+    float marks;
+    int live;               // 0 once removed
+    char name[NAME_LEN];
+} PagedRecord;
+
+typedef struct {
+    long long hits, misses; // Page requests
+    long long reads, writes; // Pages read from / written to disk by the pool
+    int frames;
+} PagedPoolStats;
+
+struct PagePool; // student_paged.c
+
+typedef struct {
+    char path[512];
+    int dataFd, indexFd;
+    size_t budget;
+    struct PagePool *pool;
+    long long slots;        // Records in the file, removed ones included
+    int count;              // Live records
+    RunningStats stats;
+    int clean;              // The header on disk matches (cleared by the first change after a sync)
+    int broken;             // A sort replaced the data file but not its index: every call fails until pagedOpen
+    long long indexEntries; // Pairs in <path>.idx
+    int *fences;            // First roll of each index page
+    long long fenceCapacity;
+    RollIndexEntry *delta;  // roll -> slot since the index was written; slot -2 = removed
+    int deltaCount, deltaLimit;
+    unsigned deltaMask;
+} PagedStudentList;
+
+typedef int (*PagedVisit)(const PagedRecord *record, void *ctx); // Return 0 to stop the scan
+
+// Opens path (creating it if needed) with at most about memoryBudget bytes
+// of pages and delta in memory. 0 if the file is not a paged list.
+int pagedOpen(PagedStudentList *list, const char *path, size_t memoryBudget);
+int pagedSync(PagedStudentList *list);
+int pagedClose(PagedStudentList *list); // Syncs and frees; 0 if the sync failed
+
+// As their student_logic.h namesakes
+int pagedAddStudent(PagedStudentList *list, const char *name, int roll, float marks);
+int pagedRemoveStudent(PagedStudentList *list, int roll);
+int pagedModifyStudent(PagedStudentList *list, int roll, const char *newName, float newMarks);
+int pagedSearchStudent(PagedStudentList *list, int roll, PagedRecord *out); // 1 if found
+int pagedGetClassStats(PagedStudentList *list, ClassStats *out);
+float pagedAverageMarks(const PagedStudentList *list);
+int pagedSortBy(PagedStudentList *list, const SortKey *keys, int keyCount);
+
+int pagedScan(PagedStudentList *list, PagedVisit visit, void *ctx); // Live records in file order; 0 on a read error
+int pagedImportCsv(PagedStudentList *list, const char *path, LoadReport *report); // Adds the file's rows
+int pagedExport(PagedStudentList *list, const char *path, ExportFormat format);
+void pagedPoolStats(const PagedStudentList *list, PagedPoolStats *out);
+
+#endif // STUDENT_PAGED_H
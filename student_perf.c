@@ -0,0 +1,227 @@
+#include "student_perf.h"
+#include <string.h>
+
+#ifndef STUDENT_NO_PERF
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+// --- Per-Thread Blocks ---
+// Only the owning thread writes a block, so a counter update is a relaxed
+// load and store rather than a locked add. Blocks are never freed: when a
+// thread exits its block goes back into the pool, counts and all, and the
+// next new thread carries on from there.
+
+typedef struct PerfThread {
+    atomic_ullong calls[PERF_OP_COUNT];
+    atomic_ullong timedCalls[PERF_OP_COUNT];
+    atomic_ullong ticks[PERF_OP_COUNT];
+    atomic_ullong maxTicks[PERF_OP_COUNT];
+    atomic_ullong histogram[PERF_OP_COUNT][PERF_BUCKETS]; // By log2 of the ticks
+    atomic_ullong counters[PERF_COUNTER_COUNT];
+    int inUse;                 // Owned by a live thread (under perfLock)
+    struct PerfThread *next;
+} PerfThread;
+
+static pthread_mutex_t perfLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t perfOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t perfKey;
+static PerfThread *perfThreads;
+static _Thread_local PerfThread *perfSelf;
+_Thread_local unsigned perfSampleClock;
+
+// Clock calibration: the tick count and the time at the first recording.
+// The longer the process has run, the better the ticks-to-ns ratio.
+static unsigned long long perfStartTicks;
+static double perfStartNs;
+
+static double monotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void detachThread(void *data) {
+    PerfThread *block = data;
+    pthread_mutex_lock(&perfLock);
+    block->inUse = 0;
+    pthread_mutex_unlock(&perfLock);
+    perfSelf = NULL;
+}
+
+static void perfSetup(void) {
+    pthread_key_create(&perfKey, detachThread);
+    perfStartNs = monotonicNs();
+    perfStartTicks = perfTicks();
+}
+
+static PerfThread *attachThread(void) {
+    pthread_once(&perfOnce, perfSetup);
+    pthread_mutex_lock(&perfLock);
+    PerfThread *block = perfThreads;
+    while (block != NULL && block->inUse) {
+        block = block->next;
+    }
+    if (block == NULL) {
+        block = calloc(1, sizeof(PerfThread));
+        if (block == NULL) {
+            pthread_mutex_unlock(&perfLock);
+            return NULL; // Out of memory: this sample is dropped
+        }
+        block->next = perfThreads;
+        perfThreads = block;
+    }
+    block->inUse = 1;
+    pthread_mutex_unlock(&perfLock);
+    pthread_setspecific(perfKey, block);
+    perfSelf = block;
+    return block;
+}
+
+static inline void bump(atomic_ullong *counter, unsigned long long amount) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + amount,
+                          memory_order_relaxed);
+}
+
+void perfRecord(PerfOp op, unsigned long long startTicks) {
+    unsigned long long elapsed = startTicks ? perfTicks() - startTicks : 0;
+    PerfThread *block = perfSelf ? perfSelf : attachThread();
+    if (block == NULL) return;
+    bump(&block->calls[op], 1);
+    if (startTicks == 0) return; // Not sampled
+    bump(&block->timedCalls[op], 1);
+    bump(&block->ticks[op], elapsed);
+    if (elapsed > atomic_load_explicit(&block->maxTicks[op], memory_order_relaxed)) {
+        atomic_store_explicit(&block->maxTicks[op], elapsed, memory_order_relaxed);
+    }
+    int bucket = elapsed == 0 ? 0 : 63 - __builtin_clzll(elapsed);
+    bump(&block->histogram[op][bucket < PERF_BUCKETS ? bucket : PERF_BUCKETS - 1], 1);
+}
+
+void perfCount(PerfCounter counter, unsigned long long amount) {
+    PerfThread *block = perfSelf ? perfSelf : attachThread();
+    if (block) bump(&block->counters[counter], amount);
+}
+
+// Nanoseconds per tick. Waits a millisecond first if the process is younger
+// than that, so the ratio is never measured over a trivially short interval.
+static double nsPerTick(void) {
+    double elapsedNs = monotonicNs() - perfStartNs;
+    if (elapsedNs < 1e6) {
+        struct timespec pause = { 0, 1000000 };
+        nanosleep(&pause, NULL);
+        elapsedNs = monotonicNs() - perfStartNs;
+    }
+    unsigned long long elapsedTicks = perfTicks() - perfStartTicks;
+    return elapsedTicks > 0 ? elapsedNs / (double)elapsedTicks : 1.0;
+}
+
+int getPerfStats(PerfStats *out) {
+    memset(out, 0, sizeof(*out));
+    pthread_once(&perfOnce, perfSetup);
+    double scale = nsPerTick();
+
+    pthread_mutex_lock(&perfLock);
+    for (PerfThread *block = perfThreads; block != NULL; block = block->next) {
+        out->threads++;
+        for (int op = 0; op < PERF_OP_COUNT; op++) {
+            PerfOpStats *stats = &out->ops[op];
+            stats->calls += atomic_load_explicit(&block->calls[op], memory_order_relaxed);
+            stats->timedCalls += atomic_load_explicit(&block->timedCalls[op], memory_order_relaxed);
+            stats->totalNs += (double)atomic_load_explicit(&block->ticks[op], memory_order_relaxed) * scale;
+            double maxNs = (double)atomic_load_explicit(&block->maxTicks[op], memory_order_relaxed) * scale;
+            if (maxNs > stats->maxNs) stats->maxNs = maxNs;
+            // Re-bucket from ticks to nanoseconds by the middle of each
+            // tick bucket; off by at most one bucket
+            for (int b = 0; b < PERF_BUCKETS; b++) {
+                unsigned long long n = atomic_load_explicit(&block->histogram[op][b], memory_order_relaxed);
+                if (n == 0) continue;
+                double middleNs = 1.5 * (double)(1ull << b) * scale;
+                int nsBucket = 0;
+                while (nsBucket < PERF_BUCKETS - 1 && middleNs >= (double)(1ull << (nsBucket + 1))) {
+                    nsBucket++;
+                }
+                stats->histogram[nsBucket] += n;
+            }
+        }
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            out->counters[c] += atomic_load_explicit(&block->counters[c], memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&perfLock);
+
+    // Scale sampled ops' time up to all their calls
+    for (int op = 0; op < PERF_OP_COUNT; op++) {
+        PerfOpStats *stats = &out->ops[op];
+        if (stats->timedCalls > 0) stats->totalNs *= (double)stats->calls / (double)stats->timedCalls;
+    }
+    return 1;
+}
+
+// Threads recording at the same moment may put back a count or two from
+// just before the reset.
+void resetPerfStats(void) {
+    pthread_mutex_lock(&perfLock);
+    for (PerfThread *block = perfThreads; block != NULL; block = block->next) {
+        for (int op = 0; op < PERF_OP_COUNT; op++) {
+            atomic_store_explicit(&block->calls[op], 0, memory_order_relaxed);
+            atomic_store_explicit(&block->timedCalls[op], 0, memory_order_relaxed);
+            atomic_store_explicit(&block->ticks[op], 0, memory_order_relaxed);
+            atomic_store_explicit(&block->maxTicks[op], 0, memory_order_relaxed);
+            for (int b = 0; b < PERF_BUCKETS; b++) {
+                atomic_store_explicit(&block->histogram[op][b], 0, memory_order_relaxed);
+            }
+        }
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            atomic_store_explicit(&block->counters[c], 0, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&perfLock);
+}
+
+#else
+
+int getPerfStats(PerfStats *out) {
+    memset(out, 0, sizeof(*out));
+    return 0; // Compiled out
+}
+
+void resetPerfStats(void) {
+}
+
+#endif // STUDENT_NO_PERF
+
+// --- Reporting ---
+
+const char *perfOpName(PerfOp op) {
+    static const char *const names[PERF_OP_COUNT] = {
+        "addStudent", "removeStudent", "modifyStudent", "searchStudent",
+        "addStudents", "removeStudents", "modifyStudents", "sortStudentsBy",
+        "getAverageMarks", "getClassStats", "searchByName", "load (CSV)", "save (CSV)",
+        "filter", "rollRange"
+    };
+    return op >= 0 && op < PERF_OP_COUNT ? names[op] : "?";
+}
+
+const char *perfCounterName(PerfCounter counter) {
+    static const char *const names[PERF_COUNTER_COUNT] = {
+        "bytes read", "bytes written", "storage reallocations"
+    };
+    return counter >= 0 && counter < PERF_COUNTER_COUNT ? names[counter] : "?";
+}
+
+double perfPercentileNs(const PerfOpStats *op, double percentile) {
+    if (op->timedCalls == 0) return 0;
+    unsigned long long rank = (unsigned long long)(percentile / 100.0 * (double)op->timedCalls);
+    if (rank >= op->timedCalls) rank = op->timedCalls - 1;
+    unsigned long long seen = 0;
+    for (int b = 0; b < PERF_BUCKETS; b++) {
+        seen += op->histogram[b];
+        if (seen > rank) {
+            double upper = (double)(1ull << (b + 1));
+            return upper < op->maxNs ? upper : op->maxNs;
+        }
+    }
+    return op->maxNs;
+}
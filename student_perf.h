@@ -0,0 +1,113 @@
+#ifndef STUDENT_PERF_H
+#define STUDENT_PERF_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Operation counters and latency histograms for the list API.
+//
+// Every instrumented call adds its count, time and a histogram sample to a
+// block owned by the calling thread, so threads never contend on a counter:
+// recording is a cycle-counter read and a few relaxed stores. The cheapest
+// calls (add, modify, search, average) are all counted but only one in
+// PERF_SAMPLE_EVERY is timed, since reading the clock can cost more than the
+// call itself. getPerfStats adds the blocks of all threads together
+// (including threads that have exited). Compile with -DSTUDENT_NO_PERF to
+// remove the instrumentation entirely; getPerfStats then returns 0.
+
+// Instrumented operations. sortStudents is counted under sortStudentsBy,
+// loadFromFile / importCsv under load and saveToFile / exportCsv under save.
+typedef enum {
+    PERF_ADD,           // addStudent / addStudentLen
+    PERF_REMOVE,        // removeStudent
+    PERF_MODIFY,        // modifyStudent
+    PERF_SEARCH,        // searchStudent
+    PERF_ADD_BATCH,     // addStudents
+    PERF_REMOVE_BATCH,  // removeStudents
+    PERF_MODIFY_BATCH,  // modifyStudents
+    PERF_SORT,          // sortStudentsBy
+    PERF_AVERAGE,       // getAverageMarks
+    PERF_CLASS_STATS,   // getClassStats
+    PERF_NAME_SEARCH,   // searchByName
+    PERF_LOAD,          // CSV load
+    PERF_SAVE,          // CSV save
+    PERF_FILTER,        // filterCount / filterRows / filterSelect
+    PERF_ROLL_RANGE,    // rollRange
+    PERF_OP_COUNT
+} PerfOp;
+
+typedef enum {
+    PERF_BYTES_READ,      // By CSV loads
+    PERF_BYTES_WRITTEN,   // By CSV saves
+    PERF_REALLOCS,        // Record storage grown (ensureCapacity / reserveStudents)
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+// Bucket b holds calls that took [2^b, 2^(b+1)) nanoseconds; bucket 0 also
+// takes anything faster and the last one anything slower (about 4 s).
+#define PERF_BUCKETS 32
+#define PERF_SAMPLE_EVERY 256 // Power of two
+
+typedef struct {
+    unsigned long long calls;
+    unsigned long long timedCalls;  // Calls in the histogram (all, or the sampled ones)
+    double totalNs;                 // Estimated from the timed calls when sampled
+    double maxNs;                   // Of the timed calls
+    unsigned long long histogram[PERF_BUCKETS];
+} PerfOpStats;
+
+typedef struct {
+    PerfOpStats ops[PERF_OP_COUNT];
+    unsigned long long counters[PERF_COUNTER_COUNT];
+    int threads;  // Threads that have recorded anything
+} PerfStats;
+
+int getPerfStats(PerfStats *out); // 0 (and all zeroes) when compiled out
+void resetPerfStats(void);        // Zeroes every thread's counts
+const char *perfOpName(PerfOp op);
+const char *perfCounterName(PerfCounter counter);
+double perfPercentileNs(const PerfOpStats *op, double percentile); // Upper bound of the bucket; 0 if nothing was timed
+
+// --- Instrumentation (internal) ---
+
+#ifndef STUDENT_NO_PERF
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline unsigned long long perfTicks(void) {
+    return __rdtsc();
+}
+#else
+#include <time.h>
+static inline unsigned long long perfTicks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+#endif
+
+extern _Thread_local unsigned perfSampleClock;
+
+// 0 (not timed) for all but one in PERF_SAMPLE_EVERY calls
+static inline unsigned long long perfSampledTicks(void) {
+    return (++perfSampleClock & (PERF_SAMPLE_EVERY - 1)) == 0 ? perfTicks() : 0;
+}
+
+void perfRecord(PerfOp op, unsigned long long startTicks); // startTicks 0: count only
+void perfCount(PerfCounter counter, unsigned long long amount);
+
+#define PERF_BEGIN() unsigned long long perfStart_ = perfTicks()
+#define PERF_BEGIN_SAMPLED() unsigned long long perfStart_ = perfSampledTicks()
+#define PERF_END(op) perfRecord((op), perfStart_)
+#define PERF_COUNT(counter, amount) perfCount((counter), (amount))
+
+#else
+
+#define PERF_BEGIN() ((void)0)
+#define PERF_BEGIN_SAMPLED() ((void)0)
+#define PERF_END(op) ((void)0)
+#define PERF_COUNT(counter, amount) ((void)0)
+
+#endif // STUDENT_NO_PERF
+
+#endif // STUDENT_PERF_H
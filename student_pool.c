@@ -0,0 +1,202 @@
+#include "student_pool.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define MAX_WORKER_THREADS 256
+
+// --- Pool State ---
+// Chunks are counted in grain units. Slice s owns chunks [next, end); any
+// thread may claim the next chunk of any slice with one fetch_add, which is
+// all the stealing there is.
+
+typedef struct {
+    _Alignas(64) atomic_llong next;  // Own cache line: claimed by all threads
+    long long end;
+} PoolSlice;
+
+typedef struct {
+    ParallelTask task;
+    void *ctx;
+    long long n;
+    long long grain;
+    PoolSlice *slices;
+    int sliceCount;
+} PoolJob;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;          // Workers: a new job (or stop)
+    pthread_cond_t idle;          // Caller: the last worker left the job
+    pthread_mutex_t runLock;      // Held for a whole parallelFor
+    pthread_t threads[MAX_WORKER_THREADS];
+    int started;                  // Worker threads running (callers add one more)
+    int startedFor;               // The thread count they were started for
+    int configured;               // setWorkerThreads value; 0 = per CPU
+    unsigned long long generation; // Bumped per job
+    unsigned long long startGeneration; // Jobs before this one are not for new workers
+    int busy;                     // Workers still inside the current job
+    int stopping;
+    PoolJob job;
+} pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER, { 0 }, 0, 0, 0, 0, 0, 0, 0, { 0 }
+};
+
+static atomic_llong minRows = DEFAULT_PARALLEL_MIN_ROWS;
+static _Thread_local int inTask; // Pool workers, and callers while running a job
+
+static int cpuCount(void) {
+    long cpus = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (cpus > MAX_WORKER_THREADS) cpus = MAX_WORKER_THREADS;
+    return cpus < 1 ? 1 : (int)cpus;
+}
+
+static void runSlices(const PoolJob *job, int self) {
+    for (int k = 0; k < job->sliceCount; k++) {
+        PoolSlice *slice = &job->slices[(self + k) % job->sliceCount];
+        for (;;) {
+            long long chunk = atomic_fetch_add_explicit(&slice->next, 1, memory_order_relaxed);
+            if (chunk >= slice->end) break;
+            long long begin = chunk * job->grain;
+            long long end = begin + job->grain < job->n ? begin + job->grain : job->n;
+            job->task(job->ctx, begin, end);
+        }
+    }
+}
+
+static void *workerMain(void *arg) {
+    int self = (int)(long)arg;
+    inTask = 1;
+    pthread_mutex_lock(&pool.lock);
+    unsigned long long seen = pool.startGeneration;
+    for (;;) {
+        while (pool.generation == seen && !pool.stopping) {
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        }
+        if (pool.stopping) break;
+        seen = pool.generation;
+        PoolJob job = pool.job;
+        pthread_mutex_unlock(&pool.lock);
+
+        runSlices(&job, self);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.busy == 0) pthread_cond_signal(&pool.idle);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+// Both with runLock held, so no job is running.
+static void stopWorkers(void) {
+    pthread_mutex_lock(&pool.lock);
+    pool.stopping = 1;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    for (int t = 0; t < pool.started; t++) {
+        pthread_join(pool.threads[t], NULL);
+    }
+    pool.started = 0;
+    pool.startedFor = 0;
+    pool.stopping = 0;
+}
+
+static void startWorkers(int wanted) {
+    pthread_mutex_lock(&pool.lock);
+    pool.startGeneration = pool.generation;
+    pthread_mutex_unlock(&pool.lock);
+    pool.startedFor = wanted;
+    while (pool.started < wanted - 1) {
+        // Slice 0 belongs to the caller, so worker t runs slice t + 1
+        if (pthread_create(&pool.threads[pool.started], NULL, workerMain, (void *)(long)(pool.started + 1)) != 0) {
+            break; // Run with the threads we have
+        }
+        pool.started++;
+    }
+}
+
+// --- Public ---
+
+void setWorkerThreads(int threads) {
+    pthread_mutex_lock(&pool.runLock);
+    if (threads < 0) threads = 0;
+    if (threads > MAX_WORKER_THREADS) threads = MAX_WORKER_THREADS;
+    pthread_mutex_lock(&pool.lock);
+    pool.configured = threads;
+    pthread_mutex_unlock(&pool.lock);
+    stopWorkers(); // The next parallelFor starts the new number
+    pthread_mutex_unlock(&pool.runLock);
+}
+
+int workerThreads(void) {
+    pthread_mutex_lock(&pool.lock);
+    int configured = pool.configured;
+    pthread_mutex_unlock(&pool.lock);
+    return configured > 0 ? configured : cpuCount();
+}
+
+void setParallelThreshold(long long rows) {
+    atomic_store(&minRows, rows < 1 ? 1 : rows);
+}
+
+long long parallelThreshold(void) {
+    return atomic_load(&minRows);
+}
+
+int parallelWorth(long long n) {
+    return n >= atomic_load(&minRows) && workerThreads() > 1;
+}
+
+void parallelFor(long long n, long long grain, ParallelTask task, void *ctx) {
+    if (n <= 0) return;
+    if (grain < 1) grain = 1;
+    long long chunks = (n + grain - 1) / grain;
+    int wanted = workerThreads();
+    if (chunks < 2 || wanted < 2 || inTask || pthread_mutex_trylock(&pool.runLock) != 0) {
+        task(ctx, 0, n); // Serial: too small, nested, or the pool is taken
+        return;
+    }
+    if (pool.startedFor != wanted) {
+        stopWorkers();
+        startWorkers(wanted);
+    }
+
+    int sliceCount = pool.started + 1;
+    if (sliceCount > chunks) sliceCount = (int)chunks;
+    PoolSlice *slices = aligned_alloc(64, (size_t)sliceCount * sizeof(PoolSlice));
+    if (slices == NULL || sliceCount < 2) {
+        free(slices);
+        pthread_mutex_unlock(&pool.runLock);
+        task(ctx, 0, n);
+        return;
+    }
+    for (int s = 0; s < sliceCount; s++) {
+        atomic_init(&slices[s].next, chunks * s / sliceCount);
+        slices[s].end = chunks * (s + 1) / sliceCount;
+    }
+
+    PoolJob job = { task, ctx, n, grain, slices, sliceCount };
+    pthread_mutex_lock(&pool.lock);
+    pool.job = job;
+    pool.busy = pool.started;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    inTask = 1;
+    runSlices(&job, 0);
+    inTask = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy > 0) {
+        pthread_cond_wait(&pool.idle, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    free(slices);
+    pthread_mutex_unlock(&pool.runLock);
+}
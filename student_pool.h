@@ -0,0 +1,32 @@
+#ifndef STUDENT_POOL_H
+#define STUDENT_POOL_H
+
+// The record library's shared worker threads.
+//
+// parallelFor splits [0, n) into chunks of `grain` and runs task on them
+// from the calling thread plus the pool's workers. Each thread starts on
+// its own slice of the chunks and, once that runs dry, steals chunks from
+// the others' slices, so an uneven split still keeps every thread busy.
+// Chunk boundaries depend only on n and grain, never on timing, so a task
+// that writes one result per chunk gets the same results on every run.
+//
+// The pool starts its threads on first use. Only one parallelFor runs at a
+// time: a call made while another is running (or from inside a task) just
+// runs serially on the calling thread.
+
+#define DEFAULT_PARALLEL_MIN_ROWS 100000 // Smaller lists are not worth waking the workers for
+
+// Called with a range of item indices; never with an empty range.
+typedef void (*ParallelTask)(void *ctx, long long begin, long long end);
+
+void setWorkerThreads(int threads);   // Total threads including the caller; 0 = one per CPU (the default), 1 = serial
+int workerThreads(void);              // The configured count, resolved (always >= 1)
+void setParallelThreshold(long long rows); // List calls go parallel from this many rows
+long long parallelThreshold(void);
+
+// 1 if work over n rows should be split (threads > 1 and n at the threshold)
+int parallelWorth(long long n);
+
+void parallelFor(long long n, long long grain, ParallelTask task, void *ctx);
+
+#endif // STUDENT_POOL_H
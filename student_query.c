@@ -0,0 +1,323 @@
+#include "student_logic.h"
+#include "student_perf.h"
+#include "student_pool.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define QUERY_SSE2 1
+#endif
+
+// --- Filters ---
+// A filter is evaluated a block of rows at a time into a selection bitmap
+// (bit i = row begin + i). Marks and roll ranges compare four rows per SSE2
+// instruction straight off the columns; the row layout first copies the
+// block's marks or rolls into a small array so the same kernels apply.
+//
+// Every term is evaluated under a "care" mask and leaves zeroes outside it.
+// AND evaluates its right side only where the left matched, OR only where
+// it did not, so a name prefix behind a selective range only looks at the
+// few names that can still change the result.
+
+#define FILTER_BLOCK 1024                   // Rows per bitmap block
+#define BLOCK_WORDS (FILTER_BLOCK / 64)
+#define FILTER_GRAIN 65536                  // Rows per pool task; a multiple of FILTER_BLOCK
+
+typedef unsigned long long Bits;
+
+static char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static int addTerm(StudentFilter *filter, const FilterTerm *term) {
+    if (filter->count >= MAX_FILTER_TERMS) return -1;
+    filter->terms[filter->count] = *term;
+    return filter->count++;
+}
+
+void filterInit(StudentFilter *filter) {
+    filter->count = 0;
+}
+
+int filterMarks(StudentFilter *filter, float min, float max) {
+    FilterTerm term = { .op = FILTER_MARKS };
+    term.marksMin = min;
+    term.marksMax = max;
+    return addTerm(filter, &term);
+}
+
+int filterRoll(StudentFilter *filter, int min, int max) {
+    FilterTerm term = { .op = FILTER_ROLL };
+    term.rollMin = min;
+    term.rollMax = max;
+    return addTerm(filter, &term);
+}
+
+int filterPassed(StudentFilter *filter, int passed) {
+    FilterTerm term = { .op = passed ? FILTER_PASSED : FILTER_FAILED };
+    return addTerm(filter, &term);
+}
+
+int filterNamePrefix(StudentFilter *filter, const char *prefix) {
+    FilterTerm term = { .op = FILTER_NAME_PREFIX };
+    size_t len = strlen(prefix);
+    if (len >= NAME_LEN) return -1;
+    for (size_t i = 0; i <= len; i++) term.prefix[i] = lowerAscii(prefix[i]);
+    return addTerm(filter, &term);
+}
+
+static int joinTerms(StudentFilter *filter, FilterOp op, int left, int right) {
+    if (left < 0 || right < 0 || left >= filter->count || right >= filter->count) return -1;
+    FilterTerm term = { .op = op };
+    term.left = left;
+    term.right = right;
+    return addTerm(filter, &term);
+}
+
+int filterAnd(StudentFilter *filter, int left, int right) {
+    return joinTerms(filter, FILTER_AND, left, right);
+}
+
+int filterOr(StudentFilter *filter, int left, int right) {
+    return joinTerms(filter, FILTER_OR, left, right);
+}
+
+// --- Kernels ---
+// Each writes the bits of n <= FILTER_BLOCK values, zero past n.
+
+static void marksRangeBits(const float *marks, int n, float lo, float hi, Bits *out) {
+    memset(out, 0, BLOCK_WORDS * sizeof(Bits));
+    int i = 0;
+#ifdef QUERY_SSE2
+    const __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+    for (; i + 16 <= n; i += 16) {
+        Bits word = 0;
+        for (int k = 0; k < 4; k++) {
+            __m128 v = _mm_loadu_ps(marks + i + 4 * k);
+            __m128 in = _mm_and_ps(_mm_cmpge_ps(v, vlo), _mm_cmple_ps(v, vhi)); // NaN is never in
+            word |= (Bits)_mm_movemask_ps(in) << (4 * k);
+        }
+        out[i / 64] |= word << (i % 64);
+    }
+#endif
+    for (; i < n; i++) {
+        if (marks[i] >= lo && marks[i] <= hi) out[i / 64] |= 1ull << (i % 64);
+    }
+}
+
+static void rollRangeBits(const int *rolls, int n, int lo, int hi, Bits *out) {
+    memset(out, 0, BLOCK_WORDS * sizeof(Bits));
+    int i = 0;
+#ifdef QUERY_SSE2
+    const __m128i vlo = _mm_set1_epi32(lo), vhi = _mm_set1_epi32(hi);
+    for (; i + 16 <= n; i += 16) {
+        Bits word = 0;
+        for (int k = 0; k < 4; k++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(rolls + i + 4 * k));
+            __m128i outside = _mm_or_si128(_mm_cmplt_epi32(v, vlo), _mm_cmpgt_epi32(v, vhi));
+            word |= (Bits)(~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF) << (4 * k);
+        }
+        out[i / 64] |= word << (i % 64);
+    }
+#endif
+    for (; i < n; i++) {
+        if (rolls[i] >= lo && rolls[i] <= hi) out[i / 64] |= 1ull << (i % 64);
+    }
+}
+
+static int hasPrefix(const char *name, const char *lowerPrefix) {
+    for (; *lowerPrefix; name++, lowerPrefix++) {
+        if (lowerAscii(*name) != *lowerPrefix) return 0; // Also stops at the end of name
+    }
+    return 1;
+}
+
+// --- Evaluation ---
+
+typedef struct {
+    const StudentList *list;
+    const StudentFilter *filter;
+    Bits *bitmap;       // filterSelect
+    int *rows;          // filterRows
+    int *counts;        // Matches per pool chunk
+} FilterScan;
+
+// Marks of rows [begin, begin + n), straight from the column when there is one
+static const float *blockMarks(const StudentList *list, int begin, int n, float *buf) {
+    if (list->layout == LAYOUT_COLUMNS) return list->marks + begin;
+    for (int i = 0; i < n; i++) buf[i] = list->students[begin + i].marks;
+    return buf;
+}
+
+static const int *blockRolls(const StudentList *list, int begin, int n, int *buf) {
+    if (list->layout == LAYOUT_COLUMNS) return list->rolls + begin;
+    for (int i = 0; i < n; i++) buf[i] = list->students[begin + i].roll;
+    return buf;
+}
+
+static int anyBits(const Bits *bits) {
+    Bits any = 0;
+    for (int w = 0; w < BLOCK_WORDS; w++) any |= bits[w];
+    return any != 0;
+}
+
+// A term that looks at the records; apart from the name prefix these test
+// every row of the block and mask with care afterwards.
+static void evalLeaf(const StudentList *list, const FilterTerm *term, int begin, int n,
+                     const Bits *care, Bits *out) {
+    float marksBuf[FILTER_BLOCK];
+    int rollBuf[FILTER_BLOCK];
+
+    switch (term->op) {
+    case FILTER_MARKS:
+        marksRangeBits(blockMarks(list, begin, n, marksBuf), n, term->marksMin, term->marksMax, out);
+        break;
+    case FILTER_PASSED:
+    case FILTER_FAILED:
+        // marks > PASS_MARK is marks >= the next float up; failed is the rest (NaN included)
+        marksRangeBits(blockMarks(list, begin, n, marksBuf), n, nextafterf(PASS_MARK, INFINITY), INFINITY, out);
+        if (term->op == FILTER_FAILED) {
+            for (int w = 0; w < BLOCK_WORDS; w++) out[w] = ~out[w];
+        }
+        break;
+    case FILTER_ROLL:
+        rollRangeBits(blockRolls(list, begin, n, rollBuf), n, term->rollMin, term->rollMax, out);
+        break;
+    case FILTER_NAME_PREFIX: {
+        size_t len = strlen(term->prefix);
+        memset(out, 0, BLOCK_WORDS * sizeof(Bits));
+        for (int w = 0; w < BLOCK_WORDS; w++) {
+            for (Bits left = care[w]; left; left &= left - 1) {
+                int i = w * 64 + __builtin_ctzll(left);
+                int row = begin + i;
+                if (list->layout == LAYOUT_COLUMNS && list->nameLengths[row] < len) continue;
+                if (hasPrefix(studentName(list, row), term->prefix)) out[w] |= 1ull << (i % 64);
+            }
+        }
+        return;
+    }
+    default:
+        break;
+    }
+    for (int w = 0; w < BLOCK_WORDS; w++) out[w] &= care[w];
+}
+
+static void evalTerm(const StudentList *list, const StudentFilter *filter, int t, int begin, int n,
+                     const Bits *care, Bits *out) {
+    const FilterTerm *term = &filter->terms[t];
+    Bits other[BLOCK_WORDS];
+
+    switch (term->op) {
+    case FILTER_AND:
+        evalTerm(list, filter, term->left, begin, n, care, other);
+        if (!anyBits(other)) {
+            memcpy(out, other, sizeof(other));
+            return;
+        }
+        evalTerm(list, filter, term->right, begin, n, other, out);
+        return;
+    case FILTER_OR: {
+        Bits rest[BLOCK_WORDS];
+        evalTerm(list, filter, term->left, begin, n, care, other);
+        for (int w = 0; w < BLOCK_WORDS; w++) rest[w] = care[w] & ~other[w];
+        if (anyBits(rest)) {
+            evalTerm(list, filter, term->right, begin, n, rest, out);
+        } else {
+            memset(out, 0, sizeof(other));
+        }
+        for (int w = 0; w < BLOCK_WORDS; w++) out[w] |= other[w];
+        return;
+    }
+    default:
+        evalLeaf(list, term, begin, n, care, out);
+        return;
+    }
+}
+
+// Bits of rows [begin, begin + n); returns how many are set.
+static int evalBlock(const StudentList *list, const StudentFilter *filter, int begin, int n, Bits *out) {
+    Bits care[BLOCK_WORDS] = { 0 };
+    for (int w = 0; w * 64 < n; w++) {
+        care[w] = n - w * 64 >= 64 ? ~0ull : (1ull << (n - w * 64)) - 1;
+    }
+    if (filter->count == 0) {
+        memcpy(out, care, sizeof(care)); // No terms: every row
+    } else {
+        evalTerm(list, filter, filter->count - 1, begin, n, care, out);
+    }
+    int found = 0;
+    for (int w = 0; w < BLOCK_WORDS; w++) found += __builtin_popcountll(out[w]);
+    return found;
+}
+
+// Rows [begin, end) of one pool chunk. Matching rows go to rows[] from the
+// chunk's first row on, as in scanStudents.
+static void filterRange(FilterScan *scan, int begin, int end) {
+    int found = 0;
+    for (int lo = begin; lo < end; lo += FILTER_BLOCK) {
+        int n = end - lo < FILTER_BLOCK ? end - lo : FILTER_BLOCK;
+        Bits bits[BLOCK_WORDS];
+        int hits = evalBlock(scan->list, scan->filter, lo, n, bits);
+        if (scan->bitmap) {
+            memcpy(scan->bitmap + lo / 64, bits, (size_t)(n + 63) / 64 * sizeof(Bits));
+        }
+        if (scan->rows) {
+            for (int w = 0; w < BLOCK_WORDS; w++) {
+                for (Bits left = bits[w]; left; left &= left - 1) {
+                    scan->rows[begin + found++] = lo + w * 64 + __builtin_ctzll(left);
+                }
+            }
+        } else {
+            found += hits;
+        }
+    }
+    scan->counts[begin / FILTER_GRAIN] = found;
+}
+
+static void filterTask(void *ctx, long long begin, long long end) {
+    FilterScan *scan = ctx;
+    for (long long lo = begin; lo < end; lo += FILTER_GRAIN) {
+        filterRange(scan, (int)lo, (int)(lo + FILTER_GRAIN < end ? lo + FILTER_GRAIN : end));
+    }
+}
+
+static int runFilter(const StudentList *list, const StudentFilter *filter, Bits *bitmap, int *rows) {
+    PERF_BEGIN();
+    int chunks = (list->count + FILTER_GRAIN - 1) / FILTER_GRAIN;
+    int *counts = chunks > 1 && parallelWorth(list->count) ? malloc((size_t)chunks * sizeof(int)) : NULL;
+    int found = 0;
+    if (counts == NULL) {
+        FilterScan scan = { list, filter, bitmap, rows, &found };
+        filterRange(&scan, 0, list->count); // One range: rows come out in place
+    } else {
+        FilterScan scan = { list, filter, bitmap, rows, counts };
+        parallelFor(list->count, FILTER_GRAIN, filterTask, &scan);
+        for (int c = 0; c < chunks; c++) {
+            if (rows && found != c * FILTER_GRAIN) {
+                memmove(rows + found, rows + (size_t)c * FILTER_GRAIN, (size_t)counts[c] * sizeof(int));
+            }
+            found += counts[c];
+        }
+        free(counts);
+    }
+    PERF_END(PERF_FILTER);
+    return found;
+}
+
+int filterSelect(const StudentList *list, const StudentFilter *filter, unsigned long long *bitmap) {
+    return runFilter(list, filter, bitmap, NULL);
+}
+
+int filterCount(const StudentList *list, const StudentFilter *filter) {
+    return runFilter(list, filter, NULL, NULL);
+}
+
+int filterRows(const StudentList *list, const StudentFilter *filter, int *rows) {
+    return runFilter(list, filter, NULL, rows);
+}
+
+int filterMatch(const StudentList *list, const StudentFilter *filter, int row) {
+    Bits bits[BLOCK_WORDS];
+    return evalBlock(list, filter, row, 1, bits) != 0;
+}
@@ -0,0 +1,184 @@
+#include "student_shared.h"
+#include <stdlib.h>
+#include <sched.h>
+
+// --- Versions ---
+
+static SharedVersion *newVersion(StudentLayout layout) {
+    SharedVersion *version = calloc(1, sizeof(SharedVersion));
+    if (version != NULL) {
+        initListLayout(&version->list, layout);
+    }
+    return version;
+}
+
+static void freeVersion(SharedVersion *version) {
+    freeList(&version->list);
+    free(version);
+}
+
+// Moves retired versions nobody holds any more to the spare slot (the first
+// one) or frees them. Writer only.
+static void reclaimVersions(SharedStudentList *shared) {
+    SharedVersion **link = &shared->retired;
+    while (*link != NULL) {
+        SharedVersion *version = *link;
+        if (atomic_load(&version->refs) != 0) {
+            link = &version->next;
+            continue;
+        }
+        *link = version->next;
+        if (shared->spare == NULL) {
+            shared->spare = version;
+        } else {
+            freeVersion(version);
+        }
+    }
+}
+
+// A version to write a list of the given layout into: the spare if there is
+// one. Writer only.
+static SharedVersion *takeSpare(SharedStudentList *shared, StudentLayout layout) {
+    reclaimVersions(shared);
+    SharedVersion *version = shared->spare;
+    shared->spare = NULL;
+    if (version == NULL) {
+        return newVersion(layout);
+    }
+    if (version->list.layout != layout) {
+        freeList(&version->list); // Its buffers are the wrong shape
+        initListLayout(&version->list, layout);
+    }
+    return version;
+}
+
+static void keepSpare(SharedStudentList *shared, SharedVersion *version) {
+    if (shared->spare == NULL) {
+        shared->spare = version;
+    } else {
+        freeVersion(version);
+    }
+}
+
+// Makes version current and retires the old one. Writer only.
+static unsigned long long publish(SharedStudentList *shared, SharedVersion *version) {
+    ClassStats unused;
+    getClassStats(&version->list, &unused); // Settles min/max now, so readers never write
+    disableNameIndex(&version->list);       // Searches would rebuild it under the readers
+    settleRollOrder(&version->list);        // Likewise for roll range queries
+
+    SharedVersion *old = atomic_load(&shared->current);
+    version->version = old->version + 1;
+    version->next = NULL;
+    atomic_store(&version->refs, 1); // The "current" reference
+    atomic_store(&shared->current, version);
+
+    // Wait out readers that may have loaded the old pointer but not yet
+    // counted themselves in its refs. New readers use the other counter.
+    unsigned parity = atomic_fetch_add(&shared->epoch, 1) & 1;
+    while (atomic_load(&shared->acquiring[parity]) != 0) {
+        sched_yield();
+    }
+
+    atomic_fetch_sub(&old->refs, 1);
+    old->next = shared->retired;
+    shared->retired = old;
+    reclaimVersions(shared);
+    return version->version;
+}
+
+// --- Public ---
+
+int sharedInit(SharedStudentList *shared, StudentLayout layout) {
+    atomic_init(&shared->epoch, 0);
+    atomic_init(&shared->acquiring[0], 0);
+    atomic_init(&shared->acquiring[1], 0);
+    shared->working = NULL;
+    shared->retired = NULL;
+    shared->spare = NULL;
+    SharedVersion *first = newVersion(layout);
+    if (first == NULL) {
+        return 0; // Failure: out of memory
+    }
+    first->version = 1;
+    atomic_init(&first->refs, 1);
+    atomic_init(&shared->current, first);
+    pthread_mutex_init(&shared->writeLock, NULL);
+    return 1;
+}
+
+void sharedDestroy(SharedStudentList *shared) {
+    reclaimVersions(shared);
+    while (shared->retired != NULL) { // Still referenced: the caller broke the contract, free anyway
+        SharedVersion *next = shared->retired->next;
+        freeVersion(shared->retired);
+        shared->retired = next;
+    }
+    if (shared->spare) freeVersion(shared->spare);
+    freeVersion(atomic_load(&shared->current));
+    shared->spare = NULL;
+    atomic_store(&shared->current, NULL);
+    pthread_mutex_destroy(&shared->writeLock);
+}
+
+const SharedVersion *sharedAcquire(SharedStudentList *shared) {
+    for (;;) {
+        unsigned epoch = atomic_load(&shared->epoch);
+        atomic_fetch_add(&shared->acquiring[epoch & 1], 1);
+        SharedVersion *version = atomic_load(&shared->current);
+        // Only if no commit flipped the epoch since it was read is the
+        // version covered by the counter: the commit that retires it then
+        // flips from this epoch (and waits for us), or comes after one that
+        // did. Otherwise a commit may be waiting on the other counter only.
+        if (atomic_load(&shared->epoch) == epoch) {
+            atomic_fetch_add(&version->refs, 1);
+            atomic_fetch_sub(&shared->acquiring[epoch & 1], 1);
+            return version;
+        }
+        atomic_fetch_sub(&shared->acquiring[epoch & 1], 1);
+    }
+}
+
+void sharedRelease(SharedStudentList *shared, const SharedVersion *version) {
+    (void)shared; // The next writer frees it once the count hits 0
+    atomic_fetch_sub(&((SharedVersion *)version)->refs, 1);
+}
+
+StudentList *sharedBeginWrite(SharedStudentList *shared) {
+    pthread_mutex_lock(&shared->writeLock);
+    const StudentList *latest = &atomic_load(&shared->current)->list;
+    SharedVersion *version = takeSpare(shared, latest->layout);
+    if (version == NULL || !copyList(&version->list, latest)) {
+        if (version) keepSpare(shared, version);
+        pthread_mutex_unlock(&shared->writeLock);
+        return NULL; // Failure: out of memory
+    }
+    shared->working = version;
+    return &version->list;
+}
+
+unsigned long long sharedCommit(SharedStudentList *shared) {
+    unsigned long long published = publish(shared, shared->working);
+    shared->working = NULL;
+    pthread_mutex_unlock(&shared->writeLock);
+    return published;
+}
+
+void sharedAbort(SharedStudentList *shared) {
+    keepSpare(shared, shared->working);
+    shared->working = NULL;
+    pthread_mutex_unlock(&shared->writeLock);
+}
+
+int sharedPublishCopy(SharedStudentList *shared, const StudentList *list) {
+    pthread_mutex_lock(&shared->writeLock);
+    SharedVersion *version = takeSpare(shared, list->layout);
+    int ok = version != NULL && copyList(&version->list, list);
+    if (ok) {
+        publish(shared, version);
+    } else if (version) {
+        keepSpare(shared, version);
+    }
+    pthread_mutex_unlock(&shared->writeLock);
+    return ok;
+}
@@ -0,0 +1,65 @@
+#ifndef STUDENT_SHARED_H
+#define STUDENT_SHARED_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "student_logic.h"
+
+// A StudentList that many threads can read while one writes.
+//
+// Readers never see the list being edited. Instead they take a reference to
+// the latest published version (sharedAcquire): an immutable StudentList
+// that stays consistent for as long as they hold it, however many writes
+// are published meanwhile. Acquiring is a few atomic operations and never
+// waits for a writer.
+//
+// Writers take turns. sharedBeginWrite hands out a private copy of the
+// latest version (reusing the buffers of a retired one when no reader still
+// holds it); any number of ordinary list calls can go into it, and
+// sharedCommit publishes the result in one atomic step. Batch edits into one
+// write where possible: each write copies the list once.
+//
+// A published list may be passed to anything that takes a const
+// StudentList *, and also to getClassStats, searchByName and the roll order
+// queries (published lists have fresh stats, no name index and a settled
+// roll order, so none of those writes).
+
+typedef struct SharedVersion {
+    StudentList list;                 // Read-only once published
+    unsigned long long version;       // 1 for the first publish, then +1 per commit
+    atomic_int refs;                  // Readers holding it, plus 1 while it is current
+    struct SharedVersion *next;       // Retired-version list (writer only)
+} SharedVersion;
+
+typedef struct {
+    _Atomic(SharedVersion *) current;
+    // Readers between loading current and taking their reference, counted
+    // under the parity of epoch (and retrying if epoch moved meanwhile). A
+    // commit flips epoch and waits for the old counter to drain; after that
+    // nobody can still be about to reference the version it replaced.
+    atomic_uint epoch;
+    atomic_int acquiring[2];
+    pthread_mutex_t writeLock;        // Held from sharedBeginWrite to sharedCommit / sharedAbort
+    SharedVersion *working;           // The write in progress
+    SharedVersion *retired;           // Replaced versions still held by readers
+    SharedVersion *spare;             // A drained version kept for its buffers
+} SharedStudentList;
+
+// Publishes an empty list (version 1). 0 if out of memory.
+int sharedInit(SharedStudentList *shared, StudentLayout layout);
+void sharedDestroy(SharedStudentList *shared); // No readers or writer may be active
+
+// Readers
+const SharedVersion *sharedAcquire(SharedStudentList *shared);
+void sharedRelease(SharedStudentList *shared, const SharedVersion *version);
+
+// Writers. sharedBeginWrite returns NULL (without holding the lock) if the
+// copy cannot be made; otherwise finish with exactly one of commit / abort.
+StudentList *sharedBeginWrite(SharedStudentList *shared);
+unsigned long long sharedCommit(SharedStudentList *shared); // Returns the version published
+void sharedAbort(SharedStudentList *shared);
+
+// Replaces the contents with a copy of list in one write.
+int sharedPublishCopy(SharedStudentList *shared, const StudentList *list);
+
+#endif // STUDENT_SHARED_H
@@ -0,0 +1,372 @@
+#include "student_logic.h"
+#include "student_journal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// --- Snapshot File Format ---
+// A snapshot is a binary image of a StudentList, laid out so it can be mapped
+// and used without parsing:
+//
+//   SnapshotHeader   (64 bytes)
+//   ColumnEntry[]    column directory, one entry per column
+//   columns          each starts on a 64-byte boundary
+//
+// Columns (all little-endian, row i in each column belongs together):
+//   COLUMN_ROLL        int32[rowCount]
+//   COLUMN_MARKS       float32[rowCount]
+//   COLUMN_NAME_OFFSET uint32[rowCount + 1], start of each name in the table
+//   COLUMN_NAME_TABLE  NUL-terminated names back to back
+//   COLUMN_NAME_LENGTH uint32[rowCount], name lengths without the NUL
+//
+// The roll, marks, offset and length columns have exactly the shape of a
+// LAYOUT_COLUMNS list, so openSnapshot can point such a list straight into
+// the mapped file instead of copying anything.
+//
+// The checksum covers the directory and every column. Readers skip column ids
+// they do not know, so new columns can be added without a version bump.
+
+#define SNAPSHOT_MAGIC "SRSNAP\r\n"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_ALIGN 64
+#define MAX_COLUMNS 16
+
+enum {
+    COLUMN_ROLL = 1,
+    COLUMN_MARKS = 2,
+    COLUMN_NAME_OFFSET = 3,
+    COLUMN_NAME_TABLE = 4,
+    COLUMN_NAME_LENGTH = 5
+};
+
+#define SNAPSHOT_COLUMNS 5
+#define SNAPSHOT_BATCH 512 // Rows handed to addStudents at a time when copying out
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t rowCount;
+    uint32_t columnCount;
+    uint64_t sequence;   // Generation counter, free for the caller to use
+    uint64_t fileSize;
+    uint64_t checksum;
+    uint8_t reserved[16];
+} SnapshotHeader;
+
+typedef struct {
+    uint32_t id;
+    uint32_t elemSize;
+    uint64_t offset;
+    uint64_t size;
+} ColumnEntry;
+
+// FNV-1a over 64-bit words (bytes for the tail). Fast enough to run at
+// memory bandwidth, which plain byte-wise FNV is not.
+static uint64_t checksumUpdate(uint64_t h, const void *data, size_t size) {
+    const unsigned char *p = data;
+    while (size >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0x100000001b3ULL;
+        p += 8;
+        size -= 8;
+    }
+    while (size > 0) {
+        h = (h ^ *p++) * 0x100000001b3ULL;
+        size--;
+    }
+    return h;
+}
+
+#define CHECKSUM_SEED 0xcbf29ce484222325ULL
+
+static uint64_t alignUp(uint64_t n) {
+    return (n + SNAPSHOT_ALIGN - 1) & ~(uint64_t)(SNAPSHOT_ALIGN - 1);
+}
+
+// --- Writing ---
+
+static int writePadded(FILE *fp, const void *data, size_t size, uint64_t *pos) {
+    static const char zeros[SNAPSHOT_ALIGN] = {0};
+    if (size > 0 && fwrite(data, 1, size, fp) != size) {
+        return 0;
+    }
+    uint64_t end = *pos + size;
+    uint64_t padded = alignUp(end);
+    if (padded > end && fwrite(zeros, 1, (size_t)(padded - end), fp) != (size_t)(padded - end)) {
+        return 0;
+    }
+    *pos = padded;
+    return 1;
+}
+
+int saveSnapshot(const StudentList *list, const char *path) {
+    return saveSnapshotAt(list, path, 0);
+}
+
+int saveSnapshotAt(const StudentList *list, const char *path, unsigned long long sequence) {
+    uint32_t n = (uint32_t)list->count;
+
+    // Build the columns in memory first; the checksum needs all of them
+    int32_t *rolls = malloc((size_t)n * sizeof(int32_t) + 1);
+    float *marks = malloc((size_t)n * sizeof(float) + 1);
+    uint32_t *offsets = malloc(((size_t)n + 1) * sizeof(uint32_t));
+    uint32_t *lengths = malloc((size_t)n * sizeof(uint32_t) + 1);
+    uint64_t tableSize = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        tableSize += strlen(studentName(list, (int)i)) + 1;
+    }
+    char *table = malloc((size_t)tableSize + 1);
+    if (!rolls || !marks || !offsets || !lengths || !table || tableSize > UINT32_MAX) {
+        free(rolls); free(marks); free(offsets); free(lengths); free(table);
+        return 0; // Failure
+    }
+
+    uint32_t at = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        const char *name = studentName(list, (int)i);
+        size_t len = strlen(name);
+        rolls[i] = studentRoll(list, (int)i);
+        marks[i] = studentMarks(list, (int)i);
+        offsets[i] = at;
+        lengths[i] = (uint32_t)len;
+        memcpy(table + at, name, len + 1);
+        at += (uint32_t)len + 1;
+    }
+    offsets[n] = at;
+
+    const void *data[SNAPSHOT_COLUMNS] = { rolls, marks, offsets, table, lengths };
+    ColumnEntry dir[SNAPSHOT_COLUMNS] = {
+        { COLUMN_ROLL, 4, 0, (uint64_t)n * 4 },
+        { COLUMN_MARKS, 4, 0, (uint64_t)n * 4 },
+        { COLUMN_NAME_OFFSET, 4, 0, ((uint64_t)n + 1) * 4 },
+        { COLUMN_NAME_TABLE, 1, 0, tableSize },
+        { COLUMN_NAME_LENGTH, 4, 0, (uint64_t)n * 4 },
+    };
+    uint64_t pos = alignUp(sizeof(SnapshotHeader) + sizeof(dir));
+    for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        dir[c].offset = pos;
+        pos = alignUp(pos + dir[c].size);
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.rowCount = n;
+    header.columnCount = SNAPSHOT_COLUMNS;
+    header.sequence = sequence;
+    header.fileSize = pos;
+    header.checksum = checksumUpdate(CHECKSUM_SEED, dir, sizeof(dir));
+    for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        header.checksum = checksumUpdate(header.checksum, data[c], (size_t)dir[c].size);
+    }
+
+    // Write next to the target and rename, so a crash never leaves a torn file
+    char tmpPath[1024];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE *fp = fopen(tmpPath, "wb");
+    int ok = fp != NULL;
+    if (ok) {
+        pos = 0;
+        ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+        pos = sizeof(header);
+        ok = ok && writePadded(fp, dir, sizeof(dir), &pos);
+        for (int c = 0; c < SNAPSHOT_COLUMNS && ok; c++) {
+            ok = writePadded(fp, data[c], (size_t)dir[c].size, &pos);
+        }
+        ok = ok && flushToDisk(fp);
+        ok = (fclose(fp) == 0) && ok;
+        ok = ok && rename(tmpPath, path) == 0;
+        if (!ok) remove(tmpPath);
+    }
+
+    free(rolls); free(marks); free(offsets); free(lengths); free(table);
+    return ok;
+}
+
+// --- Reading ---
+
+// Points a LAYOUT_COLUMNS list straight at the mapped columns. Only the
+// offsets and lengths are checked (so a bad file can't send a name read
+// outside the table); the names themselves are not touched, so opening costs
+// a few page faults plus building the roll index.
+static int backByMapping(StudentList *list, MappedFile *file, const SnapshotHeader *header,
+                         const ColumnEntry *rollCol, const ColumnEntry *marksCol,
+                         const ColumnEntry *offCol, const ColumnEntry *nameCol,
+                         const ColumnEntry *lenCol, unsigned long long *sequence) {
+    char *base = (char *)file->data;
+    uint32_t n = header->rowCount;
+    const uint32_t *offsets = (const uint32_t *)(base + offCol->offset);
+    const uint32_t *lengths = (const uint32_t *)(base + lenCol->offset);
+    const char *table = base + nameCol->offset;
+    uint64_t tableSize = nameCol->size;
+
+    int ok = tableSize == 0 ? n == 0 : table[tableSize - 1] == '\0';
+    for (uint32_t i = 0; i < n && ok; i++) {
+        ok = (uint64_t)offsets[i] + lengths[i] < tableSize;
+    }
+    if (!ok) {
+        unmapFile(file);
+        return 0;
+    }
+
+    struct Journal *journal = list->journal;
+    clearList(list); // Replace whatever was loaded before
+    list->rolls = (int *)(base + rollCol->offset);
+    list->marks = (float *)(base + marksCol->offset);
+    list->nameOffsets = (unsigned *)(base + offCol->offset);
+    list->nameLengths = (unsigned *)(base + lenCol->offset);
+    list->nameArena = base + nameCol->offset;
+    list->arenaUsed = (size_t)tableSize;
+    list->arenaCapacity = (size_t)tableSize;
+    list->count = (int)n;
+    list->capacity = (int)n;
+    list->mapping = *file;
+    if (!rebuildIndex(list)) {
+        clearList(list); // Out of memory: also drops the mapping
+        return 0;
+    }
+    recomputeClassStats(list); // No adds went through statsAdd
+    if (list->names) enableNameIndex(list); // ...nor through the name index
+
+    if (sequence) *sequence = header->sequence;
+    list->journal = journal;
+    if (journal) journalCheckpoint(journal, list);
+    return 1; // Success
+}
+
+static const ColumnEntry *findColumn(const ColumnEntry *dir, uint32_t count, uint32_t id) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (dir[i].id == id) return &dir[i];
+    }
+    return NULL;
+}
+
+// Reads just the header's sequence, without checking the payload: lets a
+// caller place a snapshot that fails SNAPSHOT_VERIFY among its journals
+int snapshotSequence(const char *path, unsigned long long *sequence) {
+    SnapshotHeader header;
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return 0;
+    }
+    int ok = fread(&header, sizeof(header), 1, fp) == 1
+          && memcmp(header.magic, SNAPSHOT_MAGIC, 8) == 0
+          && header.version == SNAPSHOT_VERSION
+          && header.headerSize == sizeof(SnapshotHeader);
+    fclose(fp);
+    if (ok) *sequence = header.sequence;
+    return ok;
+}
+
+int openSnapshot(StudentList *list, const char *path, int flags) {
+    return openSnapshotAt(list, path, flags, NULL);
+}
+
+int openSnapshotAt(StudentList *list, const char *path, int flags, unsigned long long *sequence) {
+    // Column lists keep the mapping, so map it writable (copy-on-write)
+    MappedFile file;
+    if (!(list->layout == LAYOUT_COLUMNS ? mapFilePrivate(path, &file) : mapFile(path, &file))) {
+        return 0; // Failure
+    }
+
+    const char *base = file.data;
+    SnapshotHeader header;
+    int ok = file.size >= sizeof(header);
+    if (ok) {
+        memcpy(&header, base, sizeof(header));
+        ok = memcmp(header.magic, SNAPSHOT_MAGIC, 8) == 0
+          && header.version == SNAPSHOT_VERSION
+          && header.headerSize == sizeof(SnapshotHeader)
+          && header.fileSize == file.size
+          && header.columnCount <= MAX_COLUMNS
+          && sizeof(header) + header.columnCount * sizeof(ColumnEntry) <= file.size;
+    }
+
+    const ColumnEntry *dir = NULL;
+    if (ok) {
+        dir = (const ColumnEntry *)(base + sizeof(header));
+        for (uint32_t c = 0; c < header.columnCount && ok; c++) {
+            ok = dir[c].offset <= file.size && dir[c].size <= file.size - dir[c].offset;
+        }
+    }
+    if (ok && (flags & SNAPSHOT_VERIFY)) {
+        uint64_t sum = checksumUpdate(CHECKSUM_SEED, dir, header.columnCount * sizeof(ColumnEntry));
+        for (uint32_t c = 0; c < header.columnCount; c++) {
+            sum = checksumUpdate(sum, base + dir[c].offset, (size_t)dir[c].size);
+        }
+        ok = sum == header.checksum;
+    }
+
+    uint32_t n = ok ? header.rowCount : 0;
+    const ColumnEntry *rollCol = NULL, *marksCol = NULL, *offCol = NULL, *nameCol = NULL;
+    if (ok) {
+        rollCol = findColumn(dir, header.columnCount, COLUMN_ROLL);
+        marksCol = findColumn(dir, header.columnCount, COLUMN_MARKS);
+        offCol = findColumn(dir, header.columnCount, COLUMN_NAME_OFFSET);
+        nameCol = findColumn(dir, header.columnCount, COLUMN_NAME_TABLE);
+        ok = rollCol && rollCol->size == (uint64_t)n * 4
+          && marksCol && marksCol->size == (uint64_t)n * 4
+          && offCol && offCol->size == ((uint64_t)n + 1) * 4
+          && nameCol && n <= (uint32_t)(~0u >> 2);
+    }
+    if (!ok) {
+        unmapFile(&file);
+        return 0;
+    }
+
+    const char *rolls = base + rollCol->offset;
+    const char *marks = base + marksCol->offset;
+    const char *offsets = base + offCol->offset;
+    const char *table = base + nameCol->offset;
+    const ColumnEntry *lenCol = findColumn(dir, header.columnCount, COLUMN_NAME_LENGTH);
+
+    if (list->layout == LAYOUT_COLUMNS && lenCol && lenCol->size == (uint64_t)n * 4
+        && ((rollCol->offset | marksCol->offset | offCol->offset | lenCol->offset) & 3) == 0) {
+        return backByMapping(list, &file, &header, rollCol, marksCol, offCol, nameCol, lenCol, sequence);
+    }
+
+    struct Journal *journal = list->journal;
+    clearList(list); // Replace whatever was loaded before
+    list->journal = NULL;
+    StudentInput batch[SNAPSHOT_BATCH];
+    int batched = 0;
+    ok = reserveStudents(list, (int)n);
+
+    for (uint32_t i = 0; i < n && ok; i++) {
+        int32_t roll;
+        float mark;
+        uint32_t from, to;
+        memcpy(&roll, rolls + (size_t)i * 4, 4);
+        memcpy(&mark, marks + (size_t)i * 4, 4);
+        memcpy(&from, offsets + (size_t)i * 4, 4);
+        memcpy(&to, offsets + ((size_t)i + 1) * 4, 4);
+        if (from >= to || to > nameCol->size || table[to - 1] != '\0') {
+            clearList(list); // Corrupt name table
+            list->journal = journal;
+            unmapFile(&file);
+            return 0;
+        }
+        StudentInput row = { table + from, to - from - 1, roll, mark };
+        batch[batched++] = row;
+        if (batched == SNAPSHOT_BATCH || i + 1 == n) {
+            ok = addStudents(list, batch, batched, NULL);
+            batched = 0;
+        }
+    }
+    if (!ok) {
+        clearList(list); // Out of memory
+        list->journal = journal;
+        unmapFile(&file);
+        return 0;
+    }
+
+    unmapFile(&file);
+    if (sequence) *sequence = header.sequence;
+    list->journal = journal;
+    if (journal) journalCheckpoint(journal, list);
+    return 1; // Success
+}
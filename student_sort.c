@@ -0,0 +1,453 @@
+#include "student_logic.h"
+#include "student_journal.h"
+#include "student_perf.h"
+#include "student_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+// --- Sort Engine ---
+// Sorting works on a permutation of row indices rather than on the records
+// themselves. Compound keys are handled LSD-style: one stable pass per key,
+// least significant key first, so every pass only ever needs a single
+// comparator. Each pass first pulls its key out of the list into a plain
+// array (so it works the same for either layout), then numeric keys use an
+// LSD radix sort once the list is big enough; names (and small lists) use a
+// stable bottom-up merge sort.
+
+#define RADIX_THRESHOLD 256   // Below this, merge sort beats the histogram setup
+#define INSERTION_RUN 32      // Merge sort starts from insertion-sorted runs
+
+// Generates a stable merge sort over perm[0..n) specialised for one key type
+// and comparator, so the inner loop never tests the key or the order at
+// runtime. key[] is indexed by row, perm[] holds rows. Reports n units of
+// progress spread over its merge levels and gives up between levels once
+// cancelled (perm is then left in no particular order).
+#define DEFINE_MERGE_SORT(FUNC, KEY_T, LESS)                                   \
+static void FUNC(const KEY_T *key, int *perm, int *tmp, int n,                 \
+                 Progress *progress) {                                         \
+    int levels = 1, level = 1;                                                 \
+    long long reported = 0;                                                    \
+    for (int width = INSERTION_RUN; width < n; width *= 2) levels++;           \
+    for (int lo = 0; lo < n; lo += INSERTION_RUN) {                            \
+        int hi = lo + INSERTION_RUN < n ? lo + INSERTION_RUN : n;              \
+        for (int i = lo + 1; i < hi; i++) {                                    \
+            int v = perm[i];                                                   \
+            int j = i - 1;                                                     \
+            while (j >= lo && LESS(key[v], key[perm[j]])) {                    \
+                perm[j + 1] = perm[j];                                         \
+                j--;                                                           \
+            }                                                                  \
+            perm[j + 1] = v;                                                   \
+        }                                                                      \
+    }                                                                          \
+    int *src = perm, *dst = tmp;                                               \
+    for (int width = INSERTION_RUN; width < n; width *= 2, level++) {          \
+        long long due = (long long)n * level / levels;                         \
+        progressAdvance(progress, due - reported);                             \
+        reported = due;                                                        \
+        if (progressCancelled(progress)) return;                               \
+        for (int lo = 0; lo < n; lo += 2 * width) {                            \
+            int mid = lo + width < n ? lo + width : n;                         \
+            int hi = lo + 2 * width < n ? lo + 2 * width : n;                  \
+            int a = lo, b = mid, k = lo;                                       \
+            while (a < mid && b < hi) {                                        \
+                dst[k++] = LESS(key[src[b]], key[src[a]]) ? src[b++] : src[a++]; \
+            }                                                                  \
+            while (a < mid) dst[k++] = src[a++];                               \
+            while (b < hi) dst[k++] = src[b++];                                \
+        }                                                                      \
+        int *t = src; src = dst; dst = t;                                      \
+    }                                                                          \
+    if (src != perm) {                                                         \
+        memcpy(perm, src, (size_t)n * sizeof(int));                            \
+    }                                                                          \
+    progressAdvance(progress, n - reported);                                   \
+}
+
+#define NUM_ASC(a, b)   ((a) < (b))
+#define NUM_DESC(a, b)  ((b) < (a))
+#define NAME_ASC(a, b)  (strcmp((a), (b)) < 0)
+#define NAME_DESC(a, b) (strcmp((b), (a)) < 0)
+
+DEFINE_MERGE_SORT(mergeSortMarksAsc, float, NUM_ASC)
+DEFINE_MERGE_SORT(mergeSortMarksDesc, float, NUM_DESC)
+DEFINE_MERGE_SORT(mergeSortRollAsc, int, NUM_ASC)
+DEFINE_MERGE_SORT(mergeSortRollDesc, int, NUM_DESC)
+typedef const char *NameKey; // So `const KEY_T *` reads as const char *const *
+
+DEFINE_MERGE_SORT(mergeSortNameAsc, NameKey, NAME_ASC)
+DEFINE_MERGE_SORT(mergeSortNameDesc, NameKey, NAME_DESC)
+
+// Maps a float to an unsigned key with the same ordering.
+static unsigned marksKey(float marks) {
+    unsigned u;
+    memcpy(&u, &marks, sizeof(u));
+    return (u & 0x80000000U) ? ~u : (u | 0x80000000U);
+}
+
+// Copies one field of every row into out[] (row order).
+static void extractKey(const StudentList *list, SortField field, void *out) {
+    int n = list->count;
+    if (field == SORT_BY_MARKS) {
+        float *marks = out;
+        if (list->layout == LAYOUT_COLUMNS) memcpy(marks, list->marks, (size_t)n * sizeof(float));
+        else for (int i = 0; i < n; i++) marks[i] = list->students[i].marks;
+    } else if (field == SORT_BY_ROLL) {
+        int *rolls = out;
+        if (list->layout == LAYOUT_COLUMNS) memcpy(rolls, list->rolls, (size_t)n * sizeof(int));
+        else for (int i = 0; i < n; i++) rolls[i] = list->students[i].roll;
+    } else {
+        const char **names = out;
+        for (int i = 0; i < n; i++) names[i] = studentName(list, i);
+    }
+}
+
+// Stable LSD radix sort of perm by a 32-bit key, 8 bits per pass. Passes in
+// which every key shares the same byte are skipped.
+static void radixPass(const void *column, SortField field, int descending,
+                      int *perm, int *tmpPerm, unsigned *keys, unsigned *tmpKeys, int n) {
+    unsigned flip = descending ? 0xFFFFFFFFU : 0U;
+    if (field == SORT_BY_MARKS) {
+        const float *marks = column;
+        for (int i = 0; i < n; i++) keys[i] = marksKey(marks[perm[i]]) ^ flip;
+    } else {
+        const int *rolls = column;
+        for (int i = 0; i < n; i++) keys[i] = ((unsigned)rolls[perm[i]] ^ 0x80000000U) ^ flip;
+    }
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        int counts[256] = {0};
+        for (int i = 0; i < n; i++) counts[(keys[i] >> shift) & 0xFF]++;
+        if (counts[(keys[0] >> shift) & 0xFF] == n)
+            continue; // All keys share this byte
+
+        int offsets[256];
+        int total = 0;
+        for (int b = 0; b < 256; b++) {
+            offsets[b] = total;
+            total += counts[b];
+        }
+        for (int i = 0; i < n; i++) {
+            int dst = offsets[(keys[i] >> shift) & 0xFF]++;
+            tmpKeys[dst] = keys[i];
+            tmpPerm[dst] = perm[i];
+        }
+        memcpy(keys, tmpKeys, (size_t)n * sizeof(unsigned));
+        memcpy(perm, tmpPerm, (size_t)n * sizeof(int));
+    }
+}
+
+// One stable pass over perm[0..n) by a single key. radixKeys is 2n of
+// scratch, needed only for numeric keys from RADIX_THRESHOLD rows.
+static void sortByKey(const void *column, SortField field, int descending, int *perm, int *tmpPerm,
+                      unsigned *radixKeys, int n, Progress *progress) {
+    if (field != SORT_BY_NAME && n >= RADIX_THRESHOLD) {
+        radixPass(column, field, descending, perm, tmpPerm, radixKeys, radixKeys + n, n);
+        progressAdvance(progress, n); // Radix passes are quick; no finer steps
+    } else if (field == SORT_BY_MARKS) {
+        (descending ? mergeSortMarksDesc : mergeSortMarksAsc)(column, perm, tmpPerm, n, progress);
+    } else if (field == SORT_BY_ROLL) {
+        (descending ? mergeSortRollDesc : mergeSortRollAsc)(column, perm, tmpPerm, n, progress);
+    } else {
+        (descending ? mergeSortNameDesc : mergeSortNameAsc)(column, perm, tmpPerm, n, progress);
+    }
+}
+
+// --- Parallel Sort ---
+// From the parallel threshold up, each key pass is split: perm is cut into
+// one run per thread, the runs are sorted at the same time by sortByKey, and
+// then merged pairwise in log2(runs) rounds. Every merge is cut again into
+// equal slices of its output by merge-path co-ranking (a binary search for
+// how many elements each side contributes), so each round keeps all threads
+// busy rather than one per pair. Ties take the left run first, which keeps
+// the pass stable.
+
+#define MAX_RUNS 256
+#define MIN_MERGE_SLICE (1 << 15) // Output elements per merge task, at least
+
+// Writes out[d0..d1) of the stable merge of a[0..m) and b[0..l).
+#define DEFINE_MERGE_SLICE(FUNC, KEY_T, LESS)                                  \
+static void FUNC(const void *column, const int *a, int m, const int *b, int l,  \
+                 int d0, int d1, int *out) {                                   \
+    const KEY_T *key = column;                                                 \
+    int cut[2], ends[2] = { d0, d1 };                                          \
+    for (int c = 0; c < 2; c++) {                                              \
+        int d = ends[c];                                                       \
+        int lo = d > l ? d - l : 0, hi = d < m ? d : m;                        \
+        while (lo < hi) { /* a[mid] comes out before b[d - mid - 1]? */        \
+            int mid = lo + (hi - lo) / 2;                                      \
+            if (!LESS(key[b[d - mid - 1]], key[a[mid]])) lo = mid + 1;         \
+            else hi = mid;                                                     \
+        }                                                                      \
+        cut[c] = lo;                                                           \
+    }                                                                          \
+    int i = cut[0], iEnd = cut[1], j = d0 - cut[0], jEnd = d1 - cut[1], k = d0; \
+    while (i < iEnd && j < jEnd) {                                             \
+        out[k++] = LESS(key[b[j]], key[a[i]]) ? b[j++] : a[i++];               \
+    }                                                                          \
+    while (i < iEnd) out[k++] = a[i++];                                        \
+    while (j < jEnd) out[k++] = b[j++];                                        \
+}
+
+DEFINE_MERGE_SLICE(mergeSliceMarksAsc, float, NUM_ASC)
+DEFINE_MERGE_SLICE(mergeSliceMarksDesc, float, NUM_DESC)
+DEFINE_MERGE_SLICE(mergeSliceRollAsc, int, NUM_ASC)
+DEFINE_MERGE_SLICE(mergeSliceRollDesc, int, NUM_DESC)
+DEFINE_MERGE_SLICE(mergeSliceNameAsc, NameKey, NAME_ASC)
+DEFINE_MERGE_SLICE(mergeSliceNameDesc, NameKey, NAME_DESC)
+
+typedef void (*MergeSliceFn)(const void *column, const int *a, int m, const int *b, int l,
+                             int d0, int d1, int *out);
+
+typedef struct {
+    int lo, mid, hi;  // Merge src[lo..mid) with src[mid..hi) (mid == hi: a plain copy)
+    int d0, d1;       // This task's share of the output, relative to lo
+} MergeSlice;
+
+typedef struct {
+    const void *column;
+    SortField field;
+    int descending;
+    int *perm, *tmpPerm;
+    unsigned *radixKeys;
+    const int *bounds;     // Run r is perm[bounds[r]..bounds[r + 1])
+    Progress *progress;
+    // Merge rounds
+    MergeSliceFn merge;
+    const int *src;
+    int *dst;
+    const MergeSlice *slices;
+} ParallelSort;
+
+static void sortRunsTask(void *ctx, long long begin, long long end) {
+    ParallelSort *ps = ctx;
+    for (long long r = begin; r < end; r++) {
+        int lo = ps->bounds[r], n = ps->bounds[r + 1] - lo;
+        sortByKey(ps->column, ps->field, ps->descending, ps->perm + lo, ps->tmpPerm + lo,
+                  ps->radixKeys ? ps->radixKeys + 2 * (size_t)lo : NULL, n, ps->progress);
+    }
+}
+
+static void mergeTask(void *ctx, long long begin, long long end) {
+    ParallelSort *ps = ctx;
+    for (long long t = begin; t < end; t++) {
+        const MergeSlice *s = &ps->slices[t];
+        ps->merge(ps->column, ps->src + s->lo, s->mid - s->lo, ps->src + s->mid, s->hi - s->mid,
+                  s->d0, s->d1, ps->dst + s->lo);
+    }
+}
+
+static void copyTask(void *ctx, long long begin, long long end) {
+    ParallelSort *ps = ctx;
+    memcpy(ps->dst + begin, ps->src + begin, (size_t)(end - begin) * sizeof(int));
+}
+
+// Same result as sortByKey. Returns 0 if memory ran out or the sort was
+// cancelled.
+static int parallelSortByKey(const void *column, SortField field, int descending, int *perm, int *tmpPerm,
+                             unsigned *radixKeys, int n, Progress *progress) {
+    static const MergeSliceFn merges[3][2] = {
+        { mergeSliceMarksAsc, mergeSliceMarksDesc },
+        { mergeSliceRollAsc, mergeSliceRollDesc },
+        { mergeSliceNameAsc, mergeSliceNameDesc }
+    };
+    int threads = workerThreads();
+    int runs = threads < MAX_RUNS ? threads : MAX_RUNS;
+    int sliceSize = n / (threads * 4) > MIN_MERGE_SLICE ? n / (threads * 4) : MIN_MERGE_SLICE;
+    int bounds[MAX_RUNS + 1];
+    for (int r = 0; r <= runs; r++) {
+        bounds[r] = (int)((long long)n * r / runs);
+    }
+    MergeSlice *slices = malloc(((size_t)n / sliceSize + runs + 1) * sizeof(MergeSlice));
+    if (slices == NULL) {
+        return 0;
+    }
+
+    ParallelSort ps = { column, field, descending, perm, tmpPerm, radixKeys, bounds, progress,
+                        merges[field][descending], NULL, NULL, slices };
+    parallelFor(runs, 1, sortRunsTask, &ps);
+
+    int *src = perm, *dst = tmpPerm;
+    while (runs > 1 && !progressCancelled(progress)) {
+        int count = 0;
+        for (int r = 0; r < runs; r += 2) {
+            int lo = bounds[r], mid = bounds[r + 1 < runs ? r + 1 : runs], hi = bounds[r + 2 < runs ? r + 2 : runs];
+            for (int d = 0; d < hi - lo; d += sliceSize) {
+                MergeSlice slice = { lo, mid, hi, d, d + sliceSize < hi - lo ? d + sliceSize : hi - lo };
+                slices[count++] = slice;
+            }
+        }
+        ps.src = src;
+        ps.dst = dst;
+        parallelFor(count, 1, mergeTask, &ps);
+        for (int r = 0; r * 2 < runs; r++) {
+            bounds[r] = bounds[r * 2];
+        }
+        bounds[(runs + 1) / 2] = n;
+        runs = (runs + 1) / 2;
+        int *t = src; src = dst; dst = t;
+    }
+    if (src != perm) {
+        ps.src = src;
+        ps.dst = perm;
+        parallelFor(n, MIN_MERGE_SLICE, copyTask, &ps);
+    }
+    free(slices);
+    return !progressCancelled(progress);
+}
+
+int sortPermutation(const StudentList *list, const SortKey *keys, int keyCount, int *perm) {
+    return sortPermutationProgress(list, keys, keyCount, perm, NULL);
+}
+
+// Progress runs to keyCount * count, one count per key pass.
+int sortPermutationProgress(const StudentList *list, const SortKey *keys, int keyCount, int *perm,
+                            Progress *progress) {
+    int n = list->count;
+    for (int i = 0; i < n; i++) {
+        perm[i] = i;
+    }
+    progressStart(progress, keyCount > 0 ? (long long)keyCount * n : 0);
+    if (n < 2 || keyCount <= 0) {
+        return 1;
+    }
+
+    int *tmpPerm = malloc((size_t)n * sizeof(int));
+    void *column = malloc((size_t)n * sizeof(const char *)); // Big enough for any key type
+    unsigned *radixKeys = NULL;
+    if (tmpPerm == NULL || column == NULL) {
+        free(tmpPerm);
+        free(column);
+        return 0; // Failure: out of memory
+    }
+
+    int ok = 1;
+    for (int k = keyCount - 1; k >= 0 && ok; k--) {
+        SortField field = keys[k].field;
+        int descending = keys[k].descending ? 1 : 0;
+        extractKey(list, field, column);
+
+        if (field != SORT_BY_NAME && n >= RADIX_THRESHOLD && radixKeys == NULL) {
+            radixKeys = malloc((size_t)n * 2 * sizeof(unsigned));
+            if (radixKeys == NULL) {
+                ok = 0;
+                break;
+            }
+        }
+        if (parallelWorth(n)) {
+            ok = parallelSortByKey(column, field, descending, perm, tmpPerm, radixKeys, n, progress);
+        } else {
+            sortByKey(column, field, descending, perm, tmpPerm, radixKeys, n, progress);
+        }
+        if (progressCancelled(progress)) ok = 0;
+    }
+
+    free(radixKeys);
+    free(column);
+    free(tmpPerm);
+    return ok;
+}
+
+typedef struct {
+    const char *column;
+    size_t elemSize;
+    const int *perm;
+    char *out;
+} Gather;
+
+#define GATHER_GRAIN 65536
+
+static void gatherTask(void *ctx, long long begin, long long end) {
+    const Gather *g = ctx;
+    if (g->elemSize == 4) { // Every column of the column layout; a fixed-size copy is one move
+        for (long long i = begin; i < end; i++) memcpy(g->out + (size_t)i * 4, g->column + (size_t)g->perm[i] * 4, 4);
+        return;
+    }
+    for (long long i = begin; i < end; i++) {
+        memcpy(g->out + (size_t)i * g->elemSize, g->column + (size_t)g->perm[i] * g->elemSize, g->elemSize);
+    }
+}
+
+// Gathers one column into a fresh array in perm order.
+static void *gather(const void *column, size_t elemSize, const int *perm, int n) {
+    char *out = malloc((size_t)n * elemSize);
+    if (out == NULL) return NULL;
+    Gather g = { column, elemSize, perm, out };
+    if (parallelWorth(n)) parallelFor(n, GATHER_GRAIN, gatherTask, &g);
+    else gatherTask(&g, 0, n);
+    return out;
+}
+
+int applyPermutation(StudentList *list, const int *perm) {
+    int n = list->count;
+    if (n == 0) {
+        return 1;
+    }
+    if (list->layout == LAYOUT_ROWS) {
+        Student *sorted = gather(list->students, sizeof(Student), perm, n);
+        if (sorted == NULL) {
+            return 0; // Failure: list left untouched
+        }
+        free(list->students);
+        list->students = sorted;
+        list->capacity = n;
+    } else {
+        // Names stay where they are in the arena; only the offsets move
+        int *rolls = gather(list->rolls, sizeof(int), perm, n);
+        float *marks = gather(list->marks, sizeof(float), perm, n);
+        unsigned *offsets = gather(list->nameOffsets, sizeof(unsigned), perm, n);
+        unsigned *lengths = gather(list->nameLengths, sizeof(unsigned), perm, n);
+        if (!rolls || !marks || !offsets || !lengths) {
+            free(rolls); free(marks); free(offsets); free(lengths);
+            return 0;
+        }
+        if (list->mapping.data != NULL) {
+            // Arrays were inside a snapshot mapping: the arena has to move out too
+            char *arena = malloc(list->arenaUsed + 1);
+            if (arena == NULL) {
+                free(rolls); free(marks); free(offsets); free(lengths);
+                return 0;
+            }
+            memcpy(arena, list->nameArena, list->arenaUsed);
+            list->nameArena = arena;
+            list->arenaCapacity = list->arenaUsed;
+            unmapFile(&list->mapping);
+        } else {
+            free(list->rolls); free(list->marks); free(list->nameOffsets); free(list->nameLengths);
+        }
+        list->rolls = rolls;
+        list->marks = marks;
+        list->nameOffsets = offsets;
+        list->nameLengths = lengths;
+        list->capacity = n;
+    }
+    rebuildIndex(list); // Slots changed, so the roll index must follow
+    if (list->changes) changeFeedReset(list->changes);
+    if (list->history) historyReset(list->history);
+    return 1;
+}
+
+int sortStudentsBy(StudentList *list, const SortKey *keys, int keyCount) {
+    if (list->count < 2) {
+        return 1;
+    }
+    PERF_BEGIN();
+    int *perm = malloc((size_t)list->count * sizeof(int));
+    int ok = perm != NULL && sortPermutation(list, keys, keyCount, perm) && applySortOrder(list, perm, keys, keyCount);
+    free(perm);
+    PERF_END(PERF_SORT);
+    return ok;
+}
+
+// Lets the permutation be computed elsewhere (e.g. on a worker thread) and
+// applied later: reorders the list and journals the sort it came from.
+int applySortOrder(StudentList *list, const int *perm, const SortKey *keys, int keyCount) {
+    if (!applyPermutation(list, perm)) {
+        return 0;
+    }
+    if (list->journal) {
+        journalLogSort(list->journal, keys, keyCount);
+        journalCheckpointIfDue(list->journal);
+    }
+    return 1;
+}
@@ -0,0 +1,528 @@
+#include "student_logic.h"
+#include "student_perf.h"
+#include "student_pool.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STATS_SSE2 1
+#endif
+
+// --- Class Statistics ---
+// Every add / modify / remove pushes its marks through statsAdd/statsRemove,
+// so getClassStats is O(1). The only thing a removal can't update in O(1) is
+// the min or max; when the removed marks were one of those, the next read
+// rescans for them. recomputeClassStats rebuilds everything from the records
+// (vectorised for the column layout) to check the running values after bulk
+// work.
+
+static void kahanAdd(double *sum, double *compensation, double x) {
+    double y = x - *compensation;
+    double t = *sum + y;
+    *compensation = (t - *sum) - y;
+    *sum = t;
+}
+
+static int gradeBand(float marks) {
+    float band = marks / 10.0f;
+    if (!(band >= 0)) band = 0; // Also catches NaN
+    if (band > GRADE_BANDS - 1) band = GRADE_BANDS - 1;
+    return (int)band;
+}
+
+void statsAdd(RunningStats *stats, float marks) {
+    if (stats->count == 0) {
+        stats->min = marks;
+        stats->max = marks;
+        stats->minMaxStale = 0;
+    } else if (!stats->minMaxStale) {
+        if (marks < stats->min) stats->min = marks;
+        if (marks > stats->max) stats->max = marks;
+    }
+    stats->count++;
+    kahanAdd(&stats->sum, &stats->sumCompensation, marks);
+    kahanAdd(&stats->sumSquares, &stats->sumSquaresCompensation, (double)marks * marks);
+    if (marksPassed(marks)) stats->passCount++;
+    stats->bands[gradeBand(marks)]++;
+}
+
+void statsRemove(RunningStats *stats, float marks) {
+    if (--stats->count <= 0) {
+        memset(stats, 0, sizeof(*stats)); // Start clean, no drift carried over
+        return;
+    }
+    kahanAdd(&stats->sum, &stats->sumCompensation, -(double)marks);
+    kahanAdd(&stats->sumSquares, &stats->sumSquaresCompensation, -(double)marks * marks);
+    if (marksPassed(marks)) stats->passCount--;
+    stats->bands[gradeBand(marks)]--;
+    if (marks <= stats->min || marks >= stats->max) stats->minMaxStale = 1;
+}
+
+// --- Parallel Reductions ---
+// Big lists are scanned in fixed chunks of STATS_GRAIN rows on the worker
+// pool, one partial result per chunk, and the partials are folded in chunk
+// order. The chunks never depend on the thread count, so neither do the
+// (rounding of the) results.
+
+#define STATS_GRAIN 65536
+
+typedef struct {
+    const StudentList *list;
+    RunningStats *partials;  // One per chunk
+} StatsScan;
+
+static void minMaxRange(const StudentList *list, int begin, int end, float *min, float *max) {
+    float lo = studentMarks(list, begin), hi = lo;
+    for (int i = begin + 1; i < end; i++) {
+        float m = studentMarks(list, i);
+        if (m < lo) lo = m;
+        if (m > hi) hi = m;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+static void minMaxTask(void *ctx, long long begin, long long end) {
+    StatsScan *scan = ctx;
+    for (long long lo = begin; lo < end; lo += STATS_GRAIN) {
+        RunningStats *part = &scan->partials[lo / STATS_GRAIN];
+        long long hi = lo + STATS_GRAIN < end ? lo + STATS_GRAIN : end;
+        minMaxRange(scan->list, (int)lo, (int)hi, &part->min, &part->max);
+    }
+}
+
+// Min and max only; used after a removal took one of them out.
+static void refreshMinMax(StudentList *list) {
+    RunningStats *stats = &list->stats;
+    int chunks = (list->count + STATS_GRAIN - 1) / STATS_GRAIN;
+    RunningStats *partials = parallelWorth(list->count) ? malloc((size_t)chunks * sizeof(RunningStats)) : NULL;
+    if (partials == NULL) {
+        minMaxRange(list, 0, list->count, &stats->min, &stats->max);
+    } else {
+        StatsScan scan = { list, partials };
+        parallelFor(list->count, STATS_GRAIN, minMaxTask, &scan);
+        stats->min = partials[0].min;
+        stats->max = partials[0].max;
+        for (int c = 1; c < chunks; c++) {
+            if (partials[c].min < stats->min) stats->min = partials[c].min;
+            if (partials[c].max > stats->max) stats->max = partials[c].max;
+        }
+        free(partials);
+    }
+    stats->minMaxStale = 0;
+}
+
+static int classStats(StudentList *list, ClassStats *out) {
+    if (list->stats.count > 0 && list->stats.minMaxStale) {
+        refreshMinMax(list);
+    }
+    return statsReport(&list->stats, out);
+}
+
+int statsReport(const RunningStats *stats, ClassStats *out) {
+    memset(out, 0, sizeof(*out));
+    if (stats->count == 0) {
+        return 0; // No students
+    }
+    double n = stats->count;
+    double average = stats->sum / n;
+    double variance = stats->sumSquares / n - average * average;
+    out->count = stats->count;
+    out->average = average;
+    out->stddev = variance > 0 ? sqrt(variance) : 0.0; // Rounding can push it just below 0
+    out->min = stats->min;
+    out->max = stats->max;
+    out->passCount = stats->passCount;
+    out->failCount = stats->count - stats->passCount;
+    memcpy(out->bands, stats->bands, sizeof(out->bands));
+    return 1;
+}
+
+int getClassStats(StudentList *list, ClassStats *out) {
+    PERF_BEGIN();
+    int ok = classStats(list, out);
+    PERF_END(PERF_CLASS_STATS);
+    return ok;
+}
+
+float getAverageMarks(const StudentList *list) {
+    PERF_BEGIN_SAMPLED();
+    float average = list->stats.count == 0 ? 0.0f // 0 if no students
+                                           : (float)(list->stats.sum / list->stats.count);
+    PERF_END(PERF_AVERAGE);
+    return average;
+}
+
+// --- Full Recompute ---
+
+#ifdef STATS_SSE2
+// Four marks per step: min/max/pass/bands in float lanes, the sums widened
+// to two pairs of double lanes, each lane with its own Kahan compensation.
+static void scanMarksSse2(const float *marks, int n, RunningStats *fresh) {
+    __m128d sum[2] = { _mm_setzero_pd(), _mm_setzero_pd() };
+    __m128d sumC[2] = { _mm_setzero_pd(), _mm_setzero_pd() };
+    __m128d sq[2] = { _mm_setzero_pd(), _mm_setzero_pd() };
+    __m128d sqC[2] = { _mm_setzero_pd(), _mm_setzero_pd() };
+    __m128 lo = _mm_set1_ps(marks[0]);
+    __m128 hi = lo;
+    const __m128 passMark = _mm_set1_ps(PASS_MARK);
+    const __m128 ten = _mm_set1_ps(10.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 topBand = _mm_set1_ps((float)(GRADE_BANDS - 1));
+    static const int bitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    int pass = 0;
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(marks + i);
+        lo = _mm_min_ps(lo, v);
+        hi = _mm_max_ps(hi, v);
+        pass += bitCount[_mm_movemask_ps(_mm_cmpgt_ps(v, passMark))];
+
+        // Same clamping as gradeBand: max() with 0 first also maps NaN to 0
+        __m128 band = _mm_min_ps(_mm_max_ps(_mm_div_ps(v, ten), zero), topBand);
+        int bands[4];
+        _mm_storeu_si128((__m128i *)bands, _mm_cvttps_epi32(band));
+        fresh->bands[bands[0]]++;
+        fresh->bands[bands[1]]++;
+        fresh->bands[bands[2]]++;
+        fresh->bands[bands[3]]++;
+
+        __m128d halves[2] = { _mm_cvtps_pd(v), _mm_cvtps_pd(_mm_movehl_ps(v, v)) };
+        for (int h = 0; h < 2; h++) {
+            __m128d y = _mm_sub_pd(halves[h], sumC[h]);
+            __m128d t = _mm_add_pd(sum[h], y);
+            sumC[h] = _mm_sub_pd(_mm_sub_pd(t, sum[h]), y);
+            sum[h] = t;
+
+            y = _mm_sub_pd(_mm_mul_pd(halves[h], halves[h]), sqC[h]);
+            t = _mm_add_pd(sq[h], y);
+            sqC[h] = _mm_sub_pd(_mm_sub_pd(t, sq[h]), y);
+            sq[h] = t;
+        }
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, lo);
+    fresh->min = lanes[0];
+    for (int k = 1; k < 4; k++) if (lanes[k] < fresh->min) fresh->min = lanes[k];
+    _mm_storeu_ps(lanes, hi);
+    fresh->max = lanes[0];
+    for (int k = 1; k < 4; k++) if (lanes[k] > fresh->max) fresh->max = lanes[k];
+
+    // Fold the lanes (and their compensations) into the scalar accumulators
+    double part[2];
+    for (int h = 0; h < 2; h++) {
+        _mm_storeu_pd(part, sum[h]);
+        kahanAdd(&fresh->sum, &fresh->sumCompensation, part[0]);
+        kahanAdd(&fresh->sum, &fresh->sumCompensation, part[1]);
+        _mm_storeu_pd(part, sumC[h]);
+        kahanAdd(&fresh->sum, &fresh->sumCompensation, -part[0]);
+        kahanAdd(&fresh->sum, &fresh->sumCompensation, -part[1]);
+        _mm_storeu_pd(part, sq[h]);
+        kahanAdd(&fresh->sumSquares, &fresh->sumSquaresCompensation, part[0]);
+        kahanAdd(&fresh->sumSquares, &fresh->sumSquaresCompensation, part[1]);
+        _mm_storeu_pd(part, sqC[h]);
+        kahanAdd(&fresh->sumSquares, &fresh->sumSquaresCompensation, -part[0]);
+        kahanAdd(&fresh->sumSquares, &fresh->sumSquaresCompensation, -part[1]);
+    }
+    fresh->passCount = pass;
+    fresh->count = i;
+
+    for (; i < n; i++) {
+        statsAdd(fresh, marks[i]); // Leftover tail
+    }
+}
+#endif
+
+static int closeEnough(double a, double b) {
+    double scale = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return fabs(a - b) <= 1e-9 * (scale > 1 ? scale : 1);
+}
+
+// Rows [begin, end) into fresh (zeroed by the caller).
+static void scanRange(const StudentList *list, int begin, int end, RunningStats *fresh) {
+#ifdef STATS_SSE2
+    if (list->layout == LAYOUT_COLUMNS && end - begin >= 4) {
+        scanMarksSse2(list->marks + begin, end - begin, fresh);
+        return;
+    }
+#endif
+    for (int i = begin; i < end; i++) {
+        statsAdd(fresh, studentMarks(list, i));
+    }
+}
+
+static void scanTask(void *ctx, long long begin, long long end) {
+    StatsScan *scan = ctx;
+    for (long long lo = begin; lo < end; lo += STATS_GRAIN) {
+        RunningStats *part = &scan->partials[lo / STATS_GRAIN];
+        memset(part, 0, sizeof(*part));
+        scanRange(scan->list, (int)lo, (int)(lo + STATS_GRAIN < end ? lo + STATS_GRAIN : end), part);
+    }
+}
+
+// Folds a chunk's stats into the total, compensations included.
+static void statsMerge(RunningStats *into, const RunningStats *part) {
+    if (part->count == 0) return;
+    if (into->count == 0 || part->min < into->min) into->min = part->min;
+    if (into->count == 0 || part->max > into->max) into->max = part->max;
+    into->count += part->count;
+    kahanAdd(&into->sum, &into->sumCompensation, part->sum);
+    kahanAdd(&into->sum, &into->sumCompensation, -part->sumCompensation);
+    kahanAdd(&into->sumSquares, &into->sumSquaresCompensation, part->sumSquares);
+    kahanAdd(&into->sumSquares, &into->sumSquaresCompensation, -part->sumSquaresCompensation);
+    into->passCount += part->passCount;
+    for (int b = 0; b < GRADE_BANDS; b++) into->bands[b] += part->bands[b];
+}
+
+int recomputeClassStats(StudentList *list) {
+    RunningStats fresh;
+    memset(&fresh, 0, sizeof(fresh));
+    int chunks = (list->count + STATS_GRAIN - 1) / STATS_GRAIN;
+    RunningStats *partials = parallelWorth(list->count) ? malloc((size_t)chunks * sizeof(RunningStats)) : NULL;
+    if (partials == NULL) {
+        scanRange(list, 0, list->count, &fresh);
+    } else {
+        StatsScan scan = { list, partials };
+        parallelFor(list->count, STATS_GRAIN, scanTask, &scan);
+        for (int c = 0; c < chunks; c++) {
+            statsMerge(&fresh, &partials[c]);
+        }
+        free(partials);
+    }
+
+    RunningStats *old = &list->stats;
+    if (old->minMaxStale && list->count > 0) {
+        refreshMinMax(list);
+    }
+    int agreed = old->count == fresh.count
+              && old->passCount == fresh.passCount
+              && memcmp(old->bands, fresh.bands, sizeof(fresh.bands)) == 0
+              && old->min == fresh.min && old->max == fresh.max
+              && closeEnough(old->sum, fresh.sum)
+              && closeEnough(old->sumSquares, fresh.sumSquares);
+    *old = fresh;
+    return agreed;
+}
+
+// --- Order Statistics ---
+// Top-K keeps a k-entry heap whose root is the weakest row kept so far, so a
+// query costs O(n log k) and never touches the list order. Percentiles copy
+// the marks and run introselect on the copy: quickselect with a
+// median-of-three pivot, falling back to heapsort if partitioning keeps
+// going badly.
+
+#define SELECT_SMALL 16 // Below this, insertion sort finishes the range
+
+// 1 if row a should be listed before row b
+static int ranksBefore(const StudentList *list, int a, int b, int highFirst) {
+    float ma = studentMarks(list, a), mb = studentMarks(list, b);
+    if (ma != mb) return highFirst ? ma > mb : ma < mb;
+    return studentRoll(list, a) < studentRoll(list, b);
+}
+
+// Sift down in a heap whose root is the row that ranks last
+static void siftWorst(const StudentList *list, int *heap, int n, int at, int highFirst) {
+    for (;;) {
+        int worst = at;
+        int left = 2 * at + 1, right = left + 1;
+        if (left < n && ranksBefore(list, heap[worst], heap[left], highFirst)) worst = left;
+        if (right < n && ranksBefore(list, heap[worst], heap[right], highFirst)) worst = right;
+        if (worst == at) return;
+        int t = heap[at]; heap[at] = heap[worst]; heap[worst] = t;
+        at = worst;
+    }
+}
+
+static int selectRows(const StudentList *list, int k, int *rows, int highFirst) {
+    if (k > list->count) k = list->count;
+    if (k <= 0) return 0;
+
+    for (int i = 0; i < k; i++) rows[i] = i;
+    for (int i = k / 2 - 1; i >= 0; i--) siftWorst(list, rows, k, i, highFirst);
+    for (int i = k; i < list->count; i++) {
+        if (ranksBefore(list, i, rows[0], highFirst)) {
+            rows[0] = i; // Beats the weakest kept row
+            siftWorst(list, rows, k, 0, highFirst);
+        }
+    }
+    // Heapsort: popping the weakest to the back leaves the best at the front
+    for (int end = k - 1; end > 0; end--) {
+        int t = rows[0]; rows[0] = rows[end]; rows[end] = t;
+        siftWorst(list, rows, end, 0, highFirst);
+    }
+    return k;
+}
+
+int topStudents(const StudentList *list, int k, int *rows) {
+    return selectRows(list, k, rows, 1);
+}
+
+int bottomStudents(const StudentList *list, int k, int *rows) {
+    return selectRows(list, k, rows, 0);
+}
+
+static void siftFloat(float *a, int n, int at) {
+    for (;;) {
+        int big = at;
+        int left = 2 * at + 1, right = left + 1;
+        if (left < n && a[left] > a[big]) big = left;
+        if (right < n && a[right] > a[big]) big = right;
+        if (big == at) return;
+        float t = a[at]; a[at] = a[big]; a[big] = t;
+        at = big;
+    }
+}
+
+static void heapSortFloats(float *a, int n) {
+    for (int i = n / 2 - 1; i >= 0; i--) siftFloat(a, n, i);
+    for (int end = n - 1; end > 0; end--) {
+        float t = a[0]; a[0] = a[end]; a[end] = t;
+        siftFloat(a, end, 0);
+    }
+}
+
+// Rearranges a[] so a[k] holds the k-th smallest value and returns it.
+static float selectNth(float *a, int n, int k) {
+    int lo = 0, hi = n - 1;
+    int depth = 0;
+    for (int m = n; m > 1; m >>= 1) depth += 2; // 2 * log2(n) rounds of partitioning
+    while (hi - lo >= SELECT_SMALL) {
+        if (depth-- == 0) {
+            heapSortFloats(a + lo, hi - lo + 1); // Pathological input: guarantee n log n
+            return a[k];
+        }
+        int mid = lo + (hi - lo) / 2;
+        float x = a[lo], y = a[mid], z = a[hi];
+        float pivot = x < y ? (y < z ? y : (x < z ? z : x)) : (x < z ? x : (y < z ? z : y));
+
+        int i = lo - 1, j = hi + 1;
+        for (;;) {
+            do i++; while (a[i] < pivot);
+            do j--; while (a[j] > pivot);
+            if (i >= j) break;
+            float t = a[i]; a[i] = a[j]; a[j] = t;
+        }
+        if (k <= j) hi = j;
+        else lo = j + 1;
+    }
+    for (int i = lo + 1; i <= hi; i++) {
+        float v = a[i];
+        int j = i - 1;
+        while (j >= lo && a[j] > v) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = v;
+    }
+    return a[k];
+}
+
+int marksPercentile(const StudentList *list, double percentile, double *out) {
+    int n = list->count;
+    if (n == 0 || !(percentile >= 0 && percentile <= 100)) {
+        return 0; // Failure: nothing to rank, or percentile out of range
+    }
+    float *marks = malloc((size_t)n * sizeof(float));
+    if (marks == NULL) {
+        return 0; // Failure: out of memory
+    }
+    if (list->layout == LAYOUT_COLUMNS) {
+        memcpy(marks, list->marks, (size_t)n * sizeof(float));
+    } else {
+        for (int i = 0; i < n; i++) marks[i] = list->students[i].marks;
+    }
+
+    // Linear interpolation between the two closest ranks
+    double pos = percentile / 100.0 * (n - 1);
+    int below = (int)pos;
+    double fraction = pos - below;
+    double value = selectNth(marks, n, below);
+    if (fraction > 0 && below + 1 < n) {
+        // Everything after `below` is >= it, so the next rank is their minimum
+        float next = marks[below + 1];
+        for (int i = below + 2; i < n; i++) {
+            if (marks[i] < next) next = marks[i];
+        }
+        value += fraction * (next - value);
+    }
+    free(marks);
+    *out = value;
+    return 1;
+}
+
+int medianMarks(const StudentList *list, double *out) {
+    return marksPercentile(list, 50.0, out);
+}
+
+int studentRank(const StudentList *list, int roll) {
+    int idx = findStudentRow(list, roll);
+    if (idx == -1) {
+        return 0; // Not found
+    }
+    float marks = studentMarks(list, idx);
+    int better = 0;
+    if (list->layout == LAYOUT_COLUMNS) {
+        for (int i = 0; i < list->count; i++) better += list->marks[i] > marks;
+    } else {
+        for (int i = 0; i < list->count; i++) better += list->students[i].marks > marks;
+    }
+    return better + 1;
+}
+
+// --- Scans ---
+// Big lists are split into chunks on the worker pool. Each chunk writes its
+// matches into rows[] starting at its own first row (it can't have more
+// matches than rows), then one pass slides the chunks' matches together in
+// order.
+
+#define SCAN_GRAIN 65536
+
+typedef struct {
+    const StudentList *list;
+    StudentPredicate match;
+    void *ctx;
+    int *rows;      // NULL: count only
+    int *counts;    // Matches per chunk
+} PredicateScan;
+
+static void predicateTask(void *ctx, long long begin, long long end) {
+    PredicateScan *scan = ctx;
+    for (long long lo = begin; lo < end; lo += SCAN_GRAIN) {
+        int hi = (int)(lo + SCAN_GRAIN < end ? lo + SCAN_GRAIN : end);
+        int found = 0;
+        for (int i = (int)lo; i < hi; i++) {
+            if (!scan->match(scan->list, i, scan->ctx)) continue;
+            if (scan->rows) scan->rows[lo + found] = i;
+            found++;
+        }
+        scan->counts[lo / SCAN_GRAIN] = found;
+    }
+}
+
+int scanStudents(const StudentList *list, StudentPredicate match, void *ctx, int *rows) {
+    int chunks = (list->count + SCAN_GRAIN - 1) / SCAN_GRAIN;
+    int *counts = parallelWorth(list->count) ? malloc((size_t)chunks * sizeof(int)) : NULL;
+    if (counts == NULL) {
+        int found = 0;
+        for (int i = 0; i < list->count; i++) {
+            if (!match(list, i, ctx)) continue;
+            if (rows) rows[found] = i;
+            found++;
+        }
+        return found;
+    }
+    PredicateScan scan = { list, match, ctx, rows, counts };
+    parallelFor(list->count, SCAN_GRAIN, predicateTask, &scan);
+    int found = 0;
+    for (int c = 0; c < chunks; c++) {
+        if (rows && found != c * SCAN_GRAIN) {
+            memmove(rows + found, rows + (size_t)c * SCAN_GRAIN, (size_t)counts[c] * sizeof(int));
+        }
+        found += counts[c];
+    }
+    free(counts);
+    return found;
+}
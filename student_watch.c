@@ -0,0 +1,442 @@
+#include "student_watch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+// --- Reading ---
+
+// The whole file into a heap buffer. missingOk: a missing file reads as
+// empty (rather than failing, as it should while a writer recreates it).
+static int readWhole(const char *path, char **data, size_t *size, int missingOk) {
+    *data = NULL;
+    *size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return missingOk && errno == ENOENT;
+    struct stat st;
+    size_t capacity = fstat(fd, &st) == 0 && st.st_size > 0 ? (size_t)st.st_size + 1 : 4096;
+    char *buffer = malloc(capacity);
+    size_t used = 0;
+    int ok = buffer != NULL;
+    while (ok) {
+        if (used == capacity) { // Grew while we read it
+            char *grown = realloc(buffer, capacity * 2);
+            if (grown == NULL) break;
+            buffer = grown;
+            capacity *= 2;
+        }
+        ssize_t n = read(fd, buffer + used, capacity - used);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ok = n == 0;
+            break;
+        }
+        used += (size_t)n;
+    }
+    close(fd);
+    if (!ok || used == capacity) {
+        free(buffer);
+        return 0;
+    }
+    *data = buffer;
+    *size = used;
+    return 1;
+}
+
+// --- Opening ---
+
+int watchOpen(FileWatch *watch, const char *path) {
+    memset(watch, 0, sizeof(*watch));
+    watch->fd = watch->wd = -1;
+    if (strlen(path) >= sizeof(watch->path)) return 0;
+    strcpy(watch->path, path);
+    const char *slash = strrchr(path, '/');
+    const char *name = slash ? slash + 1 : path;
+    if (*name == '\0' || strlen(name) >= sizeof(watch->fileName)) return 0;
+    strcpy(watch->fileName, name);
+    if (!readWhole(path, &watch->image, &watch->imageSize, 1)) return 0;
+
+#ifdef __linux__
+    char dir[512];
+    if (slash == NULL) {
+        strcpy(dir, ".");
+    } else {
+        size_t len = slash == path ? 1 : (size_t)(slash - path);
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    }
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd >= 0) {
+        watch->wd = inotify_add_watch(watch->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watch->wd < 0) {
+            close(watch->fd);
+            watch->fd = -1;
+        }
+    }
+#endif
+    if (watch->fd < 0) {
+        free(watch->image);
+        watch->image = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+void watchClose(FileWatch *watch) {
+    if (watch->fd >= 0) close(watch->fd);
+    free(watch->image);
+    watch->image = NULL;
+    watch->fd = watch->wd = -1;
+}
+
+int watchFd(const FileWatch *watch) {
+    return watch->fd;
+}
+
+int watchPoll(FileWatch *watch) {
+#ifdef __linux__
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        ssize_t n = read(watch->fd, events, sizeof(events));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break; // EAGAIN: drained
+        for (char *p = events; p < events + n;) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && strcmp(event->name, watch->fileName) == 0)) {
+                watch->pending = 1;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+    return watch->pending;
+}
+
+// --- Line Diff ---
+// Both versions are walked in step. Identical bytes are skipped with
+// memcmp; where they differ, the next few lines of each side are hashed to
+// find the nearest line both go on with, and what lies before it on either
+// side is the change. The window grows (x4) until a common line turns up or
+// both sides run out, so a scattered edit costs a handful of lines and a
+// block of new lines about as many lines as it has. A line that moved comes
+// out on both sides; matching by roll then finds it unchanged.
+
+#define SYNC_WINDOW 16
+
+typedef struct {
+    const char *p;
+    size_t len;             // Without the '\n'
+    const char *next;       // Start of the following line
+} Line;
+
+typedef struct {
+    Line *lines;
+    int count, capacity;
+} LineList;
+
+typedef struct {
+    Line *a, *b;            // The next lines of each side
+    int *table;             // Hash table of a's lines: index into a, -1 = empty
+    unsigned long long *hashes;
+    int capacity;           // Lines per side
+} SyncWindow;
+
+static unsigned long long hashLine(const char *p, size_t len) {
+    unsigned long long h = 0xcbf29ce484222325ull ^ len;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        unsigned long long word;
+        memcpy(&word, p + i, 8);
+        h = (h ^ word) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    for (; i < len; i++) h = (h ^ (unsigned char)p[i]) * 0x100000001b3ull;
+    return h ^ (h >> 32);
+}
+
+static int isBlank(const char *p, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != ' ' && p[i] != '\t' && p[i] != '\r') return 0;
+    }
+    return 1;
+}
+
+static int sameLine(const Line *x, const Line *y) {
+    return x->len == y->len && memcmp(x->p, y->p, x->len) == 0;
+}
+
+static int pushLine(LineList *list, const Line *line) {
+    if (isBlank(line->p, line->len)) return 1; // Blank lines are skipped, as in a load
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        Line *grown = realloc(list->lines, (size_t)capacity * sizeof(Line));
+        if (grown == NULL) return 0;
+        list->lines = grown;
+        list->capacity = capacity;
+    }
+    list->lines[list->count++] = *line;
+    return 1;
+}
+
+// Up to max lines from p
+static int collectLines(const char *p, const char *end, Line *out, int max) {
+    int n = 0;
+    for (; n < max && p < end; n++) {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        out[n] = (Line){ p, (size_t)((eol ? eol : end) - p), eol ? eol + 1 : end };
+        p = out[n].next;
+    }
+    return n;
+}
+
+// Bytes both sides start with, cut back to whole lines
+static size_t commonLines(const char *a, const char *aEnd, const char *b, const char *bEnd) {
+    size_t na = (size_t)(aEnd - a), nb = (size_t)(bEnd - b);
+    size_t shorter = na < nb ? na : nb, m = 0;
+    while (m + 4096 <= shorter && memcmp(a + m, b + m, 4096) == 0) m += 4096;
+    while (m < shorter && a[m] == b[m]) m++;
+    int aWhole = m == na || (m > 0 && a[m - 1] == '\n');
+    int bWhole = m == nb || (m > 0 && b[m - 1] == '\n');
+    if (!(aWhole && bWhole)) {
+        while (m > 0 && a[m - 1] != '\n') m--;
+    }
+    return m;
+}
+
+static int growWindow(SyncWindow *w, int capacity) {
+    Line *a = realloc(w->a, (size_t)capacity * sizeof(Line));
+    if (a) w->a = a;
+    Line *b = realloc(w->b, (size_t)capacity * sizeof(Line));
+    if (b) w->b = b;
+    unsigned long long *hashes = realloc(w->hashes, (size_t)capacity * sizeof(unsigned long long));
+    if (hashes) w->hashes = hashes;
+    int *table = realloc(w->table, (size_t)capacity * 2 * sizeof(int));
+    if (table) w->table = table;
+    if (!a || !b || !hashes || !table) return 0;
+    w->capacity = capacity;
+    return 1;
+}
+
+// The lines only in [a, aEnd) go to gone, those only in [b, bEnd) to arrived
+static int diffLines(const char *a, const char *aEnd, const char *b, const char *bEnd, LineList *gone, LineList *arrived) {
+    SyncWindow w = { NULL, NULL, NULL, NULL, 0 };
+    int ok = growWindow(&w, SYNC_WINDOW);
+    int window = SYNC_WINDOW;
+    while (ok) {
+        size_t same = commonLines(a, aEnd, b, bEnd);
+        a += same;
+        b += same;
+        if (a == aEnd && b == bEnd) break;
+
+        if (window > w.capacity && !growWindow(&w, window)) {
+            ok = 0;
+            break;
+        }
+        int na = collectLines(a, aEnd, w.a, window);
+        int nb = collectLines(b, bEnd, w.b, window);
+        unsigned mask = (unsigned)window * 2 - 1;
+        for (unsigned i = 0; i <= mask; i++) w.table[i] = -1;
+        for (int i = 0; i < na; i++) {
+            w.hashes[i] = hashLine(w.a[i].p, w.a[i].len);
+            unsigned k = (unsigned)w.hashes[i] & mask;
+            while (w.table[k] >= 0 && !(w.hashes[w.table[k]] == w.hashes[i] && sameLine(&w.a[w.table[k]], &w.a[i]))) {
+                k = (k + 1) & mask;
+            }
+            if (w.table[k] < 0) w.table[k] = i; // The first copy is the nearest
+        }
+
+        // The common line with the fewest lines before it, counting both sides
+        int syncA = -1, syncB = -1;
+        for (int j = 0; j < nb && (syncA < 0 || j < syncA + syncB); j++) {
+            unsigned long long hash = hashLine(w.b[j].p, w.b[j].len);
+            for (unsigned k = (unsigned)hash & mask; w.table[k] >= 0; k = (k + 1) & mask) {
+                int i = w.table[k];
+                if (w.hashes[i] != hash || !sameLine(&w.a[i], &w.b[j])) continue;
+                if (syncA < 0 || i + j < syncA + syncB) {
+                    syncA = i;
+                    syncB = j;
+                }
+                break;
+            }
+        }
+        if (syncA < 0 && (na == window || nb == window)) {
+            window *= 4; // Nothing in common yet: look further
+            continue;
+        }
+        if (syncA < 0) { // Both sides end here
+            syncA = na;
+            syncB = nb;
+        }
+        for (int i = 0; i < syncA && ok; i++) ok = pushLine(gone, &w.a[i]);
+        for (int j = 0; j < syncB && ok; j++) ok = pushLine(arrived, &w.b[j]);
+        a = syncA < na ? w.a[syncA].next : aEnd; // Past the common line
+        b = syncB < nb ? w.b[syncB].next : bEnd;
+        window = SYNC_WINDOW;
+    }
+    free(w.a);
+    free(w.b);
+    free(w.hashes);
+    free(w.table);
+    return ok;
+}
+
+// --- Applying ---
+
+typedef struct {
+    int roll;
+    int before, after;      // Rows of the parsed old / new lines; -1 = none
+} RollChange;
+
+typedef struct {
+    RollChange *changes;
+    int count;
+    unsigned mask;
+} ChangeTable;
+
+static RollChange *changeFor(ChangeTable *table, int roll) {
+    for (unsigned i = ((unsigned)roll * 2654435761u) & table->mask;; i = (i + 1) & table->mask) {
+        RollChange *change = &table->changes[i];
+        if (change->before == -2) {
+            *change = (RollChange){ roll, -1, -1 };
+            table->count++;
+            return change;
+        }
+        if (change->roll == roll) return change;
+    }
+}
+
+static int sameInput(const StudentInput *a, const StudentInput *b) {
+    return a->nameLen == b->nameLen && memcmp(a->name, b->name, a->nameLen) == 0 && a->marks == b->marks;
+}
+
+// Does row idx hold what the line says (allowing for names cut to fit)?
+static int listHolds(const StudentList *list, int idx, const StudentInput *row) {
+    const char *name = studentName(list, idx);
+    size_t len = strlen(name);
+    int nameMatches = len == row->nameLen ||
+                      (list->layout == LAYOUT_ROWS && len == NAME_LEN - 1 && row->nameLen > len);
+    return nameMatches && memcmp(name, row->name, len) == 0 && studentMarks(list, idx) == row->marks;
+}
+
+static int parseLines(const LineList *lines, StudentInput *rows, WatchReport *report, int countMalformed) {
+    int n = 0;
+    for (int i = 0; i < lines->count; i++) {
+        report->bytesParsed += lines->lines[i].len;
+        if (parseCsvLine(lines->lines[i].p, lines->lines[i].p + lines->lines[i].len, &rows[n])) n++;
+        else if (countMalformed) report->malformed++;
+    }
+    return n;
+}
+
+// Three-way merge of the rolls that changed in the file into the list
+static int applyChanges(StudentList *list, const StudentInput *before, int beforeCount,
+                        const StudentInput *after, int afterCount, WatchReport *report) {
+    int total = beforeCount + afterCount;
+    unsigned capacity = 16;
+    while (capacity < (unsigned)total * 2) capacity <<= 1;
+    ChangeTable table = { malloc(capacity * sizeof(RollChange)), 0, capacity - 1 };
+    int *removes = malloc((size_t)(total + 1) * sizeof(int));
+    StudentInput *adds = malloc((size_t)(total + 1) * sizeof(StudentInput));
+    StudentUpdate *updates = malloc((size_t)(total + 1) * sizeof(StudentUpdate));
+    RowResult *results = malloc((size_t)(total + 1) * sizeof(RowResult));
+    size_t nameBytes = 0;
+    for (int i = 0; i < afterCount; i++) nameBytes += after[i].nameLen + 1;
+    char *names = malloc(nameBytes + 1);
+    int ok = table.changes && removes && adds && updates && results && names;
+    if (!ok) goto done;
+
+    for (unsigned i = 0; i < capacity; i++) table.changes[i].before = -2;
+    for (int i = 0; i < beforeCount; i++) {
+        RollChange *change = changeFor(&table, before[i].roll);
+        if (change->before == -1) change->before = i; // Repeated rolls: the first counts, as in a load
+    }
+    for (int i = 0; i < afterCount; i++) {
+        RollChange *change = changeFor(&table, after[i].roll);
+        if (change->after == -1) change->after = i;
+    }
+
+    int removeCount = 0, addCount = 0, updateCount = 0;
+    char *nameAt = names;
+    for (unsigned i = 0; i < capacity; i++) {
+        const RollChange *change = &table.changes[i];
+        if (change->before == -2) continue;
+        const StudentInput *was = change->before >= 0 ? &before[change->before] : NULL;
+        const StudentInput *now = change->after >= 0 ? &after[change->after] : NULL;
+        if (was && now && sameInput(was, now)) continue; // Only the spacing or number format changed
+        int idx = searchStudent(list, change->roll);
+        if (idx == -1) {
+            if (was == NULL) adds[addCount++] = *now;
+            else if (now != NULL) report->kept++; // Removed here since
+        } else if (now != NULL && listHolds(list, idx, now)) {
+            continue; // Already there: our own save, or the same edit made here
+        } else if (was == NULL || !listHolds(list, idx, was)) {
+            report->kept++; // Changed here since
+        } else if (now == NULL) {
+            removes[removeCount++] = change->roll;
+        } else if (now->marks < 0) { // modifyStudent reads negative marks as "keep"
+            removes[removeCount++] = change->roll;
+            adds[addCount++] = *now;
+        } else {
+            memcpy(nameAt, now->name, now->nameLen);
+            nameAt[now->nameLen] = '\0';
+            updates[updateCount++] = (StudentUpdate){ change->roll, nameAt, now->marks };
+            nameAt += now->nameLen + 1;
+        }
+    }
+
+    ok = removeStudents(list, removes, removeCount, results);
+    for (int i = 0; i < removeCount; i++) report->removed += results[i] == ROW_OK;
+    ok = modifyStudents(list, updates, updateCount, results) && ok;
+    for (int i = 0; i < updateCount; i++) report->modified += results[i] == ROW_OK;
+    ok = addStudents(list, adds, addCount, results) && ok;
+    for (int i = 0; i < addCount; i++) report->added += results[i] == ROW_OK;
+
+done:
+    free(table.changes);
+    free(removes);
+    free(adds);
+    free(updates);
+    free(results);
+    free(names);
+    return ok;
+}
+
+int watchApply(FileWatch *watch, StudentList *list, WatchReport *report) {
+    memset(report, 0, sizeof(*report));
+    char *fresh;
+    size_t freshSize;
+    if (!readWhole(watch->path, &fresh, &freshSize, 0)) return 0;
+    watch->pending = 0;
+    const char *a = watch->image ? watch->image : "", *b = fresh ? fresh : "";
+    size_t na = watch->imageSize, nb = freshSize;
+    report->bytesCompared = na + nb;
+
+    LineList gone = { NULL, 0, 0 }, arrived = { NULL, 0, 0 };
+    int ok = diffLines(a, a + na, b, b + nb, &gone, &arrived);
+    StudentInput *before = malloc((size_t)(gone.count + 1) * sizeof(StudentInput));
+    StudentInput *after = malloc((size_t)(arrived.count + 1) * sizeof(StudentInput));
+    ok = ok && before && after;
+    if (ok) {
+        int beforeCount = parseLines(&gone, before, report, 0);
+        int afterCount = parseLines(&arrived, after, report, 1);
+        ok = applyChanges(list, before, beforeCount, after, afterCount, report);
+    }
+    free(gone.lines);
+    free(arrived.lines);
+    free(before);
+    free(after);
+    if (!ok) { // Out of memory part way: what was applied stays, and the next apply diffs the same versions again
+        free(fresh);
+        watch->pending = 1;
+        return 0;
+    }
+    free(watch->image);
+    watch->image = fresh;
+    watch->imageSize = freshSize;
+    return 1;
+}
@@ -0,0 +1,47 @@
+#ifndef STUDENT_WATCH_H
+#define STUDENT_WATCH_H
+
+#include "student_logic.h"
+
+// Live reload of a CSV file (students.txt) that other programs rewrite.
+//
+// inotify watches the file's directory, so both in-place rewrites
+// (IN_CLOSE_WRITE) and write-then-rename (IN_MOVED_TO) are seen. The watch
+// keeps the file as it was at the last apply. watchApply reads the new
+// version and walks both in step, skipping identical runs with memcmp and
+// resynchronising on a common line after each difference: only the lines
+// that differ are hashed and parsed. Matching their rolls gives the adds,
+// modifies and removes, which go to the list as three batch calls (views
+// hear of them through the list's change feed). The parse and the list
+// updates scale with the change; the file is still read and compared once.
+//
+// The list may have changed since the last apply (edits not saved yet, or
+// a save of our own, which rewrites the file too). A roll is only updated
+// if the list still holds what the old file said, so local edits win over
+// the file and re-reading our own save is a no-op.
+
+typedef struct {
+    char path[512];
+    char fileName[256];      // path's last component, as inotify reports it
+    int fd;                  // inotify, -1 if not available
+    int wd;
+    char *image;             // The file as of the last apply
+    size_t imageSize;
+    int pending;             // Seen a change not yet applied
+} FileWatch;
+
+typedef struct {
+    int added, modified, removed;
+    int kept;                // File changes not applied because the list changed that roll too
+    int malformed;           // Changed lines that did not parse
+    size_t bytesCompared;    // Both versions
+    size_t bytesParsed;      // Changed lines only
+} WatchReport;
+
+int watchOpen(FileWatch *watch, const char *path); // Takes the file as it is now as the baseline
+void watchClose(FileWatch *watch);
+int watchFd(const FileWatch *watch);        // Readable when there are events; -1 without inotify
+int watchPoll(FileWatch *watch);            // Drains the events; 1 if the file changed since the last apply
+int watchApply(FileWatch *watch, StudentList *list, WatchReport *report); // 0 if the file can't be read (try again later)
+
+#endif // STUDENT_WATCH_H
@@ -0,0 +1,178 @@
+// Stress test for SharedStudentList: a writer keeps committing edits while
+// reader threads acquire snapshots, and every snapshot is checked in full,
+// twice, while it is held. The writer's edits keep the row count and the marks
+// total constant, so a torn, half-published or recycled version shows up
+// as a wrong count, a wrong total, a stale roll index or a version number
+// that changes under the reader. Exits non-zero on the first failure.
+// Usage: test_shared [seconds]   (default 2; run by `make check`)
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include "../student_shared.h"
+
+#define ROWS 2000
+#define READERS 6
+#define EDITS_PER_COMMIT 16
+
+typedef struct {
+    SharedStudentList *shared;
+    double marksTotal;
+    atomic_int *stop;
+    unsigned seed;
+    long long snapshots;
+    char failure[160];       // First problem seen, "" if none
+} Worker;
+
+static unsigned nextRand(unsigned *state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Returns 0 (and records why) on the first inconsistency in list
+static int checkList(Worker *w, const StudentList *list) {
+    if (list->count != ROWS) {
+        snprintf(w->failure, sizeof(w->failure), "%d rows, expected %d", list->count, ROWS);
+        return 0;
+    }
+    double total = 0;
+    for (int i = 0; i < list->count; i++) {
+        total += studentMarks(list, i);
+        if (searchStudent(list, studentRoll(list, i)) != i) {
+            snprintf(w->failure, sizeof(w->failure), "roll index is stale at row %d", i);
+            return 0;
+        }
+    }
+    if (total != w->marksTotal) {
+        snprintf(w->failure, sizeof(w->failure), "marks total %.0f, expected %.0f", total, w->marksTotal);
+        return 0;
+    }
+    return 1;
+}
+
+static void *readerMain(void *arg) {
+    Worker *w = arg;
+    unsigned long long lastVersion = 0;
+    while (!atomic_load(&w->stop[0]) && w->failure[0] == '\0') {
+        const SharedVersion *version = sharedAcquire(w->shared);
+        unsigned long long seen = version->version;
+        if (seen < lastVersion) {
+            snprintf(w->failure, sizeof(w->failure), "version went back from %llu to %llu", lastVersion, seen);
+        } else if (checkList(w, &version->list)) {
+            // Hold it a while (across several commits, now and then) and
+            // look again: a version recycled under the reader has changed
+            if (nextRand(&w->seed) % 32 == 0) usleep(1000);
+            else sched_yield();
+            if (checkList(w, &version->list) && version->version != seen) {
+                snprintf(w->failure, sizeof(w->failure), "version %llu was reused while held", seen);
+            }
+        }
+        lastVersion = seen;
+        sharedRelease(w->shared, version);
+        w->snapshots++;
+    }
+    atomic_store(&w->stop[0], 1); // One failure is enough
+    return NULL;
+}
+
+// Moves marks between students and replaces students with new rolls that
+// carry the same marks: the count and total never change
+static void *writerMain(void *arg) {
+    Worker *w = arg;
+    int nextRoll = ROWS + 1;
+    int rolls[EDITS_PER_COMMIT];
+    RowResult removed[EDITS_PER_COMMIT];
+    StudentInput added[EDITS_PER_COMMIT];
+    float marks[EDITS_PER_COMMIT];
+    char names[EDITS_PER_COMMIT][32];
+    while (!atomic_load(&w->stop[0])) {
+        StudentList *list = sharedBeginWrite(w->shared);
+        if (list == NULL) {
+            snprintf(w->failure, sizeof(w->failure), "sharedBeginWrite ran out of memory");
+            break;
+        }
+        for (int e = 0; e < EDITS_PER_COMMIT; e++) {
+            int a = (int)(nextRand(&w->seed) % ROWS), b = (int)(nextRand(&w->seed) % ROWS);
+            if (a != b && studentMarks(list, a) >= 1) {
+                modifyStudent(list, studentRoll(list, a), NULL, studentMarks(list, a) - 1);
+                modifyStudent(list, studentRoll(list, b), NULL, studentMarks(list, b) + 1);
+            }
+        }
+        for (int e = 0; e < EDITS_PER_COMMIT; e++) {
+            int c = (int)(nextRand(&w->seed) % ROWS);
+            rolls[e] = studentRoll(list, c);
+            marks[e] = studentMarks(list, c);
+        }
+        removeStudents(list, rolls, EDITS_PER_COMMIT, removed);
+        int n = 0;
+        for (int e = 0; e < EDITS_PER_COMMIT; e++) {
+            if (removed[e] != ROW_OK) continue; // Picked twice
+            snprintf(names[n], sizeof(names[n]), "Student %d", nextRoll);
+            added[n] = (StudentInput){ names[n], strlen(names[n]), nextRoll++, marks[e] };
+            n++;
+        }
+        addStudents(list, added, n, NULL);
+        sharedCommit(w->shared);
+        w->snapshots++;
+    }
+    atomic_store(&w->stop[0], 1);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+
+    // Whole-number marks, so the total is exact in a double
+    StudentList seed;
+    initListLayout(&seed, LAYOUT_COLUMNS);
+    double marksTotal = 0;
+    unsigned state = 12345u;
+    for (int i = 0; i < ROWS; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "Student %d", i + 1);
+        float marks = (float)(nextRand(&state) % 101);
+        addStudent(&seed, name, i + 1, marks);
+        marksTotal += marks;
+    }
+    SharedStudentList shared;
+    if (!sharedInit(&shared, LAYOUT_COLUMNS) || !sharedPublishCopy(&shared, &seed)) {
+        fprintf(stderr, "test_shared: out of memory\n");
+        return EXIT_FAILURE;
+    }
+    freeList(&seed);
+
+    atomic_int stop;
+    atomic_init(&stop, 0);
+    Worker workers[READERS + 1];
+    pthread_t threads[READERS + 1];
+    for (int t = 0; t <= READERS; t++) {
+        workers[t] = (Worker){ &shared, marksTotal, &stop, 2463534242u + (unsigned)t * 7919u, 0, "" };
+        pthread_create(&threads[t], NULL, t == 0 ? writerMain : readerMain, &workers[t]);
+    }
+    for (int waited = 0; waited < (int)(seconds * 100) && !atomic_load(&stop); waited++) {
+        usleep(10000);
+    }
+    atomic_store(&stop, 1);
+
+    int failed = 0;
+    long long snapshots = 0;
+    for (int t = 0; t <= READERS; t++) {
+        pthread_join(threads[t], NULL);
+        if (t > 0) snapshots += workers[t].snapshots;
+        if (workers[t].failure[0] != '\0') {
+            fprintf(stderr, "test_shared: %s: %s\n", t == 0 ? "writer" : "reader", workers[t].failure);
+            failed = 1;
+        }
+    }
+    sharedDestroy(&shared);
+    if (failed) return EXIT_FAILURE;
+    printf("test_shared: ok (%lld commits, %lld snapshots checked)\n", workers[0].snapshots, snapshots);
+    return 0;
+}